@@ -32,7 +32,9 @@
 #include "common/filesystem.hpp"
 #include "common/quantity.hpp"
 #include "common/system.hpp"
+#include "experiment/details/query_scheduler.hpp"
 #include "experiment/graphalytics.hpp"
+#include "graph/vertex_reordering.hpp"
 #include "library/interface.hpp"
 #include "reader/graphlog_reader.hpp"
 #include "third-party/cxxopts/cxxopts.hpp"
@@ -102,28 +104,38 @@ void Configuration::initialise(int argc, char* argv[]){
         ("aging_memfp_report", "Whether to log to stdout the memory footprint measurements observed", value<bool>()->default_value("false"))
         ("aging_memfp_threshold", "Forcedly stop the execution of the aging experiment if the memory footprint of the whole process is above this threshold", value<ComputerQuantity>())
         ("aging_release_memory", "Whether to release the memory from the driver as the experiment proceeds", value<bool>()->default_value("true"))
+        ("aging_decoders", "Number of threads to decompress the blocks of the log of updates concurrently. The boundaries of the blocks are cached in the file <log>.blocks", value<uint64_t>()->default_value("1"))
+        ("aging_stream", "Overlap the decompression of the log with the execution of the updates, keeping at most the given amount of MB of decoded updates in the driver (0 = load the whole log upfront)", value<uint64_t>()->default_value("0"))
         ("aging_step_size", "The step of each recording for the measured progress in the Aging2 experiment. Valid values are 0.1, 0.25, 0.5 and 1.0", value<double>()->default_value("1"))
         ("aging_timeout", "Force terminating the aging experiment after the given amount of time (excl. cool-off time)", value<DurationQuantity>())
         ("blacklist", "Comma separated list of graph algorithms to blacklist and do not execute", value<string>())
         ("build_frequency", "The frequency to build a new snapshot in the aging experiment (default: disabled)", value<DurationQuantity>())
         ("d, database", "Store the current configuration value into the a sqlite3 database at the given location", value<string>())
+        ("dense_vertices", "The vertex IDs of the graph are dense in [0, N). Supported by GTX, which translates these IDs with a flat array rather than a hash map (0 = disabled)", value<uint64_t>()->default_value("0"))
         ("efe", "Expansion factor for the edges in the graph", value<double>()->default_value(to_string(get_ef_edges())))
         ("efv", "Expansion factor for the vertices in the graph", value<double>()->default_value(to_string(get_ef_vertices())))
         ("G, graph", "The path to the graph to load", value<string>())
         ("h, help", "Show this help menu")
-        ("latency", "Measure the latency of inserts/updates, report the average, median, std. dev. and 90/95/97/99 percentiles")
+        ("latency", "Measure the latency of inserts/updates, report the average, median, std. dev. and 90/95/97/99/99.9/99.99 percentiles")
         ("l, library", libraries_help_screen(), value<string>())
         ("load", "Load the graph into the library in one go")
         ("log", "Repeat the log of updates specified in the given file", value<string>())
+        ("mixed_queries", "In the mixed workload, run short queries concurrently with the updates. Comma separated list of pools of readers <query>:<num_threads>[:<num_vertices>], with query either one_hop or two_hop, e.g. one_hop:8,two_hop:2:16", value<string>())
         ("max_weight", "The maximum weight that can be assigned when reading non weighted graphs", value<double>()->default_value(to_string(max_weight())))
         ("omp", "Maximum number of threads that can be used by OpenMP (0 = do not change)", value<int>()->default_value(to_string(num_threads_omp())))
+        ("perf_counters", "Measure the hardware counters (cycles, instructions, LLC/dTLB/branch misses) of the update and analytics phases, through perf_event_open")
+        ("reorder", "Reorder the vertices while loading the graph with --load, to improve the locality of the Graphalytics kernels: none, degree, hub, rcm or gorder", value<string>()->default_value("none"))
         ("R, repetitions", "The number of repetitions of the same experiment (where applicable)", value<uint64_t>()->default_value(to_string(num_repetitions())))
         ("r, readers", "The number of client threads to use for the read operations", value<int>()->default_value(to_string(num_threads(THREADS_READ))))
         ("seed", "Random seed used in various places in the experiments", value<uint64_t>()->default_value(to_string(seed())))
         ("t, threads", "The number of threads to use for both the read and write operations", value<int>()->default_value(to_string(num_threads(THREADS_TOTAL))))
+        ("timeline", "Sample the throughput and the latency of the updates at the given interval, in the aging experiment (default: disabled)", value<DurationQuantity>())
         ("timeout", "Set the maximum time for an operation to complete, in seconds", value<uint64_t>()->default_value(to_string(get_timeout_graphalytics())))
+        ("update_batch", "Number of updates performed together in a single call to the library, in the insert only and aging experiments (1 = one update at the time)", value<uint64_t>()->default_value("1"))
+        ("update_batch_atomicity", "The atomicity of each group of updates: per_edge, per_batch (all or nothing) or best_effort", value<string>()->default_value("best_effort"))
         ("u, undirected", "Is the graph undirected? By default, it's considered directed.")
         ("v, validate", "Whether to validate the output results of the Graphalytics algorithms", value<string>()->implicit_value("<path>"))
+        ("validate_binary", "With --validate, the Graphalytics algorithms save their results in a binary format, rather than text, faster to write and to parse")
         ("w, writers", "The number of client threads to use for the write operations", value<int>()->default_value(to_string(num_threads(THREADS_WRITE))))
         ("b, block_size", "The block size for Sortledton to use.", value<int>()->default_value("1024"))
         ("m, mixed_workload", "If set run updates and analytics concurrently.", value<bool>()->default_value("false"))
@@ -246,6 +258,8 @@ void Configuration::initialise(int argc, char* argv[]){
                     m_validate_graph = path_validate_graph;
                 }
             }
+
+            m_validate_binary = result["validate_binary"].count() > 0;
         }
 
         if ( result["omp"].count() > 0 ){
@@ -268,6 +282,11 @@ void Configuration::initialise(int argc, char* argv[]){
           m_is_mixed_workload = result["mixed_workload"].as<bool>();
         }
 
+        if(result["mixed_queries"].count() > 0){
+            m_mixed_queries = result["mixed_queries"].as<string>();
+            experiment::details::QueryScheduler::parse(m_mixed_queries); // validate
+        }
+
         if( result["aging_memfp_physical"].count() > 0 ){
             m_aging_memfp_physical = result["aging_memfp_physical"].as<bool>();
         }
@@ -284,6 +303,38 @@ void Configuration::initialise(int argc, char* argv[]){
             m_aging_release_memory = result["aging_release_memory"].as<bool>();
         }
 
+        if(result["aging_decoders"].count() > 0){
+            m_aging_num_decoders = max<uint64_t>(1, result["aging_decoders"].as<uint64_t>());
+        }
+
+        if(result["aging_stream"].count() > 0){
+            m_aging_stream_buffer = result["aging_stream"].as<uint64_t>() * 1024ull * 1024ull; // MB -> bytes
+        }
+
+        if(result["timeline"].count() > 0){
+            m_timeline_interval = result["timeline"].as<DurationQuantity>().as<chrono::milliseconds>().count();
+        }
+
+        if(result["dense_vertices"].count() > 0){
+            m_dense_vertices = result["dense_vertices"].as<uint64_t>();
+        }
+
+        if(result["update_batch"].count() > 0){
+            m_update_batch_size = max<uint64_t>(1, result["update_batch"].as<uint64_t>());
+        }
+
+        if(result["update_batch_atomicity"].count() > 0){
+            string atomicity = result["update_batch_atomicity"].as<string>();
+            library::parse_batch_atomicity(atomicity); // validate
+            m_update_batch_atomicity = atomicity;
+        }
+
+        if(result["reorder"].count() > 0){
+            string reorder = result["reorder"].as<string>();
+            graph::parse_vertex_reordering(reorder); // validate
+            m_reorder = reorder;
+        }
+
         if( result["blacklist"].count() > 0 ){
             string algorithm;
             stringstream ss(result["blacklist"].as<string>());
@@ -302,6 +353,7 @@ void Configuration::initialise(int argc, char* argv[]){
         } // blacklist
 
         m_measure_latency = result["latency"].count() > 0;
+        m_perf_counters = result["perf_counters"].count() > 0;
 
         if ( result["aging_timeout"].count() > 0 ){
             set_timeout_aging2( result["aging_timeout"].as<DurationQuantity>().as<chrono::seconds>().count() );
@@ -543,8 +595,14 @@ void Configuration::save_parameters() {
     params.push_back(P{"aging_memfp_threshold", to_string(get_aging_memfp_threshold())});
     params.push_back(P{"aging_release_memory", to_string(get_aging_release_memory())});
     params.push_back(P{"aging_step_size", to_string(get_aging_step_size())});
+    params.push_back(P{"aging_num_decoders", to_string(get_aging_num_decoders())});
+    params.push_back(P{"aging_stream_buffer", to_string(get_aging_stream_buffer())});
     params.push_back(P{"aging_timeout", to_string(get_timeout_aging2())});
     params.push_back(P{"build_frequency", to_string(get_build_frequency())}); // milliseconds
+    params.push_back(P{"update_batch", to_string(get_update_batch_size())});
+    params.push_back(P{"update_batch_atomicity", get_update_batch_atomicity()});
+    params.push_back(P{"dense_vertices", to_string(get_dense_vertices())});
+    params.push_back(P{"reorder", get_vertex_reordering()});
     params.push_back(P{"ef_edges", to_string(get_ef_edges())});
     params.push_back(P{"ef_vertices", to_string(get_ef_vertices())});
     if(!get_path_graph().empty()){ params.push_back(P{"graph", get_path_graph()}); }
@@ -554,6 +612,8 @@ void Configuration::save_parameters() {
     params.push_back(P{"num_threads_read", to_string(num_threads(ThreadsType::THREADS_READ))});
     params.push_back(P{"num_threads_write", to_string(num_threads(ThreadsType::THREADS_WRITE))});
     params.push_back(P{"omp_proc_bind", omp_proc_bind_to_string()});
+    params.push_back(P{"perf_counters", to_string(measure_perf_counters())});
+    params.push_back(P{"timeline_interval", to_string(get_timeline_interval())}); // milliseconds
     params.push_back(P{"timeout", to_string(get_timeout_graphalytics())});
     params.push_back(P{"directed", to_string(is_graph_directed())});
     params.push_back(P{"library", get_library_name()});
@@ -569,8 +629,10 @@ void Configuration::save_parameters() {
     params.push_back(P{"validate_inserts", to_string(validate_inserts())});
     params.push_back(P{"validate_output", to_string(validate_output())});
     params.push_back(P{"validate_output_graph", get_validation_graph()});
+    params.push_back(P{"validate_output_binary", to_string(validate_output_binary())});
     params.push_back(P{"block_size", to_string(block_size())});
     params.push_back(P{"is_mixed_workload", to_string(m_is_mixed_workload)});
+    if(!m_mixed_queries.empty()) params.push_back(P{"mixed_queries", m_mixed_queries});
 
     if(!m_blacklist.empty()){
         stringstream ss;
@@ -65,11 +65,14 @@ class Configuration {
     bool m_aging_memfp_report = false; // whether to print stdout the measurements observed for the memory footprint
     uint64_t m_aging_memfp_threshold { 0 }; // forcedly stop the execution of the aging2 experiment if the process is using more memory than this threshold, in bytes
     bool m_aging_release_memory = true; // whether to release the memory from the driver as the experiment proceeds
+    uint64_t m_aging_num_decoders { 1 }; // number of threads to decompress the log of updates in the aging2 experiment
+    uint64_t m_aging_stream_buffer { 0 }; // if > 0, stream the updates of the log in the aging2 experiment, with a buffer of the given amount of bytes
     std::vector<std::string> m_blacklist; // list of graph algorithms that cannot be executed
     uint64_t m_build_frequency { 0 }; // in the aging experiment, the amount of time that must pass before each invocation to #build(), in milliseconds
     double m_coeff_aging { 0.0 }; // coefficient for the additional updates to perform
     common::Database* m_database { nullptr }; // handle to the database
     std::string m_database_path { "" }; // the path where to store the results
+    uint64_t m_dense_vertices { 0 }; // if > 0, the external vertex IDs are dense in [0, m_dense_vertices)
     double m_ef_vertices = 1; // expansion factor for the vertices in the graph
     double m_ef_edges = 1;  // expansion factor for the edges in the graph
     bool m_graph_directed = true; // whether the graph is undirected or directed
@@ -77,20 +80,27 @@ class Configuration {
     bool m_load = false; // whether to load the graph in one go
     double m_max_weight { 1.0 }; // the maximum weight that can be assigned when reading non weighted graphs
     bool m_measure_latency = false; // whether to measure the latency of the update operations (insert/deletion).
+    std::string m_mixed_queries; // in the mixed workload, the pools of readers executing short queries concurrently with the updates
     uint64_t m_num_repetitions { 0 }; // when applicable, how many times the same experiment should be repeated
     int m_num_threads_omp { 0 }; // if different than 0, the max number of threads used by OpenMP
     int m_num_threads_read { 0 }; // number of threads to use for the read operations. The value of 0 is the default of OpenMP.
     int m_num_threads_write { 1 }; // number of threads to use for the write (insert/update/delete) operations
     std::string m_path_graph_to_load; // the file must be accessible to the server
+    bool m_perf_counters = false; // whether to measure the hardware counters (cycles, cache & TLB misses, ...) of the update and analytics phases
+    std::string m_reorder { "none" }; // how to reorder the vertices while loading the graph: none, degree, hub, rcm or gorder
     uint64_t m_seed = 5051789ull; // random seed, used in various places in the experiments
     double m_step_size_recordings { 1.0 }; // in the aging2 experiment, how often to record the progress done in the db. It must be a value in (0, 1].
+    uint64_t m_timeline_interval { 0 }; // in the aging2 experiment, how often to sample the throughput and the latency of the updates, in milliseconds (0 = disabled)
     uint64_t m_timeout_aging2 { 0 }; // forcedly stop the aging2 experiment after the given amount of seconds
     uint64_t m_timeout_graphalytics { 3600 }; // max time to complete a kernel from Graphalytics, in seconds (0 => indefinite)
+    uint64_t m_update_batch_size { 1 }; // number of updates performed together with UpdateInterface#update_batch (1 = one update at the time)
+    std::string m_update_batch_atomicity { "best_effort" }; // atomicity of each group of updates: per_edge, per_batch or best_effort
     std::string m_update_log; // aging experiment through the log file
     std::unique_ptr<library::Interface> (*m_library_factory)(bool directed) {nullptr} ; // function to retrieve an instance of the library `m_library_name'
     std::string m_validate_graph; // validate the results from graphalytics against the given graph
     bool m_validate_inserts = false; // whether to validate the edges inserted
     bool m_validate_output = false; // whether to validate the execution results of the Graphalytics algorithms
+    bool m_validate_binary = false; // whether the results to validate are saved in the binary format, rather than text
     size_t m_block_size = 1024;  // Block size for Sortledton to use
     bool m_is_mixed_workload = false;
     bool m_is_timestamped_graph = false;
@@ -149,6 +159,9 @@ public:
     // Whether to validate the execution results of the Graphalytics algorithms
     bool validate_output() const { return m_validate_output; }
 
+    // Whether the results to validate are saved in the binary format of utility/result_writer.hpp
+    bool validate_output_binary() const { return m_validate_binary; }
+
     // Whether to validate the edges inserted
     bool validate_inserts() const { return m_validate_inserts; }
 
@@ -167,6 +180,9 @@ public:
     // Measure the latency of update operations ?
     bool measure_latency() const { return m_measure_latency; }
 
+    // Measure the hardware counters of the update and analytics phases ?
+    bool measure_perf_counters() const { return m_perf_counters; }
+
     // Number of repetitions of the same experiment (when applicable)
     uint64_t num_repetitions() const { return m_num_repetitions; }
 
@@ -215,6 +231,30 @@ public:
     // Whether to release the memory from the driver as the experiment proceeds
     bool get_aging_release_memory() const { return m_aging_release_memory; }
 
+    // Number of threads to decompress the log of updates in the aging2 experiment
+    uint64_t get_aging_num_decoders() const { return m_aging_num_decoders; }
+
+    // The amount of bytes for the updates decoded and not yet executed in the aging2 experiment, streaming mode (0 = load the whole log upfront)
+    uint64_t get_aging_stream_buffer() const { return m_aging_stream_buffer; }
+
+    // Number of updates performed together with UpdateInterface#update_batch in the insert only and aging2 experiments (1 = one update at the time)
+    uint64_t get_update_batch_size() const { return m_update_batch_size; }
+
+    // The atomicity of each group of updates, as accepted by library::parse_batch_atomicity
+    const std::string& get_update_batch_atomicity() const { return m_update_batch_atomicity; }
+
+    // How often to sample the throughput and the latency of the updates in the aging2 experiment, in milliseconds (0 = disabled)
+    uint64_t get_timeline_interval() const { return m_timeline_interval; }
+
+    // The pools of readers executing short queries in the mixed workload, as parsed by experiment::details::QueryScheduler::parse (empty = disabled)
+    const std::string& get_mixed_queries() const { return m_mixed_queries; }
+
+    // How to reorder the vertices while loading the graph, as accepted by graph::parse_vertex_reordering
+    const std::string& get_vertex_reordering() const { return m_reorder; }
+
+    // If > 0, the external vertex IDs are dense in [0, get_dense_vertices()). The libraries that support it can translate them with a flat array
+    uint64_t get_dense_vertices() const { return m_dense_vertices; }
+
     // Check whether the configuration/results need to be stored into a database
     bool has_database() const;
 
@@ -104,6 +104,10 @@ void Aging2Experiment::set_measure_latency(bool value){
     m_measure_latency = value;
 }
 
+void Aging2Experiment::set_timeline(std::chrono::milliseconds interval){
+    m_timeline_interval = interval;
+}
+
 void Aging2Experiment::set_timeout(std::chrono::seconds secs){
     m_timeout = secs;
 }
@@ -117,6 +121,21 @@ void Aging2Experiment::set_cooloff(std::chrono::seconds secs){
     m_cooloff = secs;
 }
 
+void Aging2Experiment::set_num_decoders(uint64_t num_threads){
+    if(num_threads < 1){ INVALID_ARGUMENT("num_threads < 1: " << num_threads); }
+    m_num_decoders = num_threads;
+}
+
+void Aging2Experiment::set_stream_buffer(uint64_t bytes){
+    m_stream_buffer = bytes;
+}
+
+void Aging2Experiment::set_update_batch(uint64_t size, library::UpdateInterface::BatchAtomicity atomicity){
+    if(size < 1){ INVALID_ARGUMENT("size < 1: " << size); }
+    m_update_batch_size = size;
+    m_update_batch_atomicity = atomicity;
+}
+
 void Aging2Experiment::set_memfp(bool value){
     m_memfp = value;
 }
@@ -132,13 +151,16 @@ void Aging2Experiment::set_memfp_threshold(uint64_t value) {
 Aging2Result Aging2Experiment::execute(){
     if(m_library.get() == nullptr) ERROR("Library not set. Use #set_library to set it.");
     if(m_path_log.empty()) ERROR("Path to the log file not set. Use #set_log to set it.")
+    if(m_update_batch_size > 1 && m_update_batch_atomicity == library::UpdateInterface::BatchAtomicity::PER_BATCH && !m_library->has_atomic_batches()){
+        ERROR("The library does not support atomic groups of updates. Use the atomicity per_edge or best_effort.");
+    }
 #if HAVE_GTX
    // m_library.get()->set_worker_thread_num(m_num_threads);
 #endif
     m_master = new details::Aging2Master(*this);
     //auto result = m_master->execute();
     //auto result = m_master->execute_synchronized(5);
-    auto result = m_master->execute_synchronized_small_batch();
+    auto result = (m_stream_buffer > 0) ? m_master->execute_streaming() : m_master->execute_synchronized_small_batch();
     //auto result = m_master->execute_pure_update_small_batch();
     //auto result = m_master->execute_synchronized_small_batch_even_partition();
     //auto result = m_master->execute_synchronized_evenly_partition(5);
@@ -24,13 +24,13 @@
 
 #include "aging2_result.hpp"
 #include "details/aging2_master.hpp"
+#include "library/interface.hpp"
 
 // forward declarations
 namespace gfe::graph { class WeightedEdgeStream; }
 namespace gfe::experiment { class Aging2Experiment; }
 namespace gfe::experiment::details { class Aging2Master; }
 namespace gfe::experiment::details { class Aging2Worker; }
-namespace gfe::library { class UpdateInterface; }
 
 namespace gfe::experiment {
 
@@ -58,8 +58,13 @@ class Aging2Experiment {
     bool m_report_progress = false; // whether to report the current progress
     uint64_t m_num_reports_per_operations = 1; // how often to save in the database progress done
     bool m_measure_latency = false; // whether to measure the latency of updates
+    std::chrono::milliseconds m_timeline_interval {0}; // how often to sample the throughput and the latency of the updates (0 = disabled)
     std::chrono::seconds m_timeout {0}; // max time to run the simulation (excl. cool-off time)
     std::chrono::seconds m_cooloff {0}; // number of seconds to wait after the experiment terminates, to check the effectiveness of the GC
+    uint64_t m_num_decoders = 1; // number of threads to decompress the blocks of the log
+    uint64_t m_stream_buffer = 0; // if > 0, stream the updates from the log while executing them, keeping at most this amount of bytes in the driver
+    uint64_t m_update_batch_size = 1; // number of updates sent together to the library with UpdateInterface#update_batch (1 = one update at the time)
+    library::UpdateInterface::BatchAtomicity m_update_batch_atomicity = library::UpdateInterface::BatchAtomicity::BEST_EFFORT; // atomicity of each group of updates
 
     details::Aging2Master* m_master;
 public:
@@ -101,6 +106,9 @@ public:
     // Measure the latency of updates?
     void set_measure_latency(bool value);
 
+    // Sample the throughput and the latency of the updates at the given interval (0 = disabled)
+    void set_timeline(std::chrono::milliseconds interval);
+
     // Set the max time to run the experiment
     void set_timeout(std::chrono::seconds secs);
 
@@ -117,6 +125,17 @@ public:
     // Forcedly stop the execution of the experiment when the readings of the memory footprint are above this threshold (0 = infinite)
     void set_memfp_threshold(uint64_t value);
 
+    // Set the number of threads to decompress the blocks of the log concurrently
+    void set_num_decoders(uint64_t num_threads);
+
+    // Overlap the decompression of the log with the execution of the updates, keeping at most the given amount of
+    // bytes of decoded updates in the driver. With 0, the default, the whole log is loaded upfront.
+    void set_stream_buffer(uint64_t bytes);
+
+    // Send the updates to the library in groups of `size' updates, by means of UpdateInterface#update_batch, with the given atomicity.
+    // With a size of 1, the default, the updates are performed one at the time.
+    void set_update_batch(uint64_t size, library::UpdateInterface::BatchAtomicity atomicity);
+
     // [Internal parameter]
     // Set the granularity of a task for a worker thread. This is the number of contiguos operations (inserts/deletes) done
     // by each worker thread between each invocation to the scheduler.
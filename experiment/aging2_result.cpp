@@ -22,6 +22,8 @@
 #include "common/database.hpp"
 #include "common/error.hpp"
 #include "details/latency.hpp"
+#include "details/timeline.hpp"
+#include "utility/perf_counters.hpp"
 #include "aging2_experiment.hpp"
 
 using namespace common;
@@ -45,6 +47,7 @@ void Aging2Result::save(common::Database* handle) {
     db.add("granularity", m_worker_granularity);
     db.add("num_threads", m_num_threads);
     db.add("num_updates", m_num_operations_total);
+    db.add("num_discarded_updates", m_num_discarded_updates);
     db.add("num_artificial_vertices", m_num_artificial_vertices);
     db.add("num_vertices_load", m_num_vertices_load);
     db.add("num_vertices_final", m_num_vertices_final_graph);
@@ -84,6 +87,14 @@ void Aging2Result::save(common::Database* handle) {
         m_latency_stats[1].save("deletes");
         m_latency_stats[2].save("updates");
     }
+
+    if(m_timeline.get() != nullptr){
+        m_timeline->save(handle);
+    }
+
+    if(m_perf_counters.get() != nullptr){
+        m_perf_counters->save(handle);
+    }
 }
 
 void Aging2Result::save(std::shared_ptr<common::Database> db){
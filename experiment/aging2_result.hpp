@@ -26,6 +26,8 @@ namespace gfe::experiment { class Aging2Experiment; }
 namespace gfe::experiment::details { class Aging2Master; }
 namespace gfe::experiment::details { class Aging2Worker; }
 namespace gfe::experiment::details { class LatencyStatistics; }
+namespace gfe::experiment::details { class TimelineRecorder; }
+namespace gfe::utility { class PerfPhase; }
 
 namespace gfe::experiment {
 
@@ -47,12 +49,15 @@ class Aging2Result {
     uint64_t m_num_build_invocations = 0; // total number of invocations to the method #build
     uint64_t m_num_levels_created = 0; // total number of levels/snapshots/deltas created in a LSM/delta based implementation
     uint64_t m_num_operations_total = 0; // total number of operations expected to be performed by the workers
+    uint64_t m_num_discarded_updates = 0; // updates not performed, as their atomic group (PER_BATCH) has been repeatedly discarded by the library
     std::vector<uint64_t> m_reported_times; // time to complete 1x, 2x, 3x, ... updates (inserts/deletions) w.r.t. the size of the input graph, in microsecs
     std::vector<uint64_t> m_progress; // number of operations performed after each seconds of the execution
     struct MemoryFootprint { uint64_t m_tick; uint64_t m_memory_process; uint64_t m_memory_driver; bool m_is_cooloff; };
     std::vector<MemoryFootprint> m_memory_footprint;
     uint64_t m_random_vertex_id = 0; // the ID of a random vertex stored in the graph
     std::shared_ptr<details::LatencyStatistics[]> m_latency_stats; // 3 items, 0 = insertions, 1 = deletions, 2 = both insertions & deletions
+    std::shared_ptr<details::TimelineRecorder> m_timeline; // throughput & latency of the updates over time, if recorded
+    std::shared_ptr<utility::PerfPhase> m_perf_counters; // hardware counters of the workers, if recorded
     bool m_timeout_hit = false; // whether the experiment terminated due to the internal timeout
     bool m_memfp_threshold_passed = false; // whether the experiment terminated due to the excessive usage of memory
     bool m_thread_deadlocked = false; // Whether a worker thread deadlocked
@@ -17,10 +17,13 @@
 
 #include "aging2_master.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <utility>
@@ -32,13 +35,17 @@
 #include "common/timer.hpp"
 #include "experiment/aging2_experiment.hpp"
 #include "experiment/aging2_result.hpp"
+#include "reader/graphlog_cache.hpp"
 #include "reader/graphlog_reader.hpp"
 #include "library/interface.hpp"
 #include "utility/memory_usage.hpp"
+#include "utility/perf_counters.hpp"
+#include "aging2_stream.hpp"
 #include "aging2_worker.hpp"
 #include "build_thread.hpp"
 #include "configuration.hpp"
 #include "latency.hpp"
+#include "timeline.hpp"
 
 using namespace common;
 using namespace std;
@@ -95,6 +102,11 @@ namespace gfe::experiment::details {
         m_parameters.m_library->on_main_init(m_parameters.m_num_threads + /* this + builder service */ 2 +
                                              /* plus potentially an analytics runner (mixed epxeriment) */ 1);
 
+        if (m_parameters.m_timeline_interval.count() > 0) { // before the workers, they will retrieve their probes
+            m_timeline = make_shared<TimelineRecorder>(m_parameters.m_num_threads, m_parameters.m_timeline_interval);
+        }
+        m_perf_counters = utility::PerfPhase::create("aging2_updates");
+
         init_workers();
         m_parameters.m_library->on_thread_init(m_parameters.m_num_threads + 1);
     }
@@ -107,9 +119,6 @@ namespace gfe::experiment::details {
 
         delete[] m_reported_times;
         m_reported_times = nullptr;
-
-        delete[] m_latencies;
-        m_latencies = nullptr;
     }
 
     void Aging2Master::init_workers() {
@@ -142,33 +151,24 @@ namespace gfe::experiment::details {
         Timer timer;
         timer.start();
 
-        fstream handle(m_parameters.m_path_log, ios_base::in | ios_base::binary);
-        auto properties = reader::graphlog::parse_properties(handle);
-        uint64_t array_sz = stoull(properties["internal.edges.block_size"]);
-        unique_ptr<uint64_t[]> ptr_array1{new uint64_t[array_sz]};
-        unique_ptr<uint64_t[]> ptr_array2{new uint64_t[array_sz]};
-        uint64_t *array1 = ptr_array1.get();
-        uint64_t *array2 = ptr_array2.get();
-        reader::graphlog::set_marker(properties, handle, reader::graphlog::Section::EDGES);
-
-        reader::graphlog::EdgeLoader loader(handle);
-        uint64_t num_edges = loader.load(array1, array_sz / 3);
+        reader::graphlog::EdgeBlockSource source(m_parameters.m_path_log, m_parameters.m_num_decoders);
+        if (source.is_cached()) { LOG("[Aging2] Reading the updates from the cache " << reader::graphlog::Cache::default_path(m_parameters.m_path_log)); }
+        uint64_t num_edges = 0;
+        const uint64_t *edges = source.next(&num_edges);
         //std::cout<<num_edges<<std::endl;
-        uint64_t total_size = num_edges;
+        uint64_t total_size = 0;
         //std::cout<<"system has "<<num_edges<<" edge operations"<<std::endl;
-        while (num_edges > 0) {
+        while (edges != nullptr) {
             // partition the batch among the workers
-            for (auto w: m_workers) w->load_edges(array1, num_edges);
-            if (m_results.m_random_vertex_id == 0) { set_random_vertex_id(array1, num_edges); }
+            partition_edges(edges, num_edges);
+            if (m_results.m_random_vertex_id == 0) { set_random_vertex_id(edges, num_edges); }
+            total_size += num_edges;
 
-            // load the next batch in the meanwhile
-            num_edges = loader.load(array2, array_sz / 3);
+            // load the next batch in the meanwhile, the partitioning is already done with the current batch
+            edges = source.next(&num_edges);
             //std::cout<<num_edges<<std::endl;
-            total_size += num_edges;
             // wait for the workers to complete
             for (auto w: m_workers) w->wait();
-
-            swap(array1, array2);
         }
         /*
         std::cout<<"worker 1"<<std::endl;
@@ -179,7 +179,6 @@ namespace gfe::experiment::details {
             std::cout<<"worker "<<x<<std::endl;
             m_workers.at(x)->print_workload(6509488+50,10);
         }*/
-        handle.close();
 
         timer.stop();
         LOG("[Aging2] Graphlog loaded in " << timer);
@@ -205,12 +204,12 @@ namespace gfe::experiment::details {
         while (num_edges > 0) {
             // partition the batch among the workers
             if (already_read_size + num_edges <= batch_to_read_size) {
-                for (auto w: m_workers) w->load_edges(array1, num_edges);
+                partition_edges(array1, num_edges);
                 if (m_results.m_random_vertex_id == 0) { set_random_vertex_id(array1, num_edges); }
                 already_read_size += num_edges;
             } else {
                 uint64_t to_read_size = batch_to_read_size - already_read_size;
-                for (auto w: m_workers) w->load_edges(array1, to_read_size);
+                partition_edges(array1, to_read_size);
                 if (m_results.m_random_vertex_id == 0) { set_random_vertex_id(array1, to_read_size); }
                 break;
             }
@@ -225,34 +224,57 @@ namespace gfe::experiment::details {
         read_operations_num += already_read_size;
     }
 
-    void Aging2Master::prepare_latencies() {
-        LOG("[Aging2] Allocating space to record the latency of each update ...");
-        Timer timer;
-        timer.start();
+    void Aging2Master::partition_edges(const uint64_t *edges, uint64_t num_edges) {
+        const uint64_t num_workers = m_workers.size();
 
-        for (auto w: m_workers) {
-            m_latencies_num_insertions += w->num_insertions();
-            m_latencies_num_deletions += w->num_deletions();
+        if (m_partition_capacity < num_edges) {
+            m_partition_buffer.reset(); // release the previous buffer before allocating the new one
+            m_partition_buffer.reset(new uint64_t[3 * num_edges]);
+            m_partition_capacity = num_edges;
         }
-        assert(m_latencies_num_insertions + m_latencies_num_deletions == m_results.m_num_operations_total &&
-               "Counting mismatch");
-
-        m_latencies = new uint64_t[m_results.m_num_operations_total];
+        m_partition_num_edges = num_edges;
+        m_partition_offsets.assign(num_workers * num_workers, 0);
 
-        uint64_t *latency_insertions = m_latencies;
-        uint64_t *latency_deletions = m_latencies + m_latencies_num_insertions;
-        for (auto w: m_workers) {
-            w->set_latencies(latency_insertions, latency_deletions);
+        // 1. histogram, each worker counts how many edges of its chunk belong to each owner
+        for (auto w: m_workers) w->partition_count(edges, num_edges);
+        for (auto w: m_workers) w->wait();
 
-            // next offset
-            latency_insertions += w->num_insertions();
-            latency_deletions += w->num_deletions();
+        // 2. exclusive prefix sum, owner-major, so that the slice of each owner is contiguous and the edges of the
+        // same owner retain the order of the log
+        uint64_t sum = 0;
+        for (uint64_t owner_id = 0; owner_id < num_workers; owner_id++) {
+            for (uint64_t chunk_id = 0; chunk_id < num_workers; chunk_id++) {
+                uint64_t &cell = m_partition_offsets[chunk_id * num_workers + owner_id];
+                uint64_t count = cell;
+                cell = sum;
+                sum += count;
+            }
         }
+        assert(sum == num_edges && "Counting mismatch");
 
-        for (auto w: m_workers) { w->wait(); }
+        // 3. scatter
+        for (auto w: m_workers) w->partition_scatter(edges, num_edges);
+        for (auto w: m_workers) w->wait();
 
-        timer.stop();
-        LOG("[Aging2] Latency allocations done in " << timer);
+        // 4. each worker takes ownership of its slice
+        for (auto w: m_workers) w->load_edges();
+    }
+
+    uint64_t Aging2Master::owner(uint64_t source, uint64_t destination) const {
+        return std::hash<uint64_t>()(source + destination) % m_parameters.m_num_threads;
+    }
+
+    std::pair<uint64_t, uint64_t> Aging2Master::partition_slice(uint64_t worker_id) const {
+        const uint64_t num_workers = m_workers.size();
+        uint64_t begin = m_partition_offsets[/* first chunk */ worker_id];
+        uint64_t end = (worker_id + 1 < num_workers) ? m_partition_offsets[worker_id + 1] : m_partition_num_edges;
+        return std::make_pair(begin, end);
+    }
+
+    void Aging2Master::prepare_latencies() {
+        LOG("[Aging2] Enabling the histograms to record the latency of the updates ...");
+        for (auto w: m_workers) { w->enable_latencies(); }
+        for (auto w: m_workers) { w->wait(); }
     }
 
     void Aging2Master::do_run_experiment() {
@@ -269,7 +291,11 @@ namespace gfe::experiment::details {
         Timer timer;
         timer.start();
         m_parameters.m_library->updates_start();
-        for (auto w: m_workers) w->execute_updates();
+        if (m_stream) {
+            for (auto w: m_workers) w->execute_stream();
+        } else {
+            for (auto w: m_workers) w->execute_updates();
+        }
         m_experiment_running = true;
         wait_and_record();
         //build_service.stop();
@@ -294,15 +320,24 @@ namespace gfe::experiment::details {
         Timer timer;
         timer.start();
 
-        fstream handle(m_parameters.m_path_log, ios_base::in | ios_base::binary);
-        auto properties = reader::graphlog::parse_properties(handle);
-        uint64_t num_vertices = stoull(properties["internal.vertices.temporary.cardinality"]);
-        unique_ptr<uint64_t[]> ptr_vertices{new uint64_t[num_vertices]};
+        uint64_t num_vertices = 0;
+        unique_ptr<uint64_t[]> ptr_vertices;
+        auto cache = reader::graphlog::Cache::open(m_parameters.m_path_log);
+        if (cache) {
+            const uint64_t *cached_vertices = cache->vertices_temporary(&num_vertices);
+            ptr_vertices.reset(new uint64_t[num_vertices]);
+            memcpy(ptr_vertices.get(), cached_vertices, num_vertices * sizeof(uint64_t));
+        } else {
+            fstream handle(m_parameters.m_path_log, ios_base::in | ios_base::binary);
+            auto properties = reader::graphlog::parse_properties(handle);
+            num_vertices = stoull(properties["internal.vertices.temporary.cardinality"]);
+            ptr_vertices.reset(new uint64_t[num_vertices]);
+            reader::graphlog::set_marker(properties, handle, reader::graphlog::Section::VTX_TEMP);
+
+            reader::graphlog::VertexLoader loader{handle};
+            loader.load(ptr_vertices.get(), num_vertices);
+        }
         uint64_t *vertices = ptr_vertices.get();
-        reader::graphlog::set_marker(properties, handle, reader::graphlog::Section::VTX_TEMP);
-
-        reader::graphlog::VertexLoader loader{handle};
-        loader.load(vertices, num_vertices);
         m_results.m_num_artificial_vertices = num_vertices;
 
         for (auto w: m_workers) w->remove_vertices(vertices, num_vertices);
@@ -321,7 +356,9 @@ namespace gfe::experiment::details {
     Aging2Result Aging2Master::execute() {
         load_edges();
         if (parameters().m_measure_latency) prepare_latencies();
+        if (m_timeline) { m_timeline->start(); }
         do_run_experiment();
+        if (m_timeline) { m_timeline->stop(); }
         remove_vertices();
 
         store_results();
@@ -456,34 +493,49 @@ namespace gfe::experiment::details {
     void Aging2Master::store_results() {
         m_results.m_num_vertices_final_graph = parameters().m_library->num_vertices();
         m_results.m_num_edges_final_graph = parameters().m_library->num_edges();
+        m_results.m_num_discarded_updates = 0;
+        for (auto w: m_workers) m_results.m_num_discarded_updates += w->num_discarded_updates();
+        if (m_results.m_num_discarded_updates > 0) {
+            LOG("[Aging2] WARNING: " << m_results.m_num_discarded_updates << " updates have not been performed, as their atomic groups have been repeatedly discarded by the library");
+        }
         m_results.m_reported_times.reserve(m_last_time_reported);
         for (size_t i = 0, sz = m_last_time_reported; i < sz; i++) {
             m_results.m_reported_times.push_back(m_reported_times[i]);
         }
 
         if (parameters().m_measure_latency) {
-            assert(m_latencies != nullptr);
             LOG("[Aging2] Computing the statistics for the measured latencies ...");
             Timer timer;
             timer.start();
 
+            // merge the histograms of the workers
+            auto insertions = make_unique<LatencyHistogram>();
+            auto deletions = make_unique<LatencyHistogram>();
+            for (auto w: m_workers) {
+                assert(w->latency_insertions() != nullptr && w->latency_deletions() != nullptr);
+                insertions->merge(*w->latency_insertions());
+                deletions->merge(*w->latency_deletions());
+            }
+            auto updates = make_unique<LatencyHistogram>(*insertions);
+            updates->merge(*deletions);
+
             m_results.m_latency_stats.reset(new LatencyStatistics[3]);
-            m_results.m_latency_stats[0] = LatencyStatistics::compute_statistics(m_latencies,
-                                                                                 m_latencies_num_insertions); // insertions
-            m_results.m_latency_stats[1] = LatencyStatistics::compute_statistics(
-                    m_latencies + m_latencies_num_insertions, m_latencies_num_deletions); // deletions
-            m_results.m_latency_stats[2] = LatencyStatistics::compute_statistics(m_latencies,
-                                                                                 m_latencies_num_insertions +
-                                                                                 m_latencies_num_deletions); // both insertions & deletions
+            m_results.m_latency_stats[0] = LatencyStatistics::compute_statistics(*insertions); // insertions
+            m_results.m_latency_stats[1] = LatencyStatistics::compute_statistics(*deletions); // deletions
+            m_results.m_latency_stats[2] = LatencyStatistics::compute_statistics(*updates); // both insertions & deletions
 
             timer.stop();
             LOG("[Aging2] Statistics computed in " << timer);
             LOG("[Aging2] Average latency of updates: " << DurationQuantity(m_results.m_latency_stats[2].mean())
                                                         << ", 99th percentile: " << DurationQuantity(
                     m_results.m_latency_stats[2].percentile99()));
+        }
 
-            delete[] m_latencies;
-            m_latencies = nullptr; // free some memory
+        m_results.m_timeline = m_timeline;
+
+        if (m_perf_counters) {
+            m_perf_counters->add_operations(num_operations_sofar());
+            m_results.m_perf_counters = m_perf_counters;
         }
 
         m_results.m_timeout_hit = (m_stop_reason == StopReason::TIMEOUT_HIT);
@@ -505,10 +557,10 @@ namespace gfe::experiment::details {
         cout << "]" << endl;
     }
 
-    void Aging2Master::set_random_vertex_id(uint64_t *edges, uint64_t num_edges) {
-        uint64_t *__restrict sources = edges;
-        uint64_t *__restrict destinations = sources + num_edges;
-        double *__restrict weights = reinterpret_cast<double *>(destinations + num_edges);
+    void Aging2Master::set_random_vertex_id(const uint64_t *edges, uint64_t num_edges) {
+        const uint64_t *__restrict sources = edges;
+        const uint64_t *__restrict destinations = sources + num_edges;
+        const double *__restrict weights = reinterpret_cast<const double *>(destinations + num_edges);
 
         uint64_t i = 0;
         while (i < num_edges && weights[i] <= 0) i++;
@@ -522,19 +574,20 @@ namespace gfe::experiment::details {
         // workers
         for (auto &w: m_workers) { result += w->memory_footprint(); }
 
+        // updates decoded and not yet executed, streaming mode
+        if (m_stream) { result += m_stream->memory_footprint(); }
+
         // size of the internal vectors
         if (parameters().m_memfp_physical) { // physical memory
             //result += sizeof(uint64_t) * static_cast<uint64_t>( m_parameters.m_num_reports_per_operations * ::ceil( static_cast<double>(num_operations_total())/num_edges_final_graph()) + 1 );
             result += m_results.m_progress.size() * sizeof(m_results.m_progress[0]);
             result += m_results.m_memory_footprint.size() * sizeof(m_results.m_memory_footprint[0]);
-            if (m_latencies != nullptr) {
-                result += sizeof(uint64_t) * m_results.m_num_operations_total;
-            }
+            result += sizeof(uint64_t) * 3 * m_partition_capacity;
         } else { // virtual memory
             result += utility::MemoryUsage::get_allocated_space(m_results.m_progress.data());
             result += utility::MemoryUsage::get_allocated_space(m_results.m_memory_footprint.data());
-            if (m_latencies != nullptr) {
-                result += utility::MemoryUsage::get_allocated_space(m_latencies);
+            if (m_partition_buffer) {
+                result += utility::MemoryUsage::get_allocated_space(m_partition_buffer.get());
             }
         }
 
@@ -562,6 +615,8 @@ namespace gfe::experiment::details {
         reader::graphlog::EdgeLoader loader(handle);
         uint64_t num_edges = 0;
         //bool print = false;
+        if (parameters().m_measure_latency) prepare_latencies();
+        if (m_timeline) { m_timeline->start(); }
         for (uint64_t i = 0; i < iterations; i++) {
             unique_ptr<uint64_t[]> ptr_array1{new uint64_t[array_sz]};
             unique_ptr<uint64_t[]> ptr_array2{new uint64_t[array_sz]};
@@ -578,7 +633,7 @@ namespace gfe::experiment::details {
             //we manually calculated it, load 16 batches
             while (num_edges > 0) {
                 // partition the batch among the workers
-                for (auto w: m_workers) w->load_edges(array1, num_edges);
+                partition_edges(array1, num_edges);
                 if (m_results.m_random_vertex_id == 0) { set_random_vertex_id(array1, num_edges); }
                 load_iterations++;
                 if (load_iterations < 9) {
@@ -601,14 +656,15 @@ namespace gfe::experiment::details {
                 }
             }*/
             LOG("execute edge updates of batch size " << batch_size);
-            if (parameters().m_measure_latency) prepare_latencies();
             do_run_experiment();
             //print = true;
             // for (auto w: m_workers) w->load_edges(array1, num_edges);
-            //store_results();
-            //log_num_vtx_edges();
         }
         handle.close();
+
+        if (m_timeline) { m_timeline->stop(); }
+        store_results();
+        log_num_vtx_edges();
         return m_results;
     }
 
@@ -628,6 +684,8 @@ namespace gfe::experiment::details {
         reader::graphlog::EdgeLoader loader(handle);
         uint64_t num_edges = 0;
         //bool print = false;
+        if (parameters().m_measure_latency) prepare_latencies();
+        if (m_timeline) { m_timeline->start(); }
         for (uint64_t i = 0; i < iterations; i++) {
             unique_ptr<uint64_t[]> ptr_array1{new uint64_t[array_sz]};
             unique_ptr<uint64_t[]> ptr_array2{new uint64_t[array_sz]};
@@ -696,14 +754,15 @@ namespace gfe::experiment::details {
                 }
             }*/
             LOG("execute edge updates of batch size " << batch_size);
-            if (parameters().m_measure_latency) prepare_latencies();
             do_run_experiment();
             //print = true;
             // for (auto w: m_workers) w->load_edges(array1, num_edges);
-            //store_results();
-            //log_num_vtx_edges();
         }
         handle.close();
+
+        if (m_timeline) { m_timeline->stop(); }
+        store_results();
+        log_num_vtx_edges();
         return m_results;
     }
 
@@ -711,18 +770,11 @@ namespace gfe::experiment::details {
         //setup loader:
         uint64_t read_log_num = 0;
         uint64_t total_log_num = 2603795200;//for graph500's 10 hour log
-        fstream handle(m_parameters.m_path_log, ios_base::in | ios_base::binary);
-        auto properties = reader::graphlog::parse_properties(handle);
-        uint64_t array_sz = stoull(properties["internal.edges.block_size"]);
-        reader::graphlog::set_marker(properties, handle, reader::graphlog::Section::EDGES);
-        reader::graphlog::EdgeLoader loader(handle);
+        reader::graphlog::EdgeBlockSource source(m_parameters.m_path_log, m_parameters.m_num_decoders);
+        if (source.is_cached()) { LOG("[Aging2] Reading the updates from the cache " << reader::graphlog::Cache::default_path(m_parameters.m_path_log)); }
         uint64_t num_edges = 0;
         //bool print = false;
-        unique_ptr<uint64_t[]> ptr_array1{new uint64_t[array_sz]};
-        unique_ptr<uint64_t[]> ptr_array2{new uint64_t[array_sz]};
-        uint64_t *array1 = ptr_array1.get();
-        uint64_t *array2 = ptr_array2.get();
-        num_edges = loader.load(array1, array_sz / 3);
+        const uint64_t *edges = source.next(&num_edges);
         /*if(print){
             for(uint64_t j=100; j<150; j++){
                 LOG(array1[j]<<" "<<(array1+num_edges)[j]<<" "<< (reinterpret_cast<double*>(array1+2*num_edges))[j]);
@@ -733,22 +785,22 @@ namespace gfe::experiment::details {
         uint64_t executed_operations = 0;
         uint64_t total_log = 2603795200;
 #endif
-        while (num_edges > 0) {
+        if (parameters().m_measure_latency) prepare_latencies();
+        if (m_timeline) { m_timeline->start(); }
+        while (edges != nullptr) {
 #if HAVE_LIVEGRAPH
             executed_operations+=num_edges;
 #endif
             // partition the batch among the workers
-            for (auto w: m_workers) w->load_edges(array1, num_edges);
-            if (m_results.m_random_vertex_id == 0) { set_random_vertex_id(array1, num_edges); }
+            partition_edges(edges, num_edges);
+            if (m_results.m_random_vertex_id == 0) { set_random_vertex_id(edges, num_edges); }
            // LOG("execute edge updates of batch size " << num_edges);
             // load the next batch in the meanwhile
-            num_edges = loader.load(array2, array_sz / 3);
+            edges = source.next(&num_edges);
             //std::cout<<num_edges<<std::endl;
             // wait for the workers to complete
             for (auto w: m_workers) w->wait();
             //for (auto w: m_workers) w->print_workload(0,num_edges);
-            swap(array1, array2);
-            if (parameters().m_measure_latency) prepare_latencies();
             do_run_experiment();
 #if HAVE_LIVEGRAPH
             if(executed_operations>(2603795200/5)){
@@ -765,10 +817,10 @@ namespace gfe::experiment::details {
 
         //print = true;
         // for (auto w: m_workers) w->load_edges(array1, num_edges);
-        //store_results();
-        //log_num_vtx_edges();
+        if (m_timeline) { m_timeline->stop(); }
+        store_results();
+        log_num_vtx_edges();
 
-        handle.close();
 #if HAVE_LIVEGRAPH
             LOG("LiveGraph executed "<<executed_operations<<" operations");
 #endif
@@ -799,6 +851,8 @@ namespace gfe::experiment::details {
             }
         }*/
         //we manually calculated it, load 16 batches
+        if (parameters().m_measure_latency) prepare_latencies();
+        if (m_timeline) { m_timeline->start(); }
         while (num_edges > 0) {
             uint64_t offset = 0;
             std::unordered_map<std::pair<uint64_t, uint64_t>, uint64_t, hash_edge> edge_to_worker_map;
@@ -841,7 +895,6 @@ namespace gfe::experiment::details {
             for (auto w: m_workers) w->wait();
             //for (auto w: m_workers) w->print_workload(0,num_edges);
             swap(array1, array2);
-            if (parameters().m_measure_latency) prepare_latencies();
             do_run_experiment();
         }
         /*if(print){
@@ -853,8 +906,9 @@ namespace gfe::experiment::details {
 
         //print = true;
         // for (auto w: m_workers) w->load_edges(array1, num_edges);
-        //store_results();
-        //log_num_vtx_edges();
+        if (m_timeline) { m_timeline->stop(); }
+        store_results();
+        log_num_vtx_edges();
 
         handle.close();
         LOG("total execution time is "<<total_time_microseconds);
@@ -888,9 +942,10 @@ namespace gfe::experiment::details {
         uint64_t executed_operations = 0;
         uint64_t total_log = 2603795200;
 #endif
+        if (parameters().m_measure_latency) prepare_latencies();
+        if (m_timeline) { m_timeline->start(); }
         while (num_edges > 0) {
             loop++;
-            if (parameters().m_measure_latency) prepare_latencies();
             for(uint64_t j=100; j<150; j++){
                 LOG(array1[j]<<" "<<(array1+num_edges)[j]<<" "<< (reinterpret_cast<double*>(array1+2*num_edges))[j]);
             }
@@ -918,7 +973,88 @@ namespace gfe::experiment::details {
             m_workload_index.store(0,std::memory_order_release);
             //do_run_experiment();
         }
+        handle.close();
+
+        if (m_timeline) { m_timeline->stop(); }
+        store_results();
+        log_num_vtx_edges();
+
         LOG("total update time is "<<total_time_microseconds<<" us");
         return m_results;
     }
+
+    Aging2Result Aging2Master::execute_streaming() {
+        if (parameters().m_measure_latency) prepare_latencies();
+        if (m_timeline) { m_timeline->start(); }
+        LOG("[Aging2] Streaming the updates from " << m_parameters.m_path_log << ", buffer size: " << ComputerQuantity(parameters().m_stream_buffer, true));
+
+        m_stream.reset(new Aging2Stream(m_workers.size(), parameters().m_stream_buffer));
+        m_decoder_error = nullptr;
+        std::thread decoder{&Aging2Master::main_decoder, this};
+        do_run_experiment();
+        if (m_timeline) { m_timeline->stop(); }
+        decoder.join();
+        if (m_decoder_error) { std::rethrow_exception(m_decoder_error); }
+        m_stream.reset();
+
+        remove_vertices();
+        store_results();
+        log_num_vtx_edges();
+
+        return m_results;
+    }
+
+    void Aging2Master::main_decoder() {
+        concurrency::set_thread_name("Aging2 Decoder");
+        using Chunk = Aging2Stream::Chunk;
+        const uint64_t num_workers = m_workers.size();
+        // keep the chunks pending in the decoder to at most a quarter of the budget
+        const uint64_t chunk_capacity = std::clamp<uint64_t>(parameters().m_stream_buffer / (4 * num_workers * sizeof(graph::WeightedEdge)), 1024, 1ull << 16);
+        vector<Chunk*> pending(num_workers, nullptr);
+
+        try {
+            Timer timer;
+            timer.start();
+            reader::graphlog::EdgeBlockSource source(m_parameters.m_path_log, m_parameters.m_num_decoders);
+
+            uint64_t num_edges = 0;
+            const uint64_t *edges = nullptr;
+            while (!m_stop_experiment && (edges = source.next(&num_edges)) != nullptr) {
+                if (m_results.m_random_vertex_id == 0) { set_random_vertex_id(edges, num_edges); }
+
+                const uint64_t *__restrict sources = edges;
+                const uint64_t *__restrict destinations = sources + num_edges;
+                const double *__restrict weights = reinterpret_cast<const double *>(destinations + num_edges);
+                for (uint64_t i = 0; i < num_edges; i++) {
+                    uint64_t owner_id = owner(sources[i], destinations[i]);
+                    if (pending[owner_id] == nullptr) {
+                        pending[owner_id] = new Chunk();
+                        pending[owner_id]->reserve(chunk_capacity);
+                    }
+                    pending[owner_id]->emplace_back(sources[i], destinations[i], weights[i]);
+                    if (pending[owner_id]->size() == chunk_capacity) {
+                        m_stream->push(owner_id, pending[owner_id]);
+                        pending[owner_id] = nullptr;
+                    }
+                }
+            }
+
+            // flush the leftovers
+            for (uint64_t owner_id = 0; owner_id < num_workers; owner_id++) {
+                if (pending[owner_id] != nullptr) {
+                    m_stream->push(owner_id, pending[owner_id]);
+                    pending[owner_id] = nullptr;
+                }
+            }
+
+            timer.stop();
+            LOG("[Aging2] Graphlog decoded in " << timer);
+        } catch (...) {
+            m_decoder_error = std::current_exception();
+            m_stop_experiment = true;
+            for (auto chunk: pending) { delete chunk; }
+        }
+
+        m_stream->close();
+    }
 } // namespace
@@ -18,8 +18,10 @@
 #pragma once
 
 #include <memory>
+#include <utility>
 #include <vector>
 #include <atomic>
+#include <exception>
 
 #include "common/static_index.hpp"
 #include "experiment/aging2_result.hpp"
@@ -28,9 +30,12 @@
 
 // forward declarations
 namespace gfe::experiment { class Aging2Experiment; }
+namespace gfe::experiment::details { class Aging2Stream; }
 namespace gfe::experiment::details { class Aging2Worker; }
 namespace gfe::experiment::details { class LatencyStatistics; }
+namespace gfe::experiment::details { class TimelineRecorder; }
 namespace gfe::reader::graphlog {class EdgeLoader;}
+namespace gfe::utility { class PerfPhase; }
 namespace gfe::experiment::details {
 
 class Aging2Master {
@@ -47,10 +52,11 @@ class Aging2Master {
     uint64_t* m_reported_times = nullptr; // microsecs
     std::atomic<int> m_last_time_reported = 0;
 
-    // latencies of each update
-    uint64_t* m_latencies = nullptr; // nanosecs
-    uint64_t m_latencies_num_insertions = 0; // total number of operations that are insertions
-    uint64_t m_latencies_num_deletions = 0; // total number of operations that are deletions
+    // throughput & latency of the updates over time, if requested
+    std::shared_ptr<TimelineRecorder> m_timeline;
+
+    // hardware counters of the workers executing the updates, if requested
+    std::shared_ptr<utility::PerfPhase> m_perf_counters;
 
     // Stinger is so slow, that we stop the experiment after four hours
     std::atomic<bool> m_stop_experiment = false;
@@ -61,6 +67,16 @@ class Aging2Master {
 
     std::atomic_bool m_experiment_running = false;
 
+    // partition of the current batch of edges among the workers, each worker owns a contiguous slice of m_partition_buffer
+    std::unique_ptr<uint64_t[]> m_partition_buffer; // columnar layout: sources, destinations, weights
+    uint64_t m_partition_capacity = 0; // max number of edges that can be stored in m_partition_buffer
+    uint64_t m_partition_num_edges = 0; // number of edges in the current batch
+    std::vector<uint64_t> m_partition_offsets; // num_workers x num_workers matrix, (chunk, owner) -> offset in m_partition_buffer
+
+    // streaming mode, the updates are decoded from the graphlog while the workers execute them
+    std::unique_ptr<Aging2Stream> m_stream; // the queues between the decoder and the workers
+    std::exception_ptr m_decoder_error; // set if the decoder terminated with an exception
+
     uint64_t total_time_microseconds = 0;
    // uint64_t read_log_num = 0;
    // uint64_t total_log_num = 2603795200;//for graph500's 10 hour log
@@ -71,10 +87,23 @@ class Aging2Master {
     // Load & partition the edges to insert/remove in the available workers
     void load_edges();
 
+    // Scatter the given batch of edges among the workers and let each worker take ownership of its slice. The
+    // workers are still busy loading their slice when this method returns, use Aging2Worker#wait to synchronise.
+    void partition_edges(const uint64_t* edges, uint64_t num_edges);
+
+    // The worker that owns the given edge. All updates of the same edge are always executed by the same worker.
+    uint64_t owner(uint64_t source, uint64_t destination) const;
+
+    // The range [begin, end) of the edges assigned to the given worker in m_partition_buffer
+    std::pair<uint64_t, uint64_t> partition_slice(uint64_t worker_id) const;
+
     // Load & partition the percent of total edges to insert/remove in the available workers
     void load_edges_percent( reader::graphlog::EdgeLoader* loader,uint64_t* array1,uint64_t* array2, uint64_t& total_workload_size, uint64_t& read_operations_num, uint64_t synchronization_ratio, uint64_t array_size);
 
-    // Prepare the array to record the latency of all updates
+    // Decode the whole graphlog and append its updates to the queues in m_stream, executed by the decoder thread
+    void main_decoder();
+
+    // Request the workers to record the latency of their updates
     void prepare_latencies();
 
     // Execute the main part of the experiment, that is the insertions/deletions in the graph with the worker threads
@@ -99,7 +128,7 @@ class Aging2Master {
     void log_num_vtx_edges();
 
     // Grab the vertex id of a random (final) edge
-    void set_random_vertex_id(uint64_t* edges, uint64_t num_edges);
+    void set_random_vertex_id(const uint64_t* edges, uint64_t num_edges);
 
     // Get the current memory footprint of the experiment, in bytes
     uint64_t memory_footprint() const;
@@ -132,6 +161,9 @@ public:
     Aging2Result execute_synchronized_small_batch();
     Aging2Result execute_synchronized_small_batch_even_partition();
     Aging2Result execute_pure_update_small_batch();
+
+    // Execute the experiment overlapping the decompression of the graphlog with the execution of the updates
+    Aging2Result execute_streaming();
     std::atomic_uint64_t m_workload_index;
 };
 
@@ -0,0 +1,98 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "aging2_stream.hpp"
+
+#include <cassert>
+
+#include "common/error.hpp"
+
+using namespace std;
+
+namespace gfe::experiment::details {
+
+Aging2Stream::Aging2Stream(uint64_t num_workers, uint64_t budget) : m_budget(budget), m_queues(num_workers), m_condvar_workers(new condition_variable[num_workers]) {
+    if(num_workers == 0) INVALID_ARGUMENT("num_workers == 0");
+    if(budget == 0) INVALID_ARGUMENT("budget == 0");
+}
+
+Aging2Stream::~Aging2Stream(){
+    for(auto& queue : m_queues){
+        for(auto chunk : queue){ delete chunk; }
+        queue.clear();
+    }
+}
+
+uint64_t Aging2Stream::chunk_size(const Chunk* chunk){
+    return chunk->capacity() * sizeof(graph::WeightedEdge);
+}
+
+void Aging2Stream::push(uint64_t worker_id, Chunk* chunk){
+    assert(worker_id < m_queues.size() && "Invalid worker id");
+    assert(chunk != nullptr);
+    const uint64_t sz = chunk_size(chunk);
+
+    unique_lock<mutex> lock(m_mutex);
+    assert(m_closed == false && "The stream has already been closed");
+    // always accept a chunk when the queues are empty, even if it's bigger than the whole budget
+    m_condvar_decoder.wait(lock, [this, sz](){ return m_footprint == 0 || m_footprint + sz <= m_budget; });
+    m_footprint += sz;
+    m_queues[worker_id].push_back(chunk);
+    lock.unlock();
+
+    m_condvar_workers[worker_id].notify_one();
+}
+
+void Aging2Stream::close(){
+    unique_lock<mutex> lock(m_mutex);
+    m_closed = true;
+    lock.unlock();
+
+    for(uint64_t i = 0; i < m_queues.size(); i++){ m_condvar_workers[i].notify_all(); }
+}
+
+Aging2Stream::Chunk* Aging2Stream::pop(uint64_t worker_id){
+    assert(worker_id < m_queues.size() && "Invalid worker id");
+    auto& queue = m_queues[worker_id];
+
+    unique_lock<mutex> lock(m_mutex);
+    m_condvar_workers[worker_id].wait(lock, [this, &queue](){ return !queue.empty() || m_closed; });
+    if(queue.empty()) return nullptr; // closed & depleted
+    Chunk* chunk = queue.front();
+    queue.pop_front();
+    return chunk;
+}
+
+void Aging2Stream::release(Chunk* chunk){
+    if(chunk == nullptr) return;
+    const uint64_t sz = chunk_size(chunk);
+    delete chunk;
+
+    unique_lock<mutex> lock(m_mutex);
+    assert(m_footprint >= sz);
+    m_footprint -= sz;
+    lock.unlock();
+
+    m_condvar_decoder.notify_all();
+}
+
+uint64_t Aging2Stream::memory_footprint() const {
+    return m_footprint;
+}
+
+} // namespace
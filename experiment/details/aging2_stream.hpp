@@ -0,0 +1,87 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "graph/edge.hpp"
+
+namespace gfe::experiment::details {
+
+/**
+ * The set of bounded queues connecting the decoder of the graphlog with the workers of the Aging2 experiment, when the
+ * updates are streamed rather than loaded upfront. The decoder appends chunks of updates to the queue of their owner,
+ * waiting while the amount of memory in flight is above the budget. Each worker fetches the chunks from its own queue,
+ * in the same order they have been appended.
+ *
+ * The class is thread-safe.
+ */
+class Aging2Stream {
+    Aging2Stream(const Aging2Stream&) = delete;
+    Aging2Stream& operator=(const Aging2Stream&) = delete;
+
+public:
+    using Chunk = std::vector<graph::WeightedEdge>;
+
+private:
+    const uint64_t m_budget; // max amount of memory, in bytes, for the chunks in the queues
+    std::atomic<uint64_t> m_footprint = 0; // current amount of memory, in bytes, held by the queues and the workers
+    std::vector<std::deque<Chunk*>> m_queues; // one queue for each worker
+    bool m_closed = false; // whether the decoder has appended the last chunk
+    mutable std::mutex m_mutex; // sync the access to the queues
+    std::condition_variable m_condvar_decoder; // the decoder waits here when the budget has been exhausted
+    std::unique_ptr<std::condition_variable[]> m_condvar_workers; // each worker waits on its own condvar when its queue is empty
+
+    // Amount of memory used by the given chunk, in bytes
+    static uint64_t chunk_size(const Chunk* chunk);
+
+public:
+    // Create a new set of queues, for the given number of workers and the given memory budget, in bytes
+    Aging2Stream(uint64_t num_workers, uint64_t budget);
+
+    // Destructor
+    ~Aging2Stream();
+
+    // Append a chunk to the queue of the given worker, waiting while the budget is exhausted. The stream takes ownership of the chunk.
+    void push(uint64_t worker_id, Chunk* chunk);
+
+    // Signal that the decoder will not append further chunks
+    void close();
+
+    // Fetch the next chunk for the given worker, or nullptr if the stream has been closed and the queue is depleted.
+    // The worker takes ownership of the chunk and must invoke #release once it has been processed.
+    Chunk* pop(uint64_t worker_id);
+
+    // Release a chunk fetched with #pop, giving its memory back to the budget
+    void release(Chunk* chunk);
+
+    // The memory budget, in bytes
+    uint64_t budget() const { return m_budget; }
+
+    // The current amount of memory held by the chunks not released yet, in bytes
+    uint64_t memory_footprint() const;
+};
+
+} // namespace
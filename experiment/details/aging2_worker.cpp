@@ -18,9 +18,11 @@
 
 #include "aging2_worker.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <random>
 #include <thread>
@@ -33,7 +35,11 @@
 #include "graph/edge_stream.hpp"
 #include "library/interface.hpp"
 #include "utility/memory_usage.hpp"
+#include "utility/perf_counters.hpp"
 #include "aging2_master.hpp"
+#include "aging2_stream.hpp"
+#include "latency.hpp"
+#include "timeline.hpp"
 #include "configuration.hpp"
 
 using namespace common;
@@ -64,6 +70,7 @@ namespace gfe::experiment::details {
                                                                       m_worker_id(worker_id),
                                                                       m_task{TaskOp::IDLE, nullptr, 0} {
         assert(m_library != nullptr);
+        if (m_master.m_timeline) { m_timeline_probe = m_master.m_timeline->probe(worker_id); }
 
         // start the background thread
         start();
@@ -107,14 +114,26 @@ namespace gfe::experiment::details {
  *                                                                           *
  *****************************************************************************/
 
-    void Aging2Worker::load_edges(uint64_t *edges, uint64_t num_edges) {
-        set_task_async(TaskOp::LOAD_EDGES, edges, num_edges);
+    void Aging2Worker::partition_count(const uint64_t *edges, uint64_t num_edges) {
+        set_task_async(TaskOp::PARTITION_COUNT, const_cast<uint64_t *>(edges), num_edges); // read only
+    }
+
+    void Aging2Worker::partition_scatter(const uint64_t *edges, uint64_t num_edges) {
+        set_task_async(TaskOp::PARTITION_SCATTER, const_cast<uint64_t *>(edges), num_edges); // read only
+    }
+
+    void Aging2Worker::load_edges() {
+        set_task_async(TaskOp::LOAD_EDGES);
     }
 
     void Aging2Worker::execute_updates() {
         set_task_async(TaskOp::EXECUTE_UPDATES);
     }
 
+    void Aging2Worker::execute_stream() {
+        set_task_async(TaskOp::EXECUTE_STREAM);
+    }
+
     void Aging2Worker::execute_true_updates(uint64_t *edges, uint64_t num_edges) {
         set_task_async(TaskOp::EXECUTE_TRUE_UPDATES, edges, num_edges);
     }
@@ -123,9 +142,16 @@ namespace gfe::experiment::details {
         set_task_async(TaskOp::REMOVE_VERTICES, vertices, num_vertices);
     }
 
-    void Aging2Worker::set_latencies(uint64_t *array_insertions, uint64_t *array_deletions) {
-        set_task_async(TaskOp::SET_ARRAY_LATENCIES, array_insertions, /* hack */
-                       reinterpret_cast<uint64_t>(array_deletions));
+    void Aging2Worker::enable_latencies() {
+        set_task_async(TaskOp::ENABLE_LATENCIES);
+    }
+
+    const LatencyHistogram* Aging2Worker::latency_insertions() const {
+        return m_latency_insertions.get();
+    }
+
+    const LatencyHistogram* Aging2Worker::latency_deletions() const {
+        return m_latency_deletions.get();
     }
 
     void Aging2Worker::set_task_async(TaskOp type, uint64_t *payload, uint64_t payload_sz) {
@@ -194,17 +220,26 @@ namespace gfe::experiment::details {
                 case TaskOp::STOP:
                     terminate = true;
                     break;
-                case TaskOp::SET_ARRAY_LATENCIES:
-                    m_latency_insertions = task.m_payload;
-                    m_latency_deletions = reinterpret_cast<uint64_t *>(task.m_payload_sz); // hack
+                case TaskOp::ENABLE_LATENCIES:
+                    if (!m_latency_insertions) m_latency_insertions.reset(new LatencyHistogram());
+                    if (!m_latency_deletions) m_latency_deletions.reset(new LatencyHistogram());
+                    break;
+                case TaskOp::PARTITION_COUNT:
+                    main_partition_count(task.m_payload, task.m_payload_sz);
+                    break;
+                case TaskOp::PARTITION_SCATTER:
+                    main_partition_scatter(task.m_payload, task.m_payload_sz);
                     break;
                 case TaskOp::LOAD_EDGES:
-                    main_load_edges(task.m_payload, task.m_payload_sz);
+                    main_load_edges();
                     //main_load_edges_even_split(task.m_payload, task.m_payload_sz);
                     break;
                 case TaskOp::EXECUTE_UPDATES:
                     main_execute_updates();
                     break;
+                case TaskOp::EXECUTE_STREAM:
+                    main_execute_stream();
+                    break;
                 case TaskOp::REMOVE_VERTICES:
                     main_remove_vertices(task.m_payload, task.m_payload_sz);
                     break;
@@ -241,53 +276,15 @@ namespace gfe::experiment::details {
         }
         COUT_DEBUG("Initial memory footprint: " << m_updates_mem_usage << " bytes");
 
-        const int64_t num_total_ops = m_master.num_operations_total();
-        const bool report_progress = m_master.parameters().m_report_progress;
         const bool release_memory = m_master.parameters().m_release_driver_memory;
-        // reports_per_ops only affects how often a report is saved in the db, not the report to the stdout
-        const double reports_per_ops = m_master.parameters().m_num_reports_per_operations;
         int lastset_coeff = 0;
+        utility::ScopedPerfCounters perf_counters{m_master.m_perf_counters.get(), static_cast<uint64_t>(m_worker_id)};
 
         for (uint64_t i = 0, end = m_updates.size(); i < end; i++) {
             // if we're release the driver's memory, always fetch the first. Otherwise follow the index.
             vector<graph::WeightedEdge> *operations = m_updates[release_memory ? 0 : i];
 
-            uint64_t num_loops = (operations->size() / granularity()) + (operations->size() % granularity() != 0);
-            uint64_t start = 0;
-            for (uint64_t j = 0; j < num_loops; j++) {
-                uint64_t end = std::min(start + granularity(), operations->size());
-
-                // execute a chunk of updates
-                graph_execute_batch_updates(operations->data() + start, end - start);
-
-                uint64_t num_ops_done = m_master.m_num_operations_performed.fetch_add(end - start);
-
-                // report progress
-              /*  if (report_progress &&
-                    static_cast<int>(100.0 * num_ops_done / num_total_ops) > m_master.m_last_progress_reported){
-                    m_master.m_last_progress_reported = 100.0 * num_ops_done / num_total_ops;
-                    if (!m_master.m_stop_experiment) {
-                        LOG("[thread: " << ::common::concurrency::get_thread_id() << ", worker_id: " << m_worker_id
-                                        << "] Progress: " << static_cast<int>(100.0 * num_ops_done / num_total_ops)
-                                        << "%");
-                    }
-                }*/
-
-                // report how long it took to perform 1x, 2x, ... updates w.r.t. to the size of the final graph
-                int aging_coeff =
-                        (static_cast<double>(num_ops_done) / m_master.num_edges_final_graph()) * reports_per_ops;
-                if (aging_coeff > lastset_coeff) {
-                    if (m_master.m_last_time_reported.compare_exchange_strong(/* updates lastset_coeff */ lastset_coeff,
-                                                                                                          aging_coeff)) {
-                        uint64_t duration = chrono::duration_cast<chrono::microseconds>(
-                                chrono::steady_clock::now() - m_master.m_time_start).count();
-                        m_master.m_reported_times[aging_coeff - 1] = duration;
-                    }
-                }
-
-                // next iteration
-                start = end;
-            }
+            execute_operations(operations->data(), operations->size(), lastset_coeff);
 
             if (release_memory) {
                 COUT_DEBUG("Releasing a buffer of cardinality " << operations->size() << ", " << m_updates.size() - 1
@@ -316,44 +313,143 @@ namespace gfe::experiment::details {
     }
 
 
-    void Aging2Worker::main_load_edges(uint64_t *edges, uint64_t num_edges) {
+    void Aging2Worker::main_execute_stream() {
+        Aging2Stream* stream = m_master.m_stream.get();
+        assert(stream != nullptr && "The master is not in streaming mode");
+        uniform_real_distribution<double> rndweight{0, m_master.parameters().m_max_weight}; // in [0, max_weight)
+        int lastset_coeff = 0;
+        utility::ScopedPerfCounters perf_counters{m_master.m_perf_counters.get(), static_cast<uint64_t>(m_worker_id)};
+
+        Aging2Stream::Chunk* operations = nullptr;
+        while ((operations = stream->pop(m_worker_id)) != nullptr) {
+            if (!m_master.m_stop_experiment) { // otherwise, keep draining the stream to unblock the decoder
+                for (auto &update: *operations) {
+                    // counters
+                    if (update.m_weight >= 0) {
+                        m_num_edge_insertions++;
+                    } else {
+                        m_num_edge_deletions++;
+                    }
+
+                    // generate a random weight
+                    if (update.m_weight == 0.0) {
+                        update.m_weight = rndweight(m_random); // in [0, max_weight)
+                        if (update.m_weight == 0.0) update.m_weight = m_master.parameters().m_max_weight; // in (0, max_weight]
+                    }
+                }
+
+                execute_operations(operations->data(), operations->size(), lastset_coeff);
+            }
+
+            stream->release(operations);
+        }
+    }
+
+    void Aging2Worker::execute_operations(graph::WeightedEdge *operations, uint64_t num_operations, int &lastset_coeff) {
+        // reports_per_ops only affects how often a report is saved in the db, not the report to the stdout
+        const double reports_per_ops = m_master.parameters().m_num_reports_per_operations;
+
+        uint64_t num_loops = (num_operations / granularity()) + (num_operations % granularity() != 0);
+        uint64_t start = 0;
+        for (uint64_t j = 0; j < num_loops; j++) {
+            uint64_t end = std::min(start + granularity(), num_operations);
+
+            // execute a chunk of updates
+            graph_execute_batch_updates(operations + start, end - start);
+
+            uint64_t num_ops_done = m_master.m_num_operations_performed.fetch_add(end - start);
+
+            // report how long it took to perform 1x, 2x, ... updates w.r.t. to the size of the final graph
+            int aging_coeff =
+                    (static_cast<double>(num_ops_done) / m_master.num_edges_final_graph()) * reports_per_ops;
+            if (aging_coeff > lastset_coeff) {
+                if (m_master.m_last_time_reported.compare_exchange_strong(/* updates lastset_coeff */ lastset_coeff,
+                                                                                                      aging_coeff)) {
+                    uint64_t duration = chrono::duration_cast<chrono::microseconds>(
+                            chrono::steady_clock::now() - m_master.m_time_start).count();
+                    m_master.m_reported_times[aging_coeff - 1] = duration;
+                }
+            }
+
+            // next iteration
+            start = end;
+        }
+    }
+
+    void Aging2Worker::main_partition_count(const uint64_t *edges, uint64_t num_edges) {
+        const uint64_t num_workers = m_master.m_workers.size();
+        const uint64_t chunk_start = num_edges * m_worker_id / num_workers;
+        const uint64_t chunk_end = num_edges * (m_worker_id + 1) / num_workers;
+
+        const uint64_t *__restrict sources = edges;
+        const uint64_t *__restrict destinations = sources + num_edges;
+        uint64_t *__restrict histogram = m_master.m_partition_offsets.data() + m_worker_id * num_workers;
+
+        for (uint64_t i = chunk_start; i < chunk_end; i++) {
+            histogram[m_master.owner(sources[i], destinations[i])]++;
+        }
+    }
+
+    void Aging2Worker::main_partition_scatter(const uint64_t *edges, uint64_t num_edges) {
+        const uint64_t num_workers = m_master.m_workers.size();
+        const uint64_t chunk_start = num_edges * m_worker_id / num_workers;
+        const uint64_t chunk_end = num_edges * (m_worker_id + 1) / num_workers;
+
+        const uint64_t *__restrict sources = edges;
+        const uint64_t *__restrict destinations = sources + num_edges;
+        const double *__restrict weights = reinterpret_cast<const double *>(destinations + num_edges);
+
+        uint64_t *__restrict out_sources = m_master.m_partition_buffer.get();
+        uint64_t *__restrict out_destinations = out_sources + num_edges;
+        double *__restrict out_weights = reinterpret_cast<double *>(out_destinations + num_edges);
+
+        // the offsets of the master are read-only at this stage, the other workers are reading them too
+        const uint64_t *offsets = m_master.m_partition_offsets.data() + m_worker_id * num_workers;
+        vector<uint64_t> cursor(offsets, offsets + num_workers);
+
+        for (uint64_t i = chunk_start; i < chunk_end; i++) {
+            uint64_t position = cursor[m_master.owner(sources[i], destinations[i])]++;
+            out_sources[position] = sources[i];
+            out_destinations[position] = destinations[i];
+            out_weights[position] = weights[i];
+        }
+    }
+
+    void Aging2Worker::main_load_edges() {
         if (m_updates.empty()) { m_updates.append(new vector<graph::WeightedEdge>()); }
         vector<graph::WeightedEdge> *last = m_updates[m_updates.size() - 1];
 
         constexpr uint64_t last_max_sz = (1ull << 22); // 4M
-        const uint64_t modulo = m_master.parameters().m_num_threads;
+        const uint64_t num_edges = m_master.m_partition_num_edges;
+        auto slice = m_master.partition_slice(m_worker_id);
 
-        uint64_t *__restrict sources = edges;
+        uint64_t *__restrict sources = m_master.m_partition_buffer.get();
         uint64_t *__restrict destinations = sources + num_edges;
         double *__restrict weights = reinterpret_cast<double *>(destinations + num_edges);
 
         uniform_real_distribution<double> rndweight{0, m_master.parameters().m_max_weight}; // in [0, max_weight)
 
-        for (uint64_t i = 0; i < num_edges; i++) {
-            // if(static_cast<int>((sources[i] + destinations[i]) % modulo) == m_worker_id){
-            if (static_cast<int>(std::hash<uint64_t>()((sources[i] + destinations[i])) % modulo) == m_worker_id) {
-                if (last->size() > last_max_sz) {
-                    last = new vector<graph::WeightedEdge>();
-                    m_updates.append(last);
-                }
-
-                // counters
-                double weight = weights[i];
-                if (weight >= 0) {
-                    m_num_edge_insertions++;
-                } else {
-                    m_num_edge_deletions++;
-                }
-
-                // generate a random weight
-                if (weight == 0.0) {
-                    weight = rndweight(m_random); // in [0, max_weight)
-                    if (weight == 0.0) weight = m_master.parameters().m_max_weight; // in (0, max_weight]
-                }
+        for (uint64_t i = slice.first; i < slice.second; i++) {
+            if (last->size() > last_max_sz) {
+                last = new vector<graph::WeightedEdge>();
+                m_updates.append(last);
+            }
 
+            // counters
+            double weight = weights[i];
+            if (weight >= 0) {
+                m_num_edge_insertions++;
+            } else {
+                m_num_edge_deletions++;
+            }
 
-                last->emplace_back(sources[i], destinations[i], weight);
+            // generate a random weight
+            if (weight == 0.0) {
+                weight = rndweight(m_random); // in [0, max_weight)
+                if (weight == 0.0) weight = m_master.parameters().m_max_weight; // in (0, max_weight]
             }
+
+            last->emplace_back(sources[i], destinations[i], weight);
         }
     }
 
@@ -362,6 +458,8 @@ namespace gfe::experiment::details {
         uint64_t *__restrict sources = edges;
         uint64_t *__restrict destinations = sources + num_edges;
         double *__restrict weights = reinterpret_cast<double *>(destinations + num_edges);
+        utility::ScopedPerfCounters perf_counters{m_master.m_perf_counters.get(), static_cast<uint64_t>(m_worker_id)};
+        const bool with_latency = m_latency_insertions != nullptr || m_timeline_probe != nullptr;
         //start_index = m_master.m_workload_index.fetch_add(m_update_batch_granularity);
         //LOG("Thread "<<m_worker_id<<" insert "<<start_index);
         while((start_index = m_master.m_workload_index.fetch_add(m_update_batch_granularity))<num_edges){
@@ -377,12 +475,20 @@ namespace gfe::experiment::details {
                     new_weight+=current_weight;
                 }*/
                 //m_library->update_edge_v1(graph::WeightedEdge(sources[i],destinations[i],weights[i]));
+                chrono::steady_clock::time_point t0;
+                if (with_latency) { t0 = chrono::steady_clock::now(); }
+                m_is_in_library_code = true;
                 m_library->add_edge_v3(graph::WeightedEdge(sources[i],destinations[i],(weights[i]+1)));
+                m_is_in_library_code = false;
+                if (with_latency) { // the updates are upserts, recorded as insertions
+                    record_latency_insertions(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - t0).count());
+                }
                // LOG("Thread "<<m_worker_id<<" insert "<<sources[i]<<" "<<destinations[i]);
                 //while (!m_library->add_edge_v3(graph::WeightedEdge(sources[i],destinations[i],weights[i]))) { /* nop */ };
                 //while (!m_library->update_edge_v1(graph::WeightedEdge(sources[i],destinations[i],weights[i]))) { /* nop */ };
 
             }
+            m_num_operations += end - start_index;
         }
        //LOG("Worker "<<m_worker_id<<" finished in this batch");
     }
@@ -474,16 +580,92 @@ namespace gfe::experiment::details {
  *****************************************************************************/
 
     void Aging2Worker::graph_execute_batch_updates(graph::WeightedEdge *__restrict updates, uint64_t num_updates) {
-        if (m_latency_insertions == nullptr) {
+        const bool use_groups = m_master.parameters().m_update_batch_size > 1;
+        if (m_latency_insertions == nullptr && m_timeline_probe == nullptr) {
             assert(m_master.parameters().m_measure_latency == false);
             assert(m_latency_deletions == nullptr);
-            graph_execute_batch_updates0</* measure latency ? */ false>(updates, num_updates);
+            if (use_groups) {
+                graph_execute_group_updates</* measure latency ? */ false>(updates, num_updates);
+            } else {
+                graph_execute_batch_updates0</* measure latency ? */ false>(updates, num_updates);
+            }
             //graph_execute_batch_updates1</* measure latency ? */ false>(updates, num_updates);
         } else {
-            assert(m_master.parameters().m_measure_latency == true);
-            assert(m_latency_deletions != nullptr);
+            assert(m_master.parameters().m_measure_latency == true || m_timeline_probe != nullptr);
+            assert((m_latency_insertions == nullptr) == (m_latency_deletions == nullptr));
             //graph_execute_batch_updates1</* measure latency ? */ true>(updates, num_updates);
-            graph_execute_batch_updates0</* measure latency ? */ true>(updates, num_updates);
+            if (use_groups) {
+                graph_execute_group_updates</* measure latency ? */ true>(updates, num_updates);
+            } else {
+                graph_execute_batch_updates0</* measure latency ? */ true>(updates, num_updates);
+            }
+        }
+    }
+
+    template<bool with_latency>
+    void Aging2Worker::graph_execute_group_updates(graph::WeightedEdge *__restrict updates, uint64_t num_updates) {
+        using SingleUpdate = library::UpdateInterface::SingleUpdate;
+        const uint64_t group_size = m_master.parameters().m_update_batch_size;
+        const auto atomicity = m_master.parameters().m_update_batch_atomicity;
+        constexpr uint64_t max_group_retries = 64; // attempts to perform an atomic group before discarding it
+        vector<SingleUpdate> group; group.reserve(std::min(group_size, num_updates));
+        unique_ptr<bool[]> applied { new bool[std::min(group_size, num_updates)] };
+
+        uint64_t i = 0;
+        while (i < num_updates && !m_master.m_stop_experiment) {
+            const uint64_t group_end = std::min(num_updates, i + group_size);
+            group.clear();
+            for (uint64_t j = i; j < group_end; j++) {
+                graph::WeightedEdge edge = updates[j];
+                if (!m_master.is_directed() && m_uniform(m_random) < 0.5) edge.swap_src_dst(); // noise
+                group.push_back(SingleUpdate{edge.m_source, edge.m_destination, edge.m_weight});
+            }
+
+            chrono::steady_clock::time_point t0;
+            if (with_latency) { t0 = chrono::steady_clock::now(); }
+            m_is_in_library_code = true;
+            uint64_t num_applied = m_library->update_batch(group.data(), group.size(), atomicity, applied.get());
+
+            if (num_applied < group.size()) {
+                if (atomicity == library::UpdateInterface::BatchAtomicity::PER_BATCH) {
+                    // the library discarded the whole group, e.g. because one of the vertices is still being inserted by
+                    // another thread. Retry it as a whole, to preserve its atomicity. A group that keeps failing, e.g.
+                    // because it removes a missing edge, is eventually discarded and reported in the results
+                    for (uint64_t retry = 0; num_applied == 0 && retry < max_group_retries && !m_master.m_stop_experiment; retry++) {
+                        num_applied = m_library->update_batch(group.data(), group.size(), atomicity, applied.get());
+                    }
+                    if (num_applied == 0) {
+                        m_is_in_library_code = false;
+                        if (!m_master.m_stop_experiment) { m_num_discarded_updates += group.size(); }
+                        i = group_end;
+                        continue;
+                    }
+                } else {
+                    // as in #graph_insert_edge and #graph_remove_edge (force = false), repeat the insertions that could
+                    // not be performed and attempt once more the deletions
+                    for (uint64_t j = 0; j < group.size(); j++) {
+                        if (applied[j]) continue;
+                        if (group[j].m_weight >= 0) { // insertion
+                            while (!m_library->add_edge_v2(graph::WeightedEdge{group[j].m_source, group[j].m_destination, group[j].m_weight})) { /* nop */ };
+                            num_applied++;
+                        } else if (m_library->remove_edge(graph::Edge{group[j].m_source, group[j].m_destination})) { // deletion
+                            num_applied++;
+                        }
+                    }
+                }
+            }
+            m_is_in_library_code = false;
+
+            if (with_latency) { // all updates in the group share the same latency
+                uint64_t latency = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - t0).count();
+                uint64_t num_insertions = 0;
+                for (uint64_t j = 0; j < group.size(); j++) { num_insertions += (group[j].m_weight >= 0); }
+                if (num_insertions > 0) record_latency_insertions(latency, num_insertions);
+                if (num_insertions < group.size()) record_latency_deletions(latency, group.size() - num_insertions);
+            }
+
+            m_num_operations += group.size();
+            i = group_end;
         }
     }
 
@@ -534,8 +716,7 @@ namespace gfe::experiment::details {
             } while (!m_library->add_edge_v2(edge));
             t1 = chrono::steady_clock::now();
 
-            m_latency_insertions[0] = chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count();
-            m_latency_insertions++;
+            record_latency_insertions(chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count());
         }
         m_is_in_library_code = false;
     }
@@ -565,12 +746,21 @@ namespace gfe::experiment::details {
             }
             t1 = chrono::steady_clock::now();
 
-            m_latency_deletions[0] = chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count();
-            m_latency_deletions++;
+            record_latency_deletions(chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count());
         }
         m_is_in_library_code = false;
     }
 
+    void Aging2Worker::record_latency_insertions(uint64_t latency, uint64_t count) {
+        if (m_latency_insertions) { m_latency_insertions->record(latency, count); }
+        if (m_timeline_probe != nullptr) { m_timeline_probe->record(TimelineProbe::INSERTION, latency, count); }
+    }
+
+    void Aging2Worker::record_latency_deletions(uint64_t latency, uint64_t count) {
+        if (m_latency_deletions) { m_latency_deletions->record(latency, count); }
+        if (m_timeline_probe != nullptr) { m_timeline_probe->record(TimelineProbe::DELETION, latency, count); }
+    }
+
     uint64_t Aging2Worker::granularity() const {
         return m_master.parameters().m_worker_granularity;
     }
@@ -587,6 +777,10 @@ namespace gfe::experiment::details {
         return m_num_operations;
     }
 
+    uint64_t Aging2Worker::num_discarded_updates() const {
+        return m_num_discarded_updates;
+    }
+
     uint64_t Aging2Worker::memory_footprint() const {
         return m_updates_mem_usage;
     }
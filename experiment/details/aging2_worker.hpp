@@ -19,6 +19,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <random>
 #include <thread>
@@ -28,6 +29,8 @@
 
 // forward declarations
 namespace gfe::experiment::details { class Aging2Master; }
+namespace gfe::experiment::details { class LatencyHistogram; }
+namespace gfe::experiment::details { class TimelineProbe; }
 namespace gfe::library { class UpdateInterface; }
 
 namespace gfe::experiment::details {
@@ -43,16 +46,18 @@ class Aging2Worker {
     uint64_t m_updates_mem_usage {0}; // total amount of space used by the vectors `m_updates', in bytes
     std::mt19937_64 m_random { std::random_device{}() }; // pseudo-random generator
     std::uniform_real_distribution<double> m_uniform{ 0., 1. }; // uniform distribution in [0, 1]
-    uint64_t* m_latency_insertions {nullptr};
+    std::unique_ptr<LatencyHistogram> m_latency_insertions; // histogram of the latencies of the insertions, if measured
     uint64_t m_num_edge_insertions {0}; // counter, total number of edge insertions to perform, as contained in the array m_updates
-    uint64_t* m_latency_deletions {nullptr};
+    std::unique_ptr<LatencyHistogram> m_latency_deletions; // histogram of the latencies of the deletions, if measured
     uint64_t m_num_edge_deletions {0}; // counter, total number of edge deletions to perform, as contained in the array m_updates
+    TimelineProbe* m_timeline_probe {nullptr}; // where to record the latencies for the timeline of the master, if requested
     uint64_t m_update_batch_granularity= 16;
     std::atomic<uint64_t> m_num_operations = 0; // counter, total number of operations performed so far
+    uint64_t m_num_discarded_updates = 0; // counter, updates of the atomic groups discarded by the library after all retries
 
     std::atomic<bool> m_is_in_library_code = false;
 
-    enum class TaskOp { IDLE, START, STOP, LOAD_EDGES, EXECUTE_UPDATES, REMOVE_VERTICES, SET_ARRAY_LATENCIES, EXECUTE_TRUE_UPDATES };
+    enum class TaskOp { IDLE, START, STOP, PARTITION_COUNT, PARTITION_SCATTER, LOAD_EDGES, EXECUTE_UPDATES, EXECUTE_STREAM, REMOVE_VERTICES, ENABLE_LATENCIES, EXECUTE_TRUE_UPDATES };
     struct Task { TaskOp m_type; uint64_t* m_payload; uint64_t m_payload_sz; };
     Task m_task; // current task being executed
 
@@ -69,8 +74,14 @@ class Aging2Worker {
     // the controller for the background thread
     void main_thread();
 
-    // load a batch of edges in the background thread
-    void main_load_edges(uint64_t* edges, uint64_t num_edges);
+    // count, for each owner, the number of edges in the chunk of this worker, in the background thread
+    void main_partition_count(const uint64_t* edges, uint64_t num_edges);
+
+    // scatter the edges in the chunk of this worker to the slices of their owners, in the background thread
+    void main_partition_scatter(const uint64_t* edges, uint64_t num_edges);
+
+    // load the slice of edges assigned by the master to this worker, in the background thread
+    void main_load_edges();
 
     // load a batch of edges in the background thread
     void main_load_edges_even_split(uint64_t* edges, uint64_t num_edges);
@@ -78,6 +89,12 @@ class Aging2Worker {
     // execute the insert/delete operations for the graph in the background thread
     void main_execute_updates();
 
+    // execute the insert/delete operations fetched from the stream of the master, in the background thread
+    void main_execute_stream();
+
+    // execute a sequence of operations in chunks of `granularity', recording the progress done
+    void execute_operations(graph::WeightedEdge* operations, uint64_t num_operations, int& lastset_coeff);
+
     void main_execute_true_updates(uint64_t* edges, uint64_t num_edges);
 
     // remote the artificial vertices, those that do not belong to the final graph, in the background thread
@@ -94,6 +111,10 @@ class Aging2Worker {
     template<bool with_latency>
     void graph_execute_batch_updates1(graph::WeightedEdge* __restrict updates, uint64_t num_updates);
 
+    // Execute a batch of updates in groups, with UpdateInterface#update_batch
+    template<bool with_latency>
+    void graph_execute_group_updates(graph::WeightedEdge* __restrict updates, uint64_t num_updates);
+
     // Insert the given edge in the graph
     template<bool with_latency>
     void graph_insert_edge(graph::WeightedEdge edge);
@@ -102,6 +123,10 @@ class Aging2Worker {
     template<bool with_latency>
     void graph_remove_edge(graph::Edge edge, bool force = true);
 
+    // Record the latency of `count' insertions or deletions, in nanosecs
+    void record_latency_insertions(uint64_t latency, uint64_t count = 1);
+    void record_latency_deletions(uint64_t latency, uint64_t count = 1);
+
     // Remove the temporary edge at the head of the queue m_edges2remove
     void graph_remove_temporary_edge();
 
@@ -117,19 +142,32 @@ public:
     // Destructor. It implicitly stops the background thread.
     ~Aging2Worker();
 
-    // Load a batch of edges
-    void load_edges(uint64_t* edges, uint64_t num_edges);
+    // First phase of the partitioning of a batch of edges: build the histogram of the owners for the chunk of this worker
+    void partition_count(const uint64_t* edges, uint64_t num_edges);
+
+    // Second phase of the partitioning: copy the edges of the chunk of this worker into the partition buffer of the master
+    void partition_scatter(const uint64_t* edges, uint64_t num_edges);
+
+    // Take ownership of the slice of edges assigned to this worker in the last partitioning
+    void load_edges();
 
     void load_edge(uint64_t source, uint64_t destination, double weight);
 
     void execute_true_updates(uint64_t* edges, uint64_t num_edges);
 
-    // Set the latency arrays for insertions and deletions
-    void set_latencies(uint64_t* array_insertions, uint64_t* array_deletions);
+    // Start recording the latency of the updates
+    void enable_latencies();
+
+    // Retrieve the histograms of the latencies recorded so far, or nullptr if the latencies are not measured
+    const LatencyHistogram* latency_insertions() const;
+    const LatencyHistogram* latency_deletions() const;
 
     // Request the thread to execute all updates
     void execute_updates();
 
+    // Request the thread to execute the updates from the stream of the master, until the stream is closed
+    void execute_stream();
+
     // Request to remove the vertices that do not belong to the final graph
     void remove_vertices(uint64_t* vertices, uint64_t num_vertices);
 
@@ -148,6 +186,9 @@ public:
     // Total number of operations performed so far
     uint64_t num_operations() const;
 
+    // Total number of updates not performed, as their atomic group has been repeatedly discarded by the library
+    uint64_t num_discarded_updates() const;
+
     // Rough estimate of the memory footprint consumed by this worker, in bytes
     uint64_t memory_footprint() const;
 
@@ -20,6 +20,8 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <cstring>
 #include <limits>
 #include "common/database.hpp"
 #include "common/quantity.hpp"
@@ -30,47 +32,109 @@ using namespace std;
 
 namespace gfe::experiment::details {
 
-static uint64_t get_percentile(uint64_t* __restrict A, uint64_t A_sz, uint64_t index){
-    uint64_t pos = (index * A_sz) / 100; // i : 100 = pos : num_operations
-    return A[pos > 0 ? (pos -1) : 0];
+/*****************************************************************************
+ *                                                                           *
+ *   LatencyHistogram                                                        *
+ *                                                                           *
+ *****************************************************************************/
+
+LatencyHistogram::LatencyHistogram(){
+    memset(m_counts, 0, sizeof(m_counts));
 }
 
-LatencyStatistics LatencyStatistics::compute_statistics(uint64_t* arr_latencies_nanosecs, uint64_t arr_latencies_sz){
-    LatencyStatistics instance;
-    if(arr_latencies_sz == 0) return instance;
-
-    // compute mean/std.dev/min/max
-    uint64_t sum = 0;
-    uint64_t sum2 = 0;
-    uint64_t vmin = numeric_limits<uint64_t>::max();
-    uint64_t vmax = 0;
-    for(uint64_t i = 0; i < arr_latencies_sz; i++){
-        uint64_t value = arr_latencies_nanosecs[i];
-
-        sum += value;
-        sum2 += value * value;
-        vmin = min(value, vmin);
-        vmax = max(value, vmax);
-    }
+uint64_t LatencyHistogram::bucket_of(uint64_t value){
+    if(value < SUB_BUCKET_COUNT) return value; // the first buckets are exact
+    uint64_t exponent = 63 - __builtin_clzll(value); // position of the most significant bit, >= SUB_BUCKET_BITS
+    uint64_t shift = exponent - SUB_BUCKET_BITS;
+    uint64_t sub_bucket = (value >> shift) - SUB_BUCKET_COUNT; // the bits following the most significant one
+    return (shift +1) * SUB_BUCKET_COUNT + sub_bucket;
+}
 
-    instance.m_num_operations = arr_latencies_sz;
-    instance.m_mean = sum / arr_latencies_sz;
-    instance.m_stddev = (sum2 / arr_latencies_sz) - (instance.m_mean * instance.m_mean);
-    instance.m_min = vmin;
-    instance.m_max = vmax;
-
-    // compute the percentiles
-    sort(arr_latencies_nanosecs, arr_latencies_nanosecs + arr_latencies_sz);
-    instance.m_percentile90 = get_percentile(arr_latencies_nanosecs, arr_latencies_sz, 90);
-    instance.m_percentile95 = get_percentile(arr_latencies_nanosecs, arr_latencies_sz, 95);
-    instance.m_percentile97 = get_percentile(arr_latencies_nanosecs, arr_latencies_sz, 97);
-    instance.m_percentile99 = get_percentile(arr_latencies_nanosecs, arr_latencies_sz, 99);
-
-    if(arr_latencies_sz % 2 == 0){
-        instance.m_median = (arr_latencies_nanosecs[arr_latencies_sz /2] + arr_latencies_nanosecs[(arr_latencies_sz /2)-1]) /2;
-    } else {
-        instance.m_median = arr_latencies_nanosecs[arr_latencies_sz /2];
+uint64_t LatencyHistogram::lowest_value(uint64_t bucket){
+    if(bucket < SUB_BUCKET_COUNT) return bucket;
+    uint64_t shift = bucket / SUB_BUCKET_COUNT -1;
+    uint64_t sub_bucket = bucket % SUB_BUCKET_COUNT;
+    return (SUB_BUCKET_COUNT + sub_bucket) << shift;
+}
+
+uint64_t LatencyHistogram::highest_value(uint64_t bucket){
+    if(bucket < SUB_BUCKET_COUNT) return bucket;
+    uint64_t shift = bucket / SUB_BUCKET_COUNT -1;
+    return lowest_value(bucket) + ((1ull << shift) -1);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other){
+    for(uint64_t i = 0; i < NUM_BUCKETS; i++){ m_counts[i] += other.m_counts[i]; }
+    m_num_values += other.m_num_values;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+    m_sum += other.m_sum;
+    m_sum_squares += other.m_sum_squares;
+}
+
+uint64_t LatencyHistogram::min() const {
+    return m_num_values > 0 ? m_min : 0;
+}
+
+uint64_t LatencyHistogram::max() const {
+    return m_max;
+}
+
+double LatencyHistogram::mean() const {
+    return m_num_values > 0 ? static_cast<double>(m_sum / m_num_values) : 0.;
+}
+
+double LatencyHistogram::stddev() const {
+    if(m_num_values == 0) return 0.;
+    long double mean = m_sum / m_num_values;
+    long double variance = m_sum_squares / m_num_values - mean * mean;
+    return variance > 0 ? static_cast<double>(sqrt(variance)) : 0.;
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const {
+    if(m_num_values == 0) return 0;
+    assert(percentile >= 0 && percentile <= 100);
+
+    // the rank of the value to retrieve, in [1, num_values]
+    uint64_t rank = static_cast<uint64_t>(ceil(percentile / 100. * m_num_values));
+    rank = std::max<uint64_t>(1, std::min(rank, m_num_values));
+
+    uint64_t cumulative = 0;
+    uint64_t bucket = 0;
+    while(cumulative + m_counts[bucket] < rank){
+        cumulative += m_counts[bucket];
+        bucket++;
     }
+    assert(bucket < NUM_BUCKETS);
+
+    // report the middle of the bucket, within the values actually recorded
+    uint64_t low = lowest_value(bucket);
+    uint64_t value = low + (highest_value(bucket) - low) / 2;
+    return std::max(m_min, std::min(m_max, value));
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *   LatencyStatistics                                                       *
+ *                                                                           *
+ *****************************************************************************/
+
+LatencyStatistics LatencyStatistics::compute_statistics(const LatencyHistogram& histogram){
+    LatencyStatistics instance;
+    if(histogram.num_values() == 0) return instance;
+
+    instance.m_num_operations = histogram.num_values();
+    instance.m_mean = histogram.mean();
+    instance.m_stddev = histogram.stddev();
+    instance.m_min = histogram.min();
+    instance.m_max = histogram.max();
+    instance.m_median = histogram.percentile(50);
+    instance.m_percentile90 = histogram.percentile(90);
+    instance.m_percentile95 = histogram.percentile(95);
+    instance.m_percentile97 = histogram.percentile(97);
+    instance.m_percentile99 = histogram.percentile(99);
+    instance.m_percentile999 = histogram.percentile(99.9);
+    instance.m_percentile9999 = histogram.percentile(99.99);
 
     return instance;
 }
@@ -102,6 +166,8 @@ void LatencyStatistics::save(const std::string& name){
     store.add("p95", m_percentile95);
     store.add("p97", m_percentile97);
     store.add("p99", m_percentile99);
+    store.add("p999", m_percentile999);
+    store.add("p9999", m_percentile9999);
 }
 
 static DurationQuantity _D(uint64_t value){
@@ -112,7 +178,8 @@ std::ostream& operator<<(std::ostream& out, const LatencyStatistics& stats){
     out << "N: " << stats.m_num_operations << ", mean: " << _D(stats.m_mean) << ", median: " << _D(stats.m_median) << ", "
             << "std. dev.: " << _D(stats.m_stddev) << ", min: " << _D(stats.m_min) << ", max: " << _D(stats.m_max) << ", "
             << "perc 90: " << _D(stats.m_percentile90) << ", perc 95: " << _D(stats.m_percentile95) << ", "
-            << "perc 97: " << _D(stats.m_percentile97) << ", perc 99: " << _D(stats.m_percentile99);
+            << "perc 97: " << _D(stats.m_percentile97) << ", perc 99: " << _D(stats.m_percentile99) << ", "
+            << "perc 99.9: " << _D(stats.m_percentile999) << ", perc 99.99: " << _D(stats.m_percentile9999);
     return out;
 }
 
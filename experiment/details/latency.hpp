@@ -20,11 +20,98 @@
 #include <cinttypes>
 #include <chrono>
 #include <cstdint>
+#include <limits>
 #include <ostream>
 #include <string>
 
 namespace gfe::experiment::details {
 
+/**
+ * Log-linear histogram (HDR-style) of latencies, in nanosecs. Each power of 2 is divided in 2^SUB_BUCKET_BITS linear
+ * sub-buckets, so that the relative error of the recorded values is bound by 2^-SUB_BUCKET_BITS, while the memory
+ * footprint is constant, regardless of the number of recorded operations.
+ *
+ * A histogram is meant to be updated by a single thread, without any synchronisation. The histograms of different
+ * threads can be merged once they have terminated.
+ */
+class LatencyHistogram {
+public:
+    constexpr static uint64_t SUB_BUCKET_BITS = 7; // 128 sub-buckets for each power of 2, relative error < 1%
+    constexpr static uint64_t SUB_BUCKET_COUNT = 1ull << SUB_BUCKET_BITS;
+    constexpr static uint64_t NUM_BUCKETS = SUB_BUCKET_COUNT * (64 - SUB_BUCKET_BITS + 1);
+
+private:
+    uint64_t m_counts[NUM_BUCKETS]; // number of values recorded in each bucket
+    uint64_t m_num_values {0}; // total number of values recorded
+    uint64_t m_min {std::numeric_limits<uint64_t>::max()}; // min value recorded
+    uint64_t m_max {0}; // max value recorded
+    long double m_sum {0}; // sum of the recorded values
+    long double m_sum_squares {0}; // sum of the squares of the recorded values
+
+    // The bucket associated to the given value
+    static uint64_t bucket_of(uint64_t value);
+
+    // The smallest value stored in the given bucket
+    static uint64_t lowest_value(uint64_t bucket);
+
+    // The largest value stored in the given bucket
+    static uint64_t highest_value(uint64_t bucket);
+
+public:
+    /**
+     * Create an empty histogram
+     */
+    LatencyHistogram();
+
+    /**
+     * Record the given value, `count' times
+     */
+    void record(uint64_t value, uint64_t count = 1){
+        m_counts[bucket_of(value)] += count;
+        m_num_values += count;
+        if(value < m_min) m_min = value;
+        if(value > m_max) m_max = value;
+        long double v = value;
+        m_sum += v * count;
+        m_sum_squares += v * v * count;
+    }
+
+    /**
+     * Add the values recorded by another histogram to this one
+     */
+    void merge(const LatencyHistogram& other);
+
+    /**
+     * Total number of recorded values
+     */
+    uint64_t num_values() const { return m_num_values; }
+
+    /**
+     * The smallest recorded value, or 0 if the histogram is empty
+     */
+    uint64_t min() const;
+
+    /**
+     * The largest recorded value, or 0 if the histogram is empty
+     */
+    uint64_t max() const;
+
+    /**
+     * The average of the recorded values
+     */
+    double mean() const;
+
+    /**
+     * The standard deviation of the recorded values
+     */
+    double stddev() const;
+
+    /**
+     * Retrieve the (approximate) value at the given percentile, in [0, 100]
+     */
+    uint64_t percentile(double percentile) const;
+};
+
 class LatencyStatistics {
     friend std::ostream& operator<<(std::ostream& out, const LatencyStatistics& stats);
     uint64_t m_num_operations {0};
@@ -37,14 +124,14 @@ class LatencyStatistics {
     uint64_t m_percentile95 {0};
     uint64_t m_percentile97 {0};
     uint64_t m_percentile99 {0};
+    uint64_t m_percentile999 {0};
+    uint64_t m_percentile9999 {0};
 
 public:
     /**
-     * Compute the statistics for the given latencies
-     * @param arr_latencies_nanosecs an array containing the latency of each operation, in nanosecs
-     * @param arr_latencies_sz number of elements in the array arr_latencies_nanosecs
+     * Compute the statistics for the latencies recorded in the given histogram, in nanosecs
      */
-    static LatencyStatistics compute_statistics(uint64_t* arr_latencies_nanosecs, uint64_t arr_latencies_sz);
+    static LatencyStatistics compute_statistics(const LatencyHistogram& histogram);
 
     /**
      * Save the statistics into the table "latency" with the given value for the attribute `type'
@@ -0,0 +1,244 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "query_scheduler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#if defined(HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+#include "common/database.hpp"
+#include "common/error.hpp"
+#include "common/system.hpp"
+#include "library/interface.hpp"
+#include "configuration.hpp"
+#include "latency.hpp"
+
+using namespace std;
+
+/*****************************************************************************
+ *                                                                           *
+ * Debug                                                                     *
+ *                                                                           *
+ *****************************************************************************/
+//#define DEBUG
+namespace gfe { extern mutex _log_mutex [[maybe_unused]]; }
+#define COUT_DEBUG_FORCE(msg) { std::scoped_lock<std::mutex> lock{::gfe::_log_mutex}; std::cout << "[QueryScheduler::" << __FUNCTION__ << "] " << msg << std::endl; }
+#if defined(DEBUG)
+    #define COUT_DEBUG(msg) COUT_DEBUG_FORCE(msg)
+#else
+    #define COUT_DEBUG(msg)
+#endif
+
+/*****************************************************************************
+ *                                                                           *
+ * QueryScheduler                                                            *
+ *                                                                           *
+ *****************************************************************************/
+namespace gfe::experiment::details {
+
+QueryScheduler::QueryScheduler(std::shared_ptr<library::GraphalyticsInterface> interface, const vector<PoolDescription>& pools) : m_interface(interface) {
+    if(m_interface.get() == nullptr) INVALID_ARGUMENT("The interface is a nullptr");
+    for(const auto& description : pools){
+        if(description.m_num_threads == 0) INVALID_ARGUMENT("A pool of readers requires at least one thread");
+        if(description.m_num_vertices == 0 || description.m_num_vertices > m_interface->two_hop_neighbor_size){
+            INVALID_ARGUMENT("Invalid number of vertices for each query: " << description.m_num_vertices << ", expected a value in [1, " << m_interface->two_hop_neighbor_size << "]");
+        }
+
+        Pool pool;
+        pool.m_description = description;
+        for(uint64_t i = 0; i < description.m_num_threads; i++){
+            pool.m_latencies.emplace_back( new LatencyHistogram() );
+        }
+        m_pools.push_back(move(pool));
+    }
+}
+
+QueryScheduler::~QueryScheduler(){
+    try {
+        stop();
+    } catch(...){ /* the error has been already reported by the reader */ }
+}
+
+vector<QueryScheduler::PoolDescription> QueryScheduler::parse(const string& description){
+    vector<PoolDescription> result;
+    stringstream ss_pools { description };
+    string str_pool;
+    while(getline(ss_pools, str_pool, ',')){
+        str_pool.erase(std::remove_if(begin(str_pool), end(str_pool), ::isspace), end(str_pool));
+        if(str_pool.empty()) continue;
+
+        vector<string> tokens;
+        stringstream ss_tokens { str_pool };
+        string token;
+        while(getline(ss_tokens, token, ':')){ tokens.push_back(token); }
+        if(tokens.size() < 2 || tokens.size() > 3) INVALID_ARGUMENT("Invalid pool of readers: `" << str_pool << "', expected <query>:<num_threads>[:<num_vertices>]");
+
+        PoolDescription pool;
+        transform(tokens[0].begin(), tokens[0].end(), tokens[0].begin(), ::tolower);
+        if(tokens[0] == "one_hop" || tokens[0] == "1hop"){
+            pool.m_type = QueryType::ONE_HOP;
+        } else if(tokens[0] == "two_hop" || tokens[0] == "2hop"){
+            pool.m_type = QueryType::TWO_HOP;
+        } else {
+            INVALID_ARGUMENT("Invalid query type: `" << tokens[0] << "', expected either one_hop or two_hop");
+        }
+
+        try {
+            pool.m_num_threads = stoull(tokens[1]);
+            pool.m_num_vertices = tokens.size() == 3 ? stoull(tokens[2]) : 1;
+        } catch(std::logic_error&){ // invalid_argument or out_of_range
+            INVALID_ARGUMENT("Invalid pool of readers: `" << str_pool << "', the number of threads and vertices must be integers");
+        }
+
+        result.push_back(pool);
+    }
+
+    return result;
+}
+
+uint64_t QueryScheduler::num_threads() const {
+    uint64_t result = 0;
+    for(const auto& pool : m_pools){ result += pool.m_description.m_num_threads; }
+    return result;
+}
+
+void QueryScheduler::start(){
+    m_terminate = false;
+    m_time_start = chrono::steady_clock::now();
+    for(auto& pool : m_pools){
+        for(uint64_t i = 0; i < pool.m_description.m_num_threads; i++){
+            pool.m_threads.emplace_back(&QueryScheduler::main_reader, this, &pool, i);
+        }
+    }
+    COUT_DEBUG("started " << num_threads() << " readers");
+}
+
+void QueryScheduler::stop(){
+    m_terminate = true;
+    bool joined = false;
+    for(auto& pool : m_pools){
+        for(auto& thread : pool.m_threads){
+            if(thread.joinable()){ thread.join(); joined = true; }
+        }
+        pool.m_threads.clear();
+    }
+    if(joined){ m_time_end = chrono::steady_clock::now(); }
+    COUT_DEBUG("readers terminated");
+
+    scoped_lock<mutex> lock(m_mutex);
+    if(m_exception){
+        exception_ptr exception = m_exception;
+        m_exception = nullptr;
+        rethrow_exception(exception);
+    }
+}
+
+void QueryScheduler::main_reader(Pool* pool, uint64_t thread_id){
+    common::concurrency::set_thread_name("Reader " + string(to_string(pool->m_description.m_type)) + " #" + std::to_string(thread_id));
+#if defined(HAVE_OPENMP)
+    omp_set_num_threads(1); // each query is executed by a single thread, the drivers parallelise the vertices of a query with OpenMP
+#endif
+
+    LatencyHistogram& latencies = *(pool->m_latencies[thread_id]);
+    const QueryType type = pool->m_description.m_type;
+    const uint64_t num_vertices = pool->m_description.m_num_vertices;
+    vector<uint64_t> candidates; // random vertices, as provided by the library
+    uint64_t next = 0; // next candidate to use
+    vector<uint64_t> vertices; // the source vertices of the current query
+    vertices.reserve(num_vertices);
+
+    try {
+        while(!m_terminate.load(memory_order_relaxed)){
+            if(next + num_vertices > candidates.size()){
+                candidates.clear();
+                m_interface->generate_two_hops_neighbor_candidates(candidates);
+                next = 0;
+                if(candidates.size() < num_vertices){ ERROR("The library does not support the generation of the candidate vertices for the short queries"); }
+            }
+            vertices.assign(candidates.begin() + next, candidates.begin() + next + num_vertices);
+            next += num_vertices;
+
+            auto t0 = chrono::steady_clock::now();
+            if(type == QueryType::ONE_HOP){
+                m_interface->one_hop_neighbors(vertices);
+            } else {
+                m_interface->two_hop_neighbors(vertices);
+            }
+            auto t1 = chrono::steady_clock::now();
+            latencies.record(chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count());
+        }
+    } catch(...){
+        scoped_lock<mutex> lock(m_mutex);
+        if(!m_exception){ m_exception = current_exception(); }
+        m_terminate = true; // stop the other readers as well
+    }
+}
+
+void QueryScheduler::report() const {
+    const double duration = chrono::duration_cast<chrono::microseconds>(m_time_end - m_time_start).count();
+
+    for(uint64_t pool_id = 0; pool_id < m_pools.size(); pool_id++){
+        const auto& pool = m_pools[pool_id];
+        LatencyHistogram latencies;
+        for(const auto& histogram : pool.m_latencies){ latencies.merge(*histogram); }
+        double throughput = duration > 0 ? latencies.num_values() * 1000000. / duration : 0.;
+
+        LOG("[QueryScheduler] Pool #" << pool_id << ", query: " << to_string(pool.m_description.m_type) << ", threads: " << pool.m_description.m_num_threads << ", "
+                "vertices per query: " << pool.m_description.m_num_vertices << ", throughput: " << (uint64_t) throughput << " queries/sec");
+        LOG("[QueryScheduler] Pool #" << pool_id << ", latencies: " << LatencyStatistics::compute_statistics(latencies));
+    }
+}
+
+void QueryScheduler::save(common::Database* db) const {
+    assert(db != nullptr && "Null pointer");
+    if(db == nullptr) INVALID_ARGUMENT("The handle to the database is a nullptr");
+    const uint64_t duration = chrono::duration_cast<chrono::microseconds>(m_time_end - m_time_start).count();
+
+    for(uint64_t pool_id = 0; pool_id < m_pools.size(); pool_id++){
+        const auto& pool = m_pools[pool_id];
+        LatencyHistogram latencies;
+        for(const auto& histogram : pool.m_latencies){ latencies.merge(*histogram); }
+        string name = string(to_string(pool.m_description.m_type)) + "_pool" + std::to_string(pool_id);
+
+        auto store = db->add("mixed_queries");
+        store.add("pool", pool_id);
+        store.add("type", name);
+        store.add("query", to_string(pool.m_description.m_type));
+        store.add("num_threads", pool.m_description.m_num_threads);
+        store.add("num_vertices", pool.m_description.m_num_vertices);
+        store.add("num_queries", latencies.num_values());
+        store.add("duration", duration); // microsecs
+
+        LatencyStatistics::compute_statistics(latencies).save(name); // table `latencies'
+    }
+}
+
+const char* to_string(QueryScheduler::QueryType type){
+    switch(type){
+    case QueryScheduler::QueryType::ONE_HOP: return "one_hop";
+    case QueryScheduler::QueryType::TWO_HOP: return "two_hop";
+    default: return "unknown";
+    }
+}
+
+} // namespace
@@ -0,0 +1,129 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace common { class Database; } // forward decl.
+namespace gfe::library { class GraphalyticsInterface; } // forward decl.
+
+namespace gfe::experiment::details {
+
+class LatencyHistogram; // forward decl.
+
+/**
+ * Run a mix of short read queries (1-hop and 2-hop neighbourhoods) concurrently with the updates of the mixed workload.
+ * The readers are organised in pools. Each pool executes the same kind of query, with a given number of threads, in a
+ * closed loop: every thread issues its next query as soon as the previous one completed. A query is a single
+ * invocation to GraphalyticsInterface#one_hop_neighbors or #two_hop_neighbors, thus each query is executed in its own
+ * snapshot/transaction of the library. The latency of each query is recorded in a histogram per thread.
+ */
+class QueryScheduler {
+    QueryScheduler(const QueryScheduler&) = delete;
+    QueryScheduler& operator=(const QueryScheduler&) = delete;
+
+public:
+    enum class QueryType { ONE_HOP, TWO_HOP };
+
+    // The description of a pool of readers
+    struct PoolDescription {
+        QueryType m_type; // the kind of query executed by the readers of the pool
+        uint64_t m_num_threads; // number of reader threads in the pool
+        uint64_t m_num_vertices; // number of source vertices in each query
+    };
+
+private:
+    struct Pool {
+        PoolDescription m_description;
+        std::vector<std::thread> m_threads; // the reader threads
+        std::vector<std::unique_ptr<LatencyHistogram>> m_latencies; // one histogram per thread
+    };
+
+    std::shared_ptr<library::GraphalyticsInterface> m_interface; // the library to evaluate
+    std::vector<Pool> m_pools; // the pools of readers
+    std::atomic<bool> m_terminate = false; // signal the readers to stop
+    std::chrono::steady_clock::time_point m_time_start; // when the readers were started
+    std::chrono::steady_clock::time_point m_time_end; // when the readers were stopped
+    std::mutex m_mutex; // protect m_exception
+    std::exception_ptr m_exception; // the first error raised by a reader, rethrown by #stop()
+
+    // The logic of each reader thread
+    void main_reader(Pool* pool, uint64_t thread_id);
+
+public:
+    /**
+     * Create a new scheduler, the readers are not started until #start() is invoked
+     * @param interface the library to evaluate
+     * @param pools the pools of readers to execute
+     */
+    QueryScheduler(std::shared_ptr<library::GraphalyticsInterface> interface, const std::vector<PoolDescription>& pools);
+
+    /**
+     * Destructor. It implicitly stops the readers
+     */
+    ~QueryScheduler();
+
+    /**
+     * Parse the description of the pools from a comma separated list of <query>:<num_threads>[:<num_vertices>], where
+     * query is either one_hop or two_hop, and num_vertices is the number of source vertices for each query (default 1).
+     * For instance, "one_hop:8,two_hop:2:16" is a pool with 8 threads executing 1-hop queries from a single vertex and
+     * a pool with 2 threads executing 2-hop queries from 16 vertices.
+     */
+    static std::vector<PoolDescription> parse(const std::string& description);
+
+    /**
+     * Total number of reader threads, among all pools
+     */
+    uint64_t num_threads() const;
+
+    /**
+     * Start the reader threads
+     */
+    void start();
+
+    /**
+     * Stop and join the reader threads. If any reader failed, rethrow its exception.
+     */
+    void stop();
+
+    /**
+     * Print to stdout the latencies and the throughput of each pool
+     */
+    void report() const;
+
+    /**
+     * Save the latencies and the throughput of each pool into the tables `latencies' and `mixed_queries'
+     */
+    void save(common::Database* db) const;
+};
+
+/**
+ * Retrieve the name of the given type of query
+ */
+const char* to_string(QueryScheduler::QueryType type);
+
+} // namespace
@@ -0,0 +1,204 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "timeline.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "common/database.hpp"
+#include "common/error.hpp"
+
+using namespace std;
+
+namespace gfe::experiment::details {
+
+/*****************************************************************************
+ *                                                                           *
+ *   TimelineProbe                                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+TimelineProbe::TimelineProbe(){
+    for(uint64_t type = 0; type < 2; type++){
+        for(uint64_t i = 0; i < NUM_BUCKETS; i++){
+            m_counts[type][i].store(0, memory_order_relaxed);
+        }
+    }
+}
+
+uint64_t TimelineProbe::bucket_of(uint64_t latency){
+    if(latency < SUB_BUCKET_COUNT) return latency;
+    uint64_t shift = (63 - __builtin_clzll(latency)) - SUB_BUCKET_BITS;
+    return (shift +1) * SUB_BUCKET_COUNT + ((latency >> shift) - SUB_BUCKET_COUNT);
+}
+
+uint64_t TimelineProbe::bucket_value(uint64_t bucket){
+    if(bucket < SUB_BUCKET_COUNT) return bucket;
+    uint64_t shift = bucket / SUB_BUCKET_COUNT -1;
+    uint64_t lowest = (SUB_BUCKET_COUNT + bucket % SUB_BUCKET_COUNT) << shift;
+    return lowest + ((1ull << shift) -1) / 2;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *   TimelineRecorder                                                        *
+ *                                                                           *
+ *****************************************************************************/
+
+TimelineRecorder::TimelineRecorder(uint64_t num_probes, chrono::milliseconds interval) : m_interval(interval) {
+    if(num_probes == 0) INVALID_ARGUMENT("num_probes == 0");
+    if(interval.count() <= 0) INVALID_ARGUMENT("The interval must be > 0");
+
+    m_probes.reserve(num_probes);
+    for(uint64_t i = 0; i < num_probes; i++){ m_probes.emplace_back(new TimelineProbe()); }
+    m_last_counts.resize(num_probes * 2 * TimelineProbe::NUM_BUCKETS, 0);
+}
+
+TimelineRecorder::~TimelineRecorder(){
+    stop();
+}
+
+TimelineProbe* TimelineRecorder::probe(uint64_t worker_id) {
+    assert(worker_id < m_probes.size() && "Invalid worker id");
+    return m_probes[worker_id].get();
+}
+
+uint64_t TimelineRecorder::now() {
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TimelineRecorder::start(){
+    if(m_sampler.joinable()) return; // already running
+
+    // the start of the first window
+    uint64_t* __restrict last_counts = m_last_counts.data();
+    for(auto& probe : m_probes){
+        for(uint64_t type = 0; type < 2; type++){
+            for(uint64_t i = 0; i < TimelineProbe::NUM_BUCKETS; i++){
+                *(last_counts++) = probe->get(static_cast<TimelineProbe::Type>(type), i);
+            }
+        }
+    }
+    m_last_time = now();
+
+    m_stop = false;
+    m_sampler = thread{ &TimelineRecorder::main_sampler, this };
+}
+
+void TimelineRecorder::stop(){
+    if(!m_sampler.joinable()) return; // not running
+
+    { // restrict the scope
+        scoped_lock<mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condvar.notify_all();
+    m_sampler.join();
+
+    take_sample(); // last window
+}
+
+void TimelineRecorder::main_sampler(){
+    unique_lock<mutex> lock(m_mutex);
+    auto next_sample = chrono::steady_clock::now() + m_interval;
+    while(!m_stop){
+        if(m_condvar.wait_until(lock, next_sample, [this](){ return m_stop; })) break;
+        take_sample();
+        next_sample += m_interval;
+    }
+}
+
+// Retrieve the latency at the given percentile, in [0, 100], from the histogram of a window
+static uint64_t window_percentile(const uint64_t* counts, uint64_t num_operations, double percentile){
+    if(num_operations == 0) return 0;
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(ceil(percentile / 100. * num_operations)));
+    uint64_t cumulative = 0;
+    uint64_t bucket = 0;
+    while(bucket < TimelineProbe::NUM_BUCKETS -1 && cumulative + counts[bucket] < rank){
+        cumulative += counts[bucket];
+        bucket++;
+    }
+    return TimelineProbe::bucket_value(bucket);
+}
+
+void TimelineRecorder::take_sample(){
+    // histogram of the window, for both insertions and deletions, merging all probes
+    vector<uint64_t> window(2 * TimelineProbe::NUM_BUCKETS, 0);
+    uint64_t num_operations[2] = {0, 0};
+
+    uint64_t time_end = now();
+    uint64_t* __restrict last_counts = m_last_counts.data();
+    for(auto& probe : m_probes){
+        for(uint64_t type = 0; type < 2; type++){
+            for(uint64_t i = 0; i < TimelineProbe::NUM_BUCKETS; i++){
+                uint64_t count = probe->get(static_cast<TimelineProbe::Type>(type), i);
+                uint64_t delta = count - *last_counts;
+                window[type * TimelineProbe::NUM_BUCKETS + i] += delta;
+                num_operations[type] += delta;
+                *(last_counts++) = count;
+            }
+        }
+    }
+
+    Sample sample;
+    sample.m_time_start = m_last_time;
+    sample.m_time_end = time_end;
+    sample.m_num_insertions = num_operations[TimelineProbe::INSERTION];
+    sample.m_num_deletions = num_operations[TimelineProbe::DELETION];
+    const uint64_t* insertions = window.data() + TimelineProbe::INSERTION * TimelineProbe::NUM_BUCKETS;
+    sample.m_insertions_p50 = window_percentile(insertions, sample.m_num_insertions, 50);
+    sample.m_insertions_p99 = window_percentile(insertions, sample.m_num_insertions, 99);
+    const uint64_t* deletions = window.data() + TimelineProbe::DELETION * TimelineProbe::NUM_BUCKETS;
+    sample.m_deletions_p50 = window_percentile(deletions, sample.m_num_deletions, 50);
+    sample.m_deletions_p99 = window_percentile(deletions, sample.m_num_deletions, 99);
+    m_samples.push_back(sample);
+
+    m_last_time = time_end;
+}
+
+const vector<TimelineRecorder::Sample>& TimelineRecorder::samples() const {
+    assert(!m_sampler.joinable() && "The recorder is still running");
+    return m_samples;
+}
+
+double TimelineRecorder::Sample::throughput() const {
+    uint64_t duration = m_time_end - m_time_start; // microsecs
+    return duration == 0 ? 0. : static_cast<double>(m_num_insertions + m_num_deletions) * 1000000. / duration;
+}
+
+void TimelineRecorder::save(common::Database* handle) const {
+    assert(handle != nullptr && "Null pointer");
+    if(handle == nullptr) INVALID_ARGUMENT("The handle to the database is a nullptr");
+
+    for(const auto& sample : samples()){
+        auto db = handle->add("aging_timeline");
+        db.add("time_start", sample.m_time_start); // microsecs, steady clock
+        db.add("time_end", sample.m_time_end); // microsecs, steady clock
+        db.add("num_insertions", sample.m_num_insertions);
+        db.add("num_deletions", sample.m_num_deletions);
+        db.add("throughput", sample.throughput()); // operations per second
+        db.add("insert_p50", sample.m_insertions_p50); // nanosecs
+        db.add("insert_p99", sample.m_insertions_p99); // nanosecs
+        db.add("delete_p50", sample.m_deletions_p50); // nanosecs
+        db.add("delete_p99", sample.m_deletions_p99); // nanosecs
+    }
+}
+
+} // namespace
@@ -0,0 +1,153 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace common { class Database; } // forward decl.
+
+namespace gfe::experiment::details {
+
+/**
+ * The counters fed by a single worker thread to a TimelineRecorder: a log-linear histogram of the latencies, in
+ * nanosecs, for both insertions and deletions. The counters are cumulative and written only by the owner thread,
+ * without atomic RMW instructions, while the sampler of the recorder reads them concurrently.
+ */
+class alignas(64) TimelineProbe {
+public:
+    constexpr static uint64_t SUB_BUCKET_BITS = 4; // 16 sub-buckets for each power of 2, relative error < 7%
+    constexpr static uint64_t SUB_BUCKET_COUNT = 1ull << SUB_BUCKET_BITS;
+    constexpr static uint64_t NUM_BUCKETS = SUB_BUCKET_COUNT * (64 - SUB_BUCKET_BITS + 1);
+    enum Type { INSERTION = 0, DELETION = 1 };
+
+private:
+    std::atomic<uint64_t> m_counts[2][NUM_BUCKETS]; // number of operations recorded so far, for each type and bucket
+
+public:
+    // Create a new probe, with all counters set to 0
+    TimelineProbe();
+
+    // The bucket associated to the given latency
+    static uint64_t bucket_of(uint64_t latency);
+
+    // A representative latency for the given bucket, that is, the middle value of the bucket
+    static uint64_t bucket_value(uint64_t bucket);
+
+    // Record `count' operations of the given type, with the given latency. Only the owner thread can invoke this method.
+    void record(Type type, uint64_t latency, uint64_t count = 1){
+        auto& counter = m_counts[type][bucket_of(latency)];
+        counter.store(counter.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+    // Read the number of operations recorded so far, for the given type and bucket
+    uint64_t get(Type type, uint64_t bucket) const { return m_counts[type][bucket].load(std::memory_order_relaxed); }
+};
+
+/**
+ * Record, every interval of time, the throughput and the tail latency of the updates performed by the workers in the
+ * last window. Each worker feeds its own TimelineProbe, a background thread samples them all at each interval.
+ */
+class TimelineRecorder {
+    TimelineRecorder(const TimelineRecorder&) = delete;
+    TimelineRecorder& operator=(const TimelineRecorder&) = delete;
+
+public:
+    struct Sample {
+        uint64_t m_time_start; // start of the window, microsecs of the steady clock
+        uint64_t m_time_end; // end of the window, microsecs of the steady clock
+        uint64_t m_num_insertions; // number of insertions performed in the window
+        uint64_t m_num_deletions; // number of deletions performed in the window
+        uint64_t m_insertions_p50; // median latency of the insertions in the window, in nanosecs
+        uint64_t m_insertions_p99; // 99th percentile of the latency of the insertions in the window, in nanosecs
+        uint64_t m_deletions_p50; // median latency of the deletions in the window, in nanosecs
+        uint64_t m_deletions_p99; // 99th percentile of the latency of the deletions in the window, in nanosecs
+
+        // Operations per second in the window
+        double throughput() const;
+    };
+
+private:
+    const std::chrono::milliseconds m_interval; // how often to take a sample
+    std::vector<std::unique_ptr<TimelineProbe>> m_probes; // one for each worker
+    std::vector<uint64_t> m_last_counts; // the counters of all probes at the previous sample
+    uint64_t m_last_time = 0; // when the previous sample was taken, microsecs of the steady clock
+    std::vector<Sample> m_samples; // the samples recorded so far
+    std::thread m_sampler; // background thread taking the samples
+    std::mutex m_mutex; // to sync with the sampler
+    std::condition_variable m_condvar; // to wake up the sampler when the recorder is stopped
+    bool m_stop = false; // request the sampler to terminate
+
+    // The main loop of the sampler
+    void main_sampler();
+
+    // Compute the delta of the counters w.r.t. the previous sample and append a new sample
+    void take_sample();
+
+public:
+    /**
+     * Create a new recorder
+     * @param num_probes the number of probes, that is the number of workers feeding the recorder
+     * @param interval how often to take a sample
+     */
+    TimelineRecorder(uint64_t num_probes, std::chrono::milliseconds interval);
+
+    /**
+     * Destructor. It implicitly stops the sampler.
+     */
+    ~TimelineRecorder();
+
+    /**
+     * Retrieve the probe for the given worker, in [0, num_probes)
+     */
+    TimelineProbe* probe(uint64_t worker_id);
+
+    /**
+     * Start sampling the probes in the background. The first window starts at the time of this invocation.
+     */
+    void start();
+
+    /**
+     * Stop sampling the probes, recording the last (partial) window
+     */
+    void stop();
+
+    /**
+     * Retrieve the samples recorded so far. The recorder must be stopped.
+     */
+    const std::vector<Sample>& samples() const;
+
+    /**
+     * Current time, in microsecs of the steady clock, the same clock used for the samples
+     */
+    static uint64_t now();
+
+    /**
+     * Save the samples into the table "aging_timeline"
+     */
+    void save(common::Database* db) const;
+};
+
+} // namespace
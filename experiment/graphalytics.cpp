@@ -18,6 +18,7 @@
 #include "graphalytics.hpp"
 
 #include <algorithm>
+#include <cassert>
 #include <cstdio> // mkdtemp
 #include <cstring>
 #include <filesystem>
@@ -31,6 +32,7 @@
 #include "library/interface.hpp"
 #include "reader/graphalytics_reader.hpp"
 #include "utility/graphalytics_validate.hpp"
+#include "utility/perf_counters.hpp"
 #include "configuration.hpp"
 #include "statistics.hpp"
 
@@ -135,11 +137,14 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
             string path_tmp = get_temporary_path("bfs", i);
             const char* path_result = m_validate_output_enabled ? path_tmp.c_str() : nullptr;
             try {
+                perf_counters_start("bfs");
                 t_local.start();
                 interface->bfs(m_properties.bfs.m_source_vertex, path_result);
                 t_local.stop();
+                perf_counters_stop("bfs");
               //  LOG(">> BFS Execution time: " << t_local);
                 m_exec_bfs.push_back(t_local.microseconds());
+                record_kernel("bfs", t_local);
 
                 if(m_validate_output_enabled){
                     string path_reference = get_validation_path("BFS");
@@ -155,6 +160,7 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
                     }
                 }
             } catch (library::TimeoutError& e){
+                perf_counters_stop("bfs"); // skipped in the try block by the timeout
                 LOG(">> BFS TIMEOUT");
                 m_exec_bfs.push_back(-1);
                 m_properties.bfs.m_enabled = false;
@@ -166,23 +172,18 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
         }
 
         if(m_properties.cdlp.m_enabled){
-            //std::cout<<"execute 2 hops neighbors"<<std::endl;
-            std::vector<uint64_t>vertices;
-            interface->generate_two_hops_neighbor_candidates(vertices);
-            t_local.start();
-            interface->two_hop_neighbors(vertices);
-            t_local.stop();
-            m_exec_cdlp.push_back(t_local.microseconds());
-            /*
             //LOG("Execution " << (i+1) << "/" << m_num_repetitions << ": CDLP, max_iterations: " << m_properties.cdlp.m_max_iterations);
             string path_tmp = get_temporary_path("cdlp", i);
             const char* path_result = m_validate_output_enabled ? path_tmp.c_str() : nullptr;
             try {
+                perf_counters_start("cdlp");
                 t_local.start();
                 interface->cdlp(m_properties.cdlp.m_max_iterations, path_result);
                 t_local.stop();
+                perf_counters_stop("cdlp");
               // LOG(">> CDLP Execution time: " << t_local);
                 m_exec_cdlp.push_back(t_local.microseconds());
+                record_kernel("cdlp", t_local);
 
                 if(m_validate_output_enabled){
                     string path_reference = get_validation_path("CDLP");
@@ -197,6 +198,7 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
                     }
                 }
             } catch(library::TimeoutError& e){
+                perf_counters_stop("cdlp"); // skipped in the try block by the timeout
                 LOG(">> CDLP TIMEOUT");
                 m_exec_cdlp.push_back(-1);
                 m_properties.cdlp.m_enabled = false;
@@ -204,25 +206,22 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
                 LOG(">> Validation failed: " << e.what());
                 m_validate_results.emplace_back("cdlp", ValidationResult::FAILED);
                 m_properties.cdlp.m_enabled = false;
-            }*/
+            }
         }
 
         if(m_properties.lcc.m_enabled){
-            std::vector<uint64_t>vertices;
-            interface->generate_two_hops_neighbor_candidates(vertices);
-            t_local.start();
-            interface->one_hop_neighbors(vertices);
-            t_local.stop();
-            m_exec_lcc.push_back(t_local.microseconds());
-           /*LOG("Execution " << (i+1) << "/" << m_num_repetitions << ": LCC");
+           //LOG("Execution " << (i+1) << "/" << m_num_repetitions << ": LCC");
             string path_tmp = get_temporary_path("lcc", i);
             const char* path_result = m_validate_output_enabled ? path_tmp.c_str() : nullptr;
             try {
+                perf_counters_start("lcc");
                 t_local.start();
                 interface->lcc(path_result);
                 t_local.stop();
+                perf_counters_stop("lcc");
                // LOG(">> LCC Execution time: " << t_local);
                 m_exec_lcc.push_back(t_local.microseconds());
+                record_kernel("lcc", t_local);
 
                 if(m_validate_output_enabled){
                     string path_reference = get_validation_path("LCC");
@@ -237,6 +236,7 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
                     }
                 }
             } catch(library::TimeoutError& e){
+                perf_counters_stop("lcc"); // skipped in the try block by the timeout
                 LOG(">> LCC TIMEOUT");
                 m_exec_lcc.push_back(-1);
                 m_properties.lcc.m_enabled = false;
@@ -244,7 +244,7 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
                 LOG(">> Validation failed: " << e.what());
                 m_validate_results.emplace_back("lcc", ValidationResult::FAILED);
                 m_properties.lcc.m_enabled = false;
-            }*/
+            }
         }
 
         if(m_properties.pagerank.m_enabled){
@@ -252,11 +252,14 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
             string path_tmp = get_temporary_path("pagerank", i);
             const char* path_result = m_validate_output_enabled ? path_tmp.c_str() : nullptr;
             try {
+                perf_counters_start("pagerank");
                 t_local.start();
                 interface->pagerank(m_properties.pagerank.m_num_iterations, m_properties.pagerank.m_damping_factor, path_result);
                 t_local.stop();
+                perf_counters_stop("pagerank");
                // LOG(">> PageRank Execution time: " << t_local);
                 m_exec_pagerank.push_back(t_local.microseconds());
+                record_kernel("pagerank", t_local);
 
                 if(m_validate_output_enabled){
                     string path_reference = get_validation_path("PR");
@@ -271,6 +274,7 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
                     }
                 }
             } catch(library::TimeoutError& e){
+                perf_counters_stop("pagerank"); // skipped in the try block by the timeout
                 LOG(">> PageRank TIMEOUT");
                 m_exec_pagerank.push_back(-1);
                 m_properties.pagerank.m_enabled = false;
@@ -286,13 +290,16 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
             string path_tmp = get_temporary_path("sssp", i);
             const char* path_result = m_validate_output_enabled ? path_tmp.c_str() : nullptr;
             try {
+                perf_counters_start("sssp");
                 t_local.start();
                 //std::cout<<"executing sssp from "<<m_properties.sssp.m_source_vertex<<std::endl;
                 interface->sssp(2592222, path_result);
                 //interface->sssp(m_properties.sssp.m_source_vertex, path_result);//2592222
                 t_local.stop();
+                perf_counters_stop("sssp");
                 //LOG(">> SSSP Execution time: " << t_local);
                 m_exec_sssp.push_back(t_local.microseconds());
+                record_kernel("sssp", t_local);
 
                 if(m_validate_output_enabled){
                     string path_reference = get_validation_path("SSSP");
@@ -307,6 +314,7 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
                     }
                 }
             } catch(library::TimeoutError& e){
+                perf_counters_stop("sssp"); // skipped in the try block by the timeout
                 LOG(">> SSSP TIMEOUT");
                 m_exec_sssp.push_back(-1);
                 m_properties.sssp.m_enabled = false;
@@ -321,11 +329,14 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
             string path_tmp = get_temporary_path("wcc", i);
             const char* path_result = m_validate_output_enabled ? path_tmp.c_str() : nullptr;
             try {
+                perf_counters_start("wcc");
                 t_local.start();
                 interface->wcc(path_result);
                 t_local.stop();
+                perf_counters_stop("wcc");
                // LOG(">> WCC Execution time: " << t_local);
                 m_exec_wcc.push_back(t_local.microseconds());
+                record_kernel("wcc", t_local);
 
                 if(m_validate_output_enabled){
                     string path_reference = get_validation_path("WCC");
@@ -340,6 +351,7 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
                     }
                 }
             } catch(library::TimeoutError& e){
+                perf_counters_stop("wcc"); // skipped in the try block by the timeout
                 LOG(">> WCC TIMEOUT");
                 m_exec_wcc.push_back(-1);
                 m_properties.wcc.m_enabled = false;
@@ -356,6 +368,37 @@ std::chrono::microseconds GraphalyticsSequential::execute(){
     return t_global.duration<chrono::microseconds>();
 }
 
+bool GraphalyticsSequential::has_algorithms() const {
+    const auto& p = m_properties;
+    return p.bfs.m_enabled || p.cdlp.m_enabled || p.lcc.m_enabled || p.pagerank.m_enabled || p.sssp.m_enabled || p.wcc.m_enabled;
+}
+
+void GraphalyticsSequential::set_record_timeline(bool value){
+    m_record_timeline = value;
+}
+
+void GraphalyticsSequential::record_kernel(const char* algorithm, const common::Timer& timer){
+    if(!m_record_timeline) return;
+    // the kernel has just terminated
+    uint64_t time_end = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    m_timeline.push_back(KernelExecution{ algorithm, time_end - timer.microseconds(), time_end });
+}
+
+void GraphalyticsSequential::perf_counters_start(const char* algorithm){
+    if(!configuration().measure_perf_counters()) return;
+    auto& phase = m_perf_counters[algorithm];
+    if(!phase){ phase = PerfPhase::create(string("graphalytics_") + algorithm); }
+    phase->start_openmp();
+}
+
+void GraphalyticsSequential::perf_counters_stop(const char* algorithm){
+    if(!configuration().measure_perf_counters()) return;
+    auto& phase = m_perf_counters[algorithm];
+    assert(phase.get() != nullptr && "The counters have not been started");
+    phase->stop_openmp();
+    phase->add_operations(m_interface->num_edges()); // normalise per edge
+}
+
 void GraphalyticsSequential::report(bool save_in_db){
     if(!m_exec_bfs.empty()){
         ExecStatistics stats { m_exec_bfs };
@@ -390,6 +433,19 @@ void GraphalyticsSequential::report(bool save_in_db){
         if(save_in_db) stats.save("wcc");
     }
 
+    if(save_in_db){
+        for(const auto& execution : m_timeline){
+            auto store = configuration().db()->add("graphalytics_timeline");
+            store.add("algorithm", execution.m_algorithm);
+            store.add("time_start", execution.m_time_start); // microsecs, steady clock
+            store.add("time_end", execution.m_time_end); // microsecs, steady clock
+        }
+
+        for(const auto& pair : m_perf_counters){
+            pair.second->save(configuration().db());
+        }
+    }
+
     if(!m_validate_results.empty()){
         uint64_t num_validation_errors = 0;
 
@@ -25,7 +25,9 @@
 #include <unordered_map>
 #include <vector>
 
+namespace common { class Timer; } // forward decl.
 namespace gfe::library { class GraphalyticsInterface; } // forward decl.
+namespace gfe::utility { class PerfPhase; } // forward decl.
 
 namespace gfe::experiment {
 
@@ -89,6 +91,14 @@ class GraphalyticsSequential{
     std::vector<int64_t> m_exec_sssp;
     std::vector<int64_t> m_exec_wcc;
 
+    // when each kernel started and terminated, to align it with the timeline of the updates in the mixed workload
+    bool m_record_timeline = false;
+    struct KernelExecution { std::string m_algorithm; uint64_t m_time_start; uint64_t m_time_end; }; // microsecs, steady clock
+    std::vector<KernelExecution> m_timeline;
+
+    // hardware counters of each kernel, if requested in the configuration
+    std::unordered_map<std::string, std::shared_ptr<utility::PerfPhase>> m_perf_counters;
+
 private:
 
     /**
@@ -96,6 +106,21 @@ private:
      */
     std::string get_temporary_path(const std::string& algorithm_name, uint64_t execution_no) const;
 
+    /**
+     * Record the execution of a kernel, terminated just now, if the timeline has been requested
+     */
+    void record_kernel(const char* algorithm, const common::Timer& timer);
+
+    /**
+     * Start the hardware counters of the threads executing the given kernel, if requested in the configuration
+     */
+    void perf_counters_start(const char* algorithm);
+
+    /**
+     * Stop the hardware counters of the given kernel, normalising them by the number of edges in the graph
+     */
+    void perf_counters_stop(const char* algorithm);
+
     /**
      * Retrieve the full path to the reference file related to the execution of a given algorithm.
      */
@@ -133,6 +158,17 @@ public:
      */
     std::chrono::microseconds execute();
 
+    /**
+     * Check whether at least one algorithm is enabled
+     */
+    bool has_algorithms() const;
+
+    /**
+     * Record when each kernel starts and terminates. The timestamps are saved in the table `graphalytics_timeline', with
+     * the same clock of the table `aging_timeline'.
+     */
+    void set_record_timeline(bool value);
+
     /**
      * Report the execution results
      * @param save_in_db: if true store the results in the database
@@ -20,6 +20,7 @@
 #include <atomic>
 #include <chrono>
 #include <future>
+#include <memory>
 #include <thread>
 #include <vector>
 //#include <ittnotify.h>
@@ -30,7 +31,7 @@
 #include "details/build_thread.hpp"
 #include "configuration.hpp"
 #include "library/interface.hpp"
-#include "third-party/perfevent/PerfEvent.hpp"
+#include "utility/perf_counters.hpp"
 
 using namespace common;
 using namespace gfe::experiment::details;
@@ -52,6 +53,12 @@ void InsertOnly::set_build_frequency(std::chrono::milliseconds millisecs){
     m_build_frequency = millisecs;
 }
 
+void InsertOnly::set_update_batch(uint64_t size, library::UpdateInterface::BatchAtomicity atomicity){
+    if(size == 0) INVALID_ARGUMENT("The size of a group of insertions cannot be zero");
+    m_update_batch_size = size;
+    m_update_batch_atomicity = atomicity;
+}
+
 // Execute an update at the time
 static void run_sequential(library::UpdateInterface* interface, graph::WeightedEdgeStream* graph, uint64_t start, uint64_t end){
     for(uint64_t pos = start; pos < end; pos++){
@@ -60,6 +67,38 @@ static void run_sequential(library::UpdateInterface* interface, graph::WeightedE
         assert(result == true && "Edge not inserted");
     }
 }
+// Execute the updates in groups of `group_size' insertions
+static void run_groups(library::UpdateInterface* interface, graph::WeightedEdgeStream* graph, uint64_t start, uint64_t end, uint64_t group_size, library::UpdateInterface::BatchAtomicity atomicity){
+    using SingleUpdate = library::UpdateInterface::SingleUpdate;
+    constexpr uint64_t max_group_retries = 64; // attempts to perform an atomic group before discarding it
+    vector<SingleUpdate> group; group.reserve(std::min(group_size, end - start));
+    unique_ptr<bool[]> applied { new bool[std::min(group_size, end - start)] };
+
+    for(uint64_t group_start = start; group_start < end; group_start += group_size){
+        uint64_t group_end = std::min(end, group_start + group_size);
+        group.clear();
+        for(uint64_t pos = group_start; pos < group_end; pos++){
+            auto edge = graph->get(pos);
+            group.push_back(SingleUpdate{edge.source(), edge.destination(), edge.m_weight});
+        }
+
+        uint64_t num_applied = interface->update_batch(group.data(), group.size(), atomicity, applied.get());
+        if(atomicity == library::UpdateInterface::BatchAtomicity::PER_BATCH){ // retry the whole group, to preserve its atomicity
+            for(uint64_t retry = 0; num_applied == 0 && retry < max_group_retries; retry++){
+                num_applied = interface->update_batch(group.data(), group.size(), atomicity, applied.get());
+            }
+            assert(num_applied == group.size() && "Group not inserted");
+        } else {
+            for(uint64_t i = 0; num_applied < group.size() && i < group.size(); i++){ // fall back to single insertions for the edges rejected
+                if(applied[i]) continue;
+                [[maybe_unused]] bool result = interface->add_edge_v2(graph::WeightedEdge{group[i].m_source, group[i].m_destination, group[i].m_weight});
+                assert(result == true && "Edge not inserted");
+                num_applied++;
+            }
+        }
+    }
+}
+
 static void run_concurrent(library::UpdateInterface* interface, graph::WeightedEdgeStream* graph, uint64_t size, uint64_t total_thread_count, uint64_t thread_id){
     for(uint64_t pos = thread_id; pos< size; pos+= total_thread_count){
         auto edge = graph->get(pos);
@@ -74,8 +113,7 @@ void InsertOnly::execute_round_robin(){
     m_interface.get()->set_worker_thread_num(m_num_threads);
 #endif
     atomic<uint64_t> start_chunk_next = 0;
-   // PerfEvent e;
-   // e.startCounters();
+
     for(int64_t i = 0; i < m_num_threads; i++){
         threads.emplace_back([this, &start_chunk_next](int thread_id){
             concurrency::set_thread_name("Worker #" + to_string(thread_id));
@@ -87,9 +125,17 @@ void InsertOnly::execute_round_robin(){
 
             interface->on_thread_init(thread_id);
 
-            while( (start = start_chunk_next.fetch_add(m_scheduler_granularity)) < size ){
-                uint64_t end = std::min<uint64_t>(start + m_scheduler_granularity, size);
-                run_sequential(interface, graph, start, end);
+            { // hardware counters, if requested
+                utility::ScopedPerfCounters perf_counters { m_perf_counters.get(), static_cast<uint64_t>(thread_id) };
+
+                while( (start = start_chunk_next.fetch_add(m_scheduler_granularity)) < size ){
+                    uint64_t end = std::min<uint64_t>(start + m_scheduler_granularity, size);
+                    if(m_update_batch_size > 1){
+                        run_groups(interface, graph, start, end, m_update_batch_size, m_update_batch_atomicity);
+                    } else {
+                        run_sequential(interface, graph, start, end);
+                    }
+                }
             }
 
             interface->on_thread_destroy(thread_id);
@@ -99,9 +145,6 @@ void InsertOnly::execute_round_robin(){
 
     // wait for all threads to complete
     for(auto& t : threads) t.join();
-    //e.stopCounters();
-    //e.printReport(std::cout, m_num_threads); // use n as scale factor
-    //std::cout << std::endl;
 }
 void InsertOnly::execute_concurrent_by_timestamp() {
     LOG("Execute interleaving");
@@ -119,7 +162,11 @@ void InsertOnly::execute_concurrent_by_timestamp() {
             const uint64_t size = graph->num_edges();
 
             interface->on_thread_init(thread_id);
-            run_concurrent(interface,graph,size, m_num_threads, thread_id);
+
+            { // hardware counters, if requested
+                utility::ScopedPerfCounters perf_counters { m_perf_counters.get(), static_cast<uint64_t>(thread_id) };
+                run_concurrent(interface,graph,size, m_num_threads, thread_id);
+            }
           /*  while( (start = start_chunk_next.fetch_add(m_scheduler_granularity)) < size ){
                 uint64_t end = std::min<uint64_t>(start + m_scheduler_granularity, size);
                 run_sequential(interface, graph, start, end);
@@ -134,6 +181,10 @@ void InsertOnly::execute_concurrent_by_timestamp() {
     for(auto& t : threads) t.join();
 }
 chrono::microseconds InsertOnly::execute() {
+    if(m_update_batch_size > 1 && m_update_batch_atomicity == library::UpdateInterface::BatchAtomicity::PER_BATCH && !m_interface->has_atomic_batches()){
+        ERROR("The library does not support atomic groups of updates. Use the atomicity per_edge or best_effort.");
+    }
+
     // re-adjust the scheduler granularity if there are too few insertions to perform
     if(m_stream->num_edges() / m_num_threads < m_scheduler_granularity){
         m_scheduler_granularity = m_stream->num_edges() / m_num_threads;
@@ -142,6 +193,8 @@ chrono::microseconds InsertOnly::execute() {
     }
 
     // Execute the insertions
+    m_perf_counters = utility::PerfPhase::create("insert_only");
+    if(m_perf_counters){ m_perf_counters->add_operations(m_stream->num_edges()); }
     m_interface->on_main_init(m_num_threads /* build thread */ +1);
     m_interface->updates_start();
     Timer timer;
@@ -186,11 +239,15 @@ void InsertOnly::save() {
     db.add("num_edges", m_stream->num_edges());
     db.add("num_snapshots_created", m_interface->num_levels());
     db.add("num_build_invocations", m_num_build_invocations);
+    db.add("update_batch", m_update_batch_size);
+    db.add("update_batch_atomicity", library::batch_atomicity_to_string(m_update_batch_atomicity));
     // missing revision: until 25/Nov/2019
     // version 20191125: build thread, build frequency taken into account, scheduler set to round_robin, removed batch updates
     // version 20191210: difference between num_build_invocations (explicit invocations to #build()) and num_snapshots_created (actual number of deltas created by the impl)
     // version 20200625: rely on #add_edge_v2 to implicitly create the vertices. This should alleviate the footprint of the driver for non scalable implementations
     db.add("revision", "20200625");
+
+    if(m_perf_counters){ m_perf_counters->save(configuration().db()); }
 }
 
 } // namespace
@@ -25,6 +25,8 @@
 #include "graph/edge_stream.hpp"
 #include "library/interface.hpp"
 
+namespace gfe::utility { class PerfPhase; } // forward declaration
+
 namespace gfe::experiment {
 
 /**
@@ -42,6 +44,9 @@ class InsertOnly {
     uint64_t m_time_insert = 0; // the amount of time to insert all elements in the database, in microseconds
     uint64_t m_time_build = 0; // the amount of time to build the last snapshot/delta/level in the library, in microseconds
     uint64_t m_num_build_invocations = 0; // number of times the method #build() has been invoked
+    uint64_t m_update_batch_size = 1; // number of insertions sent together to the library with UpdateInterface#update_batch (1 = one insertion at the time)
+    library::UpdateInterface::BatchAtomicity m_update_batch_atomicity = library::UpdateInterface::BatchAtomicity::BEST_EFFORT; // atomicity of each group of insertions
+    std::shared_ptr<utility::PerfPhase> m_perf_counters; // hardware counters of the insertions, when requested in the configuration
 
     // Execute the experiment with the round robin scheduler
     void execute_round_robin();
@@ -62,6 +67,10 @@ public:
     // Set how frequently create a new snapshot/delta in the library (0 = do not create new snapshots)
     void set_build_frequency(std::chrono::milliseconds millisecs);
 
+    // Insert the edges in groups of `size' edges, by means of UpdateInterface#update_batch, with the given atomicity.
+    // With a size of 1, the default, the edges are inserted one at the time.
+    void set_update_batch(uint64_t size, library::UpdateInterface::BatchAtomicity atomicity);
+
     // Execute the experiment
     std::chrono::microseconds execute();
 
@@ -14,12 +14,18 @@
 #include "graphalytics.hpp"
 #include "aging2_experiment.hpp"
 #include "mixed_workload_result.hpp"
+#include "details/query_scheduler.hpp"
 
 namespace gfe::experiment {
 
     using namespace std;
 
+    void MixedWorkload::set_short_queries(std::shared_ptr<details::QueryScheduler> queries) {
+      m_short_queries = queries;
+    }
+
     MixedWorkloadResult MixedWorkload::execute() {
+      m_graphalytics.set_record_timeline(true); // to align the kernels with the timeline of the updates
       auto aging_result_future = std::async(std::launch::async, &Aging2Experiment::execute, &m_aging_experiment);
 
       chrono::seconds progress_check_interval( 1 );
@@ -39,23 +45,37 @@ namespace gfe::experiment {
                         omp_set_num_threads(m_read_threads);
                     }
 #endif
+      if (m_short_queries) {
+        cout << "Starting " << m_short_queries->num_threads() << " readers for the short queries" << endl;
+        m_short_queries->start();
+      }
 
+      // the readers of the short queries run in the background, the Graphalytics kernels are the occasional full scans
+      const bool run_kernels = m_graphalytics.has_algorithms();
 #if HAVE_LIVEGRAPH
-      while (m_aging_experiment.progress_so_far() < 0.16 && aging_result_future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
-        m_graphalytics.execute();
-      }
+      const double progress_end = 0.16;
 #else
-      while (m_aging_experiment.progress_so_far() < 0.9 && aging_result_future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
-        m_graphalytics.execute();
-      }
+      const double progress_end = 0.9;
 #endif
+      while (m_aging_experiment.progress_so_far() < progress_end && aging_result_future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        if (run_kernels) {
+          m_graphalytics.execute();
+        } else {
+          this_thread::sleep_for( chrono::milliseconds(100) );
+        }
+      }
+
+      if (m_short_queries) {
+        m_short_queries->stop();
+        m_short_queries->report();
+      }
       m_graphalytics.mixed_workload_read_finish();
       cout << "Waiting for aging experiment to finish" << endl;
       aging_result_future.wait();
       cout << "Getting aging experiment results" << endl;
       auto aging_result = aging_result_future.get();
 
-      return MixedWorkloadResult { aging_result, m_graphalytics };
+      return MixedWorkloadResult { aging_result, m_graphalytics, m_short_queries };
     }
 
     void MixedWorkload::report_graphalytics() {
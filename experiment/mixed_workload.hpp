@@ -1,9 +1,12 @@
 #ifndef GFE_DRIVER_MIXED_WORKLOAD_H
 #define GFE_DRIVER_MIXED_WORKLOAD_H
 
+#include <memory>
+
 namespace gfe::experiment { class Aging2Experiment; }
 namespace gfe::experiment { class GraphalyticsSequential; }
 namespace gfe::experiment { class MixedWorkloadResult; }
+namespace gfe::experiment::details { class QueryScheduler; }
 
 namespace gfe::experiment {
 
@@ -12,11 +15,15 @@ namespace gfe::experiment {
         MixedWorkload(Aging2Experiment& aging_experiment, GraphalyticsSequential& graphalytics, int read_threads)
           : m_aging_experiment(aging_experiment), m_graphalytics(graphalytics), m_read_threads(read_threads) {}
 
+        // Run the given pools of short queries concurrently with the updates and the Graphalytics kernels
+        void set_short_queries(std::shared_ptr<details::QueryScheduler> queries);
+
         MixedWorkloadResult execute();
         void report_graphalytics();
     private:
         Aging2Experiment& m_aging_experiment;
         GraphalyticsSequential& m_graphalytics;
+        std::shared_ptr<details::QueryScheduler> m_short_queries; // can be a nullptr
 
         int m_read_threads = 0;
     };
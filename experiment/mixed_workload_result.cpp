@@ -7,13 +7,14 @@
 #include "common/database.hpp"
 #include "aging2_result.hpp"
 #include "graphalytics.hpp"
+#include "details/query_scheduler.hpp"
 #include "iostream"
 
 namespace gfe::experiment {
     using namespace std;
 
-    MixedWorkloadResult::MixedWorkloadResult(Aging2Result aging_result, GraphalyticsSequential& analytics)
-      : m_aging_result(aging_result), m_graphalytics(analytics) {
+    MixedWorkloadResult::MixedWorkloadResult(Aging2Result aging_result, GraphalyticsSequential& analytics, std::shared_ptr<details::QueryScheduler> short_queries)
+      : m_aging_result(aging_result), m_graphalytics(analytics), m_short_queries(short_queries) {
 
     }
 
@@ -21,6 +22,10 @@ namespace gfe::experiment {
       cout << "Start saving results" << endl;
       m_graphalytics.report(true);
       cout << "Saved graphalytics" << endl;
+      if (m_short_queries) {
+        m_short_queries->save(db);
+        cout << "Saved short queries" << endl;
+      }
       m_aging_result.save(db);
       cout << "Saved aging" << endl;
       cout << "Saved aging" << endl;
@@ -1,21 +1,25 @@
 #ifndef GFE_DRIVER_MIXED_WORKLOAD_RESULT_H
 #define GFE_DRIVER_MIXED_WORKLOAD_RESULT_H
 
+#include <memory>
+
 #include "aging2_result.hpp"
 namespace gfe::experiment { class GraphalyticsSequential; }
+namespace gfe::experiment::details { class QueryScheduler; }
 namespace common { class Database; }
 
 namespace gfe::experiment {
 
     class MixedWorkloadResult {
     public:
-        MixedWorkloadResult(Aging2Result aging_result, GraphalyticsSequential& analytics);
+        MixedWorkloadResult(Aging2Result aging_result, GraphalyticsSequential& analytics, std::shared_ptr<details::QueryScheduler> short_queries = nullptr);
 
         void save(common::Database* db);
 
     private:
         Aging2Result m_aging_result;
         GraphalyticsSequential& m_graphalytics;
+        std::shared_ptr<details::QueryScheduler> m_short_queries; // can be a nullptr
     };
 
     class UpdatesReadsMixedWorkloadResult {
@@ -9,7 +9,6 @@
 
 #include <algorithm>
 #include <cassert>
-#include <cmath>
 #include <cstring>
 #include <iostream>
 #include <stdexcept>
@@ -22,9 +21,9 @@ using namespace std;
 namespace gfe::graph {
 
 size_t CByteArray::compute_bytes_per_elements(size_t value){
-    double bits = ceil(log2(value));
-    double bytes = ceil(bits / 8);
-    return size_t(bytes);
+    size_t bytes = 1;
+    while(bytes < 8 && (value >> (bytes * 8)) > 0){ bytes++; }
+    return bytes;
 }
 
 size_t CByteArray::get_bytes_per_element() const{
@@ -61,36 +60,14 @@ CByteArray& CByteArray::operator=(CByteArray&& tmp){
 
 
 uint64_t CByteArray::get_value_at(size_t index) const {
-    union {
-        uint64_t key;
-      char bytes[8];
-    } u;
-    static_assert(sizeof(u) == 8, "Expected 8 bytes long");
-    u.key = 0;
-    size_t base = index * m_bytes_per_element;
-    for(size_t i =0; i < m_bytes_per_element; i++){
-        // intel is little endian
-//        u.bytes[8 - bytes_per_element + i] = array[base + i];
-        u.bytes[i] = m_array[base + i];
-    }
-    return u.key;
+    // intel is little endian, the least significant bytes come first
+    uint64_t value = 0;
+    memcpy(&value, m_array + index * m_bytes_per_element, m_bytes_per_element);
+    return value;
 }
 
-#include <vector>
-
 void CByteArray::set_value_at(size_t index, uint64_t value) {
-    union {
-        uint64_t value;
-       char bytes[8];
-    } u;
-    static_assert(sizeof(u) == 8, "Expected 8 bytes long");
-    u.value = value;
-    size_t base = index * m_bytes_per_element;
-    for(size_t i = 0; i < m_bytes_per_element; i++){
-        // intel is little endian
-//        array[base + i] = u.bytes[8 - bytes_per_element + i];
-        m_array[base + i] = u.bytes[i];
-    }
+    memcpy(m_array + index * m_bytes_per_element, &value, m_bytes_per_element);
 }
 
 CByteReference CByteArray::operator[](size_t index){
@@ -205,7 +205,7 @@ public:
     static std::unique_ptr<CByteArray> merge(CByteArray** arrays, size_t arrays_sz);
 
     /**
-     * Compute the number of bytes required to stored the given value.
+     * Compute the number of bytes required to store all values in [0, value], at least 1.
      */
     static size_t compute_bytes_per_elements(size_t value);
 
@@ -18,14 +18,23 @@
 #include "edge_stream.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
 #include <future>
 #include <memory>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <thread>
+#include <unistd.h>
 #include <unordered_map>
-#include "common/permutation.hpp"
 #include "common/sorting.hpp"
 #include "common/timer.hpp"
+#include "reader/graphalytics_reader.hpp"
 #include "reader/reader.hpp"
 #include "cbytearray.hpp"
 #include "configuration.hpp"
@@ -39,45 +48,18 @@ using namespace std;
 namespace gfe::graph {
 
 WeightedEdgeStream::WeightedEdgeStream(const std::string& path){
-    m_sources = new CByteArray(/* bytes per element */ 8, /* capacity */ 8);
-    m_destinations = new CByteArray(/* bytes per element */ 8, /* capacity */ 8);
-
-    auto reader = reader::Reader::open(path);
-    WeightedEdge edge;
-
     Timer timer;
     timer.start();
 
-    while(reader->read(edge)){
-
-        // double the capacity of the arrays sources/destinations/weights
-        if(m_num_edges >= m_sources->capacity()){
-            auto old_sources = m_sources;
-            auto old_destinations = m_destinations;
-            auto new_sources = make_unique<CByteArray>(/* bytes per element */ 8, old_sources->capacity() *2);
-            auto new_destinations = make_unique<CByteArray>(/* bytes per element */ 8, old_sources->capacity() *2);
-            for(size_t i = 0; i < old_sources->capacity(); i++){
-                new_sources->set_value_at(i, old_sources->get_value_at(i));
-                new_destinations->set_value_at(i, old_destinations->get_value_at(i));
-            }
-
-            m_sources = new_sources.release();
-            m_destinations = new_destinations.release();
-
-            delete old_sources; old_sources = nullptr;
-            delete old_destinations; old_destinations = nullptr;
-        }
-
-        m_sources->set_value_at(m_num_edges, edge.m_source);
-        m_destinations->set_value_at(m_num_edges, edge.m_destination);
-        m_weights.emplace_back(edge.m_weight);
-
-        // keep track of the max vertex id and max weight
-        m_max_vertex_id = std::max(m_max_vertex_id, std::max(edge.m_source, edge.m_destination));
-        m_max_weight = std::max(m_max_weight, edge.m_weight);
-
-        // update the number of vertices loaded
-        m_num_edges++;
+    auto reader = reader::Reader::open(path);
+    auto graphalytics = dynamic_cast<reader::GraphalyticsReader*>(reader.get());
+    if(graphalytics != nullptr && !graphalytics->is_compressed()){
+        string path_edge_file = graphalytics->get_path_edge_list();
+        bool is_weighted = graphalytics->is_weighted();
+        reader.reset(); // close the handles of the reader
+        load_parallel(path_edge_file, is_weighted);
+    } else {
+        load_sequential(reader.get());
     }
 
     timer.stop();
@@ -86,19 +68,18 @@ WeightedEdgeStream::WeightedEdgeStream(const std::string& path){
 }
 
 WeightedEdgeStream::WeightedEdgeStream(const std::vector<WeightedEdge>& vector){
-    m_num_edges = vector.size();
-    m_sources = new CByteArray(/* bytes per element */ 8, /* capacity */ m_num_edges);
-    m_destinations = new CByteArray(/* bytes per element */ 8, /* capacity */ m_num_edges);
-    m_weights.reserve(m_num_edges);
+    for(const auto& edge : vector){
+        m_max_vertex_id = std::max(m_max_vertex_id, std::max(edge.m_source, edge.m_destination));
+        m_max_weight = std::max(m_max_weight, edge.m_weight);
+    }
 
+    init_columns(vector.size());
+    m_weights.reserve(m_num_edges);
     for(size_t i = 0, sz = m_num_edges; i < sz; i++){
         const auto& edge = vector[i];
         m_sources->set_value_at(i, edge.m_source);
         m_destinations->set_value_at(i, edge.m_destination);
         m_weights.push_back(edge.m_weight);
-
-        m_max_vertex_id = std::max(m_max_vertex_id, std::max(edge.m_source, edge.m_destination));
-        m_max_weight = std::max(m_max_weight, edge.m_weight);
     }
 }
 
@@ -108,6 +89,352 @@ WeightedEdgeStream::~WeightedEdgeStream(){
     delete m_destinations; m_destinations = nullptr;
 }
 
+void WeightedEdgeStream::init_columns(uint64_t num_edges){
+    auto bytes_per_vertex_id = CByteArray::compute_bytes_per_elements(m_max_vertex_id);
+    delete m_sources; m_sources = new CByteArray(bytes_per_vertex_id, num_edges);
+    delete m_destinations; m_destinations = new CByteArray(bytes_per_vertex_id, num_edges);
+    m_num_edges = num_edges;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Loaders                                                                  *
+ *                                                                           *
+ *****************************************************************************/
+
+void WeightedEdgeStream::load_sequential(reader::Reader* reader){
+    vector<uint64_t> sources;
+    vector<uint64_t> destinations;
+    WeightedEdge edge;
+
+    while(reader->read(edge)){
+        sources.push_back(edge.m_source);
+        destinations.push_back(edge.m_destination);
+        m_weights.push_back(edge.m_weight);
+
+        // keep track of the max vertex id and max weight
+        m_max_vertex_id = std::max(m_max_vertex_id, std::max(edge.m_source, edge.m_destination));
+        m_max_weight = std::max(m_max_weight, edge.m_weight);
+    }
+
+    // now that the max vertex id is known, store the vertices with the minimum number of bytes
+    init_columns(sources.size());
+    for(uint64_t i = 0; i < m_num_edges; i++){
+        m_sources->set_value_at(i, sources[i]);
+        m_destinations->set_value_at(i, destinations[i]);
+    }
+}
+
+namespace {
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+    const char* m_content = nullptr;
+    uint64_t m_size = 0;
+
+public:
+    MappedFile(const string& path){
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) ERROR("Cannot open the file `" << path << "': " << strerror(errno));
+        struct stat st;
+        if(::fstat(fd, &st) != 0){ ::close(fd); ERROR("Cannot retrieve the size of the file `" << path << "': " << strerror(errno)); }
+        m_size = st.st_size;
+        if(m_size > 0){
+            void* mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd); // the mapping keeps its own reference to the file
+            if(mapping == MAP_FAILED) ERROR("Cannot memory map the file `" << path << "': " << strerror(errno));
+            ::madvise(mapping, m_size, MADV_SEQUENTIAL); // ignore rc
+            m_content = reinterpret_cast<const char*>(mapping);
+        } else {
+            ::close(fd);
+        }
+    }
+
+    ~MappedFile(){
+        if(m_content != nullptr){ ::munmap(const_cast<char*>(m_content), m_size); }
+    }
+
+    const char* begin() const { return m_content; }
+    const char* end() const { return m_content + m_size; }
+    uint64_t size() const { return m_size; }
+};
+
+// Skip the blank characters, but the new line
+const char* skip_blanks(const char* it, const char* end){
+    while(it < end && (*it == ' ' || *it == '\t' || *it == '\r' || *it == '\v' || *it == '\f')) it++;
+    return it;
+}
+
+// Parse an unsigned integer, return the position after its last digit, or nullptr if there is no number
+const char* parse_uint(const char* it, const char* end, uint64_t* out_value){
+    if(it >= end || *it < '0' || *it > '9') return nullptr;
+    uint64_t value = 0;
+    while(it < end && *it >= '0' && *it <= '9'){
+        value = value * 10 + (*it - '0');
+        it++;
+    }
+    *out_value = value;
+    return it;
+}
+
+// Parse a floating point number, with an optional sign and possibly starting with the decimal point (e.g. `-.5'),
+// return the position after its last character, or nullptr if there is no number
+const char* parse_double(const char* it, const char* end, double* out_value){
+    if(it >= end || !((*it >= '0' && *it <= '9') || *it == '.' || *it == '-' || *it == '+')) return nullptr;
+    char buffer[64]; // strtod requires a null terminated string, the mapped file is not
+    uint64_t length = 0;
+    while(it + length < end && length < sizeof(buffer) -1 && !isspace(it[length])){ buffer[length] = it[length]; length++; }
+    buffer[length] = '\0';
+    char* next = nullptr;
+    *out_value = strtod(buffer, &next);
+    if(next == buffer) return nullptr; // e.g. a lone sign or decimal point
+    return it + (next - buffer);
+}
+
+// Parse the edges in the given range, as in GraphalyticsPlainReader. The range must start at the beginning of a line.
+template<typename Callback>
+void parse_edge_range(const char* begin, const char* end, bool is_weighted, Callback&& callback){
+    const char* line = begin;
+    while(line < end){
+        const char* eol = reinterpret_cast<const char*>(memchr(line, '\n', end - line));
+        if(eol == nullptr) eol = end;
+
+        const char* it = skip_blanks(line, eol);
+        if(it < eol && *it != '#'){ // skip comments and empty lines
+            uint64_t source = 0, destination = 0;
+            double weight = 0;
+            it = parse_uint(it, eol, &source);
+            if(it == nullptr) ERROR("line: `" << string(line, eol - line) << "', cannot read the source vertex");
+            it = parse_uint(skip_blanks(it, eol), eol, &destination);
+            if(it == nullptr) ERROR("line: `" << string(line, eol - line) << "', cannot read the destination vertex");
+            if(is_weighted){
+                it = parse_double(skip_blanks(it, eol), eol, &weight);
+                if(it == nullptr) ERROR("line: `" << string(line, eol - line) << "', cannot read the weight");
+            }
+            callback(source, destination, weight);
+        }
+
+        line = eol + 1;
+    }
+}
+
+// Finaliser of splitmix64, scramble the bits of the given value
+uint64_t mix64(uint64_t z){
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Random weight in (0, max_weight] for the edge at the given position of a non weighted graph. It only depends on the
+// seed and the position, so that the ranges of the edge file can be parsed in any order.
+double random_weight(uint64_t seed, uint64_t position, double max_weight){
+    uint64_t z = mix64(seed + (position +1) * 0x9E3779B97F4A7C15ull);
+    double weight = static_cast<double>(z >> 11) * 0x1.0p-53 * max_weight; // in [0, max_weight)
+    return weight == 0.0 ? max_weight : weight;
+}
+
+// Execute fn(i), for i in [0, num_tasks), each in its own thread
+template<typename Function>
+void run_tasks(uint64_t num_tasks, Function&& fn){
+    std::vector<future<void>> tasks;
+    tasks.reserve(num_tasks);
+    for(uint64_t i = 0; i < num_tasks; i++){
+        tasks.push_back( async(launch::async, fn, i) );
+    }
+    for(auto& t: tasks) t.get();  // wait for all tasks to finish, rethrow their exceptions
+}
+
+} // anonymous namespace
+
+void WeightedEdgeStream::load_parallel(const std::string& path_edge_file, bool is_weighted){
+    MappedFile file { path_edge_file };
+
+    // split the file in ranges of bytes, each range starts at the beginning of a line
+    const uint64_t num_tasks = std::max<uint64_t>(1, std::min<uint64_t>(file.size() / (1ull << 20) +1, thread::hardware_concurrency() * 8));
+    vector<const char*> boundaries(num_tasks +1);
+    boundaries[0] = file.begin();
+    boundaries[num_tasks] = file.end();
+    for(uint64_t i = 1; i < num_tasks; i++){
+        const char* it = std::max(boundaries[i -1], file.begin() + file.size() * i / num_tasks);
+        const char* eol = reinterpret_cast<const char*>(memchr(it, '\n', file.end() - it));
+        boundaries[i] = (eol == nullptr) ? file.end() : eol +1;
+    }
+
+    // first pass, count the edges and find the max vertex id in each range
+    struct RangeStats { uint64_t m_num_edges = 0; uint64_t m_max_vertex_id = 0; double m_max_weight = 0; };
+    vector<RangeStats> stats(num_tasks);
+    run_tasks(num_tasks, [&](uint64_t task_id){
+        RangeStats local;
+        parse_edge_range(boundaries[task_id], boundaries[task_id +1], is_weighted, [&](uint64_t source, uint64_t destination, double weight){
+            local.m_num_edges++;
+            local.m_max_vertex_id = std::max(local.m_max_vertex_id, std::max(source, destination));
+            local.m_max_weight = std::max(local.m_max_weight, weight);
+        });
+        stats[task_id] = local;
+    });
+
+    vector<uint64_t> offsets(num_tasks +1, 0);
+    for(uint64_t i = 0; i < num_tasks; i++){
+        offsets[i +1] = offsets[i] + stats[i].m_num_edges;
+        m_max_vertex_id = std::max(m_max_vertex_id, stats[i].m_max_vertex_id);
+        m_max_weight = std::max(m_max_weight, stats[i].m_max_weight);
+    }
+    init_columns(offsets[num_tasks]);
+    m_weights.resize(m_num_edges);
+
+    // second pass, store the edges directly in their final position
+    const uint64_t seed = configuration().seed() + 12908478;
+    const double max_weight = configuration().max_weight();
+    vector<double> max_weights(num_tasks, 0.0);
+    run_tasks(num_tasks, [&](uint64_t task_id){
+        uint64_t position = offsets[task_id];
+        double local_max_weight = 0;
+        parse_edge_range(boundaries[task_id], boundaries[task_id +1], is_weighted, [&](uint64_t source, uint64_t destination, double weight){
+            if(!is_weighted){
+                weight = random_weight(seed, position, max_weight);
+                local_max_weight = std::max(local_max_weight, weight);
+            }
+            m_sources->set_value_at(position, source);
+            m_destinations->set_value_at(position, destination);
+            m_weights[position] = weight;
+            position++;
+        });
+        assert(position == offsets[task_id +1] && "The two passes parsed a different number of edges");
+        max_weights[task_id] = local_max_weight;
+    });
+    for(double weight : max_weights){ m_max_weight = std::max(m_max_weight, weight); }
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Permutation                                                              *
+ *                                                                           *
+ *****************************************************************************/
+
+namespace {
+
+// Access the elements of a column, either the vertices in a CByteArray or the weights in a vector
+uint64_t get_item(const CByteArray* column, uint64_t index){ return column->get_value_at(index); }
+void set_item(CByteArray* column, uint64_t index, uint64_t value){ column->set_value_at(index, value); }
+double get_item(const vector<double>* column, uint64_t index){ return (*column)[index]; }
+void set_item(vector<double>* column, uint64_t index, double value){ (*column)[index] = value; }
+
+// Sequence of pseudo random numbers, splitmix64
+class SplitMix64 {
+    uint64_t m_state;
+
+public:
+    SplitMix64(uint64_t seed) : m_state(seed) { }
+
+    // Next random number in [0, 2^64)
+    uint64_t next(){ m_state += 0x9E3779B97F4A7C15ull; return mix64(m_state); }
+
+    // Next random number in [0, bound)
+    uint64_t next(uint64_t bound){ return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * bound) >> 64); }
+};
+
+/**
+ * Random permutation of the positions [0, num_edges), computed in parallel without materialising the permutation array.
+ * The input is split in chunks. Each element of a chunk is scattered to a random bucket, preserving the order inside
+ * the chunk, and each bucket is then shuffled with Fisher-Yates. The random sequences are derived from the seed and the
+ * chunk/bucket ids only, so the outcome is the same for a given seed regardless of the number of threads.
+ */
+class BucketPermutation {
+    constexpr static uint64_t MIN_CHUNK_SIZE = 1ull << 16; // min number of elements in a chunk
+    constexpr static uint64_t MAX_NUM_CHUNKS = 256; // max number of chunks
+    constexpr static uint64_t BUCKET_SIZE = 1ull << 16; // expected number of elements in a bucket
+    constexpr static uint64_t MAX_NUM_BUCKETS = 8192; // max number of buckets, power of 2
+
+    const uint64_t m_num_elements; // total number of elements to permute
+    const uint64_t m_seed_scatter; // seed for the assignment of the elements to the buckets
+    const uint64_t m_seed_shuffle; // seed for the permutation inside the buckets
+    uint64_t m_chunk_size; // number of elements in each chunk
+    uint64_t m_num_chunks; // number of chunks
+    uint64_t m_num_buckets; // number of buckets, power of 2
+    vector<uint64_t> m_offsets; // for each chunk and bucket, the first position in the output assigned to the chunk
+
+    // Random sequence to assign the elements of the given chunk to the buckets
+    SplitMix64 scatter_rng(uint64_t chunk_id) const { return SplitMix64{ mix64(m_seed_scatter + chunk_id) }; }
+
+    // Random sequence to shuffle the given bucket
+    SplitMix64 shuffle_rng(uint64_t bucket_id) const { return SplitMix64{ mix64(m_seed_shuffle + bucket_id) }; }
+
+    // Pick the bucket for the next element of a chunk
+    uint64_t next_bucket(SplitMix64& rng) const { return m_num_buckets == 1 ? 0 : rng.next(m_num_buckets); }
+
+    // Position in the output of the first element of the given bucket
+    uint64_t bucket_start(uint64_t bucket_id) const { return bucket_id < m_num_buckets ? m_offsets[bucket_id] : m_num_elements; }
+
+    // Execute fn(i) for i in [0, num_jobs), with a pool of threads
+    template<typename Function>
+    static void parallel_for(uint64_t num_jobs, Function&& fn){
+        atomic<uint64_t> next_job = 0;
+        uint64_t num_threads = std::max<uint64_t>(1, std::min<uint64_t>(num_jobs, thread::hardware_concurrency()));
+        run_tasks(num_threads, [&](uint64_t){
+            uint64_t job_id;
+            while((job_id = next_job++) < num_jobs){ fn(job_id); }
+        });
+    }
+
+public:
+    BucketPermutation(uint64_t num_elements, uint64_t seed) : m_num_elements(num_elements), m_seed_scatter(mix64(seed)), m_seed_shuffle(mix64(seed + 1)){
+        m_chunk_size = std::max(MIN_CHUNK_SIZE, (num_elements + MAX_NUM_CHUNKS -1) / MAX_NUM_CHUNKS);
+        m_num_chunks = std::max<uint64_t>(1, (num_elements + m_chunk_size -1) / m_chunk_size);
+        m_num_buckets = 1;
+        while(m_num_buckets < MAX_NUM_BUCKETS && m_num_buckets * BUCKET_SIZE < num_elements){ m_num_buckets *= 2; }
+
+        // count the elements assigned by each chunk to each bucket
+        vector<uint64_t> histogram(m_num_chunks * m_num_buckets, 0);
+        parallel_for(m_num_chunks, [&](uint64_t chunk_id){
+            uint64_t* __restrict counts = histogram.data() + chunk_id * m_num_buckets;
+            SplitMix64 rng = scatter_rng(chunk_id);
+            for(uint64_t i = chunk_id * m_chunk_size, end = std::min(m_num_elements, i + m_chunk_size); i < end; i++){
+                counts[next_bucket(rng)]++;
+            }
+        });
+
+        // prefix sum, bucket by bucket, and inside a bucket chunk by chunk
+        m_offsets.resize(m_num_chunks * m_num_buckets);
+        uint64_t position = 0;
+        for(uint64_t bucket_id = 0; bucket_id < m_num_buckets; bucket_id++){
+            for(uint64_t chunk_id = 0; chunk_id < m_num_chunks; chunk_id++){
+                m_offsets[chunk_id * m_num_buckets + bucket_id] = position;
+                position += histogram[chunk_id * m_num_buckets + bucket_id];
+            }
+        }
+        assert(position == m_num_elements);
+    }
+
+    // Store in `output' the elements of `input' in the permuted order. Both columns must have the same size.
+    template<typename Column>
+    void apply(const Column* input, Column* output) const {
+        // scatter the elements to their buckets
+        parallel_for(m_num_chunks, [&](uint64_t chunk_id){
+            vector<uint64_t> cursors(m_offsets.begin() + chunk_id * m_num_buckets, m_offsets.begin() + (chunk_id +1) * m_num_buckets);
+            SplitMix64 rng = scatter_rng(chunk_id);
+            for(uint64_t i = chunk_id * m_chunk_size, end = std::min(m_num_elements, i + m_chunk_size); i < end; i++){
+                set_item(output, cursors[next_bucket(rng)]++, get_item(input, i));
+            }
+        });
+
+        // shuffle the content of each bucket
+        parallel_for(m_num_buckets, [&](uint64_t bucket_id){
+            uint64_t start = bucket_start(bucket_id);
+            uint64_t length = bucket_start(bucket_id +1) - start;
+            SplitMix64 rng = shuffle_rng(bucket_id);
+            for(uint64_t i = length; i > 1; i--){
+                uint64_t j = start + rng.next(i);
+                uint64_t k = start + i -1;
+                auto tmp = get_item(output, k);
+                set_item(output, k, get_item(output, j));
+                set_item(output, j, tmp);
+            }
+        });
+    }
+};
+
+} // anonymous namespace
+
 void WeightedEdgeStream::permute(){
     permute(configuration().seed() + 91);
 }
@@ -120,14 +447,23 @@ void WeightedEdgeStream::permute(uint64_t seed){
     Timer timer;
     timer.start();
 
-    // Create a permutation array
-    auto ptr_permutation = make_unique<uint64_t[]>(m_num_edges);
-    uint64_t* __restrict permutation = ptr_permutation.get();
-    for(size_t i = 0; i < m_num_edges; i++){ permutation[i] = i; }
-    common::permute(permutation, m_num_edges, seed);
-
-    // Permute the elements in m_sources, m_destinations and m_weights
-    do_permute_edges(permutation);
+    // Permute one column at the time, so that at most one extra column is allocated
+    BucketPermutation permutation { m_num_edges, seed };
+    {
+        auto new_sources = make_unique<CByteArray>(m_sources->get_bytes_per_element(), m_num_edges);
+        permutation.apply(m_sources, new_sources.get());
+        delete m_sources; m_sources = new_sources.release();
+    }
+    {
+        auto new_destinations = make_unique<CByteArray>(m_destinations->get_bytes_per_element(), m_num_edges);
+        permutation.apply(m_destinations, new_destinations.get());
+        delete m_destinations; m_destinations = new_destinations.release();
+    }
+    {
+        vector<double> new_weights(m_num_edges);
+        permutation.apply(&m_weights, &new_weights);
+        m_weights = std::move(new_weights);
+    }
 
     timer.stop();
 
@@ -25,6 +25,8 @@
 #include "third-party/libcuckoo/cuckoohash_map.hh"
 
 
+namespace gfe::reader { class Reader; } // forward decl.
+
 namespace gfe::graph {
 
 class CByteArray; // forward decl.
@@ -52,9 +54,19 @@ class WeightedEdgeStream {
     // Permute the edges according to the given permutation vector, with indices in 0, ..., num_edges -1
     void do_permute_edges(uint64_t* permutation);
 
+    // Load the edges one at the time from the given reader
+    void load_sequential(reader::Reader* reader);
+
+    // Load the edges from a text edge list in the graphalytics format, parsing it with multiple threads
+    void load_parallel(const std::string& path_edge_file, bool is_weighted);
+
+    // Allocate the columns for the given number of edges, with the minimum number of bytes to store m_max_vertex_id
+    void init_columns(uint64_t num_edges);
+
 public:
     /**
-     * Load the list of edges from the given file
+     * Load the list of edges from the given file. The uncompressed edge lists of the graphalytics format are split in
+     * ranges of bytes and parsed in parallel, the other formats are read sequentially.
      */
     WeightedEdgeStream(const std::string& path);
 
@@ -71,7 +83,8 @@ public:
     // Perform a random permutation of the edge list. Use the default random seed.
     void permute();
 
-    // Perform a random permutation of the edge list. The permutation is based on the given random seed.
+    // Perform a random permutation of the edge list. The permutation is based on the given random seed and it is computed
+    // in parallel. For a given seed, the resulting order does not depend on the number of threads.
     void permute(uint64_t seed);
 
     // Retrieve the edge at the given position, in [0, num_edges() )
@@ -0,0 +1,365 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "vertex_reordering.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <omp.h>
+#include <parallel/algorithm>
+#include <utility>
+#include <vector>
+
+#include "common/error.hpp"
+#include "edge_stream.hpp"
+
+using namespace std;
+
+namespace gfe::graph {
+
+VertexReordering parse_vertex_reordering(const std::string& value){
+    if(value == "none"){
+        return VertexReordering::NONE;
+    } else if(value == "degree"){
+        return VertexReordering::DEGREE;
+    } else if(value == "hub"){
+        return VertexReordering::HUB_CLUSTER;
+    } else if(value == "rcm"){
+        return VertexReordering::RCM;
+    } else if(value == "gorder"){
+        return VertexReordering::GORDER;
+    } else {
+        INVALID_ARGUMENT("Invalid vertex reordering: `" << value << "'. Valid values are: none, degree, hub, rcm and gorder");
+    }
+}
+
+std::string vertex_reordering_to_string(VertexReordering reordering){
+    switch(reordering){
+    case VertexReordering::NONE: return "none";
+    case VertexReordering::DEGREE: return "degree";
+    case VertexReordering::HUB_CLUSTER: return "hub";
+    case VertexReordering::RCM: return "rcm";
+    case VertexReordering::GORDER: return "gorder";
+    default: return "unknown";
+    }
+}
+
+namespace {
+
+constexpr uint64_t GORDER_WINDOW = 5; // size of the sliding window in the Gorder algorithm, the same default of the paper
+
+class Graph {
+    const uint64_t m_num_vertices;
+    const uint64_t* m_offsets;
+    const uint64_t* m_neighbours;
+
+public:
+    Graph(uint64_t num_vertices, const uint64_t* offsets, const uint64_t* neighbours) : m_num_vertices(num_vertices), m_offsets(offsets), m_neighbours(neighbours) { }
+
+    uint64_t num_vertices() const { return m_num_vertices; }
+    uint64_t degree(uint64_t v) const { return m_offsets[v +1] - m_offsets[v]; }
+    const uint64_t* begin(uint64_t v) const { return m_neighbours + m_offsets[v]; }
+    const uint64_t* end(uint64_t v) const { return m_neighbours + m_offsets[v +1]; }
+
+    // All vertices sorted by decreasing degree, ties by vertex ID
+    vector<uint64_t> sort_by_degree() const {
+        vector<uint64_t> order(m_num_vertices);
+        for(uint64_t v = 0; v < m_num_vertices; v++){ order[v] = v; }
+        __gnu_parallel::stable_sort(order.begin(), order.end(), [this](uint64_t v1, uint64_t v2){ return degree(v1) > degree(v2); });
+        return order;
+    }
+};
+
+vector<uint64_t> order_by_degree(const Graph& graph){
+    return graph.sort_by_degree();
+}
+
+vector<uint64_t> order_by_hub_cluster(const Graph& graph){
+    const uint64_t N = graph.num_vertices();
+    const double avg_degree = N > 0 ? static_cast<double>(graph.end(N -1) - graph.begin(0)) / N : 0.;
+    vector<uint64_t> order;
+    order.reserve(N);
+    for(uint64_t v = 0; v < N; v++){ if(graph.degree(v) > avg_degree) order.push_back(v); }
+    for(uint64_t v = 0; v < N; v++){ if(graph.degree(v) <= avg_degree) order.push_back(v); }
+    return order;
+}
+
+vector<uint64_t> order_by_rcm(const Graph& graph){
+    const uint64_t N = graph.num_vertices();
+    vector<uint64_t> roots = graph.sort_by_degree();
+    reverse(roots.begin(), roots.end()); // by increasing degree
+    vector<bool> visited(N, false);
+    vector<uint64_t> order;
+    order.reserve(N);
+    auto by_increasing_degree = [&graph](uint64_t v1, uint64_t v2){ return graph.degree(v1) < graph.degree(v2) || (graph.degree(v1) == graph.degree(v2) && v1 < v2); };
+
+    for(uint64_t root : roots){
+        if(visited[root]) continue;
+        visited[root] = true;
+        order.push_back(root);
+        for(uint64_t head = order.size() -1; head < order.size(); head++){ // the order doubles as the queue of the BFS
+            uint64_t v = order[head];
+            uint64_t start = order.size();
+            for(const uint64_t* it = graph.begin(v); it != graph.end(v); it++){
+                if(!visited[*it]){
+                    visited[*it] = true;
+                    order.push_back(*it);
+                }
+            }
+            sort(order.begin() + start, order.end(), by_increasing_degree);
+        }
+    }
+
+    reverse(order.begin(), order.end());
+    return order;
+}
+
+// The unit heap of Gorder: the vertices are linked in a list for each score, as the scores are only incremented or
+// decremented by one, moving a vertex takes constant time. The vertices with a score of zero are not tracked.
+class UnitHeap {
+    static constexpr uint64_t NIL = numeric_limits<uint64_t>::max();
+    vector<int64_t> m_score; // the current score of each vertex
+    vector<uint64_t> m_prev; // the previous vertex in the list of its score
+    vector<uint64_t> m_next; // the next vertex in the list of its score
+    vector<uint64_t> m_heads; // the first vertex in the list of each score
+    uint64_t m_top = 0; // upper bound to the highest score with a non empty list
+
+    void link(uint64_t v){
+        uint64_t key = m_score[v];
+        if(key == 0) return;
+        if(key >= m_heads.size()){ m_heads.resize(key +1, NIL); }
+        m_prev[v] = NIL;
+        m_next[v] = m_heads[key];
+        if(m_heads[key] != NIL){ m_prev[m_heads[key]] = v; }
+        m_heads[key] = v;
+        m_top = max(m_top, key);
+    }
+
+    void unlink(uint64_t v){
+        uint64_t key = m_score[v];
+        if(key == 0) return;
+        if(m_prev[v] != NIL){ m_next[m_prev[v]] = m_next[v]; } else { m_heads[key] = m_next[v]; }
+        if(m_next[v] != NIL){ m_prev[m_next[v]] = m_prev[v]; }
+    }
+
+public:
+    UnitHeap(uint64_t num_vertices) : m_score(num_vertices, 0), m_prev(num_vertices, NIL), m_next(num_vertices, NIL) { }
+
+    // Increment (+1) or decrement (-1) the score of the vertex v
+    void update(uint64_t v, int64_t delta){
+        assert((delta == 1 || delta == -1) && "The unit heap only moves the vertices by one");
+        assert(m_score[v] + delta >= 0 && "Negative score");
+        unlink(v);
+        m_score[v] += delta;
+        link(v);
+    }
+
+    // Remove the vertex v from the heap, it will not be returned by #pop anymore
+    void remove(uint64_t v){
+        unlink(v);
+        m_score[v] = 0;
+    }
+
+    // Remove and return a vertex with the highest score, or NIL if all tracked vertices have a score of zero
+    uint64_t pop(){
+        while(m_top > 0 && m_heads[m_top] == NIL){ m_top--; } // amortised by the increments that raised the top
+        if(m_top == 0) return NIL;
+        uint64_t v = m_heads[m_top];
+        remove(v);
+        return v;
+    }
+};
+
+vector<uint64_t> order_by_gorder(const Graph& graph){
+    const uint64_t N = graph.num_vertices();
+    const uint64_t hub_degree = sqrt(static_cast<double>(N)); // the siblings through vertices with a greater degree are ignored
+    vector<uint64_t> by_degree = graph.sort_by_degree(); // pick the next vertex when no candidate is related to the window
+    uint64_t by_degree_next = 0;
+    vector<bool> placed(N, false);
+    UnitHeap candidates { N }; // by number of neighbours & siblings of the vertex in the window
+    vector<uint64_t> order;
+    order.reserve(N);
+
+    auto update_score = [&](uint64_t u, int64_t delta){
+        if(placed[u]) return;
+        candidates.update(u, delta);
+    };
+
+    // the vertex v enters (+1) or leaves (-1) the window
+    auto update_window = [&](uint64_t v, int64_t delta){
+        for(const uint64_t* n = graph.begin(v); n != graph.end(v); n++){
+            update_score(*n, delta);
+            if(graph.degree(*n) <= hub_degree){
+                for(const uint64_t* s = graph.begin(*n); s != graph.end(*n); s++){
+                    if(*s != v){ update_score(*s, delta); }
+                }
+            }
+        }
+    };
+
+    while(order.size() < N){
+        uint64_t next = candidates.pop();
+        if(next == numeric_limits<uint64_t>::max()){ // fall back to the unplaced vertex with the highest degree
+            while(placed[by_degree[by_degree_next]]){ by_degree_next++; }
+            next = by_degree[by_degree_next];
+            candidates.remove(next);
+        }
+
+        placed[next] = true;
+        order.push_back(next);
+        update_window(next, +1);
+        if(order.size() > GORDER_WINDOW){
+            update_window(order[order.size() - GORDER_WINDOW -1], -1);
+        }
+    }
+
+    return order;
+}
+
+} // anon namespace
+
+std::unique_ptr<uint64_t[]> compute_vertex_order(VertexReordering reordering, uint64_t num_vertices, const uint64_t* offsets, const uint64_t* neighbours){
+    Graph graph { num_vertices, offsets, neighbours };
+    vector<uint64_t> order;
+    switch(reordering){
+    case VertexReordering::NONE:
+        order.resize(num_vertices);
+        for(uint64_t v = 0; v < num_vertices; v++){ order[v] = v; }
+        break;
+    case VertexReordering::DEGREE:
+        order = order_by_degree(graph);
+        break;
+    case VertexReordering::HUB_CLUSTER:
+        order = order_by_hub_cluster(graph);
+        break;
+    case VertexReordering::RCM:
+        order = order_by_rcm(graph);
+        break;
+    case VertexReordering::GORDER:
+        order = order_by_gorder(graph);
+        break;
+    default:
+        INVALID_ARGUMENT("Invalid vertex reordering: " << (int) reordering);
+    }
+    assert(order.size() == num_vertices);
+
+    unique_ptr<uint64_t[]> position { new uint64_t[num_vertices] };
+    #pragma omp parallel for
+    for(uint64_t i = 0; i < num_vertices; i++){
+        position[order[i]] = i;
+    }
+    return position;
+}
+
+std::unique_ptr<uint64_t[]> compute_vertex_order(VertexReordering reordering, uint64_t num_vertices, uint64_t num_edges, const uint64_t* sources, const uint64_t* destinations){
+    // the neighbours of each vertex, in both directions, in any order
+    unique_ptr<uint64_t[]> ptr_offsets { new uint64_t[num_vertices +1]() };
+    unique_ptr<uint64_t[]> ptr_neighbours { new uint64_t[2 * num_edges] };
+    uint64_t* __restrict offsets = ptr_offsets.get();
+    uint64_t* __restrict neighbours = ptr_neighbours.get();
+    #pragma omp parallel for schedule(static, 4096)
+    for(uint64_t i = 0; i < num_edges; i++){
+        __atomic_fetch_add(offsets + sources[i] +1, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(offsets + destinations[i] +1, 1, __ATOMIC_RELAXED);
+    }
+    parallel_prefix_sum(offsets +1, num_vertices);
+    {
+        unique_ptr<uint64_t[]> ptr_cursors { new uint64_t[num_vertices] };
+        uint64_t* __restrict cursors = ptr_cursors.get();
+        copy(offsets, offsets + num_vertices, cursors);
+        #pragma omp parallel for schedule(static, 4096)
+        for(uint64_t i = 0; i < num_edges; i++){
+            neighbours[__atomic_fetch_add(cursors + sources[i], 1, __ATOMIC_RELAXED)] = destinations[i];
+            neighbours[__atomic_fetch_add(cursors + destinations[i], 1, __ATOMIC_RELAXED)] = sources[i];
+        }
+    }
+
+    return compute_vertex_order(reordering, num_vertices, offsets, neighbours);
+}
+
+std::vector<uint64_t> compute_vertex_order(VertexReordering reordering, const WeightedEdgeStream& stream){
+    // the logical vertex ID is the rank of the external vertex ID
+    vector<uint64_t> log2ext;
+    { // restrict the scope of the lock
+        auto vertex_table = stream.vertex_table();
+        auto vertices = vertex_table->lock_table();
+        log2ext.reserve(vertices.size());
+        for(const auto& pair : vertices){
+            log2ext.push_back(pair.first);
+        }
+    }
+    __gnu_parallel::sort(log2ext.begin(), log2ext.end());
+    const uint64_t num_vertices = log2ext.size();
+    const uint64_t num_edges = stream.num_edges();
+    auto ext2log = [&log2ext](uint64_t vertex_id){
+        return static_cast<uint64_t>(lower_bound(log2ext.begin(), log2ext.end(), vertex_id) - log2ext.begin());
+    };
+    unique_ptr<uint64_t[]> ptr_sources { new uint64_t[num_edges] };
+    unique_ptr<uint64_t[]> ptr_destinations { new uint64_t[num_edges] };
+    uint64_t* __restrict sources = ptr_sources.get();
+    uint64_t* __restrict destinations = ptr_destinations.get();
+    #pragma omp parallel for schedule(static, 4096)
+    for(uint64_t i = 0; i < num_edges; i++){
+        auto edge = stream.get(i);
+        sources[i] = ext2log(edge.source());
+        destinations[i] = ext2log(edge.destination());
+    }
+
+    unique_ptr<uint64_t[]> position = compute_vertex_order(reordering, num_vertices, num_edges, sources, destinations);
+    ptr_sources.reset();
+    ptr_destinations.reset();
+
+    vector<uint64_t> vertices(num_vertices);
+    #pragma omp parallel for schedule(static, 4096)
+    for(uint64_t v = 0; v < num_vertices; v++){
+        vertices[position[v]] = log2ext[v];
+    }
+    return vertices;
+}
+
+// Each thread scans a contiguous chunk of the array and then adds the total of the previous chunks
+void parallel_prefix_sum(uint64_t* __restrict array, uint64_t array_sz){
+    const int max_threads = max<uint64_t>(1, min<uint64_t>(omp_get_max_threads(), array_sz / 4096));
+    unique_ptr<uint64_t[]> ptr_totals { new uint64_t[max_threads +1]() };
+    uint64_t* totals = ptr_totals.get();
+
+    // the runtime may grant less threads than requested, derive the chunks from the actual size of the team
+    #pragma omp parallel num_threads(max_threads)
+    {
+        const uint64_t chunk_id = omp_get_thread_num();
+        const uint64_t num_chunks = omp_get_num_threads();
+        const uint64_t chunk_sz = (array_sz + num_chunks -1) / num_chunks;
+        const uint64_t start = min(array_sz, chunk_id * chunk_sz);
+        const uint64_t end = min(array_sz, start + chunk_sz);
+        for(uint64_t i = start +1; i < end; i++){ array[i] += array[i -1]; }
+        totals[chunk_id +1] = (start < end) ? array[end -1] : 0;
+
+        #pragma omp barrier
+        #pragma omp single
+        for(uint64_t j = 1; j <= num_chunks; j++){ totals[j] += totals[j -1]; }
+        // implicit barrier at the end of the single section
+
+        const uint64_t offset = totals[chunk_id];
+        if(offset > 0){
+            for(uint64_t i = start; i < end; i++){ array[i] += offset; }
+        }
+    }
+}
+
+} // namespace
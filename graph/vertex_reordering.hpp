@@ -0,0 +1,83 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gfe::graph {
+
+class WeightedEdgeStream; // forward declaration
+
+/**
+ * Relabel the vertices of a graph to improve the locality of the accesses in the Graphalytics kernels:
+ * - NONE: keep the order of the vertex IDs;
+ * - DEGREE: sort the vertices by decreasing degree;
+ * - HUB_CLUSTER: move the vertices with a degree above the average (the hubs) at the front, otherwise keep the order
+ *   of the vertex IDs, as in Balaji & Lucia, When is Graph Reordering an Optimization?, IISWC 2018;
+ * - RCM: reverse Cuthill-McKee, a BFS from a vertex of minimum degree in each component, visiting the neighbours by
+ *   increasing degree;
+ * - GORDER: greedy order of Wei et al., Speedup Graph Processing by Graph Ordering, SIGMOD 2016. The next vertex is
+ *   the one with more neighbours and siblings among the last GORDER_WINDOW vertices placed. In contrast to the
+ *   original algorithm, the siblings reachable through a hub are ignored, bounding the cost to O(|E| * avg degree).
+ */
+enum class VertexReordering { NONE, DEGREE, HUB_CLUSTER, RCM, GORDER };
+
+// Parse the given string (none, degree, hub, rcm or gorder) into a VertexReordering. Raise an error if the string is not valid
+VertexReordering parse_vertex_reordering(const std::string& value);
+
+// Get a string representation of the given reordering, the same accepted by #parse_vertex_reordering
+std::string vertex_reordering_to_string(VertexReordering reordering);
+
+/**
+ * Compute the new order of the vertices of the given graph, in CSR format.
+ * @param reordering the algorithm to use
+ * @param num_vertices the number of vertices in the graph, with IDs in [0, num_vertices)
+ * @param offsets the neighbours of the vertex v are in [offsets[v], offsets[v+1]), array of num_vertices +1 entries
+ * @param neighbours the neighbours of all vertices, both the outgoing and the incoming edges in directed graphs
+ * @return for each vertex, its position in the new order
+ */
+std::unique_ptr<uint64_t[]> compute_vertex_order(VertexReordering reordering, uint64_t num_vertices, const uint64_t* offsets, const uint64_t* neighbours);
+
+/**
+ * Compute the new order of the vertices of the graph with the given edges, gathering the neighbours of each vertex
+ * in both directions.
+ * @param reordering the algorithm to use
+ * @param num_vertices the number of vertices in the graph, with IDs in [0, num_vertices)
+ * @param num_edges the number of edges in the arrays sources and destinations
+ * @param sources the source of each edge
+ * @param destinations the destination of each edge
+ * @return for each vertex, its position in the new order
+ */
+std::unique_ptr<uint64_t[]> compute_vertex_order(VertexReordering reordering, uint64_t num_vertices, uint64_t num_edges, const uint64_t* sources, const uint64_t* destinations);
+
+/**
+ * Compute the new order of the vertices of the given edge stream, whose vertex IDs are not necessarily dense.
+ * Used to load the graph into the libraries that assign their internal vertex IDs in order of insertion.
+ * @param reordering the algorithm to use
+ * @param stream the edges of the graph
+ * @return the (external) vertex IDs of the stream, in the new order
+ */
+std::vector<uint64_t> compute_vertex_order(VertexReordering reordering, const WeightedEdgeStream& stream);
+
+// Inclusive prefix sum of the given array, computed in parallel
+void parallel_prefix_sum(uint64_t* array, uint64_t array_sz);
+
+} // namespace
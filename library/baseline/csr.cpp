@@ -19,6 +19,9 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
 #include <limits>
@@ -27,18 +30,27 @@
 #include <numa.h>
 #endif
 #include <omp.h>
+#include <parallel/algorithm>
 #include <random>
 #include <sstream>
 #include <string>
-#include <unordered_set>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "common/error.hpp"
 #include "common/system.hpp"
 #include "common/timer.hpp"
+#include "configuration.hpp" // LOG
 #include "graph/edge_stream.hpp"
-#include "graph/vertex_list.hpp"
-#include "third-party/gapbs/gapbs.hpp"
+#include "reader/format.hpp"
+#include "reader/graphalytics_reader.hpp"
+#include "library/common/kernels.hpp"
 #include "third-party/libcuckoo/cuckoohash_map.hh"
+#include "utility/result_writer.hpp"
 #include "utility/timeout_service.hpp"
 
 using namespace common;
@@ -78,6 +90,14 @@ CSR::CSR(bool is_directed, bool numa_interleaved) : m_is_directed(is_directed),
 }
 
 CSR::~CSR(){
+    if(m_snapshot != nullptr){ // the arrays point to the memory mapping
+        ::munmap(m_snapshot, m_snapshot_sz);
+        m_snapshot = nullptr;
+        m_out_v = m_out_e = m_in_v = m_in_e = m_log2ext = m_ext_order = nullptr;
+        m_out_w = m_in_w = nullptr;
+        return;
+    }
+
     free_array(m_out_v); m_out_v = nullptr;
     free_array(m_out_e); m_out_e = nullptr;
     free_array(m_out_w); m_out_w = nullptr;
@@ -93,6 +113,7 @@ CSR::~CSR(){
     m_in_w = nullptr;
 
     free_array(m_log2ext); m_log2ext = nullptr;
+    free_array(m_ext_order); m_ext_order = nullptr;
 }
 
 template<typename T>
@@ -150,15 +171,13 @@ bool CSR::is_directed() const {
 }
 
 bool CSR::has_vertex(uint64_t vertex_id) const {
-    return m_ext2log.count(vertex_id);
+    return ext2log(vertex_id) != numeric_limits<uint64_t>::max();
 }
 
 double CSR::get_weight(uint64_t source, uint64_t destination) const {
-    uint64_t logical_source_id = 0, logical_destination_id = 0;
-    try {
-        logical_source_id = m_ext2log.at(source);
-        logical_destination_id = m_ext2log.at(destination);
-    } catch(out_of_range& e){ // either source or destination do not exist
+    uint64_t logical_source_id = ext2log(source);
+    uint64_t logical_destination_id = ext2log(destination);
+    if(logical_source_id == numeric_limits<uint64_t>::max() || logical_destination_id == numeric_limits<uint64_t>::max()){ // either source or destination do not exist
         return numeric_limits<double>::signaling_NaN();
     }
 
@@ -199,6 +218,30 @@ uint64_t CSR::get_in_degree(uint64_t logical_vertex_id) const {
     return interval.second - interval.first;
 }
 
+uint64_t CSR::ext2log(uint64_t external_vertex_id) const {
+    if(m_ext_order != nullptr){ // the vertices have been reordered, binary search through the permutation
+        uint64_t lo = 0, hi = m_num_vertices;
+        while(lo < hi){
+            uint64_t mid = (lo + hi) / 2;
+            if(m_log2ext[m_ext_order[mid]] < external_vertex_id){ lo = mid +1; } else { hi = mid; }
+        }
+        if(lo == m_num_vertices || m_log2ext[m_ext_order[lo]] != external_vertex_id){
+            return numeric_limits<uint64_t>::max();
+        } else {
+            return m_ext_order[lo];
+        }
+    }
+
+    const uint64_t* begin = m_log2ext;
+    const uint64_t* end = m_log2ext + m_num_vertices;
+    const uint64_t* it = lower_bound(begin, end, external_vertex_id);
+    if(it == end || *it != external_vertex_id){
+        return numeric_limits<uint64_t>::max();
+    } else {
+        return it - begin;
+    }
+}
+
 uint64_t CSR::get_random_vertex_id() const {
     std::mt19937_64 generator { /* seed */ std::random_device{}() };
     std::uniform_int_distribution<uint64_t> distribution{ 0, m_num_vertices -1 };
@@ -210,6 +253,15 @@ void CSR::set_timeout(uint64_t seconds) {
     m_timeout = seconds;
 }
 
+void CSR::set_vertex_reordering(gfe::graph::VertexReordering reordering){
+    if(m_out_v != nullptr) ERROR("The graph has already been loaded");
+    m_reordering = reordering;
+}
+
+uint64_t CSR::get_vertex_reordering_time() const {
+    return m_reordering_time;
+}
+
 uint64_t* CSR::out_v() const { return m_out_v; }
 uint64_t* CSR::out_e() const { return m_out_e; }
 double* CSR::out_w() const { return m_out_w; }
@@ -225,175 +277,431 @@ double* CSR::in_w() const { return m_in_w; }
 void CSR::load(const std::string& path){
     if(m_out_v != nullptr) ERROR("Already initialised & loaded");
 
-    ::gfe::graph::WeightedEdgeStream stream { path };
-    load(stream);
+    if(is_snapshot_valid(snapshot_path(path), path, m_is_directed, m_reordering)){
+        LOG("[CSR] Memory mapping the snapshot " << snapshot_path(path) << " ...");
+        open(snapshot_path(path), /* populate ? */ true);
+    } else {
+        ::gfe::graph::WeightedEdgeStream stream { path };
+        load(stream);
+    }
 }
 
 void CSR::load(gfe::graph::WeightedEdgeStream& stream){
     if(m_out_v != nullptr) ERROR("Already initialised & loaded");
+    m_num_edges = stream.num_edges();
+
+    load_vertices(stream);
+
+    // translate the endpoints of the edges into logical vertex IDs, only once for both the outgoing & incoming edges
+    unique_ptr<uint64_t[]> ptr_sources { new uint64_t[m_num_edges] };
+    unique_ptr<uint64_t[]> ptr_destinations { new uint64_t[m_num_edges] };
+    uint64_t* __restrict sources = ptr_sources.get();
+    uint64_t* __restrict destinations = ptr_destinations.get();
+    #pragma omp parallel for schedule(static, 4096)
+    for(uint64_t i = 0; i < m_num_edges; i++){
+        auto edge = stream.get(i);
+        sources[i] = ext2log(edge.source());
+        destinations[i] = ext2log(edge.destination());
+        assert(sources[i] < m_num_vertices && "The source vertex is not registered in the mapping");
+        assert(destinations[i] < m_num_vertices && "The destination vertex is not registered in the mapping");
+    }
+    if(m_reordering != gfe::graph::VertexReordering::NONE){
+        reorder_vertices(sources, destinations);
+    }
 
     if(m_is_directed){
-        load_directed(stream);
+        m_out_v = alloca_array<uint64_t>(m_num_vertices); // init to 0
+        m_out_e = alloca_array<uint64_t>(m_num_edges);
+        m_out_w = alloca_array<double>(m_num_edges);
+        load_edges(sources, destinations, stream, m_out_v, m_out_e, m_out_w, /* undirected ? */ false);
+
+        m_in_v = alloca_array<uint64_t>(m_num_vertices); // init to 0
+        m_in_e = alloca_array<uint64_t>(m_num_edges);
+        m_in_w = alloca_array<double>(m_num_edges);
+        load_edges(destinations, sources, stream, m_in_v, m_in_e, m_in_w, /* undirected ? */ false);
     } else {
-        load_undirected(stream);
+        // each edge is stored in both directions, the incoming edges are simply aliases to the outgoing edges
+        m_out_v = m_in_v = alloca_array<uint64_t>(m_num_vertices); // init to 0
+        m_out_e = m_in_e = alloca_array<uint64_t>(m_num_edges *2);
+        m_out_w = m_in_w = alloca_array<double>(m_num_edges *2);
+        load_edges(sources, destinations, stream, m_out_v, m_out_e, m_out_w, /* undirected ? */ true);
     }
 }
 
-void CSR::load_directed(gfe::graph::WeightedEdgeStream& stream){
-    m_num_edges = stream.num_edges();
+void CSR::load_vertices(const gfe::graph::WeightedEdgeStream& stream){
+    // the vertices are gathered in parallel into a concurrent hash table
+    auto vertex_table = stream.vertex_table();
+    m_num_vertices = vertex_table->size();
+    m_log2ext = alloca_array<uint64_t>(m_num_vertices);
+    { // restrict the scope of the lock
+        auto vertices = vertex_table->lock_table();
+        uint64_t i = 0;
+        for(const auto& pair : vertices){
+            m_log2ext[i++] = pair.first;
+        }
+    }
+    vertex_table.reset();
+
+    // the logical vertex ID is the rank of the external vertex ID, so that the reverse mapping is a binary search
+    __gnu_parallel::sort(m_log2ext, m_log2ext + m_num_vertices);
+}
+
+void CSR::reorder_vertices(uint64_t* sources, uint64_t* destinations){
+    LOG("[CSR] Reordering the vertices, algorithm: " << gfe::graph::vertex_reordering_to_string(m_reordering) << " ...");
+    Timer timer; timer.start();
+
+    // new logical ID of each vertex. As the current logical IDs are the ranks of the external IDs, the same array
+    // gives the logical IDs in order of their external IDs
+    unique_ptr<uint64_t[]> position = gfe::graph::compute_vertex_order(m_reordering, m_num_vertices, m_num_edges, sources, destinations);
+    m_ext_order = alloca_array<uint64_t>(m_num_vertices);
+    memcpy(m_ext_order, position.get(), m_num_vertices * sizeof(uint64_t));
+
+    // relabel the edges & the mapping of the vertices
+    const uint64_t* __restrict ext_order = m_ext_order;
+    #pragma omp parallel for schedule(static, 4096)
+    for(uint64_t i = 0; i < m_num_edges; i++){
+        sources[i] = ext_order[sources[i]];
+        destinations[i] = ext_order[destinations[i]];
+    }
+    uint64_t* log2ext = alloca_array<uint64_t>(m_num_vertices);
+    #pragma omp parallel for schedule(static, 4096)
+    for(uint64_t v = 0; v < m_num_vertices; v++){
+        log2ext[ext_order[v]] = m_log2ext[v];
+    }
+    free_array(m_log2ext);
+    m_log2ext = log2ext;
 
-    { // init the mapping of vertices
-        auto vertices = stream.vertex_list();
-        vertices->sort();
-        m_num_vertices = vertices->num_vertices();
+    timer.stop();
+    m_reordering_time = timer.microseconds();
+    LOG("[CSR] Vertices reordered in " << timer);
+}
+
+void CSR::load_edges(const uint64_t* __restrict sources, const uint64_t* __restrict destinations, const gfe::graph::WeightedEdgeStream& stream, uint64_t* vertex_array, uint64_t* edge_array, double* weight_array, bool undirected){
+    // degree count
+    #pragma omp parallel for schedule(static, 4096)
+    for(uint64_t i = 0; i < m_num_edges; i++){
+        __atomic_fetch_add(vertex_array + sources[i], 1, __ATOMIC_RELAXED);
+        if(undirected){ __atomic_fetch_add(vertex_array + destinations[i], 1, __ATOMIC_RELAXED); }
+    }
 
-        m_ext2log.reserve(m_num_vertices);
-        m_log2ext = alloca_array<uint64_t>(m_num_vertices);
+    // prefix sum on the vertex array
+    gfe::graph::parallel_prefix_sum(vertex_array, m_num_vertices);
 
-        for(uint64_t i = 0; i < m_num_vertices; i++){
-            uint64_t vertex_id = vertices->get(i);
-            m_ext2log[vertex_id] = i;
-            m_log2ext[i] = vertex_id;
+    // scatter the edges, in any order
+    unique_ptr<uint64_t[]> ptr_cursors { new uint64_t[m_num_vertices] }; // next position to fill for each vertex
+    uint64_t* cursors = ptr_cursors.get();
+    #pragma omp parallel for schedule(static, 4096)
+    for(uint64_t v = 0; v < m_num_vertices; v++){
+        cursors[v] = (v == 0) ? 0 : vertex_array[v -1];
+    }
+    #pragma omp parallel for schedule(static, 4096)
+    for(uint64_t i = 0; i < m_num_edges; i++){
+        double weight = stream.get(i).weight();
+        uint64_t position = __atomic_fetch_add(cursors + sources[i], 1, __ATOMIC_RELAXED);
+        edge_array[position] = destinations[i];
+        weight_array[position] = weight;
+        if(undirected){
+            position = __atomic_fetch_add(cursors + destinations[i], 1, __ATOMIC_RELAXED);
+            edge_array[position] = sources[i];
+            weight_array[position] = weight;
         }
     }
+    ptr_cursors.reset();
+
+    // sort the edges of each vertex by their logical destination
+    #pragma omp parallel
+    {
+        vector<pair<uint64_t, double>> buffer;
+        #pragma omp for schedule(dynamic, 4096)
+        for(uint64_t v = 0; v < m_num_vertices; v++){
+            auto interval = get_interval_impl(vertex_array, v);
+            uint64_t degree = interval.second - interval.first;
+            if(degree <= 1) continue;
 
-    // init the outgoing edges
-    stream.sort_by_src_dst();
-    m_out_v = alloca_array<uint64_t>(m_num_vertices); // init to 0
-    m_out_e = alloca_array<uint64_t>(m_num_edges);
-    m_out_w = alloca_array<double>(m_num_edges);
-
-    { // restrict the scope
-        uint64_t external_source_id = numeric_limits<uint64_t>::max();
-        uint64_t logical_source_id = 0;
-        for(uint64_t i = 0; i < m_num_edges; i++){
-            auto edge = stream.get(i);
-            if(edge.source() != external_source_id){
-                external_source_id = edge.source();
-                assert(m_ext2log.count(external_source_id) == 1 && "The source vertex is not registered in the mapping");
-                logical_source_id = m_ext2log[external_source_id];
+            buffer.resize(degree);
+            for(uint64_t i = 0; i < degree; i++){
+                buffer[i] = make_pair(edge_array[interval.first + i], weight_array[interval.first + i]);
             }
-            m_out_v[logical_source_id]++;
+            std::sort(begin(buffer), end(buffer), [](const auto& e1, const auto& e2){ return e1.first < e2.first; });
+            for(uint64_t i = 0; i < degree; i++){
+                edge_array[interval.first + i] = buffer[i].first;
+                weight_array[interval.first + i] = buffer[i].second;
+            }
+        }
+    }
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Snapshot                                                                 *
+ *                                                                           *
+ *****************************************************************************/
+struct SnapshotSource {
+    uint64_t m_size; // size of the file, in bytes
+    uint64_t m_mtime; // last modification time of the file, in nanoseconds since the epoch
+};
+
+struct SnapshotHeader {
+    char m_magic[8]; // GFECSR01
+    uint64_t m_version; // 3
+    SnapshotSource m_sources[3]; // the files of the original graph, to detect stale snapshots, zeroed if unknown
+    uint64_t m_file_size; // the size of the snapshot file, to detect truncated snapshots
+    uint64_t m_is_directed; // 1 if the graph is directed, 0 otherwise
+    uint64_t m_num_vertices; // cardinality of the arrays log2ext, out_v and in_v
+    uint64_t m_num_edges; // number of edges in the graph, as returned by #num_edges()
+    uint64_t m_log2ext_offset; // offset of the array log2ext
+    uint64_t m_out_v_offset; // offset of the array out_v
+    uint64_t m_out_e_offset; // offset of the array out_e
+    uint64_t m_out_w_offset; // offset of the array out_w
+    uint64_t m_in_v_offset; // offset of the array in_v, 0 for undirected graphs
+    uint64_t m_in_e_offset; // offset of the array in_e, 0 for undirected graphs
+    uint64_t m_in_w_offset; // offset of the array in_w, 0 for undirected graphs
+    uint64_t m_reordering; // the vertex reordering, as gfe::graph::VertexReordering
+    uint64_t m_ext_order_offset; // offset of the array ext_order, 0 if the vertices have not been reordered
+};
+
+namespace {
+constexpr char SNAPSHOT_MAGIC[8] = { 'G', 'F', 'E', 'C', 'S', 'R', '0', '1' };
+constexpr uint64_t SNAPSHOT_VERSION = 3; // v2: vertex reordering, v3: size & mtime of the vertex and edge files
+constexpr uint64_t SNAPSHOT_ALIGNMENT = 4096; // all arrays start at a page boundary
+static_assert(sizeof(SnapshotHeader) <= SNAPSHOT_ALIGNMENT);
+
+// Retrieve the size of the given file, or -1 if the file does not exist
+int64_t get_file_size(const std::string& path){
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0) return -1;
+    return st.st_size;
+}
 
-            assert(m_ext2log.count(edge.destination()) == 1 && "The destination vertex is not registered in the mapping");
-            uint64_t logical_destination_id = m_ext2log[edge.destination()];
+// Retrieve the size & the modification time of the files of the graph at the given path. For the Graphalytics
+// datasets, these are the property file, the vertex and the edge file, otherwise the given file alone
+void get_snapshot_sources(const std::string& path_graph, SnapshotSource (&sources)[3]){
+    memset(sources, 0, sizeof(sources));
+    if(path_graph.empty()) return;
+
+    vector<string> paths { path_graph };
+    if(gfe::reader::get_graph_format(path_graph) == gfe::reader::Format::LDBC_GRAPHALYTICS){
+        gfe::reader::GraphalyticsReader reader { path_graph };
+        paths.push_back(reader.get_path_vertex_list());
+        paths.push_back(reader.get_path_edge_list());
+    }
 
-            m_out_e[i] = logical_destination_id;
-            m_out_w[i] = edge.weight();
-        }
+    for(uint64_t i = 0; i < paths.size(); i++){
+        struct stat st;
+        if(stat(paths[i].c_str(), &st) != 0) ERROR("Cannot stat the file `" << paths[i] << "': " << strerror(errno));
+        sources[i].m_size = st.st_size;
+        sources[i].m_mtime = static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000ull + st.st_mtim.tv_nsec;
     }
+}
 
-    // prefix sum on the vertex array
-    for(uint64_t i = 1; i < m_num_vertices; i++){
-        m_out_v[i] += m_out_v[i -1];
+// Append the given content to the output file, return the offset where the content was written
+uint64_t append(fstream& handle, const void* content, uint64_t length){
+    uint64_t offset = handle.tellp();
+    assert(offset % SNAPSHOT_ALIGNMENT == 0 && "Arrays should start at a page boundary");
+    handle.write((const char*) content, length);
+    if(length % SNAPSHOT_ALIGNMENT != 0){ // pad to the next page
+        static const char padding[SNAPSHOT_ALIGNMENT] = {0};
+        handle.write(padding, SNAPSHOT_ALIGNMENT - (length % SNAPSHOT_ALIGNMENT));
     }
+    if(!handle.good()) ERROR("Cannot write the snapshot file");
+    return offset;
+}
+} // anon namespace
 
-    // init the incoming edges
-    // do it for both directed and undirected graphs. For undirected graphs it's an intermediate step
-    stream.sort_by_dst_src();
-    m_in_v = alloca_array<uint64_t>(m_num_vertices); // init to 0
-    m_in_e = alloca_array<uint64_t>(m_num_edges);
-    m_in_w = alloca_array<double>(m_num_edges);
+string CSR::snapshot_path(const std::string& path_graph){
+    return path_graph + ".csr";
+}
 
-    uint64_t external_destination_id = numeric_limits<uint64_t>::max();
-    uint64_t logical_destination_id = 0;
+bool CSR::is_snapshot_valid(const std::string& path_snapshot, const std::string& path_source, bool is_directed, gfe::graph::VertexReordering reordering){
+    fstream handle { path_snapshot, ios_base::in | ios_base::binary };
+    if(!handle.good()) return false; // the snapshot does not exist
 
-    for(uint64_t i = 0; i < m_num_edges; i++){
-        auto edge = stream.get(i);
-        if(edge.destination() != external_destination_id){
-            external_destination_id = edge.destination();
-            assert(m_ext2log.count(external_destination_id) == 1 && "The destination vertex is not registered in the mapping");
-            logical_destination_id = m_ext2log[external_destination_id];
-        }
-        m_in_v[logical_destination_id]++;
+    SnapshotHeader header;
+    handle.read((char*) &header, sizeof(header));
+    if(!handle.good() || memcmp(header.m_magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header.m_version != SNAPSHOT_VERSION){
+        COUT_DEBUG("Invalid snapshot file: " << path_snapshot);
+        return false;
+    } else if(header.m_is_directed != (uint64_t) is_directed){
+        COUT_DEBUG("Snapshot file for a " << (header.m_is_directed ? "directed" : "undirected") << " graph: " << path_snapshot);
+        return false;
+    } else if(header.m_reordering != (uint64_t) reordering){
+        COUT_DEBUG("Snapshot file with a different vertex reordering: " << path_snapshot);
+        return false;
+    }
+
+    SnapshotSource sources[3];
+    get_snapshot_sources(path_source, sources);
+    if(memcmp(header.m_sources, sources, sizeof(sources)) != 0){
+        COUT_DEBUG("Stale snapshot file: " << path_snapshot);
+        return false;
+    } else {
+        return true;
+    }
+}
+
+void CSR::save(const std::string& path, const std::string& path_source) const {
+    if(m_out_v == nullptr) ERROR("The CSR has not been loaded yet");
 
-        assert(m_ext2log.count(edge.source()) == 1 && "The source vertex is not registered in the mapping");
-        uint64_t logical_source_id = m_ext2log[edge.source()];
+    string path_tmp = path + "." + to_string(::getpid()); // write & rename, do not leave partial snapshots around
+    fstream handle{path_tmp, ios_base::out | ios_base::binary | ios_base::trunc};
+    if(!handle.good()) ERROR("Cannot create the file: " << path_tmp);
 
-        m_in_e[i] = logical_source_id;
-        m_in_w[i] = edge.weight();
+    try {
+        const uint64_t num_edge_entries = m_is_directed ? m_num_edges : 2 * m_num_edges; // undirected edges are stored twice
+
+        SnapshotHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.m_magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.m_version = SNAPSHOT_VERSION;
+        get_snapshot_sources(path_source, header.m_sources);
+        header.m_is_directed = m_is_directed;
+        header.m_num_vertices = m_num_vertices;
+        header.m_num_edges = m_num_edges;
+        header.m_reordering = (uint64_t) m_reordering;
+        append(handle, &header, sizeof(header)); // placeholder, rewritten at the end
+
+        header.m_log2ext_offset = append(handle, m_log2ext, m_num_vertices * sizeof(uint64_t));
+        header.m_out_v_offset = append(handle, m_out_v, m_num_vertices * sizeof(uint64_t));
+        header.m_out_e_offset = append(handle, m_out_e, num_edge_entries * sizeof(uint64_t));
+        header.m_out_w_offset = append(handle, m_out_w, num_edge_entries * sizeof(double));
+        if(m_is_directed){
+            header.m_in_v_offset = append(handle, m_in_v, m_num_vertices * sizeof(uint64_t));
+            header.m_in_e_offset = append(handle, m_in_e, num_edge_entries * sizeof(uint64_t));
+            header.m_in_w_offset = append(handle, m_in_w, num_edge_entries * sizeof(double));
+        }
+        if(m_ext_order != nullptr){
+            header.m_ext_order_offset = append(handle, m_ext_order, m_num_vertices * sizeof(uint64_t));
+        }
+        header.m_file_size = handle.tellp();
+
+        // finalise the header
+        handle.seekp(0);
+        handle.write((const char*) &header, sizeof(header));
+        if(!handle.good()) ERROR("Cannot write the snapshot file: " << path_tmp);
+        handle.close();
+    } catch (...){
+        handle.close();
+        ::unlink(path_tmp.c_str());
+        throw;
     }
 
-    // prefix sum on the vertex array
-    for(uint64_t i = 1; i < m_num_vertices; i++){
-        m_in_v[i] += m_in_v[i -1];
+    if(::rename(path_tmp.c_str(), path.c_str()) != 0){
+        int rc = errno;
+        ::unlink(path_tmp.c_str());
+        ERROR("Cannot rename `" << path_tmp << "' into `" << path << "': " << strerror(rc));
     }
 }
 
-void CSR::load_undirected(gfe::graph::WeightedEdgeStream& stream){
-    // We rely to load_directed to build a directed graph first
-    load_directed(stream);
+void CSR::open(const std::string& path, bool populate){
+    if(m_out_v != nullptr) ERROR("Already initialised & loaded");
 
-    // init the final vectors
-    auto fn_free_array = [this](uint64_t* ptr){ this->free_array(ptr); };
-    unique_ptr<uint64_t, decltype(fn_free_array)> ptr_out_v_undirected { alloca_array<uint64_t>(m_num_vertices), fn_free_array };
-    unique_ptr<uint64_t, decltype(fn_free_array)> ptr_out_e_undirected { alloca_array<uint64_t>(m_num_edges *2), fn_free_array };
-    auto fn_free_array_dbl = [this](double* ptr){ this->free_array(ptr); };
-    unique_ptr<double, decltype(fn_free_array_dbl)> ptr_out_w_undirected { alloca_array<double>(m_num_edges *2), fn_free_array_dbl };
-    auto out_v_undirected = ptr_out_v_undirected.get();
-    auto out_e_undirected = ptr_out_e_undirected.get();
-    auto out_w_undirected = ptr_out_w_undirected.get();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) ERROR("Cannot open the file `" << path << "': " << strerror(errno));
+    int64_t file_size = get_file_size(path);
+    if(file_size < (int64_t) SNAPSHOT_ALIGNMENT){ ::close(fd); ERROR("Invalid snapshot file, too small: " << path); }
 
-    // process all vertices from the directed CSR
-    uint64_t k = 0; // index on the edge vector
-    for(uint64_t v = 0; v < m_num_vertices; v++){
-        auto interval_out = get_out_interval(v);
-        auto interval_in = get_in_interval(v);
-        auto degree_out = interval_out.second - interval_out.first;
-        auto degree_in = interval_in.second - interval_in.first;
-        out_v_undirected[v] = degree_out + degree_in;
-
-        // merge the incoming & outcoming edges for v
-        uint64_t out = interval_out.first;
-        uint64_t in = interval_in.first;
-        while(out < interval_out.second && in < interval_in.second){
-            assert(m_out_e[out] != m_in_e[in] && "We don't expect the same edge in both directions");
-
-            if(m_out_e[out] < m_in_e[in]){
-                out_e_undirected[k] = m_out_e[out];
-                out_w_undirected[k] = m_out_w[out];
-
-                out++;
-                k++;
-            } else {
-                out_e_undirected[k] = m_in_e[in];
-                out_w_undirected[k] = m_in_w[in];
+#if defined(HAVE_LIBNUMA)
+    // the pages of the page cache are allocated according to the policy of the thread reading the file
+    if(m_numa_interleaved){ numa_set_interleave_mask(numa_all_nodes_ptr); }
+#endif
+    void* mapping = ::mmap(nullptr, file_size, PROT_READ, MAP_SHARED | (populate ? MAP_POPULATE : 0), fd, 0);
+    int rc = errno;
+#if defined(HAVE_LIBNUMA)
+    if(m_numa_interleaved){ numa_set_localalloc(); }
+#endif
+    ::close(fd); // the mapping keeps its own reference to the file
+    if(mapping == MAP_FAILED){ ERROR("Cannot memory map the file `" << path << "': " << strerror(rc)); }
+    m_snapshot = mapping;
+    m_snapshot_sz = file_size;
+
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(m_snapshot);
+    if(memcmp(header->m_magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header->m_version != SNAPSHOT_VERSION){
+        ERROR("Invalid snapshot file: " << path);
+    }
+    if(header->m_file_size != m_snapshot_sz){
+        ERROR("Truncated snapshot file: " << path << ", expected size: " << header->m_file_size << " bytes, actual size: " << m_snapshot_sz << " bytes");
+    }
+    if(header->m_is_directed != (uint64_t) m_is_directed){
+        ERROR("The snapshot file `" << path << "' contains a " << (header->m_is_directed ? "directed" : "undirected") << " graph");
+    }
 
-                in++;
-                k++;
-            }
-        }
-        while(out < interval_out.second){
-            out_e_undirected[k] = m_out_e[out];
-            out_w_undirected[k] = m_out_w[out];
+    if(header->m_reordering > (uint64_t) gfe::graph::VertexReordering::GORDER){
+        ERROR("Invalid snapshot file: " << path << ", unknown vertex reordering: " << header->m_reordering);
+    }
 
-            out++;
-            k++;
+    // do not trust the header, all arrays must lie inside the file, after the header
+    const uint64_t max_entries = m_snapshot_sz / sizeof(uint64_t);
+    if(header->m_num_vertices > max_entries || header->m_num_edges > max_entries / 2){
+        ERROR("Invalid snapshot file: " << path << ", num vertices: " << header->m_num_vertices << ", num edges: " << header->m_num_edges);
+    }
+    const uint64_t num_edge_entries = m_is_directed ? header->m_num_edges : 2 * header->m_num_edges;
+    auto check_array = [&](const char* name, uint64_t offset, uint64_t num_entries){
+        if(offset < SNAPSHOT_ALIGNMENT || offset % SNAPSHOT_ALIGNMENT != 0 || offset > m_snapshot_sz || num_entries * sizeof(uint64_t) > m_snapshot_sz - offset){
+            ERROR("Invalid snapshot file: " << path << ", the array " << name << " at offset " << offset << " with " << num_entries << " entries exceeds the file size: " << m_snapshot_sz << " bytes");
         }
-        while(in < interval_in.second){
-            out_e_undirected[k] = m_in_e[in];
-            out_w_undirected[k] = m_in_w[in];
+    };
+    check_array("log2ext", header->m_log2ext_offset, header->m_num_vertices);
+    check_array("out_v", header->m_out_v_offset, header->m_num_vertices);
+    check_array("out_e", header->m_out_e_offset, num_edge_entries);
+    check_array("out_w", header->m_out_w_offset, num_edge_entries);
+    if(m_is_directed){
+        check_array("in_v", header->m_in_v_offset, header->m_num_vertices);
+        check_array("in_e", header->m_in_e_offset, num_edge_entries);
+        check_array("in_w", header->m_in_w_offset, num_edge_entries);
+    }
+    if(header->m_ext_order_offset != 0){
+        check_array("ext_order", header->m_ext_order_offset, header->m_num_vertices);
+    }
 
-            in++;
-            k++;
-        }
+    // the arrays are never altered after the graph has been loaded
+    auto array = [this](uint64_t offset){ return reinterpret_cast<uint64_t*>(reinterpret_cast<char*>(m_snapshot) + offset); };
+    m_num_vertices = header->m_num_vertices;
+    m_num_edges = header->m_num_edges;
+    m_log2ext = array(header->m_log2ext_offset);
+    m_reordering = static_cast<gfe::graph::VertexReordering>(header->m_reordering);
+    m_ext_order = header->m_ext_order_offset != 0 ? array(header->m_ext_order_offset) : nullptr;
+    m_out_v = array(header->m_out_v_offset);
+    m_out_e = array(header->m_out_e_offset);
+    m_out_w = reinterpret_cast<double*>(array(header->m_out_w_offset));
+    if(m_is_directed){
+        m_in_v = array(header->m_in_v_offset);
+        m_in_e = array(header->m_in_e_offset);
+        m_in_w = reinterpret_cast<double*>(array(header->m_in_w_offset));
+    } else {
+        m_in_v = m_out_v;
+        m_in_e = m_out_e;
+        m_in_w = m_out_w;
     }
+}
 
-    // prefix sum
-    for(uint64_t v = 1; v < m_num_vertices; v++){
-        out_v_undirected[v] += out_v_undirected[v -1];
+void CSR::release_edge_arrays(){
+    if(m_snapshot != nullptr){ // copy the arrays still required out of the memory mapping
+        auto copy = [this](const uint64_t* array){
+            uint64_t* result = alloca_array<uint64_t>(m_num_vertices);
+            memcpy(result, array, m_num_vertices * sizeof(uint64_t));
+            return result;
+        };
+        m_log2ext = copy(m_log2ext);
+        if(m_ext_order != nullptr){ m_ext_order = copy(m_ext_order); }
+        uint64_t* out_v = copy(m_out_v);
+        uint64_t* in_v = m_is_directed ? copy(m_in_v) : out_v;
+
+        ::munmap(m_snapshot, m_snapshot_sz);
+        m_snapshot = nullptr;
+        m_snapshot_sz = 0;
+        m_out_v = out_v;
+        m_in_v = in_v;
+    } else {
+        free_array(m_out_e);
+        free_array(m_out_w);
+        if(m_is_directed){ // otherwise, they are simply aliases to m_out_x
+            free_array(m_in_e);
+            free_array(m_in_w);
+        }
     }
 
-    // replace the out & in vectors
-    free_array(m_out_v);
-    free_array(m_out_e);
-    free_array(m_out_w);
-    free_array(m_in_v);
-    free_array(m_in_e);
-    free_array(m_in_w);
-    m_out_v = m_in_v = ptr_out_v_undirected.release();
-    m_out_e = m_in_e = ptr_out_e_undirected.release();
-    m_out_w = m_in_w = ptr_out_w_undirected.release();
+    m_out_e = m_in_e = nullptr;
+    m_out_w = m_in_w = nullptr;
 }
 
 /*****************************************************************************
@@ -452,236 +760,87 @@ template <typename T, bool negative_scores>
 void CSR::save_results(const vector<pair<uint64_t, T>>& result, const char* dump2file) {
     assert(dump2file != nullptr);
     COUT_DEBUG("save the results to: " << dump2file);
-
-    fstream handle(dump2file, ios_base::out);
-    if (!handle.good()) ERROR("Cannot save the result to `" << dump2file << "'");
-
-    for (const auto &p : result) {
-        handle << p.first << " ";
-
-        if(!negative_scores && p.second < 0){
-            handle << numeric_limits<T>::max();
-        } else {
-            handle << p.second;
-        }
-
-        handle << "\n";
-    }
-    handle.close();
+    utility::save_results<T, negative_scores>(result, dump2file);
 }
 
 /*****************************************************************************
  *                                                                           *
- *  BFS                                                                      *
+ *  Kernels                                                                  *
  *                                                                           *
  *****************************************************************************/
-// Implementation based on the reference BFS for the GAP Benchmark Suite
-// https://github.com/sbeamer/gapbs
-// The reference implementation has been written by Scott Beamer
-//
-// Copyright (c) 2015, The Regents of the University of California (Regents)
-// All Rights Reserved.
-//
-// Redistribution and use in source and binary forms, with or without
-// modification, are permitted provided that the following conditions are met:
-// 1. Redistributions of source code must retain the above copyright
-//    notice, this list of conditions and the following disclaimer.
-// 2. Redistributions in binary form must reproduce the above copyright
-//    notice, this list of conditions and the following disclaimer in the
-//    documentation and/or other materials provided with the distribution.
-// 3. Neither the name of the Regents nor the
-//    names of its contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
-// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
-// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-// DISCLAIMED. IN NO EVENT SHALL REGENTS BE LIABLE FOR ANY
-// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
-// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
-// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
-// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-
-/*
-
-Will return parent array for a BFS traversal from a source vertex
-This BFS implementation makes use of the Direction-Optimizing approach [1].
-It uses the alpha and beta parameters to determine whether to switch search
-directions. For representing the frontier, it uses a SlidingQueue for the
-top-down approach and a Bitmap for the bottom-up approach. To reduce
-false-sharing for the top-down approach, thread-local QueueBuffer's are used.
-To save time computing the number of edges exiting the frontier, this
-implementation precomputes the degrees in bulk at the beginning by storing
-them in parent array as negative numbers. Thus the encoding of parent is:
-  parent[x] < 0 implies x is unvisited and parent[x] = -out_degree(x)
-  parent[x] >= 0 implies x been visited
-[1] Scott Beamer, Krste Asanović, and David Patterson. "Direction-Optimizing
-    Breadth-First Search." International Conference on High Performance
-    Computing, Networking, Storage and Analysis (SC), Salt Lake City, Utah,
-    November 2012.
-
-*/
-
-//#define DEBUG_BFS
-#if defined(DEBUG_BFS)
-#define COUT_DEBUG_BFS(msg) COUT_DEBUG(msg)
-#else
-#define COUT_DEBUG_BFS(msg)
-#endif
-
+// All kernels of the Graphalytics suite are implemented in library/common/kernels.hpp. This adapter exposes the CSR
+// arrays through the view expected by the kernels, everything is inlined in the kernels.
+class CSR::View {
+    const CSR* m_csr;
 
-int64_t CSR::do_bfs_BUStep(int64_t* distances, int64_t distance, gapbs::Bitmap &front, gapbs::Bitmap &next) const {
-    int64_t awake_count = 0;
-    next.reset();
-    uint64_t* __restrict in_e = m_in_e;
-
-    #pragma omp parallel for schedule(dynamic, 1024) reduction(+ : awake_count)
-    for (uint64_t u = 0; u < m_num_vertices; u++) {
-        COUT_DEBUG_BFS("explore " << u << " [external vertex = " << m_log2ext[u] << "], distance: " << distances[u]);
-
-        if (distances[u] < 0){ // the node has not been visited yet
-            auto in_interval = get_in_interval(u);
-            uint64_t degree = in_interval.second - in_interval.first;
-            if(degree == 0) continue;
-
-            for(uint64_t i = in_interval.first; i < in_interval.second; i++){
-                uint64_t dst = in_e[i];
-                COUT_DEBUG_BFS("\tincoming edge: " << dst << " [external vertex = " << m_log2ext[dst] << "]");
+    static uint64_t interval_start(const uint64_t* __restrict vertex_array, uint64_t logical_vertex_id){
+        return logical_vertex_id == 0 ? 0 : vertex_array[logical_vertex_id -1];
+    }
 
-                if(front.get_bit(dst)) {
-                    COUT_DEBUG_BFS("\t-> distance updated to " << distance << " via vertex #" << dst << " [external vertex = " << m_log2ext[dst] << "]");
-                    distances[u] = distance; // on each BUStep, all nodes will have the same distance
-                    awake_count++;
-                    next.set_bit(u);
-                    break;
-                }
-            }
+    template<typename F>
+    static void for_each_neighbour(const uint64_t* __restrict vertex_array, const uint64_t* __restrict edge_array, uint64_t logical_vertex_id, F&& f){
+        for(uint64_t i = interval_start(vertex_array, logical_vertex_id), end = vertex_array[logical_vertex_id]; i < end; i++){
+            if(!f(edge_array[i])) break;
         }
     }
 
-    return awake_count;
-}
-
-int64_t CSR::do_bfs_TDStep(int64_t* distances, int64_t distance, gapbs::SlidingQueue<int64_t>& queue) const {
-    int64_t scout_count = 0;
-    uint64_t* __restrict out_e = m_out_e;
+public:
+    View(const CSR* csr) : m_csr(csr) { }
 
-    #pragma omp parallel reduction(+ : scout_count)
-    {
-        gapbs::QueueBuffer<int64_t> lqueue(queue);
-
-        #pragma omp for schedule(dynamic, 64)
-        for (auto q_iter = queue.begin(); q_iter < queue.end(); q_iter++) {
-            int64_t u = *q_iter;
-            COUT_DEBUG_BFS("explore: " << u << " [external vertex = "  << m_log2ext[u] << "]");
-            auto out_interval = get_out_interval(u);
-            uint64_t degree = out_interval.second - out_interval.first;
-            if(degree == 0) continue;
-
-            for(uint64_t i = out_interval.first; i < out_interval.second; i++){
-                uint64_t dst = out_e[i];
-                COUT_DEBUG_BFS("\toutgoing edge: " << dst << " [external vertex = " << m_log2ext[dst] << "]");
-
-                int64_t curr_val = distances[dst];
-                if (curr_val < 0 && gapbs::compare_and_swap(distances[dst], curr_val, distance)) {
-                    COUT_DEBUG_BFS("\t-> distance updated to " << distance << " via vertex #" << dst << " [external vertex = " << m_log2ext[dst] << "]");
-                    lqueue.push_back(dst);
-                    scout_count += -curr_val;
-                }
-            }
-        }
+    uint64_t num_vertices() const { return m_csr->m_num_vertices; }
+    bool has_vertex(uint64_t v) const { return true; } // the logical IDs are dense
+    uint64_t num_edges() const { return m_csr->m_num_edges; }
+    bool is_directed() const { return m_csr->m_is_directed; }
+    void on_thread_enter() const { } // the arrays are read directly, without a per-thread context
+    void on_thread_leave() const { }
 
-        lqueue.flush();
+    uint64_t out_degree(uint64_t v) const {
+        return m_csr->m_out_v[v] - interval_start(m_csr->m_out_v, v);
     }
 
-    return scout_count;
-}
+    uint64_t in_degree(uint64_t v) const {
+        return m_csr->m_in_v[v] - interval_start(m_csr->m_in_v, v);
+    }
 
-void CSR::do_bfs_QueueToBitmap(const gapbs::SlidingQueue<int64_t> &queue, gapbs::Bitmap &bm) const {
-    #pragma omp parallel for
-    for (auto q_iter = queue.begin(); q_iter < queue.end(); q_iter++) {
-        int64_t u = *q_iter;
-        bm.set_bit_atomic(u);
+    template<typename F>
+    void for_each_out_neighbour(uint64_t v, F&& f) const {
+        for_each_neighbour(m_csr->m_out_v, m_csr->m_out_e, v, f);
     }
-}
 
-void CSR::do_bfs_BitmapToQueue(const gapbs::Bitmap &bm, gapbs::SlidingQueue<int64_t> &queue) const {
-    #pragma omp parallel
-    {
-        gapbs::QueueBuffer<int64_t> lqueue(queue);
-        #pragma omp for
-        for (uint64_t n=0; n < m_num_vertices; n++)
-            if (bm.get_bit(n))
-                lqueue.push_back(n);
-        lqueue.flush();
+    template<typename F>
+    void for_each_in_neighbour(uint64_t v, F&& f) const {
+        for_each_neighbour(m_csr->m_in_v, m_csr->m_in_e, v, f);
     }
-    queue.slide_window();
-}
 
-unique_ptr<int64_t[]> CSR::do_bfs_init_distances() const {
-    unique_ptr<int64_t[]> distances{ new int64_t[m_num_vertices] };
-    #pragma omp parallel for
-    for (uint64_t n = 0; n < m_num_vertices; n++){
-        int64_t out_degree = get_out_degree(n);
-        distances[n] = out_degree != 0 ? - out_degree : -1;
-    }
-    return distances;
-}
-
-unique_ptr<int64_t[]> CSR::do_bfs(uint64_t root, utility::TimeoutService& timer, int alpha, int beta) const {
-    // The implementation from GAP BS reports the parent (which indeed it should make more sense), while the one required by
-    // Graphalytics only returns the distance
-    unique_ptr<int64_t[]> ptr_distances = do_bfs_init_distances();
-    int64_t* __restrict distances = ptr_distances.get();
-    distances[root] = 0;
-
-    gapbs::SlidingQueue<int64_t> queue(m_num_vertices);
-    queue.push_back(root);
-    queue.slide_window();
-    gapbs::Bitmap curr(m_num_vertices);
-    curr.reset();
-    gapbs::Bitmap front(m_num_vertices);
-    front.reset();
-    int64_t edges_to_check = m_num_edges; //g.num_edges_directed();
-    int64_t scout_count = get_out_degree(root);
-    int64_t distance = 1; // current distance
-    while (!timer.is_timeout() && !queue.empty()) {
-
-        if (scout_count > edges_to_check / alpha) {
-            int64_t awake_count, old_awake_count;
-            do_bfs_QueueToBitmap(queue, front);
-            awake_count = queue.size();
-            queue.slide_window();
-            do {
-                old_awake_count = awake_count;
-                awake_count = do_bfs_BUStep(distances, distance, front, curr);
-                front.swap(curr);
-                distance++;
-            } while ((awake_count >= old_awake_count) || (awake_count > (int64_t) m_num_vertices / beta));
-            do_bfs_BitmapToQueue(front, queue);
-            scout_count = 1;
-        } else {
-            edges_to_check -= scout_count;
-            scout_count = do_bfs_TDStep(distances, distance, queue);
-            queue.slide_window();
-            distance++;
+    template<typename F>
+    void for_each_out_edge(uint64_t v, F&& f) const {
+        const uint64_t* __restrict out_e = m_csr->m_out_e;
+        const double* __restrict out_w = m_csr->m_out_w;
+        for(uint64_t i = interval_start(m_csr->m_out_v, v), end = m_csr->m_out_v[v]; i < end; i++){
+            if(!f(out_e[i], out_w[i])) break;
         }
     }
+};
 
-    return ptr_distances;
+/*****************************************************************************
+ *                                                                           *
+ *  BFS                                                                      *
+ *                                                                           *
+ *****************************************************************************/
+void CSR::bfs(uint64_t external_source_id, const char* dump2file) {
+    bfs_impl(View{ this }, external_source_id, dump2file);
 }
 
-void CSR::bfs(uint64_t external_source_id, const char* dump2file) {
+template<typename V>
+void CSR::bfs_impl(const V& view, uint64_t external_source_id, const char* dump2file) {
     // Init
     utility::TimeoutService timeout { m_timeout };
     Timer timer; timer.start();
-    uint64_t root = m_ext2log.at(external_source_id);
-    COUT_DEBUG_BFS("root: " << root << " [external vertex: " << external_source_id << "]");
+    uint64_t root = ext2log(external_source_id);
+    if(root == numeric_limits<uint64_t>::max()){ INVALID_ARGUMENT("The source vertex " << external_source_id << " does not exist"); }
 
     // Run the BFS algorithm
-    unique_ptr<int64_t[]> ptr_result = do_bfs(root, timeout);
+    unique_ptr<int64_t[]> ptr_result = kernels::bfs(view, root, timeout);
     if(timeout.is_timeout()){ RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);  }
 
     // Translate the logical IDs into the external IDs
@@ -698,111 +857,18 @@ void CSR::bfs(uint64_t external_source_id, const char* dump2file) {
  *  PageRank                                                                 *
  *                                                                           *
  *****************************************************************************/
-//#define DEBUG_PAGERANK
-#if defined(DEBUG_PAGERANK)
-#define COUT_DEBUG_PAGERANK(msg) COUT_DEBUG(msg)
-#else
-#define COUT_DEBUG_PAGERANK(msg)
-#endif
-
-// Implementation based on the reference PageRank for the GAP Benchmark Suite
-// https://github.com/sbeamer/gapbs
-// The reference implementation has been written by Scott Beamer
-//
-// Copyright (c) 2015, The Regents of the University of California (Regents)
-// All Rights Reserved.
-//
-// Redistribution and use in source and binary forms, with or without
-// modification, are permitted provided that the following conditions are met:
-// 1. Redistributions of source code must retain the above copyright
-//    notice, this list of conditions and the following disclaimer.
-// 2. Redistributions in binary form must reproduce the above copyright
-//    notice, this list of conditions and the following disclaimer in the
-//    documentation and/or other materials provided with the distribution.
-// 3. Neither the name of the Regents nor the
-//    names of its contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
-// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
-// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-// DISCLAIMED. IN NO EVENT SHALL REGENTS BE LIABLE FOR ANY
-// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
-// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
-// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
-// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-
-/*
-GAP Benchmark Suite
-Kernel: PageRank (PR)
-Author: Scott Beamer
-
-Will return pagerank scores for all vertices once total change < epsilon
-
-This PR implementation uses the traditional iterative approach. This is done
-to ease comparisons to other implementations (often use same algorithm), but
-it is not necesarily the fastest way to implement it. It does perform the
-updates in the pull direction to remove the need for atomics.
-*/
-
-unique_ptr<double[]> CSR::do_pagerank(uint64_t num_iterations, double damping_factor, utility::TimeoutService& timer) const {
-    const double init_score = 1.0 / m_num_vertices;
-    const double base_score = (1.0 - damping_factor) / m_num_vertices;
-
-    unique_ptr<double[]> ptr_scores{ new double[m_num_vertices]() }; // avoid memory leaks
-    double* scores = ptr_scores.get();
-    #pragma omp parallel for
-    for(uint64_t v = 0; v < m_num_vertices; v++){
-        scores[v] = init_score;
-    }
-    gapbs::pvector<double> outgoing_contrib(m_num_vertices, 0.0);
-    uint64_t* __restrict in_e = m_in_e;
-
-    // pagerank iterations
-    for(uint64_t iteration = 0; iteration < num_iterations && !timer.is_timeout(); iteration++){
-        double dangling_sum = 0.0;
-
-        // for each node, precompute its contribution to all of its outgoing neighbours and, if it's a sink,
-        // add its rank to the `dangling sum' (to be added to all nodes).
-        #pragma omp parallel for reduction(+:dangling_sum)
-        for(uint64_t v = 0; v < m_num_vertices; v++){
-            uint64_t out_degree = get_out_degree(v);
-            if(out_degree == 0){ // this is a sink
-                dangling_sum += scores[v];
-            } else {
-                outgoing_contrib[v] = scores[v] / out_degree;
-            }
-        }
-
-        dangling_sum /= m_num_vertices;
-
-        // compute the new score for each node in the graph
-        #pragma omp parallel for schedule(dynamic, 64)
-        for(uint64_t v = 0; v < m_num_vertices; v++){
-            auto in_interval = get_in_interval(v);
-            double incoming_total = 0;
-            for(uint64_t i = in_interval.first; i < in_interval.second; i++){
-                uint64_t u = in_e[i];
-                incoming_total += outgoing_contrib[u];
-            }
-
-            // update the score
-            scores[v] = base_score + damping_factor * (incoming_total + dangling_sum);
-        }
-    }
-
-    return ptr_scores;
+void CSR::pagerank(uint64_t num_iterations, double damping_factor, const char* dump2file) {
+    pagerank_impl(View{ this }, num_iterations, damping_factor, dump2file);
 }
 
-void CSR::pagerank(uint64_t num_iterations, double damping_factor, const char* dump2file) {
+template<typename V>
+void CSR::pagerank_impl(const V& view, uint64_t num_iterations, double damping_factor, const char* dump2file) {
     // Init
     utility::TimeoutService timeout { m_timeout };
     Timer timer; timer.start();
 
     // Run the PageRank algorithm
-    unique_ptr<double[]> ptr_result = do_pagerank(num_iterations, damping_factor, timeout);
+    unique_ptr<double[]> ptr_result = kernels::pagerank(view, num_iterations, damping_factor, timeout);
     if(timeout.is_timeout()){ RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);  }
 
     // retrieve the external node ids
@@ -820,121 +886,18 @@ void CSR::pagerank(uint64_t num_iterations, double damping_factor, const char* d
  *  WCC                                                                      *
  *                                                                           *
  *****************************************************************************/
-// Implementation based on the reference WCC for the GAP Benchmark Suite
-// https://github.com/sbeamer/gapbs
-// The reference implementation has been written by Scott Beamer
-//
-// Copyright (c) 2015, The Regents of the University of California (Regents)
-// All Rights Reserved.
-//
-// Redistribution and use in source and binary forms, with or without
-// modification, are permitted provided that the following conditions are met:
-// 1. Redistributions of source code must retain the above copyright
-//    notice, this list of conditions and the following disclaimer.
-// 2. Redistributions in binary form must reproduce the above copyright
-//    notice, this list of conditions and the following disclaimer in the
-//    documentation and/or other materials provided with the distribution.
-// 3. Neither the name of the Regents nor the
-//    names of its contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
-// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
-// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-// DISCLAIMED. IN NO EVENT SHALL REGENTS BE LIABLE FOR ANY
-// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
-// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
-// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
-// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-
-
-//#define DEBUG_WCC
-#if defined(DEBUG_WCC)
-#define COUT_DEBUG_WCC(msg) COUT_DEBUG(msg)
-#else
-#define COUT_DEBUG_WCC(msg)
-#endif
-
-/*
-GAP Benchmark Suite
-Kernel: Connected Components (CC)
-Author: Scott Beamer
-
-Will return comp array labelling each vertex with a connected component ID
-
-This CC implementation makes use of the Shiloach-Vishkin [2] algorithm with
-implementation optimizations from Bader et al. [1]. Michael Sutton contributed
-a fix for directed graphs using the min-max swap from [3], and it also produces
-more consistent performance for undirected graphs.
-
-[1] David A Bader, Guojing Cong, and John Feo. "On the architectural
-    requirements for efficient execution of graph algorithms." International
-    Conference on Parallel Processing, Jul 2005.
-
-[2] Yossi Shiloach and Uzi Vishkin. "An o(logn) parallel connectivity algorithm"
-    Journal of Algorithms, 3(1):57–67, 1982.
-
-[3] Kishore Kothapalli, Jyothish Soman, and P. J. Narayanan. "Fast GPU
-    algorithms for graph connectivity." Workshop on Large Scale Parallel
-    Processing, 2010.
-*/
-
-// The hooking condition (comp_u < comp_v) may not coincide with the edge's
-// direction, so we use a min-max swap such that lower component IDs propagate
-// independent of the edge's direction.
-unique_ptr<uint64_t[]> CSR::do_wcc(utility::TimeoutService& timer) const {
-    // init
-    unique_ptr<uint64_t[]> ptr_components { new uint64_t[m_num_vertices] };
-    uint64_t* comp = ptr_components.get();
-    uint64_t* __restrict out_e = m_out_e;
-
-    #pragma omp parallel for
-    for (uint64_t n = 0; n < m_num_vertices; n++){
-        comp[n] = n;
-    }
-
-    bool change = true;
-    while (change && !timer.is_timeout()) {
-        change = false;
-
-        #pragma omp parallel for schedule(dynamic, 64)
-        for (uint64_t u = 0; u < m_num_vertices; u++){
-            auto out_interval = get_out_interval(u);
-            for(uint64_t i = out_interval.first; i < out_interval.second; i++){
-                uint64_t v = out_e[i];
-
-                uint64_t comp_u = comp[u];
-                uint64_t comp_v = comp[v];
-                if (comp_u == comp_v) continue;
-                // Hooking condition so lower component ID wins independent of direction
-                uint64_t high_comp = std::max(comp_u, comp_v);
-                uint64_t low_comp = std::min(comp_u, comp_v);
-                if (high_comp == comp[high_comp]) {
-                    change = true;
-                    comp[high_comp] = low_comp;
-                }
-            }
-        }
-
-        #pragma omp parallel for schedule(dynamic, 64)
-        for (uint64_t n = 0; n < m_num_vertices; n++){
-            while (comp[n] != comp[comp[n]]) {
-                comp[n] = comp[comp[n]];
-            }
-        }
-    }
-
-    return ptr_components;
+void CSR::wcc(const char* dump2file) {
+    wcc_impl(View{ this }, dump2file);
 }
 
-void CSR::wcc(const char* dump2file) {
+template<typename V>
+void CSR::wcc_impl(const V& view, const char* dump2file) {
     utility::TimeoutService timeout { m_timeout };
     Timer timer; timer.start();
 
     // run wcc
-    unique_ptr<uint64_t[]> ptr_components = do_wcc(timeout);
+    unique_ptr<uint64_t[]> ptr_components = kernels::wcc(view, timeout);
+    if(timeout.is_timeout()){ RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer); }
 
     // retrieve the external node ids
     auto translation = translate(ptr_components.get(), m_num_vertices);
@@ -951,80 +914,18 @@ void CSR::wcc(const char* dump2file) {
  *  CDLP                                                                     *
  *                                                                           *
  *****************************************************************************/
-// same impl~ as the one done for llama
-unique_ptr<uint64_t[]> CSR::do_cdlp(uint64_t max_iterations, utility::TimeoutService& timer) const {
-   unique_ptr<uint64_t[]> ptr_labels0 { new uint64_t[m_num_vertices] };
-   unique_ptr<uint64_t[]> ptr_labels1 { new uint64_t[m_num_vertices] };
-   uint64_t* labels0 = ptr_labels0.get(); // current labels
-   uint64_t* labels1 = ptr_labels1.get(); // labels for the next iteration
-
-   // initialisation
-   #pragma omp parallel for
-   for(uint64_t v = 0; v < m_num_vertices; v++){
-       labels0[v] = m_log2ext[v];
-   }
-
-   // algorithm pass
-   bool change = true;
-   uint64_t current_iteration = 0;
-   uint64_t* __restrict out_e = m_out_e;
-   uint64_t* __restrict in_e = m_in_e;
-   while(current_iteration < max_iterations && change && !timer.is_timeout()){
-       change = false; // reset the flag
-
-       #pragma omp parallel for schedule(dynamic, 64) shared(change)
-       for(uint64_t v = 0; v < m_num_vertices; v++){
-           unordered_map<uint64_t, uint64_t> histogram;
-
-           // compute the histogram from both the outgoing & incoming edges. The aim is to find the number of each label
-           // is shared among the neighbours of node_id
-           auto out_interval = get_out_interval(v);
-           for(uint64_t i = out_interval.first; i < out_interval.second; i++){
-               uint64_t u = out_e[i];
-               histogram[labels0[u]]++;
-           }
-
-           // cfr. Spec v0.9 pp 14 "If the graph is directed and a neighbor is reachable via both an incoming and
-           // outgoing edge, its label will be counted twice"
-           if(m_is_directed){
-               auto in_interval = get_in_interval(v);
-               for(uint64_t i = in_interval.first; i < in_interval.second; i++){
-                   uint64_t u = in_e[i];
-                   histogram[labels0[u]]++;
-               }
-           }
-
-           // get the max label
-           uint64_t label_max = numeric_limits<int64_t>::max();
-           uint64_t count_max = 0;
-           for(const auto pair : histogram){
-               if(pair.second > count_max || (pair.second == count_max && pair.first < label_max)){
-                   label_max = pair.first;
-                   count_max = pair.second;
-               }
-           }
-
-           labels1[v] = label_max;
-           change |= (labels0[v] != labels1[v]);
-       }
-
-       std::swap(labels0, labels1); // next iteration
-       current_iteration++;
-   }
-
-   if(labels0 == ptr_labels0.get()){
-       return ptr_labels0;
-   } else {
-       return ptr_labels1;
-   }
+void CSR::cdlp(uint64_t max_iterations, const char* dump2file) {
+    cdlp_impl(View{ this }, max_iterations, dump2file);
 }
 
-void CSR::cdlp(uint64_t max_iterations, const char* dump2file) {
+template<typename V>
+void CSR::cdlp_impl(const V& view, uint64_t max_iterations, const char* dump2file) {
     utility::TimeoutService timeout { m_timeout };
     Timer timer; timer.start();
 
-    // Run the CDLP algorithm
-    unique_ptr<uint64_t[]> labels = do_cdlp(max_iterations, timeout);
+    // Run the CDLP algorithm, the labels are initialised to the external vertex IDs
+    const uint64_t* __restrict log2ext = m_log2ext;
+    unique_ptr<uint64_t[]> labels = kernels::cdlp(view, max_iterations, [log2ext](uint64_t v){ return log2ext[v]; }, timeout);
     if(timeout.is_timeout()){ RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);  }
 
     // Translate the vertex IDs
@@ -1042,167 +943,17 @@ void CSR::cdlp(uint64_t max_iterations, const char* dump2file) {
  *  LCC                                                                      *
  *                                                                           *
  *****************************************************************************/
-//#define DEBUG_LCC
-#if defined(DEBUG_LCC)
-#define COUT_DEBUG_LCC(msg) COUT_DEBUG(msg)
-#else
-#define COUT_DEBUG_LCC(msg)
-#endif
-
-unique_ptr<double[]> CSR::do_lcc(utility::TimeoutService& timer) const {
-    if(m_is_directed){
-        return do_lcc_directed(timer);
-    } else {
-        return do_lcc_undirected(timer);
-    }
-}
-
-// loosely based on the impl~ made for GraphOne
-unique_ptr<double[]> CSR::do_lcc_directed(utility::TimeoutService& timer) const {
-    assert(m_is_directed && "Implementation for directed graphs");
-
-    unique_ptr<double[]> ptr_lcc { new double[m_num_vertices] };
-    double* lcc = ptr_lcc.get();
-    uint64_t* __restrict out_e = m_out_e;
-    uint64_t* __restrict in_e = m_in_e;
-
-    #pragma omp parallel
-    {
-        std::vector<uint64_t> edges;
-
-        #pragma omp for schedule(dynamic, 64)
-        for(uint64_t v = 0; v < m_num_vertices; v++){
-            COUT_DEBUG_LCC("> Node " << v);
-            if(timer.is_timeout()) continue; // exhausted the budget of available time
-            lcc[v] = 0.0;
-            uint64_t num_triangles = 0; // number of triangles found so far for the node v
-
-            // Cfr. Spec v.0.9.0 pp. 15: "If the number of neighbors of a vertex is less than two, its coefficient is defined as zero"
-            uint64_t v_degree_out = get_out_degree(v);
-            uint64_t v_degree_in = get_in_degree(v);
-            uint64_t v_degree_ub = v_degree_in + v_degree_out; // upper bound for directed graphs, exact degree for those undirected
-            if(v_degree_ub < 2) continue;
-
-            // Build the list of neighbours of v
-            unordered_set<uint64_t> neighbours;
-            edges.clear();
-            edges.reserve(v_degree_ub);
-
-            // Outgoing edges
-            auto out_interval = get_out_interval(v);
-            for(uint64_t i = out_interval.first; i < out_interval.second; i++){
-                uint64_t u = out_e[i];
-                edges.push_back(u);
-                neighbours.insert(u);
-            }
-
-            // Incoming edges (only directed graphs)
-            auto in_interval = get_in_interval(v);
-            for(uint64_t i = in_interval.first; i < in_interval.second; i++){
-                uint64_t u = in_e[i];
-                auto result = neighbours.insert(u);
-                if(result.second){ // the element was actually inserted
-                    edges.push_back(u);
-                }
-            }
-            const uint64_t v_degree = edges.size();
-
-            // Now we know is the actual degree of v, perform the proper check for directed graphs
-            if(v_degree  < 2) continue;
-
-            // again, visit all neighbours of v
-            // for directed graphs, edges1 contains the intersection of both the incoming and the outgoing edges
-            for(uint64_t i = 0, end = v_degree; i < end; i++){
-                uint64_t u = edges[i];
-                COUT_DEBUG_LCC("[" << i << "/" << edges.size() << "] neighbour: " << u);
-                assert(neighbours.count(u) == 1 && "The set `neighbours' should contain all neighbours of v");
-
-                // For the Graphalytics spec v 0.9.0, only consider the outgoing edges for the neighbours u
-                auto u_out_interval = get_out_interval(u);
-
-                for(uint64_t j = u_out_interval.first; j < u_out_interval.second; j++){
-                    uint64_t w = out_e[j];
-                    COUT_DEBUG_LCC("---> [" << j << "/" << /* degree */ (u_out_interval.second - u_out_interval.first) << "] neighbour: " << w);
-                    // check whether it's also a neighbour of v
-                    if(neighbours.count(w) == 1){
-                        COUT_DEBUG_LCC("Triangle found " << v << " - " << u << " - " << w);
-                        num_triangles++;
-                    }
-                }
-            }
-
-            // register the final score
-            uint64_t max_num_edges = v_degree * (v_degree -1);
-            lcc[v] = static_cast<double>(num_triangles) / max_num_edges;
-            COUT_DEBUG_LCC("Score computed: " << (num_triangles) << "/" << max_num_edges << " = " << lcc[v]);
-        }
-    }
-
-    return ptr_lcc;
-}
-
-unique_ptr<double[]> CSR::do_lcc_undirected(utility::TimeoutService& timer) const {
-    assert(!m_is_directed && "Implementation for undirected graphs");
-
-    unique_ptr<double[]> ptr_lcc { new double[m_num_vertices] };
-    double* lcc = ptr_lcc.get();
-    uint64_t* __restrict out_e = m_out_e;
-
-    #pragma omp parallel for schedule(dynamic, 64)
-    for(uint64_t v = 0; v < m_num_vertices; v++){
-        COUT_DEBUG_LCC("> Node " << v);
-        if(timer.is_timeout()) continue; // exhausted the budget of available time
-        lcc[v] = 0.0;
-        uint64_t num_triangles = 0; // number of triangles found so far for the node v
-
-        // Cfr. Spec v.0.9.0 pp. 15: "If the number of neighbors of a vertex is less than two, its coefficient is defined as zero"
-        uint64_t v_degree_out = get_out_degree(v);
-        if(v_degree_out < 2) continue;
-
-        // Build the list of neighbours of v
-        unordered_set<uint64_t> neighbours;
-
-        // Outgoing edges
-        auto out_interval = get_out_interval(v);
-        for(uint64_t i = out_interval.first; i < out_interval.second; i++){
-            uint64_t u = out_e[i];
-            neighbours.insert(u);
-        }
-
-        // again, visit all neighbours of v
-        for(uint64_t i = out_interval.first; i < out_interval.second; i++){
-            uint64_t u = out_e[i];
-            COUT_DEBUG_LCC("[" << (i - out_interval.first) << "/" << v_degree_out << "] neighbour: " << u);
-            assert(neighbours.count(u) == 1 && "The set `neighbours' should contain all neighbours of v");
-
-            // For the Graphalytics spec v 0.9.0, only consider the outgoing edges for the neighbours u
-            auto u_out_interval = get_out_interval(u);
-
-            for(uint64_t j = u_out_interval.first; j < u_out_interval.second; j++){
-                uint64_t w = out_e[j];
-                COUT_DEBUG_LCC("---> [" << j << "/" << /* degree */ (u_out_interval.second - u_out_interval.first) << "] neighbour: " << w);
-                // check whether it's also a neighbour of v
-                if(neighbours.count(w) == 1){
-                    COUT_DEBUG_LCC("Triangle found " << v << " - " << u << " - " << w);
-                    num_triangles++;
-                }
-            }
-        }
-
-        // register the final score
-        uint64_t max_num_edges = v_degree_out * (v_degree_out -1);
-        lcc[v] = static_cast<double>(num_triangles) / max_num_edges;
-        COUT_DEBUG_LCC("Score computed: " << (num_triangles) << "/" << max_num_edges << " = " << lcc[v]);
-    }
-    return ptr_lcc;
+void CSR::lcc(const char* dump2file) {
+    lcc_impl(View{ this }, dump2file);
 }
 
-void CSR::lcc(const char* dump2file) {
+template<typename V>
+void CSR::lcc_impl(const V& view, const char* dump2file) {
     utility::TimeoutService timeout { m_timeout };
     Timer timer; timer.start();
 
     // Run the LCC algorithm
-    unique_ptr<double[]> scores = do_lcc(timeout);
+    unique_ptr<double[]> scores = kernels::lcc(view, timeout);
     if(timeout.is_timeout()){ RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);  }
 
     auto translation = translate(scores.get(), m_num_vertices);
@@ -1219,134 +970,21 @@ void CSR::lcc(const char* dump2file) {
  *  SSSP                                                                     *
  *                                                                           *
  *****************************************************************************/
-// Implementation based on the reference SSSP for the GAP Benchmark Suite
-// https://github.com/sbeamer/gapbs
-// The reference implementation has been written by Scott Beamer
-//
-// Copyright (c) 2015, The Regents of the University of California (Regents)
-// All Rights Reserved.
-//
-// Redistribution and use in source and binary forms, with or without
-// modification, are permitted provided that the following conditions are met:
-// 1. Redistributions of source code must retain the above copyright
-//    notice, this list of conditions and the following disclaimer.
-// 2. Redistributions in binary form must reproduce the above copyright
-//    notice, this list of conditions and the following disclaimer in the
-//    documentation and/or other materials provided with the distribution.
-// 3. Neither the name of the Regents nor the
-//    names of its contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
-// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
-// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-// DISCLAIMED. IN NO EVENT SHALL REGENTS BE LIABLE FOR ANY
-// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
-// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
-// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
-// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-
-using NodeID = uint64_t;
-using WeightT = double;
-static const size_t kMaxBin = numeric_limits<size_t>::max()/2;
-
-gapbs::pvector<WeightT> CSR::do_sssp(uint64_t source, double delta, utility::TimeoutService& timer) const {
-    // Init
-    gapbs::pvector<WeightT> dist(num_vertices(), numeric_limits<WeightT>::infinity());
-    dist[source] = 0;
-    gapbs::pvector<NodeID> frontier(num_edges());
-    // two element arrays for double buffering curr=iter&1, next=(iter+1)&1
-    size_t shared_indexes[2] = {0, kMaxBin};
-    size_t frontier_tails[2] = {1, 0};
-    frontier[0] = source;
-    uint64_t* __restrict out_e = m_out_e;
-    double* __restrict out_w = m_out_w;
-
-    #pragma omp parallel
-    {
-        vector<vector<NodeID> > local_bins(0);
-        size_t iter = 0;
-
-        while (shared_indexes[iter&1] != kMaxBin) {
-            size_t &curr_bin_index = shared_indexes[iter&1];
-            size_t &next_bin_index = shared_indexes[(iter+1)&1];
-            size_t &curr_frontier_tail = frontier_tails[iter&1];
-            size_t &next_frontier_tail = frontier_tails[(iter+1)&1];
-            #pragma omp for nowait schedule(dynamic, 64)
-            for (size_t i=0; i < curr_frontier_tail; i++) {
-                NodeID u = frontier[i];
-                if (dist[u] >= delta * static_cast<WeightT>(curr_bin_index)) {
-                    const auto u_interval = get_out_interval(u);
-                    for(uint64_t i = u_interval.first; i < u_interval.second; i++){
-                        uint64_t v = out_e[i];
-                        double w = out_w[i];
-
-                        WeightT old_dist = dist[v];
-                        WeightT new_dist = dist[u] + w;
-                        if (new_dist < old_dist) {
-                            bool changed_dist = true;
-                            while (!gapbs::compare_and_swap(dist[v], old_dist, new_dist)) {
-                                old_dist = dist[v];
-                                if (old_dist <= new_dist) {
-                                    changed_dist = false;
-                                    break;
-                                }
-                            }
-                            if (changed_dist) {
-                                size_t dest_bin = new_dist/delta;
-                                if (dest_bin >= local_bins.size()) {
-                                    local_bins.resize(dest_bin+1);
-                                }
-                                local_bins[dest_bin].push_back(v);
-                            }
-                        }
-                    }
-                }
-            }
-
-            for (size_t i=curr_bin_index; i < local_bins.size(); i++) {
-                if (!local_bins[i].empty()) {
-                    #pragma omp critical
-                    next_bin_index = min(next_bin_index, i);
-                    break;
-                }
-            }
-
-            #pragma omp barrier
-            #pragma omp single nowait
-            {
-                curr_bin_index = kMaxBin;
-                curr_frontier_tail = 0;
-            }
-
-            if (next_bin_index < local_bins.size()) {
-                size_t copy_start = gapbs::fetch_and_add(next_frontier_tail, local_bins[next_bin_index].size());
-                copy(local_bins[next_bin_index].begin(), local_bins[next_bin_index].end(), frontier.data() + copy_start);
-                local_bins[next_bin_index].resize(0);
-            }
-
-            iter++;
-            #pragma omp barrier
-        }
-
-#if defined(DEBUG)
-        #pragma omp single
-        COUT_DEBUG("took " << iter << " iterations");
-#endif
-    }
-
-    return dist;
+void CSR::sssp(uint64_t source_vertex_id, const char* dump2file) {
+    sssp_impl(View{ this }, source_vertex_id, dump2file);
 }
 
-void CSR::sssp(uint64_t source_vertex_id, const char* dump2file) {
+template<typename V>
+void CSR::sssp_impl(const V& view, uint64_t source_vertex_id, const char* dump2file) {
     utility::TimeoutService timeout { m_timeout };
     Timer timer; timer.start();
 
+    uint64_t root = ext2log(source_vertex_id);
+    if(root == numeric_limits<uint64_t>::max()){ INVALID_ARGUMENT("The source vertex " << source_vertex_id << " does not exist"); }
+
     // Run the SSSP algorithm
     double delta = 2.0; // same value used in the GAPBS, at least for most graphs
-    auto distances = do_sssp(m_ext2log.at(source_vertex_id), delta, timeout);
+    auto distances = kernels::sssp(view, root, delta, timeout);
     if(timeout.is_timeout()){ RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);  }
 
     // Translate the logical IDs into the external IDs
@@ -1562,6 +1200,381 @@ void CSR_LCC::Worker::process_vertex(uint64_t n1) {
     }
 }
 
-} // namespace
+/*****************************************************************************
+ *                                                                           *
+ *  Compressed CSR                                                           *
+ *                                                                           *
+ *****************************************************************************/
+#undef COUT_CLASS_NAME
+#define COUT_CLASS_NAME "CSR_Compressed"
+
+namespace {
+
+/**
+ * Layout of a neighbour list with n blocks:
+ * - n -1 offsets of 4 bytes, the position of the blocks 1 .. n -1 relative to the start of the first block;
+ * - the blocks, each one with its first neighbour as a varint, followed by the gaps of the next neighbours as varints.
+ * The number of neighbours is given by the vertex array of the CSR.
+ */
+constexpr uint64_t BLOCK_SIZE = 64; // number of neighbours in each block
+
+uint64_t num_blocks(uint64_t degree){
+    return (degree + BLOCK_SIZE -1) / BLOCK_SIZE;
+}
+
+uint64_t varint_size(uint64_t value){
+    uint64_t size = 1;
+    while(value >= 0x80){ value >>= 7; size++; }
+    return size;
+}
+
+uint8_t* varint_write(uint8_t* __restrict output, uint64_t value){
+    while(value >= 0x80){
+        *(output++) = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    *(output++) = static_cast<uint8_t>(value);
+    return output;
+}
+
+inline uint64_t varint_read(const uint8_t*& input){
+    uint64_t value = *input & 0x7F;
+    uint64_t shift = 7;
+    while(*(input++) & 0x80){
+        value |= static_cast<uint64_t>(*input & 0x7F) << shift;
+        shift += 7;
+    }
+    return value;
+}
+
+// Encode the given list of sorted neighbours into output, return the number of bytes written. With output == nullptr,
+// only compute the size of the encoding. The caller ensures that the size fits in the 4-byte offsets of the blocks.
+uint64_t encode_list(uint8_t* __restrict output, const uint64_t* __restrict neighbours, uint64_t degree){
+    const uint64_t blocks_sz = num_blocks(degree);
+    const uint64_t header_sz = blocks_sz > 1 ? (blocks_sz -1) * sizeof(uint32_t) : 0;
+    uint64_t size = header_sz;
+    for(uint64_t block = 0; block < blocks_sz; block++){
+        const uint64_t start = block * BLOCK_SIZE;
+        const uint64_t end = min(degree, start + BLOCK_SIZE);
+        if(output != nullptr && block > 0){
+            uint32_t offset = size - header_sz;
+            assert(offset == size - header_sz && "Overflow, the size of the list should have been checked by the caller");
+            memcpy(output + (block -1) * sizeof(uint32_t), &offset, sizeof(offset));
+        }
+        for(uint64_t i = start; i < end; i++){
+            uint64_t value = (i == start) ? neighbours[i] : neighbours[i] - neighbours[i -1];
+            if(output != nullptr){
+                size = varint_write(output + size, value) - output;
+            } else {
+                size += varint_size(value);
+            }
+        }
+    }
+    return size;
+}
+
+// Decode `count' gaps from input, adding them to `value'. Invoke f(u) for each decoded neighbour, return false if the
+// callback stopped the iteration.
+template<typename F>
+inline bool decode_gaps(const uint8_t*& input, uint64_t count, uint64_t value, F&& f){
+    while(count > 0){
+#if defined(__SSE2__)
+        // most gaps in a sorted list take a single byte, decode 16 of them at once with a prefix sum in 16-bit lanes
+        if(count >= 16){ // the list contains at least other 16 bytes
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+            if(_mm_movemask_epi8(bytes) == 0){ // no continuation bits
+                const __m128i zero = _mm_setzero_si128();
+                __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+                __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+                lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 2));
+                hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 2));
+                lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 4));
+                hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 4));
+                lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 8));
+                hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 8));
+                hi = _mm_add_epi16(hi, _mm_set1_epi16(static_cast<int16_t>(_mm_extract_epi16(lo, 7))));
+                alignas(16) uint16_t prefix[16];
+                _mm_store_si128(reinterpret_cast<__m128i*>(prefix), lo);
+                _mm_store_si128(reinterpret_cast<__m128i*>(prefix + 8), hi);
+                for(uint64_t i = 0; i < 16; i++){
+                    if(!f(value + prefix[i])) return false;
+                }
+                value += prefix[15];
+                input += 16;
+                count -= 16;
+                continue;
+            }
+        }
+#endif
+        value += varint_read(input);
+        if(!f(value)) return false;
+        count--;
+    }
+    return true;
+}
+
+// Invoke f(u) for each neighbour u in the given list, until the callback returns false
+template<typename F>
+inline void decode_list(const uint8_t* input, uint64_t degree, F&& f){
+    const uint64_t blocks_sz = num_blocks(degree);
+    if(blocks_sz > 1){ input += (blocks_sz -1) * sizeof(uint32_t); } // skip the offsets of the blocks
+    for(uint64_t start = 0; start < degree; start += BLOCK_SIZE){
+        uint64_t first = varint_read(input);
+        if(!f(first)) return;
+        if(!decode_gaps(input, min(degree - start, BLOCK_SIZE) -1, first, f)) return;
+    }
+}
+
+// Retrieve the position of the neighbour u in the given list, or max() if u is not present
+uint64_t find_neighbour(const uint8_t* input, uint64_t degree, uint64_t u){
+    if(degree == 0) return numeric_limits<uint64_t>::max();
+    const uint64_t blocks_sz = num_blocks(degree);
+    const uint8_t* blocks = input + (blocks_sz -1) * sizeof(uint32_t);
+    auto block_start = [input, blocks](uint64_t block){
+        if(block == 0) return blocks;
+        uint32_t offset;
+        memcpy(&offset, input + (block -1) * sizeof(uint32_t), sizeof(offset));
+        return blocks + offset;
+    };
+
+    // binary search over the first neighbour of each block
+    uint64_t lo = 0, hi = blocks_sz;
+    while(hi - lo > 1){
+        uint64_t mid = (lo + hi) / 2;
+        const uint8_t* ptr = block_start(mid);
+        if(varint_read(ptr) <= u){ lo = mid; } else { hi = mid; }
+    }
+
+    // linear scan inside the block
+    const uint8_t* ptr = block_start(lo);
+    uint64_t value = varint_read(ptr);
+    for(uint64_t i = lo * BLOCK_SIZE, end = min(degree, (lo +1) * BLOCK_SIZE); value <= u; ){
+        if(value == u) return i;
+        if(++i == end) break;
+        value += varint_read(ptr);
+    }
+    return numeric_limits<uint64_t>::max();
+}
+
+} // anon namespace
+
+CSR_Compressed::CSR_Compressed(bool is_directed, Weights weights, bool numa_interleaved) : CSR(is_directed, numa_interleaved), m_weights(weights) {
+
+}
+
+CSR_Compressed::~CSR_Compressed(){
+    free_lists(m_out);
+    if(m_is_directed){ free_lists(m_in); } // otherwise, they are simply aliases to m_out
+}
+
+void CSR_Compressed::free_lists(Lists& lists){
+    free_array(lists.m_bytes); lists.m_bytes = nullptr;
+    free_array(lists.m_offsets); lists.m_offsets = nullptr;
+    free_array(lists.m_weights); lists.m_weights = nullptr;
+}
+
+void CSR_Compressed::load(const std::string& path){
+    CSR::load(path);
+    compress();
+}
+
+void CSR_Compressed::load(gfe::graph::WeightedEdgeStream& stream){
+    CSR::load(stream);
+    compress();
+}
+
+void CSR_Compressed::open(const std::string& path, bool populate){
+    CSR::open(path, populate);
+    compress();
+}
+
+void CSR_Compressed::save(const std::string& path, const std::string& path_source) const {
+    ERROR("[CSR_Compressed] Snapshots are not supported, create the snapshot with the plain CSR");
+}
+
+void CSR_Compressed::compress(){
+    Timer timer; timer.start();
+    const uint64_t num_edge_entries = m_is_directed ? m_num_edges : 2 * m_num_edges;
+
+    compress(m_out_v, m_out_e, m_out_w, num_edge_entries, m_out);
+    if(m_is_directed){
+        compress(m_in_v, m_in_e, m_in_w, num_edge_entries, m_in);
+    } else {
+        m_in = m_out;
+    }
+    release_edge_arrays();
+
+    timer.stop();
+    LOG("[CSR_Compressed] Neighbour lists compressed in " << timer << ", size: " << m_num_bytes << " bytes, " <<
+            bytes_per_edge() << " bytes per edge (plain CSR: " << sizeof(uint64_t) << " bytes per edge), weights: " <<
+            (m_weights == Weights::FLOAT32 ? "float" : "not stored"));
+}
+
+void CSR_Compressed::compress(const uint64_t* vertex_array, const uint64_t* edge_array, const double* weight_array, uint64_t num_edge_entries, Lists& lists){
+    // size of the encoding for each vertex
+    uint64_t* __restrict offsets = lists.m_offsets = alloca_array<uint64_t>(m_num_vertices +1); // init to 0
+    uint64_t max_list_sz = 0;
+    #pragma omp parallel for schedule(dynamic, 4096) reduction(max:max_list_sz)
+    for(uint64_t v = 0; v < m_num_vertices; v++){
+        auto interval = get_interval_impl(vertex_array, v);
+        offsets[v +1] = encode_list(nullptr, edge_array + interval.first, interval.second - interval.first);
+        max_list_sz = max(max_list_sz, offsets[v +1]);
+    }
+    // the blocks are addressed by offsets of 4 bytes, check before encoding as an error cannot escape the parallel region
+    if(max_list_sz > numeric_limits<uint32_t>::max()){ ERROR("[CSR_Compressed] Neighbour list too long: " << max_list_sz << " bytes"); }
+    gfe::graph::parallel_prefix_sum(offsets +1, m_num_vertices);
+
+    // encode the lists
+    const uint64_t num_bytes = offsets[m_num_vertices];
+    uint8_t* __restrict bytes = lists.m_bytes = alloca_array<uint8_t>(num_bytes);
+    #pragma omp parallel for schedule(dynamic, 4096)
+    for(uint64_t v = 0; v < m_num_vertices; v++){
+        auto interval = get_interval_impl(vertex_array, v);
+        encode_list(bytes + offsets[v], edge_array + interval.first, interval.second - interval.first);
+    }
+    m_num_bytes += num_bytes;
+
+    // weights
+    if(m_weights == Weights::FLOAT32){
+        float* __restrict weights = lists.m_weights = alloca_array<float>(num_edge_entries);
+        #pragma omp parallel for schedule(static, 4096)
+        for(uint64_t i = 0; i < num_edge_entries; i++){
+            weights[i] = weight_array[i];
+        }
+    }
+}
+
+bool CSR_Compressed::has_weights() const {
+    return false;
+}
+
+double CSR_Compressed::get_weight(uint64_t source, uint64_t destination) const {
+    uint64_t logical_source_id = ext2log(source);
+    uint64_t logical_destination_id = ext2log(destination);
+    if(logical_source_id == numeric_limits<uint64_t>::max() || logical_destination_id == numeric_limits<uint64_t>::max()){ // either source or destination do not exist
+        return numeric_limits<double>::signaling_NaN();
+    }
+
+    auto offset = get_out_interval(logical_source_id);
+    uint64_t position = find_neighbour(m_out.m_bytes + m_out.m_offsets[logical_source_id], offset.second - offset.first, logical_destination_id);
+    if(position == numeric_limits<uint64_t>::max()){
+        return numeric_limits<double>::signaling_NaN();
+    } else if(m_weights == Weights::FLOAT32){
+        return m_out.m_weights[offset.first + position];
+    } else {
+        return 1.0;
+    }
+}
+
+double CSR_Compressed::bytes_per_edge() const {
+    return m_num_edges == 0 ? 0. : static_cast<double>(m_num_bytes) / (2 * m_num_edges); // both directed and undirected graphs store each edge twice
+}
+
+// Same interface of CSR::View, decoding the lists on the fly
+class CSR_Compressed::View {
+    const CSR_Compressed* m_csr;
+
+    static uint64_t interval_start(const uint64_t* __restrict vertex_array, uint64_t logical_vertex_id){
+        return logical_vertex_id == 0 ? 0 : vertex_array[logical_vertex_id -1];
+    }
+
+    template<typename F>
+    static void for_each_neighbour(const uint64_t* __restrict vertex_array, const Lists& lists, uint64_t logical_vertex_id, F&& f){
+        decode_list(lists.m_bytes + lists.m_offsets[logical_vertex_id], vertex_array[logical_vertex_id] - interval_start(vertex_array, logical_vertex_id), f);
+    }
+
+public:
+    View(const CSR_Compressed* csr) : m_csr(csr) { }
+
+    uint64_t num_vertices() const { return m_csr->m_num_vertices; }
+    bool has_vertex(uint64_t v) const { return true; } // the logical IDs are dense
+    uint64_t num_edges() const { return m_csr->m_num_edges; }
+    bool is_directed() const { return m_csr->m_is_directed; }
+    void on_thread_enter() const { } // the arrays are read directly, without a per-thread context
+    void on_thread_leave() const { }
+
+    uint64_t out_degree(uint64_t v) const {
+        return m_csr->m_out_v[v] - interval_start(m_csr->m_out_v, v);
+    }
+
+    uint64_t in_degree(uint64_t v) const {
+        return m_csr->m_in_v[v] - interval_start(m_csr->m_in_v, v);
+    }
+
+    template<typename F>
+    void for_each_out_neighbour(uint64_t v, F&& f) const {
+        for_each_neighbour(m_csr->m_out_v, m_csr->m_out, v, f);
+    }
+
+    template<typename F>
+    void for_each_in_neighbour(uint64_t v, F&& f) const {
+        for_each_neighbour(m_csr->m_in_v, m_csr->m_in, v, f);
+    }
+
+    template<typename F>
+    void for_each_out_edge(uint64_t v, F&& f) const {
+        const float* __restrict weights = m_csr->m_out.m_weights;
+        uint64_t i = interval_start(m_csr->m_out_v, v);
+        for_each_neighbour(m_csr->m_out_v, m_csr->m_out, v, [&](uint64_t u){
+            return f(u, weights != nullptr ? static_cast<double>(weights[i++]) : 1.0);
+        });
+    }
+};
+
+void CSR_Compressed::bfs(uint64_t source_vertex_id, const char* dump2file){
+    bfs_impl(View{ this }, source_vertex_id, dump2file);
+}
+
+void CSR_Compressed::pagerank(uint64_t num_iterations, double damping_factor, const char* dump2file){
+    pagerank_impl(View{ this }, num_iterations, damping_factor, dump2file);
+}
+
+void CSR_Compressed::wcc(const char* dump2file){
+    wcc_impl(View{ this }, dump2file);
+}
+
+void CSR_Compressed::cdlp(uint64_t max_iterations, const char* dump2file){
+    cdlp_impl(View{ this }, max_iterations, dump2file);
+}
+
+void CSR_Compressed::lcc(const char* dump2file){
+    lcc_impl(View{ this }, dump2file);
+}
+
+void CSR_Compressed::sssp(uint64_t source_vertex_id, const char* dump2file){
+    if(m_weights == Weights::NONE) ERROR("[CSR_Compressed] SSSP requires the weights of the edges, which have not been stored");
+    sssp_impl(View{ this }, source_vertex_id, dump2file);
+}
+
+void CSR_Compressed::dump_ostream(std::ostream& out) const {
+    out << "[CSR_Compressed] directed graph: " << (m_is_directed ? "yes" : "no");
+    out << ", num vertices: " << m_num_vertices << ", num edges: " << m_num_edges << ", bytes per edge: " << bytes_per_edge() << "\n";
+    auto dump_edges = [&](const uint64_t* vertex_array, const Lists& lists, uint64_t logical_vertex_id){
+        auto offset = get_interval_impl(vertex_array, logical_vertex_id);
+        uint64_t j = offset.first;
+        decode_list(lists.m_bytes + lists.m_offsets[logical_vertex_id], offset.second - offset.first, [&](uint64_t u){
+            if(j > offset.first) out << ", ";
+            out << "<" << m_log2ext[u] << " (logical: " << u << "), ";
+            if(lists.m_weights != nullptr){ out << lists.m_weights[j]; } else { out << "1"; }
+            out << ">";
+            j++;
+            return true;
+        });
+        out << "\n";
+    };
 
+    for(uint64_t logical_vertex_id = 0; logical_vertex_id < m_num_vertices; logical_vertex_id ++ ){
+        stringstream ss;
+        ss << "[" << logical_vertex_id << "] vtx: " << m_log2ext[logical_vertex_id] << ", ";
+        out << ss.str();
+        out << "out edges: ";
+        dump_edges(m_out_v, m_out, logical_vertex_id);
+        if(m_is_directed){
+            out << string(ss.str().length(), ' ');
+            out << "in edges: ";
+            dump_edges(m_in_v, m_in, logical_vertex_id);
+        }
+    }
+}
 
+} // namespace
@@ -22,16 +22,13 @@
 #include <cinttypes>
 #include <memory>
 #include <thread>
-#include <unordered_map>
 #include <vector>
 
 #include "common/error.hpp"
+#include "graph/vertex_reordering.hpp"
 #include "library/interface.hpp"
 
 // Forward declarations
-namespace gapbs { class Bitmap; }
-namespace gapbs { template <typename T> class SlidingQueue; }
-namespace gapbs { template <typename T> class pvector; }
 namespace gfe::graph { class WeightedEdgeStream; }
 namespace gfe::utility { class TimeoutService; }
 void _bm_run_csr(); // bm experiment
@@ -45,8 +42,8 @@ protected:
     const bool m_is_directed; // whether the graph is directed
     uint64_t m_num_vertices; // total number of vertices
     uint64_t m_num_edges; // total number of edges
-    std::unordered_map<uint64_t, uint64_t> m_ext2log; // dictionary external vertex id -> logical vertex id
-    uint64_t* m_log2ext {nullptr}; // dictionary logical vertex id -> external vertex id
+    uint64_t* m_log2ext {nullptr}; // dictionary logical vertex id -> external vertex id, sorted unless the vertices have been reordered, it also serves the reverse mapping
+    uint64_t* m_ext_order {nullptr}; // only with a vertex reordering, the logical vertex IDs sorted by their external vertex ID
     uint64_t* m_out_v {nullptr}; // vertex array for the outgoing edges
     uint64_t* m_out_e {nullptr}; // edge array for the outgoing edges
     double* m_out_w {nullptr}; // weights associated to the outgoing edges
@@ -55,6 +52,10 @@ protected:
     double* m_in_w {nullptr}; // weights associated to the incoming edges
     uint64_t m_timeout = 0; // max time to complete a kernel of the graphalytics suite, in seconds
     const bool m_numa_interleaved; // whether to use libnuma to allocate the internal arrays
+    void* m_snapshot {nullptr}; // memory mapping of the snapshot file, when the arrays have been loaded from a snapshot
+    uint64_t m_snapshot_sz {0}; // size of the memory mapping, in bytes
+    gfe::graph::VertexReordering m_reordering { gfe::graph::VertexReordering::NONE }; // how to assign the logical vertex IDs
+    uint64_t m_reordering_time {0}; // time spent to reorder the vertices while loading the graph, in microseconds
 
     // Retrieve the [start, end) interval for the outgoing edges associated to the given logical vertex
     std::pair<uint64_t, uint64_t> get_out_interval(uint64_t logical_vertex_id) const;
@@ -71,41 +72,30 @@ protected:
     // Retrieve the number of incoming edges for the given vertex
     uint64_t get_in_degree(uint64_t logical_vertex_id) const;
 
+    // Retrieve the logical vertex ID of the given external vertex ID, or max() if the vertex does not exist
+    uint64_t ext2log(uint64_t external_vertex_id) const;
+
     template<typename T>
     T* alloca_array(uint64_t sz);
 
     template<typename T>
     void free_array(T* array);
 
-private:
-    // Load an undirected graph
-    void load_undirected(gfe::graph::WeightedEdgeStream& stream);
-    void load_directed(gfe::graph::WeightedEdgeStream& stream);
-
-    // BFS implementation
-    std::unique_ptr<int64_t[]> do_bfs(uint64_t root, utility::TimeoutService& timer, int alpha = 15, int beta = 18) const;
-    std::unique_ptr<int64_t[]> do_bfs_init_distances() const;
-    void do_bfs_QueueToBitmap(const gapbs::SlidingQueue<int64_t>& queue, gapbs::Bitmap& bm) const;
-    void do_bfs_BitmapToQueue(const gapbs::Bitmap& bm, gapbs::SlidingQueue<int64_t>& queue) const;
-    int64_t do_bfs_TDStep(int64_t* distances, int64_t distance, gapbs::SlidingQueue<int64_t>& queue) const;
-    int64_t do_bfs_BUStep(int64_t* distances, int64_t distance, gapbs::Bitmap &front, gapbs::Bitmap &next) const;
+    // Adapter to run the generic kernels of library/common/kernels.hpp over the CSR arrays
+    class View;
 
-    // PageRank implementation
-    std::unique_ptr<double[]> do_pagerank(uint64_t num_iterations, double damping_factor, utility::TimeoutService& timer) const;
-
-    // WCC implementation
-    std::unique_ptr<uint64_t[]> do_wcc(utility::TimeoutService& timer) const;
+private:
+    // Init the mapping of the vertices, m_num_vertices and m_log2ext, from the vertices present in the stream
+    void load_vertices(const gfe::graph::WeightedEdgeStream& stream);
 
-    // CDLP implementation
-    std::unique_ptr<uint64_t[]> do_cdlp(uint64_t max_iterations, utility::TimeoutService& timer) const;
+    // Relabel the logical vertex IDs of the edges according to m_reordering, init m_ext_order and permute m_log2ext
+    void reorder_vertices(uint64_t* sources, uint64_t* destinations);
 
-    // LCC implementation
-    std::unique_ptr<double[]> do_lcc(utility::TimeoutService& timer) const;
-    std::unique_ptr<double[]> do_lcc_directed(utility::TimeoutService& timer) const;
-    std::unique_ptr<double[]> do_lcc_undirected(utility::TimeoutService& timer) const;
+    // Check whether the given snapshot exists, it has been created from the given source, and it is for a graph with the same directedness & reordering
+    static bool is_snapshot_valid(const std::string& path_snapshot, const std::string& path_source, bool is_directed, gfe::graph::VertexReordering reordering);
 
-    // SSSP implementation
-    gapbs::pvector<double> do_sssp(uint64_t source, double delta, utility::TimeoutService& timer) const;
+    // Fill the CSR arrays for the edges from the given logical endpoints, vertex_array must be zeroed on input
+    void load_edges(const uint64_t* __restrict sources, const uint64_t* __restrict destinations, const gfe::graph::WeightedEdgeStream& stream, uint64_t* vertex_array, uint64_t* edge_array, double* weight_array, bool undirected);
 
 protected:
     // Helper, translate the logical into real vertices IDs. Materialization step at the end of a graphalytics algorithm
@@ -116,6 +106,17 @@ protected:
     template <typename T, bool negative_scores = true>
     void save_results(const std::vector<std::pair<uint64_t, T>>& result, const char* dump2file);
 
+    // Run the kernels of library/common/kernels.hpp over the given view of the graph, then translate & save their results
+    template<typename V> void bfs_impl(const V& view, uint64_t external_source_id, const char* dump2file);
+    template<typename V> void pagerank_impl(const V& view, uint64_t num_iterations, double damping_factor, const char* dump2file);
+    template<typename V> void wcc_impl(const V& view, const char* dump2file);
+    template<typename V> void cdlp_impl(const V& view, uint64_t max_iterations, const char* dump2file);
+    template<typename V> void lcc_impl(const V& view, const char* dump2file);
+    template<typename V> void sssp_impl(const V& view, uint64_t external_source_id, const char* dump2file);
+
+    // Release the edge arrays (out_e, out_w, in_e and in_w), only the vertex arrays and the mapping of the vertices are retained
+    void release_edge_arrays();
+
 public:
     /**
      * Constructor
@@ -155,10 +156,46 @@ public:
     bool is_directed() const;
 
     /**
-     * Load the whole graph representation from the given path
+     * Load the whole graph representation from the given path, or from its snapshot when present and built with the
+     * same vertex reordering (see #snapshot_path)
      */
     void load(const std::string& path);
-    void load(gfe::graph::WeightedEdgeStream& stream); // it modifies the stream
+    void load(gfe::graph::WeightedEdgeStream& stream); // the stream is left unaltered
+
+    /**
+     * Save the CSR arrays into a snapshot file, that can be later memory mapped with #open. The file consists of a
+     * header of one page, followed by the arrays log2ext, out_v, out_e, out_w and, only for directed graphs, in_v,
+     * in_e and in_w, and, only when the vertices have been reordered, ext_order. Each array starts at a page boundary.
+     * @param path the path of the snapshot file
+     * @param path_source the graph the CSR has been loaded from, if any, to detect stale snapshots in #load
+     */
+    void save(const std::string& path, const std::string& path_source = "") const;
+
+    /**
+     * Memory map the arrays from the given snapshot file, without copies, including its vertex reordering. The mapping is shared and read only, so that
+     * concurrent processes on the same snapshot share the same pages through the page cache. With numa_interleaved,
+     * the pages read from the file are interleaved among the NUMA nodes.
+     * @param path the path of the snapshot file, created by #save
+     * @param populate whether to read the whole file in advance (MAP_POPULATE), rather than on the first access
+     */
+    void open(const std::string& path, bool populate = false);
+
+    /**
+     * The default path of the snapshot for the given graph, that is `<path_graph>.csr'. The method #load(path) memory
+     * maps the snapshot at this path, when present, rather than building the CSR from the graph.
+     */
+    static std::string snapshot_path(const std::string& path_graph);
+
+    /**
+     * Relabel the vertices while loading the graph, to improve the locality of the kernels. The results of the kernels
+     * still refer to the external vertex IDs. It must be set before #load.
+     */
+    void set_vertex_reordering(gfe::graph::VertexReordering reordering);
+
+    /**
+     * Time spent to reorder the vertices in #load, in microseconds
+     */
+    uint64_t get_vertex_reordering_time() const;
 
     /**
      * Set the timeout for the Graphalytics kernels
@@ -305,4 +342,112 @@ public:
     virtual void lcc(const char* dump2file = nullptr);
 };
 
+
+/**
+ * CSR with compressed neighbour lists. The lists are sorted and split in blocks of BLOCK_SIZE neighbours. Each block
+ * stores its first neighbour as it is and the following ones as the gaps from their predecessor, all encoded as byte
+ * aligned varints (LEB128). A list with more than one block is prefixed by the offsets of its blocks, so that a lookup
+ * (#get_weight) only needs to decode a single block. The weights are either stored as floats or not stored at all,
+ * in the latter case all edges have weight 1.
+ *
+ * The graph is first loaded as a plain CSR and then compressed, releasing the edge arrays of the CSR. The vertex arrays
+ * are retained, the degree of a vertex and the position of its weights are still given by the prefix sums.
+ */
+class CSR_Compressed : public CSR {
+public:
+    // How to store the weights of the edges
+    enum class Weights { NONE, FLOAT32 };
+
+private:
+    CSR_Compressed(const CSR_Compressed& ) = delete;
+    CSR_Compressed& operator=(const CSR_Compressed& ) = delete;
+
+    // The encoded neighbour lists for one direction of the edges
+    struct Lists {
+        uint8_t* m_bytes {nullptr}; // the encoded lists, one after the other
+        uint64_t* m_offsets {nullptr}; // position in m_bytes of the list of each vertex, array of num_vertices +1 entries
+        float* m_weights {nullptr}; // weights of the edges, in the same order of the neighbours (only with Weights::FLOAT32)
+    };
+
+    const Weights m_weights; // how the weights are stored
+    Lists m_out; // outgoing edges
+    Lists m_in; // incoming edges (only directed graphs), otherwise the same lists of m_out
+    uint64_t m_num_bytes {0}; // total size of the encoded lists, in bytes
+
+    // Compress the edge arrays of the CSR, then release them
+    void compress();
+
+    // Encode the lists of one direction of the edges
+    void compress(const uint64_t* vertex_array, const uint64_t* edge_array, const double* weight_array, uint64_t num_edge_entries, Lists& lists);
+
+    // Release the arrays of the given lists
+    void free_lists(Lists& lists);
+
+    // Adapter to run the generic kernels of library/common/kernels.hpp over the compressed lists
+    class View;
+
+public:
+    /**
+     * Constructor
+     * @param is_directed: true if the graph is directed, false otherwise
+     * @param weights: whether to store the weights of the edges as floats or not at all
+     * @param numa_interleaved: whether to allocate the internal array interleaved among the NUMA nodes
+     */
+    CSR_Compressed(bool is_directed, Weights weights = Weights::FLOAT32, bool numa_interleaved = false);
+
+    /**
+     * Destructor
+     */
+    ~CSR_Compressed();
+
+    /**
+     * Load and compress the graph from the given path, or from the snapshot of the plain CSR when present
+     */
+    void load(const std::string& path);
+    void load(gfe::graph::WeightedEdgeStream& stream); // the stream is left unaltered
+
+    /**
+     * Memory map a snapshot of the plain CSR, then compress it
+     */
+    void open(const std::string& path, bool populate = false);
+
+    /**
+     * Not supported, snapshots can only be created from the plain CSR
+     */
+    void save(const std::string& path, const std::string& path_source = "") const;
+
+    /**
+     * The weights stored as floats cannot be compared with the weights of the original graph, only the presence of
+     * the edges can be validated
+     */
+    bool has_weights() const;
+
+    /**
+     * Returns the weight of the given edge is the edge is present, or NaN otherwise. Without weights, the weight of
+     * all edges is 1.
+     */
+    double get_weight(uint64_t source, uint64_t destination) const;
+
+    /**
+     * Average size of an encoded neighbour, in bytes, to compare with the 8 bytes of the edge arrays in the plain CSR.
+     * It excludes the vertex arrays and the weights.
+     */
+    double bytes_per_edge() const;
+
+    /**
+     * Graphalytics kernels, the same implementations of the plain CSR over the compressed lists
+     */
+    void bfs(uint64_t source_vertex_id, const char* dump2file = nullptr);
+    void pagerank(uint64_t num_iterations, double damping_factor = 0.85, const char* dump2file = nullptr);
+    void wcc(const char* dump2file = nullptr);
+    void cdlp(uint64_t max_iterations, const char* dump2file = nullptr);
+    void lcc(const char* dump2file = nullptr);
+    void sssp(uint64_t source_vertex_id, const char* dump2file = nullptr); // requires the weights
+
+    /**
+     * Dump the content of the graph to given stream
+     */
+    void dump_ostream(std::ostream& out) const;
+};
+
 } // namespace
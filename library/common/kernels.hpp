@@ -0,0 +1,757 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cinttypes>
+#include <limits>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "third-party/gapbs/gapbs.hpp"
+#include "utility/timeout_service.hpp"
+
+/**
+ * Generic implementations of the Graphalytics kernels: BFS, PageRank, WCC, CDLP, LCC and SSSP.
+ *
+ * The kernels are templates over a `snapshot view' of the graph, a small class providing read only access to the
+ * vertices and the edges through logical vertex IDs in [0, num_vertices). A driver plugs in by wrapping its own
+ * snapshot/transaction in a class with the following methods:
+ *
+ *   uint64_t num_vertices() const; // number of vertices, the logical IDs are in [0, num_vertices)
+ *   bool has_vertex(uint64_t v) const; // whether the logical ID v refers to an existing vertex
+ *   uint64_t num_edges() const; // number of edges, as accounted by the driver
+ *   bool is_directed() const; // whether the graph is directed
+ *   uint64_t out_degree(uint64_t v) const; // number of outgoing edges of v
+ *   uint64_t in_degree(uint64_t v) const; // number of incoming edges of v, the same as out_degree in undirected graphs
+ *   template<typename F> void for_each_out_neighbour(uint64_t v, F&& f) const; // f(uint64_t u) -> bool
+ *   template<typename F> void for_each_in_neighbour(uint64_t v, F&& f) const; // f(uint64_t u) -> bool
+ *   template<typename F> void for_each_out_edge(uint64_t v, F&& f) const; // f(uint64_t u, double weight) -> bool
+ *   void on_thread_enter() const; // a thread starts accessing the view
+ *   void on_thread_leave() const; // a thread stops accessing the view
+ *
+ * The callbacks return true to continue the iteration, false to stop it. In undirected graphs, the incoming
+ * neighbours are expected to be the same as the outgoing neighbours. The logical IDs may have holes, for drivers
+ * that do not reuse the IDs of the removed vertices: a missing vertex has no edges and the score computed for it is
+ * meant to be discarded by the driver. All methods can be invoked concurrently by multiple OpenMP threads. The view
+ * is passed by reference and all its methods are inlined in the kernels, therefore a thin adapter does not add any
+ * overhead to the iteration.
+ *
+ * Apart from num_vertices, num_edges and is_directed, the methods are only invoked between on_thread_enter and
+ * on_thread_leave. Each thread of a parallel region invokes on_thread_enter at the start of the region and
+ * on_thread_leave at its end, while the accesses outside the parallel regions are wrapped as a region of a single
+ * thread. Drivers that need a per-thread context to read their snapshot, e.g. a worker ID, acquire it in
+ * on_thread_enter and release it in on_thread_leave, the others simply provide empty hooks.
+ *
+ * The translation of the results into the external vertex IDs is left to the driver.
+ */
+namespace gfe::library::kernels {
+
+namespace details {
+
+// Invoke the hooks on_thread_enter and on_thread_leave of the view, for the thread in the current scope
+template<typename View>
+class ThreadScope {
+    const View& m_view;
+
+public:
+    ThreadScope(const View& view) : m_view(view) { m_view.on_thread_enter(); }
+    ~ThreadScope() { m_view.on_thread_leave(); }
+    ThreadScope(const ThreadScope&) = delete;
+    ThreadScope& operator=(const ThreadScope&) = delete;
+};
+
+} // namespace details
+
+/*****************************************************************************
+ *                                                                           *
+ *  BFS                                                                      *
+ *                                                                           *
+ *****************************************************************************/
+// Implementation based on the reference BFS for the GAP Benchmark Suite
+// https://github.com/sbeamer/gapbs
+// The reference implementation has been written by Scott Beamer
+//
+// Copyright (c) 2015, The Regents of the University of California (Regents)
+// All Rights Reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of the Regents nor the
+//    names of its contributors may be used to endorse or promote products
+//    derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL REGENTS BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+
+Will return parent array for a BFS traversal from a source vertex
+This BFS implementation makes use of the Direction-Optimizing approach [1].
+It uses the alpha and beta parameters to determine whether to switch search
+directions. For representing the frontier, it uses a SlidingQueue for the
+top-down approach and a Bitmap for the bottom-up approach. To reduce
+false-sharing for the top-down approach, thread-local QueueBuffer's are used.
+To save time computing the number of edges exiting the frontier, this
+implementation precomputes the degrees in bulk at the beginning by storing
+them in parent array as negative numbers. Thus the encoding of parent is:
+  parent[x] < 0 implies x is unvisited and parent[x] = -out_degree(x)
+  parent[x] >= 0 implies x been visited
+[1] Scott Beamer, Krste Asanović, and David Patterson. "Direction-Optimizing
+    Breadth-First Search." International Conference on High Performance
+    Computing, Networking, Storage and Analysis (SC), Salt Lake City, Utah,
+    November 2012.
+
+*/
+
+namespace details {
+
+template<typename View>
+int64_t bfs_BUStep(const View& view, int64_t* distances, int64_t distance, gapbs::Bitmap &front, gapbs::Bitmap &next) {
+    const uint64_t num_vertices = view.num_vertices();
+    int64_t awake_count = 0;
+    next.reset();
+
+    #pragma omp parallel reduction(+ : awake_count)
+    {
+        ThreadScope<View> scope { view };
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (uint64_t u = 0; u < num_vertices; u++) {
+            if (distances[u] < 0){ // the node has not been visited yet
+                view.for_each_in_neighbour(u, [&](uint64_t v){
+                    if(front.get_bit(v)) {
+                        distances[u] = distance; // on each BUStep, all nodes will have the same distance
+                        awake_count++;
+                        next.set_bit(u);
+                        return false;
+                    }
+                    return true;
+                });
+            }
+        }
+    }
+
+    return awake_count;
+}
+
+template<typename View>
+int64_t bfs_TDStep(const View& view, int64_t* distances, int64_t distance, gapbs::SlidingQueue<int64_t>& queue) {
+    int64_t scout_count = 0;
+
+    #pragma omp parallel reduction(+ : scout_count)
+    {
+        ThreadScope<View> scope { view };
+        gapbs::QueueBuffer<int64_t> lqueue(queue);
+
+        #pragma omp for schedule(dynamic, 64)
+        for (auto q_iter = queue.begin(); q_iter < queue.end(); q_iter++) {
+            int64_t u = *q_iter;
+            view.for_each_out_neighbour(u, [&](uint64_t v){
+                int64_t curr_val = distances[v];
+                if (curr_val < 0 && gapbs::compare_and_swap(distances[v], curr_val, distance)) {
+                    lqueue.push_back(v);
+                    scout_count += -curr_val;
+                }
+                return true;
+            });
+        }
+
+        lqueue.flush();
+    }
+
+    return scout_count;
+}
+
+inline void bfs_QueueToBitmap(const gapbs::SlidingQueue<int64_t> &queue, gapbs::Bitmap &bm) {
+    #pragma omp parallel for
+    for (auto q_iter = queue.begin(); q_iter < queue.end(); q_iter++) {
+        int64_t u = *q_iter;
+        bm.set_bit_atomic(u);
+    }
+}
+
+inline void bfs_BitmapToQueue(uint64_t num_vertices, const gapbs::Bitmap &bm, gapbs::SlidingQueue<int64_t> &queue) {
+    #pragma omp parallel
+    {
+        gapbs::QueueBuffer<int64_t> lqueue(queue);
+        #pragma omp for
+        for (uint64_t n=0; n < num_vertices; n++)
+            if (bm.get_bit(n))
+                lqueue.push_back(n);
+        lqueue.flush();
+    }
+    queue.slide_window();
+}
+
+} // namespace details
+
+/**
+ * Direction-optimising BFS from the given root. Return the distance of each vertex from the root, the vertices that
+ * could not be reached have a negative distance.
+ */
+template<typename View>
+std::unique_ptr<int64_t[]> bfs(const View& view, uint64_t root, utility::TimeoutService& timer, int alpha = 15, int beta = 18) {
+    // The implementation from GAP BS reports the parent (which indeed it should make more sense), while the one required by
+    // Graphalytics only returns the distance
+    const uint64_t num_vertices = view.num_vertices();
+    std::unique_ptr<int64_t[]> ptr_distances{ new int64_t[num_vertices] };
+    int64_t* __restrict distances = ptr_distances.get();
+    #pragma omp parallel
+    {
+        details::ThreadScope<View> scope { view };
+
+        #pragma omp for
+        for (uint64_t n = 0; n < num_vertices; n++){
+            int64_t out_degree = view.out_degree(n);
+            distances[n] = out_degree != 0 ? - out_degree : -1;
+        }
+    }
+    distances[root] = 0;
+
+    gapbs::SlidingQueue<int64_t> queue(num_vertices);
+    queue.push_back(root);
+    queue.slide_window();
+    gapbs::Bitmap curr(num_vertices);
+    curr.reset();
+    gapbs::Bitmap front(num_vertices);
+    front.reset();
+    int64_t edges_to_check = view.num_edges();
+    int64_t scout_count = 0;
+    {
+        details::ThreadScope<View> scope { view };
+        scout_count = view.out_degree(root);
+    }
+    int64_t distance = 1; // current distance
+    while (!timer.is_timeout() && !queue.empty()) {
+
+        if (scout_count > edges_to_check / alpha) {
+            int64_t awake_count, old_awake_count;
+            details::bfs_QueueToBitmap(queue, front);
+            awake_count = queue.size();
+            queue.slide_window();
+            do {
+                old_awake_count = awake_count;
+                awake_count = details::bfs_BUStep(view, distances, distance, front, curr);
+                front.swap(curr);
+                distance++;
+            } while ((awake_count >= old_awake_count) || (awake_count > (int64_t) num_vertices / beta));
+            details::bfs_BitmapToQueue(num_vertices, front, queue);
+            scout_count = 1;
+        } else {
+            edges_to_check -= scout_count;
+            scout_count = details::bfs_TDStep(view, distances, distance, queue);
+            queue.slide_window();
+            distance++;
+        }
+    }
+
+    return ptr_distances;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  PageRank                                                                 *
+ *                                                                           *
+ *****************************************************************************/
+// Implementation based on the reference PageRank for the GAP Benchmark Suite, same license as above.
+// It performs the updates in the pull direction to remove the need for atomics.
+
+/**
+ * Execute PageRank for the given number of iterations. Return the score of each vertex.
+ */
+template<typename View>
+std::unique_ptr<double[]> pagerank(const View& view, uint64_t num_iterations, double damping_factor, utility::TimeoutService& timer) {
+    const uint64_t num_vertices = view.num_vertices();
+    uint64_t num_existing_vertices = 0; // the missing vertices must not take part to the scores
+    #pragma omp parallel reduction(+:num_existing_vertices)
+    {
+        details::ThreadScope<View> scope { view };
+
+        #pragma omp for
+        for(uint64_t v = 0; v < num_vertices; v++){
+            num_existing_vertices += view.has_vertex(v);
+        }
+    }
+    const double init_score = 1.0 / num_existing_vertices;
+    const double base_score = (1.0 - damping_factor) / num_existing_vertices;
+
+    std::unique_ptr<double[]> ptr_scores{ new double[num_vertices]() }; // avoid memory leaks
+    double* scores = ptr_scores.get();
+    #pragma omp parallel
+    {
+        details::ThreadScope<View> scope { view };
+
+        #pragma omp for
+        for(uint64_t v = 0; v < num_vertices; v++){
+            scores[v] = view.has_vertex(v) ? init_score : 0.0;
+        }
+    }
+    gapbs::pvector<double> outgoing_contrib(num_vertices, 0.0);
+
+    // pagerank iterations
+    for(uint64_t iteration = 0; iteration < num_iterations && !timer.is_timeout(); iteration++){
+        double dangling_sum = 0.0;
+
+        // for each node, precompute its contribution to all of its outgoing neighbours and, if it's a sink,
+        // add its rank to the `dangling sum' (to be added to all nodes).
+        #pragma omp parallel reduction(+:dangling_sum)
+        {
+            details::ThreadScope<View> scope { view };
+
+            #pragma omp for
+            for(uint64_t v = 0; v < num_vertices; v++){
+                if(!view.has_vertex(v)) continue; // the vertex does not exist
+
+                uint64_t out_degree = view.out_degree(v);
+                if(out_degree == 0){ // this is a sink
+                    dangling_sum += scores[v];
+                } else {
+                    outgoing_contrib[v] = scores[v] / out_degree;
+                }
+            }
+        }
+
+        dangling_sum /= num_existing_vertices;
+
+        // compute the new score for each node in the graph
+        #pragma omp parallel
+        {
+            details::ThreadScope<View> scope { view };
+
+            #pragma omp for schedule(dynamic, 64)
+            for(uint64_t v = 0; v < num_vertices; v++){
+                if(!view.has_vertex(v)) continue; // the vertex does not exist
+
+                double incoming_total = 0;
+                view.for_each_in_neighbour(v, [&](uint64_t u){
+                    incoming_total += outgoing_contrib[u];
+                    return true;
+                });
+
+                // update the score
+                scores[v] = base_score + damping_factor * (incoming_total + dangling_sum);
+            }
+        }
+    }
+
+    return ptr_scores;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  WCC                                                                      *
+ *                                                                           *
+ *****************************************************************************/
+// Implementation based on the reference CC (Afforest) for the GAP Benchmark Suite, same license as above.
+
+/*
+GAP Benchmark Suite
+Kernel: Connected Components (CC)
+Author: Michael Sutton, Scott Beamer
+
+Will return comp array labelling each vertex with a connected component ID
+
+This CC implementation makes use of the Afforest subgraph sampling algorithm [1],
+which restructures and extends the Shiloach-Vishkin algorithm [2].
+
+[1] Michael Sutton, Tal Ben-Nun, and Amnon Barak. "Optimizing Parallel
+    Graph Connectivity Computation via Subgraph Sampling" Symposium on
+    Parallel and Distributed Processing, IPDPS 2018.
+
+[2] Yossi Shiloach and Uzi Vishkin. "An o(logn) parallel connectivity algorithm"
+    Journal of Algorithms, 3(1):57–67, 1982.
+*/
+
+namespace details {
+
+// Place u and v in the same component, the component with the lower ID wins
+inline void wcc_link(uint64_t u, uint64_t v, uint64_t* comp) {
+    uint64_t p1 = comp[u];
+    uint64_t p2 = comp[v];
+    while (p1 != p2) {
+        uint64_t high = std::max(p1, p2);
+        uint64_t low = std::min(p1, p2);
+        uint64_t p_high = comp[high];
+        // Was already 'low' or succeeded in writing 'low'
+        if ((p_high == low) || (p_high == high && gapbs::compare_and_swap(comp[high], high, low)))
+            break;
+        p1 = comp[comp[high]];
+        p2 = comp[low];
+    }
+}
+
+// Shortcut each vertex to the root of its component
+inline void wcc_compress(uint64_t num_vertices, uint64_t* comp) {
+    #pragma omp parallel for schedule(dynamic, 16384)
+    for (uint64_t n = 0; n < num_vertices; n++) {
+        while (comp[n] != comp[comp[n]]) {
+            comp[n] = comp[comp[n]];
+        }
+    }
+}
+
+// Estimate the largest component by sampling the vertices
+inline uint64_t wcc_sample_frequent_element(uint64_t num_vertices, const uint64_t* comp, uint64_t num_samples = 1024) {
+    std::unordered_map<uint64_t, uint64_t> sample_counts(32);
+    std::mt19937 gen;
+    std::uniform_int_distribution<uint64_t> distribution(0, num_vertices - 1);
+    for (uint64_t i = 0; i < num_samples; i++) {
+        sample_counts[comp[distribution(gen)]]++;
+    }
+    auto most_frequent = std::max_element(sample_counts.begin(), sample_counts.end(),
+            [](const std::pair<const uint64_t, uint64_t>& a, const std::pair<const uint64_t, uint64_t>& b) { return a.second < b.second; });
+    return most_frequent->first;
+}
+
+} // namespace details
+
+/**
+ * Weakly connected components. Return, for each vertex, the logical ID of the smallest vertex in its component.
+ */
+template<typename View>
+std::unique_ptr<uint64_t[]> wcc(const View& view, utility::TimeoutService& timer, uint64_t neighbour_rounds = 2) {
+    const uint64_t num_vertices = view.num_vertices();
+    std::unique_ptr<uint64_t[]> ptr_components { new uint64_t[num_vertices] };
+    uint64_t* comp = ptr_components.get();
+    if(num_vertices == 0) return ptr_components;
+
+    #pragma omp parallel for
+    for (uint64_t n = 0; n < num_vertices; n++){
+        comp[n] = n;
+    }
+
+    // Process a sparse sampled subgraph first for approximating components.
+    // Sample by processing a fixed number of neighbors for each node (see paper)
+    for (uint64_t r = 0; r < neighbour_rounds && !timer.is_timeout(); r++) {
+        #pragma omp parallel
+        {
+            details::ThreadScope<View> scope { view };
+
+            #pragma omp for schedule(dynamic, 16384)
+            for (uint64_t u = 0; u < num_vertices; u++) {
+                uint64_t i = 0;
+                view.for_each_out_neighbour(u, [&](uint64_t v){
+                    if(i++ < r) return true; // skip the neighbours already linked in the previous rounds
+                    details::wcc_link(u, v, comp);
+                    return false;
+                });
+            }
+        }
+        details::wcc_compress(num_vertices, comp);
+    }
+
+    // Sample 'comp' to find the most frequent element -- due to prior
+    // compression, this value represents the largest intermediate component
+    uint64_t c = details::wcc_sample_frequent_element(num_vertices, comp);
+
+    // Final 'link' phase over remaining edges (excluding the largest component)
+    const bool is_directed = view.is_directed();
+    if(!timer.is_timeout()){
+        #pragma omp parallel
+        {
+            details::ThreadScope<View> scope { view };
+
+            #pragma omp for schedule(dynamic, 16384)
+            for (uint64_t u = 0; u < num_vertices; u++) {
+                // Skip processing nodes in the largest component
+                if (comp[u] == c) continue;
+
+                // Skip over part of neighborhood (determined by neighbour_rounds)
+                uint64_t i = 0;
+                view.for_each_out_neighbour(u, [&](uint64_t v){
+                    if(i++ >= neighbour_rounds){ details::wcc_link(u, v, comp); }
+                    return true;
+                });
+
+                // To support directed graphs, process reverse graph completely
+                if (is_directed) {
+                    view.for_each_in_neighbour(u, [&](uint64_t v){
+                        details::wcc_link(u, v, comp);
+                        return true;
+                    });
+                }
+            }
+        }
+    }
+
+    // Finally, 'compress' for final convergence
+    details::wcc_compress(num_vertices, comp);
+
+    return ptr_components;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  CDLP                                                                     *
+ *                                                                           *
+ *****************************************************************************/
+/**
+ * Community detection through label propagation. The initial label of each vertex is given by the functor
+ * initial_label(uint64_t v) -> uint64_t, the Graphalytics spec requires the external vertex ID, as the ties are
+ * resolved by picking the smallest label. Return the label of each vertex.
+ */
+template<typename View, typename InitialLabel>
+std::unique_ptr<uint64_t[]> cdlp(const View& view, uint64_t max_iterations, InitialLabel&& initial_label, utility::TimeoutService& timer) {
+    const uint64_t num_vertices = view.num_vertices();
+    const bool is_directed = view.is_directed();
+    std::unique_ptr<uint64_t[]> ptr_labels0 { new uint64_t[num_vertices] };
+    std::unique_ptr<uint64_t[]> ptr_labels1 { new uint64_t[num_vertices] };
+    uint64_t* labels0 = ptr_labels0.get(); // current labels
+    uint64_t* labels1 = ptr_labels1.get(); // labels for the next iteration
+
+    // initialisation, the functor may read the snapshot of the driver as well
+    #pragma omp parallel
+    {
+        details::ThreadScope<View> scope { view };
+
+        #pragma omp for
+        for(uint64_t v = 0; v < num_vertices; v++){
+            labels0[v] = initial_label(v);
+        }
+    }
+
+    // algorithm pass
+    bool change = true;
+    uint64_t current_iteration = 0;
+    while(current_iteration < max_iterations && change && !timer.is_timeout()){
+        change = false; // reset the flag
+
+        #pragma omp parallel reduction(||:change)
+        {
+            details::ThreadScope<View> scope { view };
+            std::vector<uint64_t> histogram; // the labels of the neighbours, sorted to count the occurrences of each label
+
+            #pragma omp for schedule(dynamic, 64)
+            for(uint64_t v = 0; v < num_vertices; v++){
+                histogram.clear();
+                auto fn_collect = [&](uint64_t u){ histogram.push_back(labels0[u]); return true; };
+                view.for_each_out_neighbour(v, fn_collect);
+
+                // cfr. Spec v0.9 pp 14 "If the graph is directed and a neighbor is reachable via both an incoming and
+                // outgoing edge, its label will be counted twice"
+                if(is_directed){
+                    view.for_each_in_neighbour(v, fn_collect);
+                }
+
+                // get the max label, the histogram is sorted thus the first label with the max count is the smallest.
+                // A vertex without neighbours keeps its own label
+                uint64_t label_max = labels0[v];
+                uint64_t count_max = 0;
+                std::sort(histogram.begin(), histogram.end());
+                for(uint64_t i = 0, end = histogram.size(); i < end; ){
+                    uint64_t j = i + 1;
+                    while(j < end && histogram[j] == histogram[i]) j++;
+                    if(j - i > count_max){
+                        label_max = histogram[i];
+                        count_max = j - i;
+                    }
+                    i = j;
+                }
+
+                labels1[v] = label_max;
+                change = change || (labels0[v] != labels1[v]);
+            }
+        }
+
+        std::swap(labels0, labels1); // next iteration
+        current_iteration++;
+    }
+
+    if(labels0 == ptr_labels0.get()){
+        return ptr_labels0;
+    } else {
+        return ptr_labels1;
+    }
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  LCC                                                                      *
+ *                                                                           *
+ *****************************************************************************/
+/**
+ * Local clustering coefficient. In directed graphs, the neighbourhood of a vertex v is given by both its outgoing
+ * and incoming edges, and only the outgoing edges of its neighbours are considered to count the triangles, as
+ * prescribed by the Graphalytics spec v0.9 pp. 15. Return the score of each vertex.
+ */
+template<typename View>
+std::unique_ptr<double[]> lcc(const View& view, utility::TimeoutService& timer) {
+    const uint64_t num_vertices = view.num_vertices();
+    const bool is_directed = view.is_directed();
+    std::unique_ptr<double[]> ptr_lcc { new double[num_vertices] };
+    double* lcc = ptr_lcc.get();
+
+    #pragma omp parallel
+    {
+        details::ThreadScope<View> scope { view };
+        std::vector<uint64_t> neighbours; // the neighbourhood of v, sorted
+
+        #pragma omp for schedule(dynamic, 64)
+        for(uint64_t v = 0; v < num_vertices; v++){
+            lcc[v] = 0.0;
+            if(timer.is_timeout()) continue; // exhausted the budget of available time
+
+            // Cfr. Spec v.0.9.0 pp. 15: "If the number of neighbors of a vertex is less than two, its coefficient is defined as zero"
+            uint64_t v_degree_ub = view.out_degree(v) + (is_directed ? view.in_degree(v) : 0); // upper bound for directed graphs
+            if(v_degree_ub < 2) continue;
+
+            // Build the list of neighbours of v
+            neighbours.clear();
+            neighbours.reserve(v_degree_ub);
+            auto fn_collect = [&](uint64_t u){ neighbours.push_back(u); return true; };
+            view.for_each_out_neighbour(v, fn_collect);
+            if(is_directed){ view.for_each_in_neighbour(v, fn_collect); }
+            std::sort(neighbours.begin(), neighbours.end());
+            neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+            // Now we know the actual degree of v
+            const uint64_t v_degree = neighbours.size();
+            if(v_degree < 2) continue;
+
+            // For each neighbour u of v, count the outgoing edges u -> w where w is also a neighbour of v
+            uint64_t num_triangles = 0;
+            for(uint64_t u : neighbours){
+                view.for_each_out_neighbour(u, [&](uint64_t w){
+                    num_triangles += std::binary_search(neighbours.begin(), neighbours.end(), w);
+                    return true;
+                });
+            }
+
+            // register the final score
+            uint64_t max_num_edges = v_degree * (v_degree -1);
+            lcc[v] = static_cast<double>(num_triangles) / max_num_edges;
+        }
+    }
+
+    return ptr_lcc;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  SSSP                                                                     *
+ *                                                                           *
+ *****************************************************************************/
+// Implementation based on the reference SSSP (delta stepping) for the GAP Benchmark Suite, same license as above.
+
+/**
+ * Single source shortest paths from the given source, through delta stepping. Return the distance of each vertex
+ * from the source, the vertices that could not be reached have distance +infinity.
+ */
+template<typename View>
+gapbs::pvector<double> sssp(const View& view, uint64_t source, double delta, utility::TimeoutService& timer) {
+    constexpr size_t kMaxBin = std::numeric_limits<size_t>::max()/2;
+
+    // Init
+    gapbs::pvector<double> dist(view.num_vertices(), std::numeric_limits<double>::infinity());
+    dist[source] = 0;
+    gapbs::pvector<uint64_t> frontier(std::max<uint64_t>(view.num_edges(), 1));
+    // two element arrays for double buffering curr=iter&1, next=(iter+1)&1
+    size_t shared_indexes[2] = {0, kMaxBin};
+    size_t frontier_tails[2] = {1, 0};
+    frontier[0] = source;
+    bool is_timeout = false; // set by a single thread at the end of each step, so that all threads stop in the same step
+
+    #pragma omp parallel
+    {
+        details::ThreadScope<View> scope { view };
+        std::vector<std::vector<uint64_t> > local_bins(0);
+        size_t iter = 0;
+
+        while (shared_indexes[iter&1] != kMaxBin) {
+            size_t &curr_bin_index = shared_indexes[iter&1];
+            size_t &next_bin_index = shared_indexes[(iter+1)&1];
+            size_t &curr_frontier_tail = frontier_tails[iter&1];
+            size_t &next_frontier_tail = frontier_tails[(iter+1)&1];
+            #pragma omp for nowait schedule(dynamic, 64)
+            for (size_t i=0; i < curr_frontier_tail; i++) {
+                uint64_t u = frontier[i];
+                if (dist[u] >= delta * static_cast<double>(curr_bin_index)) {
+                    view.for_each_out_edge(u, [&](uint64_t v, double w){
+                        double old_dist = dist[v];
+                        double new_dist = dist[u] + w;
+                        if (new_dist < old_dist) {
+                            bool changed_dist = true;
+                            while (!gapbs::compare_and_swap(dist[v], old_dist, new_dist)) {
+                                old_dist = dist[v];
+                                if (old_dist <= new_dist) {
+                                    changed_dist = false;
+                                    break;
+                                }
+                            }
+                            if (changed_dist) {
+                                size_t dest_bin = new_dist/delta;
+                                if (dest_bin >= local_bins.size()) {
+                                    local_bins.resize(dest_bin+1);
+                                }
+                                local_bins[dest_bin].push_back(v);
+                            }
+                        }
+                        return true;
+                    });
+                }
+            }
+
+            for (size_t i=curr_bin_index; i < local_bins.size(); i++) {
+                if (!local_bins[i].empty()) {
+                    #pragma omp critical
+                    next_bin_index = std::min(next_bin_index, i);
+                    break;
+                }
+            }
+
+            #pragma omp barrier
+            #pragma omp single nowait
+            {
+                curr_bin_index = kMaxBin;
+                curr_frontier_tail = 0;
+                is_timeout = timer.is_timeout();
+            }
+
+            if (next_bin_index < local_bins.size()) {
+                size_t copy_start = gapbs::fetch_and_add(next_frontier_tail, local_bins[next_bin_index].size());
+                std::copy(local_bins[next_bin_index].begin(), local_bins[next_bin_index].end(), frontier.data() + copy_start);
+                local_bins[next_bin_index].resize(0);
+            }
+
+            iter++;
+            #pragma omp barrier
+            if(is_timeout) break;
+        }
+    }
+
+    return dist;
+}
+
+} // namespace
@@ -0,0 +1,107 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cinttypes>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace gfe::library {
+
+/**
+ * Histogram of the labels of the neighbours of a vertex, for the CDLP kernels. It is a hash table with open addressing
+ * and linear probing, owned by a single thread and reused for all the vertices it processes. The capacity is a power
+ * of 2, at least twice the degree of the vertices seen so far, so that the probe sequences stay short and the table
+ * is never full. Only the slots touched by the last vertex are visited, and cleared, to find the most frequent label.
+ */
+class LabelHistogram {
+    LabelHistogram(const LabelHistogram&) = delete;
+    LabelHistogram& operator=(const LabelHistogram&) = delete;
+
+    struct Slot {
+        uint64_t m_label; // the key
+        uint64_t m_count; // 0 => the slot is free
+    };
+
+    std::unique_ptr<Slot[]> m_slots; // the actual table
+    uint64_t m_mask { 0 }; // capacity -1
+    std::vector<uint64_t> m_used; // positions of the slots occupied
+
+    static uint64_t hash(uint64_t label) { return label * 0x9E3779B97F4A7C15ull; } // Fibonacci hashing
+
+public:
+    /**
+     * Create an empty histogram. The table is allocated on the first invocation of #reserve
+     */
+    LabelHistogram() { }
+
+    /**
+     * Ensure the table can hold the labels of a vertex with the given degree. It can only be invoked when the
+     * histogram is empty.
+     */
+    void reserve(uint64_t degree) {
+        uint64_t capacity = m_mask +1;
+        if(m_slots.get() != nullptr && capacity >= 2 * degree) return; // nop
+        capacity = 16;
+        while(capacity < 2 * degree) capacity *= 2;
+        m_slots.reset(new Slot[capacity]());
+        m_mask = capacity -1;
+        m_used.reserve(degree);
+    }
+
+    /**
+     * Increment by one the frequency of the given label
+     */
+    void insert(uint64_t label) {
+        uint64_t pos = (hash(label) >> 32) & m_mask;
+        while(m_slots[pos].m_count != 0 && m_slots[pos].m_label != label){
+            pos = (pos +1) & m_mask;
+        }
+        if(m_slots[pos].m_count == 0){
+            m_slots[pos].m_label = label;
+            m_used.push_back(pos);
+        }
+        m_slots[pos].m_count++;
+    }
+
+    /**
+     * Retrieve the most frequent label, the smallest one in case of ties, and reset the histogram. If the histogram
+     * is empty, return the given label.
+     */
+    uint64_t pop_max(uint64_t default_label) {
+        if(m_used.empty()) return default_label;
+
+        uint64_t label_max = std::numeric_limits<uint64_t>::max();
+        uint64_t count_max = 0;
+        for(uint64_t pos : m_used){
+            Slot& slot = m_slots[pos];
+            if(slot.m_count > count_max || (slot.m_count == count_max && slot.m_label < label_max)){
+                label_max = slot.m_label;
+                count_max = slot.m_count;
+            }
+            slot.m_count = 0;
+        }
+        m_used.clear();
+
+        return label_max;
+    }
+};
+
+} // namespace gfe::library
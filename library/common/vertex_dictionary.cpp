@@ -0,0 +1,307 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "vertex_dictionary.hpp"
+
+#include <cassert>
+#include <thread>
+
+#include "common/error.hpp"
+
+using namespace std;
+
+namespace gfe::library {
+
+/*****************************************************************************
+ *                                                                           *
+ *  Helpers                                                                  *
+ *                                                                           *
+ *****************************************************************************/
+
+// Finaliser of MurmurHash3, to spread dense and sequential vertex IDs among the slots
+static uint64_t hash_key(uint64_t key){
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return key;
+}
+
+// Ratio between the capacity of a table and its predecessor in the chain. A large factor keeps the chain short, as lookups
+// need to probe all the tables preceding the one where the key has been stored.
+constexpr static uint64_t GROWTH_FACTOR = 8;
+
+static uint64_t round_up_pow2(uint64_t value){
+    uint64_t result = 1;
+    while(result < value){ result <<= 1; }
+    return result;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Table                                                                    *
+ *                                                                           *
+ *****************************************************************************/
+
+VertexDictionary::Table::Table(uint64_t capacity) : m_capacity(round_up_pow2(max<uint64_t>(capacity, 16))), m_max_entries(m_capacity / 2) {
+    m_slots = new Slot[m_capacity];
+    for(uint64_t i = 0; i < m_capacity; i++){
+        m_slots[i].m_key.store(KEY_EMPTY, memory_order_relaxed);
+        m_slots[i].m_value.store(VALUE_PENDING, memory_order_relaxed);
+    }
+}
+
+VertexDictionary::Table::~Table(){
+    delete[] m_slots; m_slots = nullptr;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Init                                                                     *
+ *                                                                           *
+ *****************************************************************************/
+
+VertexDictionary::VertexDictionary(uint64_t capacity) : m_head(new Table(capacity)) {
+
+}
+
+VertexDictionary::~VertexDictionary(){
+    Table* table = m_head;
+    while(table != nullptr){
+        Table* next = table->m_next.load(memory_order_relaxed);
+        delete table;
+        table = next;
+    }
+    m_head = nullptr;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Probing                                                                  *
+ *                                                                           *
+ *****************************************************************************/
+
+VertexDictionary::Slot* VertexDictionary::acquire(uint64_t key, bool* out_claimed){
+    const uint64_t hash = hash_key(key);
+    Table* table = m_head;
+
+    while(true){
+        const uint64_t mask = table->m_capacity -1;
+        uint64_t index = hash & mask;
+        bool moved = false;
+
+        for(uint64_t i = 0; i < table->m_capacity && !moved; i++, index = (index +1) & mask){
+            Slot* slot = table->m_slots + index;
+            uint64_t current = slot->m_key.load(memory_order_acquire);
+
+            if(current == KEY_EMPTY){
+                // all threads inserting `key' race on this slot: either they store the key here or they seal the slot
+                // and move to the next table, but they all take the same decision
+                uint64_t target = (table->m_num_entries.load(memory_order_relaxed) < table->m_max_entries) ? key : KEY_MOVED;
+                if(slot->m_key.compare_exchange_strong(current, target, memory_order_acq_rel, memory_order_acquire)){
+                    if(target == KEY_MOVED){
+                        moved = true;
+                        continue;
+                    }
+                    table->m_num_entries.fetch_add(1, memory_order_relaxed);
+                    *out_claimed = true;
+                    return slot;
+                }
+                // someone else took the slot first, `current' is now the key stored
+            }
+
+            if(current == key){
+                *out_claimed = false;
+                return slot;
+            } else if(current == KEY_MOVED){
+                moved = true;
+            }
+        }
+
+        // either the probe reached a sealed slot, or the table is completely full
+        table = next_table(table);
+    }
+}
+
+const VertexDictionary::Slot* VertexDictionary::lookup(uint64_t key) const {
+    const uint64_t hash = hash_key(key);
+    const Table* table = m_head;
+
+    while(table != nullptr){
+        const uint64_t mask = table->m_capacity -1;
+        uint64_t index = hash & mask;
+        bool moved = false;
+
+        for(uint64_t i = 0; i < table->m_capacity && !moved; i++, index = (index +1) & mask){
+            const Slot* slot = table->m_slots + index;
+            uint64_t current = slot->m_key.load(memory_order_acquire);
+            if(current == key){
+                return slot;
+            } else if(current == KEY_EMPTY){
+                return nullptr; // the key is not in this table, nor in the next ones
+            } else if(current == KEY_MOVED){
+                moved = true;
+            }
+        }
+
+        table = table->m_next.load(memory_order_acquire);
+    }
+
+    return nullptr;
+}
+
+VertexDictionary::Table* VertexDictionary::next_table(Table* table){
+    Table* next = table->m_next.load(memory_order_acquire);
+    if(next == nullptr){
+        Table* candidate = new Table(table->m_capacity * GROWTH_FACTOR);
+        if(table->m_next.compare_exchange_strong(next, candidate, memory_order_acq_rel, memory_order_acquire)){
+            next = candidate;
+        } else { // another thread created the table first
+            delete candidate;
+        }
+    }
+    return next;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Values                                                                   *
+ *                                                                           *
+ *****************************************************************************/
+
+uint64_t VertexDictionary::wait_value(const Slot* slot){
+    uint64_t value = slot->m_value.load(memory_order_acquire);
+    while(value == VALUE_PENDING){
+        this_thread::yield();
+        value = slot->m_value.load(memory_order_acquire);
+    }
+    return value;
+}
+
+void VertexDictionary::publish(Slot* slot, uint64_t value){
+    assert(slot->m_value.load() == VALUE_PENDING && "The slot must have been claimed or revived by the current thread");
+    slot->m_value.store(value, memory_order_release);
+    m_size.fetch_add(1, memory_order_relaxed);
+}
+
+bool VertexDictionary::revive(Slot* slot){
+    uint64_t expected = VALUE_REMOVED;
+    return slot->m_value.compare_exchange_strong(expected, VALUE_PENDING, memory_order_acq_rel, memory_order_acquire);
+}
+
+void VertexDictionary::cancel(Slot* slot){
+    assert(slot->m_value.load() == VALUE_PENDING && "The slot must have been claimed or revived by the current thread");
+    slot->m_value.store(VALUE_REMOVED, memory_order_release);
+}
+
+void VertexDictionary::validate(uint64_t key, uint64_t value){
+    if(key >= KEY_MOVED){ INVALID_ARGUMENT("Invalid key: " << key << ", the values " << KEY_MOVED << " and " << KEY_EMPTY << " are reserved"); }
+    if(value >= VALUE_REMOVED){ INVALID_ARGUMENT("Invalid value: " << value << ", the values " << VALUE_REMOVED << " and " << VALUE_PENDING << " are reserved"); }
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Interface                                                                *
+ *                                                                           *
+ *****************************************************************************/
+
+bool VertexDictionary::find(uint64_t key, uint64_t* out_value) const {
+    const Slot* slot = lookup(key);
+    if(slot == nullptr) return false;
+    uint64_t value = wait_value(slot);
+    if(value == VALUE_REMOVED) return false;
+    *out_value = value;
+    return true;
+}
+
+bool VertexDictionary::contains(uint64_t key) const {
+    uint64_t value = 0;
+    return find(key, &value);
+}
+
+pair<uint64_t, bool> VertexDictionary::insert(uint64_t key, uint64_t value){
+    validate(key, value);
+    bool claimed = false;
+    Slot* slot = acquire(key, &claimed);
+
+    while(true){
+        if(claimed || revive(slot)){
+            publish(slot, value);
+            return make_pair(value, true);
+        }
+
+        uint64_t current = wait_value(slot);
+        if(current != VALUE_REMOVED){
+            return make_pair(current, false);
+        }
+    }
+}
+
+bool VertexDictionary::remove(uint64_t key, uint64_t* out_value){
+    Slot* slot = const_cast<Slot*>(lookup(key));
+    if(slot == nullptr) return false;
+
+    uint64_t value = wait_value(slot);
+    while(value != VALUE_REMOVED){
+        if(slot->m_value.compare_exchange_weak(value, VALUE_REMOVED, memory_order_acq_rel, memory_order_acquire)){
+            m_size.fetch_sub(1, memory_order_relaxed);
+            if(out_value != nullptr){ *out_value = value; }
+            return true;
+        } else if(value == VALUE_PENDING){ // the key has been revived by another thread in the meanwhile
+            value = wait_value(slot);
+        }
+    }
+
+    return false;
+}
+
+void VertexDictionary::bulk_load(const uint64_t* keys, const uint64_t* values, uint64_t num_entries){
+    if(size() == 0 && m_head->m_next.load() == nullptr && m_head->m_max_entries < num_entries){
+        // resize the dictionary ahead, so that all keys fit in a single table
+        delete m_head;
+        m_head = new Table(num_entries * 2);
+    }
+
+    #pragma omp parallel for schedule(static, 4096)
+    for(uint64_t i = 0; i < num_entries; i++){
+        insert(keys[i], values[i]);
+    }
+}
+
+uint64_t VertexDictionary::size() const {
+    return m_size.load(memory_order_relaxed);
+}
+
+uint64_t VertexDictionary::capacity() const {
+    uint64_t result = 0;
+    for(const Table* table = m_head; table != nullptr; table = table->m_next.load(memory_order_acquire)){
+        result += table->m_capacity;
+    }
+    return result;
+}
+
+uint64_t VertexDictionary::num_tables() const {
+    uint64_t result = 0;
+    for(const Table* table = m_head; table != nullptr; table = table->m_next.load(memory_order_acquire)){
+        result++;
+    }
+    return result;
+}
+
+} // namespace
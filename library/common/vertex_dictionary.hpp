@@ -0,0 +1,191 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace gfe::library {
+
+/**
+ * A concurrent dictionary to translate the external vertex IDs into the internal vertex IDs of a library. It is a
+ * lock-free hash table with open addressing and linear probing. Each slot is 16 bytes, the key followed by its value.
+ *
+ * Readers never take locks: they probe the slots with atomic loads and only wait when the value of the key they are
+ * looking for is still being published by its writer. A key is inserted by claiming an empty slot with a CAS. All
+ * threads inserting the same key follow the same probe sequence, thus they race on the same empty slot and only one
+ * of them wins it (insert-if-absent).
+ *
+ * The dictionary grows by chaining: when a table reaches its max load factor, the next empty slot of each probe
+ * sequence is sealed as `moved' and the probe continues in a new table of larger capacity. A key is always looked
+ * up following the same chain of tables, so that it is never stored twice.
+ *
+ * The keys and the values max() and max() -1 are reserved for internal use.
+ */
+class VertexDictionary {
+    VertexDictionary(const VertexDictionary&) = delete;
+    VertexDictionary& operator=(const VertexDictionary&) = delete;
+
+    static constexpr uint64_t KEY_EMPTY = std::numeric_limits<uint64_t>::max(); // the slot is free
+    static constexpr uint64_t KEY_MOVED = std::numeric_limits<uint64_t>::max() -1; // the slot has been sealed, continue the probe in the next table
+    static constexpr uint64_t VALUE_PENDING = std::numeric_limits<uint64_t>::max(); // the value is being published by the thread that claimed the slot
+    static constexpr uint64_t VALUE_REMOVED = std::numeric_limits<uint64_t>::max() -1; // the key has been removed
+
+    struct alignas(16) Slot {
+        std::atomic<uint64_t> m_key;
+        std::atomic<uint64_t> m_value;
+    };
+
+    struct Table {
+        const uint64_t m_capacity; // number of slots, a power of 2
+        const uint64_t m_max_entries; // max number of keys stored before the table is considered full
+        std::atomic<uint64_t> m_num_entries {0}; // number of slots claimed so far
+        std::atomic<Table*> m_next {nullptr}; // the next table in the chain
+        Slot* m_slots; // the actual slots of the table
+
+        Table(uint64_t capacity);
+        ~Table();
+    };
+
+    Table* m_head; // first table of the chain
+    std::atomic<uint64_t> m_size {0}; // number of keys stored
+
+    // Retrieve the slot for the given key, claiming a new slot if the key is not present
+    // @param out_claimed set to true if the slot has been claimed by this invocation, and its value is still pending
+    Slot* acquire(uint64_t key, bool* out_claimed);
+
+    // Retrieve the slot for the given key, or nullptr if the key has never been inserted
+    const Slot* lookup(uint64_t key) const;
+
+    // Retrieve the next table in the chain, creating it if it does not exist yet
+    Table* next_table(Table* table);
+
+    // Wait for the value of the given slot to be published
+    static uint64_t wait_value(const Slot* slot);
+
+    // Publish the value of a slot claimed or revived by the current thread
+    void publish(Slot* slot, uint64_t value);
+
+    // Claim back the value of a removed key, so that the current thread can publish a new value
+    bool revive(Slot* slot);
+
+    // Cancel a claim or a revive of the current thread, the key is left as removed
+    void cancel(Slot* slot);
+
+    // Check that the given key/value can be stored
+    static void validate(uint64_t key, uint64_t value);
+
+public:
+    /**
+     * Create a new dictionary
+     * @param capacity the initial number of slots, rounded up to a power of 2. The dictionary can store up to half of
+     *        these entries before growing.
+     */
+    VertexDictionary(uint64_t capacity = 1024);
+
+    // Destructor
+    ~VertexDictionary();
+
+    /**
+     * Retrieve the value associated to the given key
+     * @return true if the key is present, false otherwise
+     */
+    bool find(uint64_t key, uint64_t* out_value) const;
+
+    /**
+     * Insert the given key if it is not already present
+     * @return the value associated to the key, by this invocation or by the thread that inserted it first, and
+     *         whether the key has been inserted by this invocation
+     */
+    std::pair<uint64_t, bool> insert(uint64_t key, uint64_t value);
+
+    /**
+     * Retrieve the value associated to the given key. If the key is not present, invoke `create' to compute its value.
+     * Only one thread invokes `create' for the same key, the other threads wait for its value.
+     * @param out_inserted if not null, set to true if the key has been inserted by this invocation
+     */
+    template<typename Function>
+    uint64_t get_or_create(uint64_t key, Function&& create, bool* out_inserted = nullptr);
+
+    /**
+     * Remove the given key from the dictionary
+     * @param out_value if not null, set to the value associated to the key
+     * @return true if the key was present, false otherwise
+     */
+    bool remove(uint64_t key, uint64_t* out_value = nullptr);
+
+    /**
+     * Insert the given keys & values in parallel, with OpenMP. It is meant to load a graph and it is not safe to invoke
+     * concurrently to other operations on the dictionary. If the dictionary is empty, it is resized ahead to store all
+     * keys in a single table.
+     */
+    void bulk_load(const uint64_t* keys, const uint64_t* values, uint64_t num_entries);
+
+    // Check whether the given key is present
+    bool contains(uint64_t key) const;
+
+    // Number of keys stored in the dictionary
+    uint64_t size() const;
+
+    // Total number of slots in the chain of tables
+    uint64_t capacity() const;
+
+    // Number of tables in the chain
+    uint64_t num_tables() const;
+};
+
+/*****************************************************************************
+ *                                                                           *
+ *  Implementation details                                                   *
+ *                                                                           *
+ *****************************************************************************/
+
+template<typename Function>
+uint64_t VertexDictionary::get_or_create(uint64_t key, Function&& create, bool* out_inserted){
+    validate(key, 0);
+    bool claimed = false;
+    Slot* slot = acquire(key, &claimed);
+
+    while(true){
+        if(claimed || revive(slot)){
+            uint64_t value = 0;
+            try {
+                value = create();
+                validate(key, value);
+            } catch(...){
+                cancel(slot);
+                throw;
+            }
+            publish(slot, value);
+            if(out_inserted != nullptr){ *out_inserted = true; }
+            return value;
+        }
+
+        uint64_t value = wait_value(slot);
+        if(value != VALUE_REMOVED){
+            if(out_inserted != nullptr){ *out_inserted = false; }
+            return value;
+        }
+        // the key has been removed in the meanwhile, try to revive it
+    }
+}
+
+} // namespace
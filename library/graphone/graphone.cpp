@@ -33,6 +33,7 @@
 #include "common/timer.hpp"
 #include "third-party/gapbs/gapbs.hpp"
 #include "third-party/libcuckoo/cuckoohash_map.hh"
+#include "utility/result_writer.hpp"
 #include "utility/timeout_service.hpp"
 
 using namespace common;
@@ -640,21 +641,7 @@ void GraphOne::save_results(const vector<pair<uint64_t, T>>& result, const char*
     assert(dump2file != nullptr && "File not specified");
     COUT_DEBUG("save the results to: " << dump2file);
 
-    fstream handle(dump2file, ios_base::out);
-    if (!handle.good()) ERROR("Cannot save the result to `" << dump2file << "'");
-
-    for (const auto &p : result) {
-        handle << p.first << " ";
-
-        if(!negative_scores && p.second < 0){ // for the bfs
-            handle << numeric_limits<T>::max();
-        } else {
-            handle << p.second;
-        }
-
-        handle << "\n";
-    }
-    handle.close();
+    utility::save_results<T, negative_scores>(result, dump2file);
 }
 
 template <typename T, bool negative_scores> // for dense vertices (logical vertex IDs)
@@ -662,22 +649,7 @@ void GraphOne::save_results(const T* __restrict results, uint64_t results_sz, co
     assert(dump2file != nullptr && "File not specified");
     COUT_DEBUG("save the results to: " << dump2file);
 
-    fstream handle(dump2file, ios_base::out);
-    if (!handle.good()) ERROR("Cannot save the result to `" << dump2file << "'");
-
-    for(uint64_t i = 0; i < results_sz; i++){
-        handle << i << " ";
-
-        if(!negative_scores && results[i] < 0){ // for the bfs
-            handle << numeric_limits<T>::max();
-        } else {
-            handle << results[i];
-        }
-
-        handle << "\n";
-    }
-
-    handle.close();
+    utility::save_results<T, negative_scores>(results, results_sz, dump2file);
 }
 
 /*****************************************************************************
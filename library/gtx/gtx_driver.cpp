@@ -8,23 +8,29 @@
 
 #include "gtx_driver.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <mutex>
 #include <limits>
+#include <memory>
+#include <omp.h>
 #include <sstream>
 #include <thread>
 #include <unordered_set>
 
 #include "../../third-party/libcommon/include/lib/common/system.hpp"
 #include "../../third-party/libcommon/include/lib/common/timer.hpp"
-#include "tbb/concurrent_hash_map.h"
-#include "../../third-party/gapbs/gapbs.hpp"
 #include "../../third-party/libcuckoo/cuckoohash_map.hh"
 #include "GTX.hpp"
+#include "../common/intersection.hpp"
+#include "../common/kernels.hpp"
+#include "../common/label_histogram.hpp"
+#include "../../utility/result_writer.hpp"
 #include "../../utility/timeout_service.hpp"
 
 using namespace common;
@@ -32,8 +38,17 @@ using namespace libcuckoo;
 using namespace std;
 
 #define GTX reinterpret_cast<gt::Graph*>(m_pImpl)
-using vertex_dictionary_t = tbb::concurrent_hash_map<uint64_t, gt::vertex_t>;
-#define VertexDictionary reinterpret_cast<vertex_dictionary_t*>(m_pHashMap)
+
+// Content of the slots in the flat array m_dense_vertices. Otherwise, a slot stores the internal vertex ID + 1
+static constexpr uint64_t DENSE_VERTEX_EMPTY = 0; // the vertex does not exist
+static constexpr uint64_t DENSE_VERTEX_CREATING = numeric_limits<uint64_t>::max(); // the vertex is being created by another thread
+
+// Reverse translation, from the internal to the external vertex IDs. The array is split in segments, allocated on demand
+// as the vertices are created, so that it can grow without relocating the slots already published.
+static constexpr uint64_t INT2EXT_SEGMENT_BITS = 18; // 2^18 vertices, 2 MB, per segment
+static constexpr uint64_t INT2EXT_SEGMENT_SIZE = 1ull << INT2EXT_SEGMENT_BITS;
+static constexpr uint64_t INT2EXT_NUM_SEGMENTS = 1ull << 18; // up to 2^36 vertices
+static constexpr uint64_t INT2EXT_EMPTY = numeric_limits<uint64_t>::max(); // the vertex has not been published
 
 /*****************************************************************************
  *                                                                           *
@@ -50,14 +65,19 @@ namespace gfe { extern mutex _log_mutex [[maybe_unused]]; }
 #endif
 
 namespace gfe::library {
-    GTXDriver::GTXDriver(bool is_directed, bool read_only):m_pImpl(nullptr), m_pHashMap(nullptr), m_is_directed(is_directed),m_read_only(read_only) {
+    GTXDriver::GTXDriver(bool is_directed, bool read_only, uint64_t dense_vertex_ids):m_pImpl(nullptr), m_dense_capacity(dense_vertex_ids), m_is_directed(is_directed),m_read_only(read_only) {
         m_pImpl = new gt::Graph();
-        m_pHashMap = new tbb::concurrent_hash_map<uint64_t, /* vertex_t */ uint64_t>();
+        if(m_dense_capacity > 0){
+            m_dense_vertices.reset(new atomic<uint64_t>[m_dense_capacity]()); // value initialised to DENSE_VERTEX_EMPTY
+        }
+        m_int2ext.reset(new atomic<atomic<uint64_t>*>[INT2EXT_NUM_SEGMENTS]()); // value initialised to nullptr
     }
 
     GTXDriver::~GTXDriver() noexcept {
         delete GTX; m_pImpl = nullptr;
-        delete VertexDictionary; m_pHashMap = nullptr;
+        for(uint64_t i = 0; i < INT2EXT_NUM_SEGMENTS; i++){
+            delete[] m_int2ext[i].load(memory_order_relaxed);
+        }
     }
 
     void GTXDriver::set_worker_thread_num(uint64_t new_num) {
@@ -107,7 +127,7 @@ namespace gfe::library {
     }
 
     void* GTXDriver::vertex_dictionary() {
-        return m_pHashMap;
+        return &m_vertex_dictionary;
     }
 
     void GTXDriver::analytical_workload_end(){
@@ -118,9 +138,9 @@ namespace gfe::library {
         GTX->whole_label_graph_eager_consolidation(1);
     }
     uint64_t GTXDriver::ext2int(uint64_t external_vertex_id) const {
-        vertex_dictionary_t::const_accessor accessor;
-        if ( VertexDictionary->find(accessor, external_vertex_id ) ){
-            return accessor->second;
+        uint64_t internal_vertex_id = 0;
+        if ( vertex_find(external_vertex_id, &internal_vertex_id) ){
+            return internal_vertex_id;
         } else {
             std::cout<<"unable to find the vertex "<<external_vertex_id<<std::endl;
             //ERROR("The given vertex does not exist: " << external_vertex_id);
@@ -128,8 +148,38 @@ namespace gfe::library {
             return 0;
         }
     }
+    void GTXDriver::int2ext_publish(uint64_t internal_vertex_id, uint64_t external_vertex_id){
+        const uint64_t segment_id = internal_vertex_id >> INT2EXT_SEGMENT_BITS;
+        if(segment_id >= INT2EXT_NUM_SEGMENTS){ ERROR("Internal vertex ID too large for the reverse translation: " << internal_vertex_id); }
+
+        atomic<uint64_t>* segment = m_int2ext[segment_id].load(memory_order_acquire);
+        if(segment == nullptr){
+            atomic<uint64_t>* candidate = new atomic<uint64_t>[INT2EXT_SEGMENT_SIZE];
+            for(uint64_t i = 0; i < INT2EXT_SEGMENT_SIZE; i++){ candidate[i].store(INT2EXT_EMPTY, memory_order_relaxed); }
+            if(m_int2ext[segment_id].compare_exchange_strong(segment, candidate, memory_order_acq_rel, memory_order_acquire)){
+                segment = candidate;
+            } else { // another thread allocated the segment first
+                delete[] candidate;
+            }
+        }
+
+        segment[internal_vertex_id & (INT2EXT_SEGMENT_SIZE -1)].store(external_vertex_id, memory_order_release);
+    }
+
+    uint64_t GTXDriver::int2ext_lookup(uint64_t internal_vertex_id) const {
+        const uint64_t segment_id = internal_vertex_id >> INT2EXT_SEGMENT_BITS;
+        if(segment_id >= INT2EXT_NUM_SEGMENTS) return INT2EXT_EMPTY;
+        const atomic<uint64_t>* segment = m_int2ext[segment_id].load(memory_order_acquire);
+        if(segment == nullptr) return INT2EXT_EMPTY;
+        return segment[internal_vertex_id & (INT2EXT_SEGMENT_SIZE -1)].load(memory_order_relaxed);
+    }
+
     //todo: check what should we do to support both read only and rw transaction here
     uint64_t GTXDriver::int2ext(void* opaque_transaction, uint64_t internal_vertex_id) const {
+        uint64_t external_vertex_id = int2ext_lookup(internal_vertex_id);
+        if(external_vertex_id != INT2EXT_EMPTY){ return external_vertex_id; }
+
+        // the vertex does not exist or it is still being created, check the snapshot of the transaction
         //todo: if read_only, else
         if(m_read_only){
             auto transaction = reinterpret_cast<gt::SharedROTransaction*>(opaque_transaction);
@@ -153,6 +203,9 @@ namespace gfe::library {
     }
 
     uint64_t GTXDriver::int2ext_openmp(void *opaque_transaction, uint64_t internal_vertex_id, uint8_t thread_id) const {
+        uint64_t external_vertex_id = int2ext_lookup(internal_vertex_id);
+        if(external_vertex_id != INT2EXT_EMPTY){ return external_vertex_id; }
+
         auto transaction = reinterpret_cast<gt::SharedROTransaction*>(opaque_transaction);
         string_view payload = transaction->get_vertex(internal_vertex_id,thread_id);//they store external vid in the vertex data for experiments
         if(payload.empty()){ // the vertex does not exist
@@ -161,30 +214,96 @@ namespace gfe::library {
             return *(reinterpret_cast<const uint64_t*>(payload.data()));
         }
     }
-    bool GTXDriver::add_vertex(uint64_t external_id) {
-        vertex_dictionary_t::accessor accessor; // xlock
-        bool inserted = VertexDictionary->insert(accessor, external_id);
-        if ( inserted ){
-            gt::vertex_t internal_id = 0;
-            bool done = false;
-            do {
-                auto tx = GTX->begin_read_write_transaction();
-                try {
-                    internal_id = tx.new_vertex();
-                    string_view data { (char*) &external_id, sizeof(external_id) };
-                    tx.put_vertex(internal_id, data);
-                    tx.commit();
-                    done = true;
-                } catch(gt::RollbackExcept& e){
-                    tx.abort();
-                    COUT_DEBUG("Rollback, vertex id: " << external_id);
-                    // retry ...
+    bool GTXDriver::dense_vertex_find(uint64_t external_vertex_id, uint64_t* out_internal_vertex_id) const {
+        assert(is_dense_vertex(external_vertex_id));
+        uint64_t value = m_dense_vertices[external_vertex_id].load(memory_order_acquire);
+        while(value == DENSE_VERTEX_CREATING){ // wait for the other thread to create the vertex
+            this_thread::yield();
+            value = m_dense_vertices[external_vertex_id].load(memory_order_acquire);
+        }
+        if(value == DENSE_VERTEX_EMPTY){
+            return false;
+        } else {
+            *out_internal_vertex_id = value -1;
+            return true;
+        }
+    }
+
+    uint64_t GTXDriver::dense_vertex_get_or_create(uint64_t external_vertex_id, bool* out_inserted){
+        assert(is_dense_vertex(external_vertex_id));
+        atomic<uint64_t>& slot = m_dense_vertices[external_vertex_id];
+        uint64_t value = slot.load(memory_order_acquire);
+        while(true){
+            if(value == DENSE_VERTEX_EMPTY){
+                // try to acquire the right to create the vertex
+                if(slot.compare_exchange_weak(value, DENSE_VERTEX_CREATING, memory_order_acquire, memory_order_acquire)){
+                    uint64_t internal_vertex_id = 0;
+                    try {
+                        internal_vertex_id = create_vertex(external_vertex_id);
+                    } catch(...){ // release the slot, otherwise the threads waiting on it would spin forever
+                        slot.store(DENSE_VERTEX_EMPTY, memory_order_release);
+                        throw;
+                    }
+                    slot.store(internal_vertex_id +1, memory_order_release);
+                    m_num_vertices++;
+                    if(out_inserted != nullptr){ *out_inserted = true; }
+                    return internal_vertex_id;
                 }
-            } while(!done);
+            } else if(value == DENSE_VERTEX_CREATING){ // another thread is creating the vertex
+                this_thread::yield();
+                value = slot.load(memory_order_acquire);
+            } else { // the vertex already exists
+                if(out_inserted != nullptr){ *out_inserted = false; }
+                return value -1;
+            }
+        }
+    }
+
+    uint64_t GTXDriver::create_vertex(uint64_t external_id){
+        gt::vertex_t internal_id = 0;
+        bool done = false;
+        do {
+            auto tx = GTX->begin_read_write_transaction();
+            try {
+                internal_id = tx.new_vertex();
+                string_view data { (char*) &external_id, sizeof(external_id) };
+                tx.put_vertex(internal_id, data);
+                tx.commit();
+                done = true;
+            } catch(gt::RollbackExcept& e){
+                tx.abort();
+                COUT_DEBUG("Rollback, vertex id: " << external_id);
+                // retry ...
+            }
+        } while(!done);
+
+        int2ext_publish(internal_id, external_id);
+        return internal_id;
+    }
+
+    bool GTXDriver::vertex_find(uint64_t external_vertex_id, uint64_t* out_internal_vertex_id) const {
+        if(is_dense_vertex(external_vertex_id)){
+            return dense_vertex_find(external_vertex_id, out_internal_vertex_id);
+        } else {
+            return m_vertex_dictionary.find(external_vertex_id, out_internal_vertex_id);
+        }
+    }
 
-            accessor->second = internal_id;
-            m_num_vertices++;
+    uint64_t GTXDriver::vertex_get_or_create(uint64_t external_vertex_id, bool* out_inserted){
+        if(is_dense_vertex(external_vertex_id)){ // fast path, no dictionary
+            return dense_vertex_get_or_create(external_vertex_id, out_inserted);
         }
+
+        bool inserted = false;
+        uint64_t internal_vertex_id = m_vertex_dictionary.get_or_create(external_vertex_id, [&](){ return create_vertex(external_vertex_id); }, &inserted);
+        if(inserted){ m_num_vertices++; }
+        if(out_inserted != nullptr){ *out_inserted = inserted; }
+        return internal_vertex_id;
+    }
+
+    bool GTXDriver::add_vertex(uint64_t external_id) {
+        bool inserted = false;
+        vertex_get_or_create(external_id, &inserted);
         return inserted;
     }
     //todo:: currently gtx did not implement delete vertex, it should be much more complicated
@@ -194,16 +313,15 @@ namespace gfe::library {
     }
 
     bool GTXDriver::has_vertex(uint64_t vertex_id) const {
-        vertex_dictionary_t::const_accessor accessor;
-        return VertexDictionary->find(accessor, vertex_id);
+        uint64_t internal_vertex_id = 0;
+        return vertex_find(vertex_id, &internal_vertex_id);
     }
 
     bool GTXDriver::add_edge(gfe::graph::WeightedEdge e) {
-        vertex_dictionary_t::const_accessor accessor1, accessor2;  // shared lock on the dictionary
-        if(!VertexDictionary->find(accessor1, e.source())){ return false; }
-        if(!VertexDictionary->find(accessor2, e.destination())) { return false; }
-        gt::vertex_t internal_source_id = accessor1->second;
-        gt::vertex_t internal_destination_id = accessor2->second;
+        gt::vertex_t internal_source_id = 0;
+        gt::vertex_t internal_destination_id = 0;
+        if(!vertex_find(e.source(), &internal_source_id)){ return false; }
+        if(!vertex_find(e.destination(), &internal_destination_id)){ return false; }
 
         bool done = false;
         do {
@@ -246,47 +364,15 @@ namespace gfe::library {
         uint64_t internal_destination_id = 0;
         bool insert_source = false;
         bool insert_destination = false;
-        vertex_dictionary_t::const_accessor slock1, slock2;
-        vertex_dictionary_t::accessor xlock1, xlock2;
         bool result = false;
-        if(VertexDictionary->find(slock1, edge.m_source)){ // insert the vertex e.m_source
-            internal_source_id = slock1->second;
-        } else {
-            slock1.release();
-            if ( VertexDictionary->insert(xlock1, edge.m_source) ) {
-                insert_source = true;
-            } else {
-                internal_source_id = xlock1->second;
-            }
-        }
-
-        if(VertexDictionary->find(slock2, edge.m_destination)){ // insert the vertex e.m_destination
-            internal_destination_id = slock2->second;
-        } else {
-            slock2.release();
-            if( VertexDictionary->insert(xlock2, edge.m_destination) ) {
-                insert_destination = true;
-            } else {
-                internal_destination_id = xlock2->second;
-            }
-        }
+        // the vertices are created, if they do not exist, in their own transactions
+        internal_source_id = vertex_get_or_create(edge.m_source, &insert_source);
+        internal_destination_id = vertex_get_or_create(edge.m_destination, &insert_destination);
 
         bool done = false;
         do {
             auto tx = GTX->begin_read_write_transaction();
             try {
-                // create the vertices in GTX
-                if(insert_source){
-                    internal_source_id = tx.new_vertex();
-                    string_view data { (char*) &edge.m_source, sizeof(edge.m_source) };
-                    tx.put_vertex(internal_source_id, data);
-                }
-                if(insert_destination){
-                    internal_destination_id = tx.new_vertex();
-                    string_view data { (char*) &edge.m_destination, sizeof(edge.m_destination) };
-                    tx.put_vertex(internal_destination_id, data);
-                }
-
                 // insert the edge
                 string_view weight { (char*) &edge.m_weight, sizeof(edge.m_weight) };
                 //string weight = "weight";//todo:: change this back
@@ -313,17 +399,6 @@ namespace gfe::library {
             }
         } while(!done);
 
-        if(insert_source){
-            assert(internal_source_id != numeric_limits<uint64_t>::max());
-            xlock1->second = internal_source_id;
-            m_num_vertices++;
-        }
-        if(insert_destination){
-            assert(internal_destination_id != numeric_limits<uint64_t>::max());
-            xlock2->second = internal_destination_id;
-            m_num_vertices++;
-        }
-
         return result;
     }
 /*
@@ -334,47 +409,15 @@ namespace gfe::library {
         uint64_t internal_destination_id = 0;
         bool insert_source = false;
         bool insert_destination = false;
-        vertex_dictionary_t::const_accessor slock1, slock2;
-        vertex_dictionary_t::accessor xlock1, xlock2;
         bool result = false;
-        if(VertexDictionary->find(slock1, edge.m_source)){ // insert the vertex e.m_source
-            internal_source_id = slock1->second;
-        } else {
-            slock1.release();
-            if ( VertexDictionary->insert(xlock1, edge.m_source) ) {
-                insert_source = true;
-            } else {
-                internal_source_id = xlock1->second;
-            }
-        }
-
-        if(VertexDictionary->find(slock2, edge.m_destination)){ // insert the vertex e.m_destination
-            internal_destination_id = slock2->second;
-        } else {
-            slock2.release();
-            if( VertexDictionary->insert(xlock2, edge.m_destination) ) {
-                insert_destination = true;
-            } else {
-                internal_destination_id = xlock2->second;
-            }
-        }
+        // the vertices are created, if they do not exist, in their own transactions
+        internal_source_id = vertex_get_or_create(edge.m_source, &insert_source);
+        internal_destination_id = vertex_get_or_create(edge.m_destination, &insert_destination);
 
         bool done = false;
         do {
             auto tx = GTX->begin_read_write_transaction();
             try {
-                // create the vertices in GTX
-                if(insert_source){
-                    internal_source_id = tx.new_vertex();
-                    string_view data { (char*) &edge.m_source, sizeof(edge.m_source) };
-                    tx.put_vertex(internal_source_id, data);
-                }
-                if(insert_destination){
-                    internal_destination_id = tx.new_vertex();
-                    string_view data { (char*) &edge.m_destination, sizeof(edge.m_destination) };
-                    tx.put_vertex(internal_destination_id, data);
-                }
-
                 // insert the edge
                 string_view weight { (char*) &edge.m_weight, sizeof(edge.m_weight) };
                 //string weight = "weight";//todo:: change this back
@@ -401,17 +444,6 @@ namespace gfe::library {
             }
         } while(!done);
 
-        if(insert_source){
-            assert(internal_source_id != numeric_limits<uint64_t>::max());
-            xlock1->second = internal_source_id;
-            m_num_vertices++;
-        }
-        if(insert_destination){
-            assert(internal_destination_id != numeric_limits<uint64_t>::max());
-            xlock2->second = internal_destination_id;
-            m_num_vertices++;
-        }
-
         return true;
     }
 
@@ -423,50 +455,17 @@ namespace gfe::library {
         uint64_t internal_destination_id = 0;
         bool insert_source = false;
         bool insert_destination = false;
-        vertex_dictionary_t::const_accessor slock1, slock2;
-        vertex_dictionary_t::accessor xlock1, xlock2;
         bool result = false;
-        if(VertexDictionary->find(slock1, edge.m_source)){ // insert the vertex e.m_source
-            internal_source_id = slock1->second;
-        } else {
-            slock1.release();
-            if ( VertexDictionary->insert(xlock1, edge.m_source) ) {
-                insert_source = true;
-            } else {
-                internal_source_id = xlock1->second;
-            }
-        }
-
-        if(VertexDictionary->find(slock2, edge.m_destination)){ // insert the vertex e.m_destination
-            internal_destination_id = slock2->second;
-        } else {
-            slock2.release();
-            if( VertexDictionary->insert(xlock2, edge.m_destination) ) {
-                insert_destination = true;
-            } else {
-                internal_destination_id = xlock2->second;
-            }
-        }
+        // the vertices are created, if they do not exist, in their own transactions
+        internal_source_id = vertex_get_or_create(edge.m_source, &insert_source);
+        internal_destination_id = vertex_get_or_create(edge.m_destination, &insert_destination);
 
         bool done = false;
-        bool need_check = true;
+        bool need_check = !insert_source && !insert_destination; // a new vertex cannot have edges yet
         do {
             auto tx = GTX->begin_read_write_transaction();
             double update_weight = edge.m_weight;
             try {
-                // create the vertices in GTX
-                if(insert_source){
-                    internal_source_id = tx.new_vertex();
-                    string_view data { (char*) &edge.m_source, sizeof(edge.m_source) };
-                    tx.put_vertex(internal_source_id, data);
-                    need_check= false;
-                }
-                if(insert_destination){
-                    internal_destination_id = tx.new_vertex();
-                    string_view data { (char*) &edge.m_destination, sizeof(edge.m_destination) };
-                    tx.put_vertex(internal_destination_id, data);
-                    need_check= false;
-                }
                 if(need_check){
                     std::string_view read_result = tx.get_edge(internal_source_id,internal_destination_id,1);
                     if(!read_result.empty()){
@@ -500,25 +499,14 @@ namespace gfe::library {
             }
         } while(!done);
 
-        if(insert_source){
-            assert(internal_source_id != numeric_limits<uint64_t>::max());
-            xlock1->second = internal_source_id;
-            m_num_vertices++;
-        }
-        if(insert_destination){
-            assert(internal_destination_id != numeric_limits<uint64_t>::max());
-            xlock2->second = internal_destination_id;
-            m_num_vertices++;
-        }
         return true;
     }
 
     bool GTXDriver::remove_edge(gfe::graph::Edge e){
-        vertex_dictionary_t::const_accessor slock1, slock2;
-        if(!VertexDictionary->find(slock1, e.source())){ return false; }
-        if(!VertexDictionary->find(slock2, e.destination())){ return false; }
-        gt::vertex_t internal_source_id = slock1->second;
-        gt::vertex_t internal_destination_id = slock2->second;
+        gt::vertex_t internal_source_id = 0;
+        gt::vertex_t internal_destination_id = 0;
+        if(!vertex_find(e.source(), &internal_source_id)){ return false; }
+        if(!vertex_find(e.destination(), &internal_destination_id)){ return false; }
 
         while(true){
             auto tx = GTX->begin_read_write_transaction();
@@ -546,13 +534,140 @@ namespace gfe::library {
         }
     }
 
+    bool GTXDriver::has_atomic_batches() const {
+        return true;
+    }
+
+    uint64_t GTXDriver::update_batch(const SingleUpdate* updates, uint64_t num_updates, BatchAtomicity atomicity, bool* out_applied){
+        if(atomicity == BatchAtomicity::PER_EDGE){ return UpdateInterface::update_batch(updates, num_updates, atomicity, out_applied); }
+        if(num_updates == 0){ return 0; }
+
+        unique_ptr<bool[]> ptr_applied;
+        if(out_applied == nullptr){
+            ptr_applied.reset(new bool[num_updates]);
+            out_applied = ptr_applied.get();
+        }
+        unique_ptr<uint64_t[]> ptr_internal_ids { new uint64_t[2 * num_updates] };
+        update_batch_vertices(updates, num_updates, ptr_internal_ids.get());
+
+        if(atomicity == BatchAtomicity::PER_BATCH){
+            uint64_t num_applied = 0;
+            while(!update_batch_tx(updates, ptr_internal_ids.get(), num_updates, /* all or nothing */ true, out_applied, &num_applied)){ /* retry ... */ }
+            return num_applied;
+        } else { // best effort
+            return update_batch_best_effort(updates, ptr_internal_ids.get(), num_updates, out_applied);
+        }
+    }
+
+    void GTXDriver::update_batch_vertices(const SingleUpdate* updates, uint64_t num_updates, uint64_t* out_internal_ids){
+        // the vertices are created one at the time, with the same logic of #add_vertex, each in its own transaction
+        for(uint64_t i = 0; i < num_updates; i++){
+            const uint64_t endpoints[2] = { updates[i].m_source, updates[i].m_destination };
+            for(uint64_t j = 0; j < 2; j++){
+                uint64_t internal_vertex_id = numeric_limits<uint64_t>::max();
+                if(updates[i].m_weight >= 0){ // insertion
+                    internal_vertex_id = vertex_get_or_create(endpoints[j]);
+                } else {
+                    vertex_find(endpoints[j], &internal_vertex_id);
+                }
+                out_internal_ids[2*i +j] = internal_vertex_id;
+            }
+        }
+    }
+
+    bool GTXDriver::update_batch_tx(const SingleUpdate* updates, const uint64_t* internal_ids, uint64_t num_updates, bool all_or_nothing, bool* out_applied, uint64_t* out_num_applied){
+        // best effort, the updates of an undirected graph where only one of the two directions could be applied. They
+        // are skipped when the transaction is restarted, so that it never commits a one-way edge
+        unique_ptr<bool[]> ptr_skipped;
+
+        bool restart = false;
+        do {
+            int64_t num_edges_delta = 0; // how much the number of edges changes with this transaction
+            uint64_t num_applied = 0;
+            restart = false;
+
+            auto tx = GTX->begin_read_write_transaction();
+            try {
+                for(uint64_t i = 0; i < num_updates && !restart; i++){
+                    gt::vertex_t internal_source_id = internal_ids[2*i];
+                    gt::vertex_t internal_destination_id = internal_ids[2*i +1];
+                    bool result = false;
+                    bool half_applied = false; // only the direction source -> destination has been applied
+
+                    if(ptr_skipped && ptr_skipped[i]){
+                        result = false; // an earlier attempt could not apply the reverse direction
+                    } else if(internal_source_id == numeric_limits<uint64_t>::max() || internal_destination_id == numeric_limits<uint64_t>::max()){
+                        result = false; // removal of an edge referring a non existing vertex
+                    } else if(updates[i].m_weight >= 0){ // insertion, as in #add_edge_v2
+                        string_view weight { (char*) &(updates[i].m_weight), sizeof(updates[i].m_weight) };
+                        result = tx.checked_put_edge(internal_source_id, /* label */ 1, internal_destination_id, weight);
+                        if(!m_is_directed && result){
+                            result = tx.checked_put_edge(internal_destination_id, /* label */ 1, internal_source_id, weight);
+                            half_applied = !result;
+                        }
+                        if(result){ num_edges_delta++; }
+                    } else { // removal, as in #remove_edge
+                        result = tx.checked_delete_edge(internal_source_id, /* label */ 1, internal_destination_id);
+                        if(result && !m_is_directed){
+                            result = tx.checked_delete_edge(internal_destination_id, /* label */ 1, internal_source_id);
+                            half_applied = !result;
+                        }
+                        if(result){ num_edges_delta--; }
+                    }
+
+                    if(!result && all_or_nothing){ // discard the whole group
+                        tx.abort();
+                        for(uint64_t j = 0; j < num_updates; j++){ out_applied[j] = false; }
+                        *out_num_applied = 0;
+                        return true;
+                    } else if(half_applied){ // roll back the first direction and repeat the transaction without this update
+                        tx.abort();
+                        if(!ptr_skipped){
+                            ptr_skipped.reset(new bool[num_updates]);
+                            for(uint64_t j = 0; j < num_updates; j++){ ptr_skipped[j] = false; }
+                        }
+                        ptr_skipped[i] = true;
+                        restart = true;
+                    } else {
+                        out_applied[i] = result;
+                        num_applied += result;
+                    }
+                }
+
+                if(!restart){
+                    if(!tx.commit()){ return false; } // retry ...
+                    m_num_edges += num_edges_delta;
+                    *out_num_applied = num_applied;
+                }
+            } catch (gt::RollbackExcept& e){
+                tx.abort();
+                COUT_DEBUG("Rollback, group of " << num_updates << " updates");
+                return false; // retry ...
+            }
+        } while(restart);
+
+        return true;
+    }
+
+    uint64_t GTXDriver::update_batch_best_effort(const SingleUpdate* updates, const uint64_t* internal_ids, uint64_t num_updates, bool* out_applied){
+        uint64_t num_applied = 0;
+        if(num_updates == 1){
+            while(!update_batch_tx(updates, internal_ids, 1, /* all or nothing */ false, out_applied, &num_applied)){ /* retry ... */ }
+        } else if(!update_batch_tx(updates, internal_ids, num_updates, /* all or nothing */ false, out_applied, &num_applied)){
+            // conflict with another writer, retry with two smaller transactions
+            uint64_t half = num_updates / 2;
+            num_applied = update_batch_best_effort(updates, internal_ids, half, out_applied);
+            num_applied += update_batch_best_effort(updates + half, internal_ids + 2 * half, num_updates - half, out_applied + half);
+        }
+        return num_applied;
+    }
+
     double GTXDriver::get_weight(uint64_t source, uint64_t destination) const {
         // check whether the referred vertices exist
-        vertex_dictionary_t::const_accessor slock1, slock2;
-        if(!VertexDictionary->find(slock1, source)){ return numeric_limits<double>::signaling_NaN(); }
-        if(!VertexDictionary->find(slock2, destination)){ return numeric_limits<double>::signaling_NaN(); }
-        gt::vertex_t internal_source_id = slock1->second;
-        gt::vertex_t internal_destination_id = slock2->second;
+        gt::vertex_t internal_source_id = 0;
+        gt::vertex_t internal_destination_id = 0;
+        if(!vertex_find(source, &internal_source_id)){ return numeric_limits<double>::signaling_NaN(); }
+        if(!vertex_find(destination, &internal_destination_id)){ return numeric_limits<double>::signaling_NaN(); }
 
         auto tx = GTX->begin_read_only_transaction();
        /*string_view bg_weight = tx.get_edge(internal_source_id, internal_destination_id, 1);
@@ -616,12 +731,22 @@ namespace gfe::library {
                 output[logical_id-1] = make_pair(external_id, data[logical_id-1]);
             }
         }*/
+        // The external IDs are gathered from the reverse translation array. GTX never removes the vertices, thus only
+        // those created concurrently to the transaction may be missing from the array and they are looked up in the
+        // snapshot. A vertex committed after the snapshot, but already published in the array, is reported with the
+        // score computed for it by the kernel, as an isolated vertex.
         auto graph = transaction->get_graph();
 #pragma omp parallel
         {
             uint8_t thread_id = graph->get_openmp_worker_thread_id();
 #pragma omp for
             for(uint64_t logical_id = 1; logical_id <= data_sz; logical_id++){
+                uint64_t external_id = int2ext_lookup(logical_id);
+                if(external_id != INT2EXT_EMPTY){
+                    output[logical_id-1] = make_pair(external_id, data[logical_id-1]);
+                    continue;
+                }
+
                 string_view payload = transaction->get_vertex(logical_id,thread_id);//they store external vid in the vertex data for experiments
                 if(payload.empty()){ // the vertex does not exist
                     output[logical_id-1] = make_pair(numeric_limits<uint64_t>::max(), numeric_limits<T>::max());
@@ -653,6 +778,12 @@ namespace gfe::library {
         {
 #pragma omp for
             for(uint64_t logical_id = 1; logical_id <= data_sz; logical_id++){
+                uint64_t external_id = int2ext_lookup(logical_id); // as in #translate
+                if(external_id != INT2EXT_EMPTY){
+                    output[logical_id-1] = make_pair(external_id, data[logical_id-1]);
+                    continue;
+                }
+
                 string_view payload = transaction->static_get_vertex(logical_id);//they store external vid in the vertex data for experiments
                 if(payload.empty()){ // the vertex does not exist
                     output[logical_id-1] = make_pair(numeric_limits<uint64_t>::max(), numeric_limits<T>::max());
@@ -669,546 +800,181 @@ namespace gfe::library {
         assert(dump2file != nullptr);
         COUT_DEBUG("save the results to: " << dump2file);
 
-        fstream handle(dump2file, ios_base::out);
-        if (!handle.good()) ERROR("Cannot save the result to `" << dump2file << "'");
-
-        for (const auto &p : result) {
-            if(p.first == numeric_limits<uint64_t>::max()) continue; // invalid node
-
-            handle << p.first << " ";
-
-            if(!negative_scores && p.second < 0){
-                handle << numeric_limits<T>::max();
-            } else {
-                handle << p.second;
-            }
-
-            handle << "\n";
-        }
-
-        handle.close();
+        utility::save_results<T, negative_scores>(result, dump2file);
     }
 
     /*****************************************************************************
      *                                                                           *
-     *  BFS                                                                      *
+     *  View                                                                     *
      *                                                                           *
      *****************************************************************************/
-    // Implementation based on the reference BFS for the GAP Benchmark Suite
-    // https://github.com/sbeamer/gapbs
-    // The reference implementation has been written by Scott Beamer
-    //
-    // Copyright (c) 2015, The Regents of the University of California (Regents)
-    // All Rights Reserved.
-    //
-    // Redistribution and use in source and binary forms, with or without
-    // modification, are permitted provided that the following conditions are met:
-    // 1. Redistributions of source code must retain the above copyright
-    //    notice, this list of conditions and the following disclaimer.
-    // 2. Redistributions in binary form must reproduce the above copyright
-    //    notice, this list of conditions and the following disclaimer in the
-    //    documentation and/or other materials provided with the distribution.
-    // 3. Neither the name of the Regents nor the
-    //    names of its contributors may be used to endorse or promote products
-    //    derived from this software without specific prior written permission.
-    //
-    // THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
-    // ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
-    // WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-    // DISCLAIMED. IN NO EVENT SHALL REGENTS BE LIABLE FOR ANY
-    // DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
-    // (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
-    // LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
-    // ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-    // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-    // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-
-    /*
-
-    Will return parent array for a BFS traversal from a source vertex
-    This BFS implementation makes use of the Direction-Optimizing approach [1].
-    It uses the alpha and beta parameters to determine whether to switch search
-    directions. For representing the frontier, it uses a SlidingQueue for the
-    top-down approach and a Bitmap for the bottom-up approach. To reduce
-    false-sharing for the top-down approach, thread-local QueueBuffer's are used.
-    To save time computing the number of edges exiting the frontier, this
-    implementation precomputes the degrees in bulk at the beginning by storing
-    them in parent array as negative numbers. Thus the encoding of parent is:
-      parent[x] < 0 implies x is unvisited and parent[x] = -out_degree(x)
-      parent[x] >= 0 implies x been visited
-    [1] Scott Beamer, Krste Asanović, and David Patterson. "Direction-Optimizing
-        Breadth-First Search." International Conference on High Performance
-        Computing, Networking, Storage and Analysis (SC), Salt Lake City, Utah,
-        November 2012.
-
-    */
-    //#define DEBUG_BFS
-#if defined(DEBUG_BFS)
-#define COUT_DEBUG_BFS(msg) COUT_DEBUG(msg)
-#else
-#define COUT_DEBUG_BFS(msg)
-#endif
-
-    static
-    int64_t do_bfs_BUStep(gt::SharedROTransaction& transaction, uint64_t max_vertex_id, int64_t* distances, int64_t distance, gapbs::Bitmap &front, gapbs::Bitmap &next) {
-        int64_t awake_count = 0;
-        next.reset();
-        auto graph = transaction.get_graph();
-//#pragma omp parallel for schedule(dynamic, 1024) reduction(+ : awake_count)
-#pragma omp parallel reduction(+ : awake_count)
-        {
-            uint8_t thread_id = graph->get_openmp_worker_thread_id();
-            auto iterator = transaction.generate_edge_delta_iterator(thread_id);
-#pragma omp for schedule(dynamic, 1024)
-            for (uint64_t u = 1; u <= max_vertex_id; u++) {
-                if (distances[u - 1] == numeric_limits<int64_t>::max()) continue; // the vertex does not exist
-                COUT_DEBUG_BFS("explore: " << u << ", distance: " << distances[u]);
-
-                if (distances[u - 1] < 0) { // the node has not been visited yet
-                    //auto iterator = transaction.simple_get_edges(u, /* label */1,thread_id); // fixme: incoming edges for directed graphs
-                    transaction.simple_get_edges(u,1,thread_id,iterator);
-                    //for debug:
-                    //uint64_t counter = 0;
-                    while (iterator.valid()) {
-                        uint64_t dst = iterator.dst_id();
-                        COUT_DEBUG_BFS("\tincoming edge: " << dst);
-                        //counter++;
-                        if (front.get_bit(dst - 1)) {
-                            COUT_DEBUG_BFS("\t-> distance updated to " << distance << " via vertex #" << dst);
-                            distances[u - 1] = distance; // on each BUStep, all nodes will have the same distance
-                            awake_count++;
-                            next.set_bit(u - 1);
-                            break;
+    // The logical vertex v of the kernels is the internal vertex v+1 of GTX. Each thread reading the transaction needs
+    // its own worker ID, acquired in #on_thread_enter and released in #on_thread_leave, while the last thread leaving
+    // a parallel region notifies GTX that the region is over. The degrees of all vertices are computed once, when the
+    // view is created. GTX only stores the outgoing edges, thus, in directed graphs, the incoming edges are gathered in
+    // the same scan into a CSR.
+    class GTXDriver::View {
+        using EdgeIterator = decltype(std::declval<gt::SharedROTransaction&>().generate_edge_delta_iterator(uint8_t{0}));
+
+        // The context of a thread inside a parallel region
+        struct ThreadContext {
+            const uint8_t m_worker_id; // assigned by GTX
+            EdgeIterator m_iterator; // reused for all vertices visited by the thread
+
+            ThreadContext(gt::SharedROTransaction* transaction, uint8_t worker_id) : m_worker_id(worker_id), m_iterator(transaction->generate_edge_delta_iterator(worker_id)) { }
+        };
+
+        gt::SharedROTransaction* m_transaction;
+        gt::Graph* m_graph;
+        const uint64_t m_max_vertex_id; // the logical IDs are in [0, max_vertex_id)
+        const bool m_is_directed;
+        unique_ptr<uint64_t[]> m_degrees; // the out degree of each vertex, or uint64_t::max() if the vertex does not exist
+        unique_ptr<uint64_t[]> m_in_offsets; // directed graphs only, the incoming edges of v are in [in_offsets[v], in_offsets[v+1])
+        unique_ptr<uint64_t[]> m_in_sources; // directed graphs only, the logical IDs of the sources of the incoming edges
+        uint64_t m_num_edges = 0; // number of edges visible to the transaction
+        unique_ptr<unique_ptr<ThreadContext>[]> m_contexts; // indexed by omp_get_thread_num()
+        mutable atomic<int> m_num_threads_left { 0 }; // threads that already left the current parallel region
+
+        ThreadContext* context() const { return m_contexts[omp_get_thread_num()].get(); }
+
+    public:
+        View(gt::SharedROTransaction* transaction, uint64_t max_vertex_id, bool is_directed) : m_transaction(transaction), m_graph(transaction->get_graph()),
+                m_max_vertex_id(max_vertex_id), m_is_directed(is_directed), m_degrees(new uint64_t[max_vertex_id]), m_contexts(new unique_ptr<ThreadContext>[omp_get_max_threads()]) {
+            uint64_t* __restrict degrees = m_degrees.get();
+            uint64_t* in_offsets = nullptr;
+            if(is_directed){ m_in_offsets.reset(new uint64_t[max_vertex_id +1]()); in_offsets = m_in_offsets.get(); }
+
+            uint64_t num_edges = 0;
+            #pragma omp parallel reduction(+:num_edges)
+            {
+                kernels::details::ThreadScope<View> scope { *this };
+                ThreadContext* ctxt = context();
+
+                #pragma omp for schedule(dynamic, 4096)
+                for(uint64_t v = 0; v < max_vertex_id; v++){
+                    if(transaction->get_vertex(v +1, ctxt->m_worker_id).empty()){ // the vertex does not exist
+                        degrees[v] = numeric_limits<uint64_t>::max();
+                    } else if(!is_directed){
+                        transaction->simple_get_edges(v +1, /* label */ 1, ctxt->m_worker_id, ctxt->m_iterator);
+                        degrees[v] = ctxt->m_iterator.get_vertex_degree();
+                        ctxt->m_iterator.close();
+                        num_edges += degrees[v];
+                    } else { // count the incoming edges of the neighbours as well
+                        uint64_t degree = 0;
+                        transaction->simple_get_edges(v +1, /* label */ 1, ctxt->m_worker_id, ctxt->m_iterator);
+                        while(ctxt->m_iterator.valid()){
+                            uint64_t u = ctxt->m_iterator.dst_id();
+                            if(u <= max_vertex_id){ __atomic_fetch_add(in_offsets + u, 1, __ATOMIC_RELAXED); degree++; }
                         }
-
-                        //iterator.next();
+                        ctxt->m_iterator.close();
+                        degrees[v] = degree;
+                        num_edges += degree;
                     }
-                    iterator.close();
                 }
             }
-            transaction.thread_on_openmp_section_finish(thread_id);
-        }
-        graph->on_openmp_section_finishing();
-        return awake_count;
-    }
-    static
-    int64_t static_do_bfs_BUStep(gt::SharedROTransaction& transaction, uint64_t max_vertex_id, int64_t* distances, int64_t distance, gapbs::Bitmap &front, gapbs::Bitmap &next) {
-        int64_t awake_count = 0;
-        next.reset();
-//#pragma omp parallel for schedule(dynamic, 1024) reduction(+ : awake_count)
-#pragma omp parallel reduction(+ : awake_count)
-        {
-            auto iterator = transaction.generate_static_edge_delta_iterator();
-#pragma omp for schedule(dynamic, 1024)
-            for (uint64_t u = 1; u <= max_vertex_id; u++) {
-                if (distances[u - 1] == numeric_limits<int64_t>::max()) continue; // the vertex does not exist
-                COUT_DEBUG_BFS("explore: " << u << ", distance: " << distances[u]);
+            m_num_edges = is_directed ? num_edges : num_edges / 2; // undirected edges are stored twice, as a -> b and b -> a
 
-                if (distances[u - 1] < 0) { // the node has not been visited yet
-                    //auto iterator = transaction.static_get_edges(u, 1); 
-                    transaction.static_get_edges(u,1,iterator);
+            if(is_directed){ // materialise the incoming edges
+                for(uint64_t v = 1; v <= max_vertex_id; v++){ in_offsets[v] += in_offsets[v -1]; }
+                m_in_sources.reset(new uint64_t[in_offsets[max_vertex_id]]);
+                uint64_t* in_sources = m_in_sources.get();
+                unique_ptr<uint64_t[]> ptr_in_cursors { new uint64_t[max_vertex_id] };
+                uint64_t* in_cursors = ptr_in_cursors.get();
+                memcpy(in_cursors, in_offsets, max_vertex_id * sizeof(uint64_t));
 
-                    while (iterator.valid()) {
-                        uint64_t dst = iterator.dst_id();
-                        COUT_DEBUG_BFS("\tincoming edge: " << dst);
-
-                        if (front.get_bit(dst - 1)) {
-                            COUT_DEBUG_BFS("\t-> distance updated to " << distance << " via vertex #" << dst);
-                            distances[u - 1] = distance; // on each BUStep, all nodes will have the same distance
-                            awake_count++;
-                            next.set_bit(u - 1);
-                            break;
-                        }
+                #pragma omp parallel
+                {
+                    kernels::details::ThreadScope<View> scope { *this };
+
+                    #pragma omp for schedule(dynamic, 4096)
+                    for(uint64_t v = 0; v < max_vertex_id; v++){
+                        for_each_out_neighbour(v, [&](uint64_t u){
+                            in_sources[__atomic_fetch_add(in_cursors + u, 1, __ATOMIC_RELAXED)] = v;
+                            return true;
+                        });
                     }
                 }
             }
         }
-        return awake_count;
-    }
-    static
-    int64_t do_bfs_TDStep(gt::SharedROTransaction& transaction, uint64_t max_vertex_id, int64_t* distances, int64_t distance, gapbs::SlidingQueue<int64_t>& queue) {
-        int64_t scout_count = 0;
-        auto graph = transaction.get_graph();
-#pragma omp parallel reduction(+ : scout_count)
-        {
-            uint8_t thread_id = graph->get_openmp_worker_thread_id();
-            auto iterator = transaction.generate_edge_delta_iterator(thread_id);
-          /*  if(thread_id>64){
-                std::cout<<static_cast<uint32_t>(thread_id)<<std::endl;
-                throw std::runtime_error("error, bad thread ID");
-            }*/
-            gapbs::QueueBuffer<int64_t> lqueue(queue);
-
-#pragma omp for schedule(dynamic, 64)
-            for (auto q_iter = queue.begin(); q_iter < queue.end(); q_iter++) {
-                int64_t u = *q_iter;
-                COUT_DEBUG_BFS("explore: " << u);
-                //auto iterator = transaction.simple_get_edges(u, /* label */ 1, thread_id);
-                transaction.simple_get_edges(u,1,thread_id,iterator);
-                while(iterator.valid()){
-                    uint64_t dst = iterator.dst_id();
-                    COUT_DEBUG_BFS("\toutgoing edge: " << dst);
-
-                    int64_t curr_val = distances[dst-1];
-                    if (curr_val < 0 && gapbs::compare_and_swap(distances[dst-1], curr_val, distance)) {
-                        COUT_DEBUG_BFS("\t-> distance updated to " << distance << " via vertex #" << dst);
-                        lqueue.push_back(dst);
-                        scout_count += -curr_val;
-                    }
 
-                   // iterator.next();
-                }
-                iterator.close();
-            }
+        uint64_t num_vertices() const { return m_max_vertex_id; }
+        bool has_vertex(uint64_t v) const { return m_degrees[v] != numeric_limits<uint64_t>::max(); }
+        uint64_t num_edges() const { return m_num_edges; }
+        bool is_directed() const { return m_is_directed; }
 
-            lqueue.flush();
-            transaction.thread_on_openmp_section_finish(thread_id);
+        void on_thread_enter() const {
+            m_contexts[omp_get_thread_num()].reset(new ThreadContext(m_transaction, m_graph->get_openmp_worker_thread_id()));
         }
-        graph->on_openmp_section_finishing();
-        return scout_count;
-    }
-    static
-    int64_t static_do_bfs_TDStep(gt::SharedROTransaction& transaction, uint64_t max_vertex_id, int64_t* distances, int64_t distance, gapbs::SlidingQueue<int64_t>& queue) {
-        int64_t scout_count = 0;
-#pragma omp parallel reduction(+ : scout_count)
-        {
-            gapbs::QueueBuffer<int64_t> lqueue(queue);
-            auto iterator = transaction.generate_static_edge_delta_iterator();
-#pragma omp for schedule(dynamic, 64)
-            for (auto q_iter = queue.begin(); q_iter < queue.end(); q_iter++) {
-                int64_t u = *q_iter;
-                COUT_DEBUG_BFS("explore: " << u);
-                //auto iterator = transaction.static_get_edges(u, /* label */ 1);
-                transaction.static_get_edges(u,1,iterator);
-                while(iterator.valid()){
-                    uint64_t dst = iterator.dst_id();
-                    COUT_DEBUG_BFS("\toutgoing edge: " << dst);
-
-                    int64_t curr_val = distances[dst-1];
-                    if (curr_val < 0 && gapbs::compare_and_swap(distances[dst-1], curr_val, distance)) {
-                        COUT_DEBUG_BFS("\t-> distance updated to " << distance << " via vertex #" << dst);
-                        lqueue.push_back(dst);
-                        scout_count += -curr_val;
-                    }
 
-                    // iterator.next();
-                }
+        void on_thread_leave() const {
+            unique_ptr<ThreadContext>& ctxt = m_contexts[omp_get_thread_num()];
+            m_transaction->thread_on_openmp_section_finish(ctxt->m_worker_id);
+            ctxt.reset();
+            if(m_num_threads_left.fetch_add(1) +1 == omp_get_num_threads()){ // last thread of the region
+                m_num_threads_left = 0;
+                m_graph->on_openmp_section_finishing();
             }
-
-            lqueue.flush();
-        }
-        return scout_count;
-    }
-    static
-    void do_bfs_QueueToBitmap(gt::SharedROTransaction& transaction, uint64_t max_vertex_id, const gapbs::SlidingQueue<int64_t> &queue, gapbs::Bitmap &bm) {
-#pragma omp parallel for
-        for (auto q_iter = queue.begin(); q_iter < queue.end(); q_iter++) {
-            int64_t u = *q_iter;
-            bm.set_bit_atomic(u-1);
         }
-    }
 
-    static
-    void do_bfs_BitmapToQueue(gt::SharedROTransaction& transaction, uint64_t max_vertex_id, const gapbs::Bitmap &bm, gapbs::SlidingQueue<int64_t> &queue) {
-#pragma omp parallel
-        {
-            gapbs::QueueBuffer<int64_t> lqueue(queue);
-#pragma omp for
-            for (uint64_t n=1; n <= max_vertex_id; n++)
-                if (bm.get_bit(n-1))
-                    lqueue.push_back(n);
-            lqueue.flush();
-        }
-        queue.slide_window();
-    }
-    static
-    unique_ptr<int64_t[]> do_bfs_init_distances_init_edge_num(gt::SharedROTransaction& transaction, uint64_t max_vertex_id, int64_t& edge_num){
-        unique_ptr<int64_t[]> distances{ new int64_t[max_vertex_id] };
-        //reset thread ID's
-        auto graph = transaction.get_graph();
-        std::atomic_uint64_t total_num = 0;
-        //graph->on_openmp_section_finishing();
-#pragma omp parallel
-        {
-            uint8_t thread_id = graph->get_openmp_worker_thread_id();
-            auto iterator = transaction.generate_edge_delta_iterator(thread_id);
-            uint64_t local_num = 0;
-#pragma omp for
-            for (uint64_t n = 1; n <= max_vertex_id; n++) {
-                if (transaction.get_vertex(n, thread_id).empty()) { // the vertex does not exist
-                    distances[n - 1] = numeric_limits<int64_t>::max();
-                } else { // the vertex exists
-                    // Retrieve the out degree for the vertex n
-                    /*uint64_t out_degree = 0;
-                    auto iterator = transaction.simple_get_edges(n,  1, thread_id);
-                    while (iterator.valid()) {
-                        out_degree++;
-                        // iterator.next();
-                    }
-                    iterator.close();*/
-                    transaction.simple_get_edges(n,1,thread_id,iterator);
-                    uint64_t out_degree = iterator.get_vertex_degree();
-                    local_num+= out_degree;
-                    distances[n - 1] = out_degree != 0 ? -out_degree : -1;
-                }
-            }
-            total_num.fetch_add(local_num,std::memory_order_acq_rel);
-            transaction.thread_on_openmp_section_finish(thread_id);
-        }
-        edge_num = total_num.load(std::memory_order_relaxed)/2;
-        graph->on_openmp_section_finishing();
-        return distances;
-    }
-    static
-    unique_ptr<int64_t[]> do_bfs_init_distances(gt::SharedROTransaction& transaction, uint64_t max_vertex_id) {
-        unique_ptr<int64_t[]> distances{ new int64_t[max_vertex_id] };
-        //reset thread ID's
-        auto graph = transaction.get_graph();
-        //graph->on_openmp_section_finishing();
-#pragma omp parallel
-        {
-            uint8_t thread_id = graph->get_openmp_worker_thread_id();
-            auto iterator = transaction.generate_edge_delta_iterator(thread_id);
-#pragma omp for
-            for (uint64_t n = 1; n <= max_vertex_id; n++) {
-                if (transaction.get_vertex(n, thread_id).empty()) { // the vertex does not exist
-                    distances[n - 1] = numeric_limits<int64_t>::max();
-                } else { // the vertex exists
-                    // Retrieve the out degree for the vertex n
-                    /*uint64_t out_degree = 0;
-                    auto iterator = transaction.simple_get_edges(n,  1, thread_id);
-                    while (iterator.valid()) {
-                        out_degree++;
-                        // iterator.next();
-                    }
-                    iterator.close();*/
-                    transaction.simple_get_edges(n,1,thread_id,iterator);
-                    uint64_t out_degree = iterator.get_vertex_degree();
-                    distances[n - 1] = out_degree != 0 ? -out_degree : -1;
-                }
-            }
-            transaction.thread_on_openmp_section_finish(thread_id);
+        uint64_t out_degree(uint64_t v) const {
+            return has_vertex(v) ? m_degrees[v] : 0;
         }
-        graph->on_openmp_section_finishing();
-        return distances;
-    }
-    static
-    unique_ptr<int64_t[]> static_do_bfs_init_distances(gt::SharedROTransaction& transaction, uint64_t max_vertex_id) {
-        unique_ptr<int64_t[]> distances{ new int64_t[max_vertex_id] };
 
-#pragma omp parallel
-        {
-            auto iterator = transaction.generate_static_edge_delta_iterator();
-#pragma omp for
-            for (uint64_t n = 1; n <= max_vertex_id; n++) {
-                //todo::add static get vertex
-                if (transaction.static_get_vertex(n).empty()) { // the vertex does not exist
-                    distances[n - 1] = numeric_limits<int64_t>::max();
-                } else { // the vertex exists
-                    // Retrieve the out degree for the vertex n
-
-                   /*uint64_t out_degree = 0;
-                   auto iterator = transaction.static_get_edges(n,  1);
-                    while (iterator.valid()) {
-                        out_degree++;
-                        // iterator.next();
-                    }*/
-                    transaction.static_get_edges(n,1,iterator);
-                    uint64_t out_degree = static_cast<uint64_t>(iterator.vertex_degree());
-                    distances[n - 1] = out_degree != 0 ? -out_degree : -1;
-                }
-            }
-        }
-        return distances;
-    }
-    static
-    unique_ptr<int64_t[]> do_bfs(gt::SharedROTransaction& transaction, uint64_t num_vertices, uint64_t max_vertex_id, uint64_t root, utility::TimeoutService& timer, int alpha = 15, int beta = 18) {
-        // The implementation from GAP BS reports the parent (which indeed it should make more sense), while the one required by
-        // Graphalytics only returns the distance
-        //transaction.print_debug_info();
-       // std::cout<<"correct bfs"<<std::endl;
-       int64_t edges_to_check = 0;
-        unique_ptr<int64_t[]> ptr_distances = do_bfs_init_distances_init_edge_num(transaction,max_vertex_id,edges_to_check);//do_bfs_init_distances(transaction, max_vertex_id);
-        int64_t* __restrict distances = ptr_distances.get();
-        distances[root-1] = 0;
-
-        gapbs::SlidingQueue<int64_t> queue(max_vertex_id);
-        queue.push_back(root);
-        queue.slide_window();
-        gapbs::Bitmap curr(max_vertex_id);
-        curr.reset();
-        gapbs::Bitmap front(max_vertex_id);
-        front.reset();
-        //int64_t edges_to_check = num_edges; //g.num_edges_directed();
-
-        int64_t scout_count = 0;
-        { // retrieve the out degree of the root
-            auto graph = transaction.get_graph();
-            uint8_t thread_id = graph->get_openmp_worker_thread_id();
-            auto iterator = transaction.simple_get_edges(root, 1,thread_id);
-            /*while(iterator.valid()){ scout_count++; //iterator.next();
-             }
-            iterator.close();*/
-            scout_count = iterator.get_vertex_degree();
-            graph->on_openmp_section_finishing();
+        uint64_t in_degree(uint64_t v) const {
+            return m_is_directed ? m_in_offsets[v +1] - m_in_offsets[v] : out_degree(v);
         }
-        int64_t distance = 1; // current distance
-        while (!timer.is_timeout() && !queue.empty()) {
-
-            if (scout_count > edges_to_check / alpha) {
-                int64_t awake_count, old_awake_count;
-                do_bfs_QueueToBitmap(transaction, max_vertex_id, queue, front);
-                awake_count = queue.size();
-                queue.slide_window();
-                do {
-                    old_awake_count = awake_count;
-                    awake_count = do_bfs_BUStep(transaction, max_vertex_id, distances, distance, front, curr);
-                    front.swap(curr);
-                    distance++;
-                } while ((awake_count >= old_awake_count) || (awake_count > (int64_t) num_vertices / beta));
-                do_bfs_BitmapToQueue(transaction, max_vertex_id, front, queue);
-                scout_count = 1;
-            } else {
-                edges_to_check -= scout_count;
-                scout_count = do_bfs_TDStep(transaction, max_vertex_id, distances, distance, queue);
-                queue.slide_window();
-                distance++;
+
+        template<typename F>
+        void for_each_out_neighbour(uint64_t v, F&& f) const {
+            if(!has_vertex(v)) return;
+            ThreadContext* ctxt = context();
+            m_transaction->simple_get_edges(v +1, /* label */ 1, ctxt->m_worker_id, ctxt->m_iterator);
+            while(ctxt->m_iterator.valid()){
+                uint64_t u = ctxt->m_iterator.dst_id();
+                if(u > m_max_vertex_id) continue; // created after the view
+                if(!f(u -1)) break;
             }
+            ctxt->m_iterator.close();
         }
 
-        return ptr_distances;
-    }
-    static
-    unique_ptr<int64_t[]> do_bfs(gt::SharedROTransaction& transaction, uint64_t num_vertices, uint64_t num_edges, uint64_t max_vertex_id, uint64_t root, utility::TimeoutService& timer, int alpha = 15, int beta = 18) {
-        // The implementation from GAP BS reports the parent (which indeed it should make more sense), while the one required by
-        // Graphalytics only returns the distance
-        //transaction.print_debug_info();
-        unique_ptr<int64_t[]> ptr_distances = do_bfs_init_distances(transaction, max_vertex_id);
-        int64_t* __restrict distances = ptr_distances.get();
-        distances[root-1] = 0;
-
-        gapbs::SlidingQueue<int64_t> queue(max_vertex_id);
-        queue.push_back(root);
-        queue.slide_window();
-        gapbs::Bitmap curr(max_vertex_id);
-        curr.reset();
-        gapbs::Bitmap front(max_vertex_id);
-        front.reset();
-        int64_t edges_to_check = num_edges; //g.num_edges_directed();
-
-        int64_t scout_count = 0;
-        { // retrieve the out degree of the root
-            auto graph = transaction.get_graph();
-            uint8_t thread_id = graph->get_openmp_worker_thread_id();
-            auto iterator = transaction.simple_get_edges(root, 1,thread_id);
-            /*while(iterator.valid()){ scout_count++; //iterator.next();
-             }
-            iterator.close();*/
-            scout_count = iterator.get_vertex_degree();
-            graph->on_openmp_section_finishing();
-        }
-        int64_t distance = 1; // current distance
-        while (!timer.is_timeout() && !queue.empty()) {
-
-            if (scout_count > edges_to_check / alpha) {
-                int64_t awake_count, old_awake_count;
-                do_bfs_QueueToBitmap(transaction, max_vertex_id, queue, front);
-                awake_count = queue.size();
-                queue.slide_window();
-                do {
-                    old_awake_count = awake_count;
-                    awake_count = do_bfs_BUStep(transaction, max_vertex_id, distances, distance, front, curr);
-                    front.swap(curr);
-                    distance++;
-                } while ((awake_count >= old_awake_count) || (awake_count > (int64_t) num_vertices / beta));
-                do_bfs_BitmapToQueue(transaction, max_vertex_id, front, queue);
-                scout_count = 1;
-            } else {
-                edges_to_check -= scout_count;
-                scout_count = do_bfs_TDStep(transaction, max_vertex_id, distances, distance, queue);
-                queue.slide_window();
-                distance++;
+        template<typename F>
+        void for_each_in_neighbour(uint64_t v, F&& f) const {
+            if(!m_is_directed){ for_each_out_neighbour(v, f); return; }
+            for(uint64_t i = m_in_offsets[v], end = m_in_offsets[v +1]; i < end; i++){
+                if(!f(m_in_sources[i])) break;
             }
         }
 
-        return ptr_distances;
-    }
-    static
-    unique_ptr<int64_t[]> static_do_bfs(gt::SharedROTransaction& transaction, uint64_t num_vertices, uint64_t num_edges, uint64_t max_vertex_id, uint64_t root, utility::TimeoutService& timer, int alpha = 15, int beta = 18) {
-        // The implementation from GAP BS reports the parent (which indeed it should make more sense), while the one required by
-        // Graphalytics only returns the distance
-        //transaction.print_debug_info();
-        unique_ptr<int64_t[]> ptr_distances = static_do_bfs_init_distances(transaction, max_vertex_id);
-        int64_t* __restrict distances = ptr_distances.get();
-        distances[root-1] = 0;
-
-        gapbs::SlidingQueue<int64_t> queue(max_vertex_id);
-        queue.push_back(root);
-        queue.slide_window();
-        gapbs::Bitmap curr(max_vertex_id);
-        curr.reset();
-        gapbs::Bitmap front(max_vertex_id);
-        front.reset();
-        int64_t edges_to_check = num_edges; //g.num_edges_directed();
-
-        int64_t scout_count = 0;
-        { // retrieve the out degree of the root
-            auto iterator = transaction.static_get_edges(root, 1);
-            /*while(iterator.valid()){ scout_count++; //iterator.next();
-            }*/
-            scout_count = iterator.vertex_degree();
-        }
-        int64_t distance = 1; // current distance
-
-        while (!timer.is_timeout() && !queue.empty()) {
-
-            if (scout_count > edges_to_check / alpha) {
-                int64_t awake_count, old_awake_count;
-                do_bfs_QueueToBitmap(transaction, max_vertex_id, queue, front);
-                awake_count = queue.size();
-                queue.slide_window();
-                do {
-                    old_awake_count = awake_count;
-                    awake_count = static_do_bfs_BUStep(transaction, max_vertex_id, distances, distance, front, curr);
-                    front.swap(curr);
-                    distance++;
-                } while ((awake_count >= old_awake_count) || (awake_count > (int64_t) num_vertices / beta));
-                do_bfs_BitmapToQueue(transaction, max_vertex_id, front, queue);
-                scout_count = 1;
-            } else {
-                edges_to_check -= scout_count;
-                scout_count = static_do_bfs_TDStep(transaction, max_vertex_id, distances, distance, queue);
-                queue.slide_window();
-                distance++;
+        template<typename F>
+        void for_each_out_edge(uint64_t v, F&& f) const {
+            if(!has_vertex(v)) return;
+            ThreadContext* ctxt = context();
+            m_transaction->simple_get_edges(v +1, /* label */ 1, ctxt->m_worker_id, ctxt->m_iterator);
+            while(ctxt->m_iterator.valid()){
+                uint64_t u = ctxt->m_iterator.dst_id();
+                if(u > m_max_vertex_id) continue; // created after the view
+                if(!f(u -1, ctxt->m_iterator.edge_delta_weight())) break;
             }
+            ctxt->m_iterator.close();
         }
+    };
 
-        return ptr_distances;
-    }
-    void GTXDriver::bfs(uint64_t external_source_id, const char* dump2file) {
-        //std::cout<<"from source "<<external_source_id<<std::endl;
-        if(m_is_directed) { ERROR("This implementation of the BFS does not support directed graphs"); }
-
+    /*****************************************************************************
+     *                                                                           *
+     *  BFS                                                                      *
+     *                                                                           *
+     *****************************************************************************/
+    void GTXDriver::bfs(uint64_t external_source_id, const char* dump2file) {
         // Init
         utility::TimeoutService timeout { m_timeout };
         Timer timer; timer.start();
-        gt::SharedROTransaction transaction =  GTX->begin_shared_read_only_transaction();
+        gt::SharedROTransaction transaction = GTX->begin_shared_read_only_transaction();
         uint64_t max_vertex_id = GTX->get_max_allocated_vid();
-        uint64_t num_vertices = m_num_vertices;
-        //uint64_t num_edges = m_num_edges;
-        //transaction.print_debug_info();
         uint64_t root = ext2int(external_source_id);
-        //COUT_DEBUG_BFS("root: " << root << " [external vertex: " << external_source_id << "]");
-        /*auto handler =  GTX->get_bfs_handler(num_vertices);
-        handler.compute(root);
-        if(dump2file != nullptr)
-            save_results<int64_t, false>(*handler.get_result(),dump2file);*/
-        //Timer t;
-        //t.start();
+
         // Run the BFS algorithm
-        unique_ptr<int64_t[]> ptr_result = do_bfs(transaction, num_vertices /*, num_edges*/, max_vertex_id, root, timeout);
-        //unique_ptr<int64_t[]> ptr_result = static_do_bfs(transaction, num_vertices, num_edges, max_vertex_id, root, timeout);
-        //cout << "BFS took " << t << endl;
+        View view { &transaction, max_vertex_id, m_is_directed };
+        unique_ptr<int64_t[]> ptr_result = kernels::bfs(view, root -1, timeout);
         if(timeout.is_timeout()){
             transaction.commit(); // in gtx it is necessary
             RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);
@@ -1216,512 +982,56 @@ namespace gfe::library {
 
         // translate the logical vertex IDs into the external vertex IDs
         auto external_ids = translate(&transaction, ptr_result.get(), max_vertex_id);
-        //auto external_ids = static_translate(&transaction, ptr_result.get(), max_vertex_id);
-        //cout << "Translation took " << t << endl;
         transaction.commit(); // not sure if strictly necessary
         if(timeout.is_timeout()){
             RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);
         }
-        //std::cout<<dump2file<<std::endl;
+
         if(dump2file != nullptr) // store the results in the given file
             save_results<int64_t, false>(external_ids, dump2file);
-        //std::cout<<"bfs over"<<std::endl;
     }
+
 /*****************************************************************************
  *                                                                           *
  *  PageRank                                                                 *
  *                                                                           *
  *****************************************************************************/
-    //#define DEBUG_PAGERANK
-#if defined(DEBUG_PAGERANK)
-#define COUT_DEBUG_PAGERANK(msg) COUT_DEBUG(msg)
-#else
-#define COUT_DEBUG_PAGERANK(msg)
-#endif
-
-// Implementation based on the reference PageRank for the GAP Benchmark Suite
-// https://github.com/sbeamer/gapbs
-// The reference implementation has been written by Scott Beamer
-//
-// Copyright (c) 2015, The Regents of the University of California (Regents)
-// All Rights Reserved.
-//
-// Redistribution and use in source and binary forms, with or without
-// modification, are permitted provided that the following conditions are met:
-// 1. Redistributions of source code must retain the above copyright
-//    notice, this list of conditions and the following disclaimer.
-// 2. Redistributions in binary form must reproduce the above copyright
-//    notice, this list of conditions and the following disclaimer in the
-//    documentation and/or other materials provided with the distribution.
-// 3. Neither the name of the Regents nor the
-//    names of its contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
-// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
-// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-// DISCLAIMED. IN NO EVENT SHALL REGENTS BE LIABLE FOR ANY
-// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
-// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
-// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
-// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-
-/*
-GAP Benchmark Suite
-Kernel: PageRank (PR)
-Author: Scott Beamer
-
-Will return pagerank scores for all vertices once total change < epsilon
-
-This PR implementation uses the traditional iterative approach. This is done
-to ease comparisons to other implementations (often use same algorithm), but
-it is not necessarily the fastest way to implement it. It does perform the
-updates in the pull direction to remove the need for atomics.
-*/
-    static
-    unique_ptr<double[]> do_pagerank(gt::SharedROTransaction& transaction, uint64_t num_vertices, uint64_t max_vertex_id, uint64_t num_iterations, double damping_factor, utility::TimeoutService& timer) {
-        const double init_score = 1.0 / num_vertices;
-        const double base_score = (1.0 - damping_factor) / num_vertices;
-
-        unique_ptr<double[]> ptr_scores{ new double[max_vertex_id]() }; // avoid memory leaks
-        unique_ptr<uint64_t[]> ptr_degrees{ new uint64_t[max_vertex_id]() }; // avoid memory leaks
-        double* scores = ptr_scores.get();
-        uint64_t* __restrict degrees = ptr_degrees.get();
-        auto graph = transaction.get_graph();
-
-#pragma omp parallel
-        {
-            uint8_t thread_ud = graph->get_openmp_worker_thread_id();
-            auto iterator = transaction.generate_edge_delta_iterator(thread_ud);
-#pragma omp for
-            for (uint64_t v = 1; v <= max_vertex_id; v++) {
-                scores[v - 1] = init_score;
-
-                // compute the outdegree of the vertex
-                if (!transaction.get_vertex(v, thread_ud).empty()) { // check the vertex exists
-                    /*uint64_t degree = 0;
-                    //auto iterator = transaction.simple_get_edges(v, 1,thread_ud);
-                    transaction.simple_get_edges(v,1,thread_ud,iterator);
-                    while (iterator.valid()) {
-                        degree++; //iterator.next();
-                    }
-                    iterator.close();
-                    degrees[v - 1] = degree;*/
-                    
-                    transaction.simple_get_edges(v,1,thread_ud,iterator);
-                    degrees[v - 1] = iterator.get_vertex_degree();
-                } else {
-                    degrees[v - 1] = numeric_limits<uint64_t>::max();
-                }
-            }
-            transaction.thread_on_openmp_section_finish(thread_ud);
-        }
-        graph->on_openmp_section_finishing();
-        gapbs::pvector<double> outgoing_contrib(max_vertex_id, 0.0);
-        #if false
-        {
-            double dangling_sum = 0.0;
-
-            // for each node, precompute its contribution to all of its outgoing neighbours and, if it's a sink,
-            // add its rank to the `dangling sum' (to be added to all nodes).
-#pragma omp parallel for reduction(+:dangling_sum)
-            for(uint64_t v = 1; v <= max_vertex_id; v++){
-                uint64_t out_degree = degrees[v-1];
-                if(out_degree == numeric_limits<uint64_t>::max()){
-                    continue; // the vertex does not exist
-                } else if (out_degree == 0){ // this is a sink
-                    dangling_sum += scores[v-1];
-                } else {
-                    outgoing_contrib[v-1] = scores[v-1] / out_degree;
-                }
-            }
-
-            dangling_sum /= num_vertices;
-
-            // compute the new score for each node in the graph
-            //fixme: currently our txn does not support being executed by mutiple threads. It requires fetching thread_id for each operation execution from the table.
-//#pragma omp parallel for schedule(dynamic, 64)
-#pragma omp parallel
-            {
-                uint8_t thread_id = graph->get_openmp_worker_thread_id();
-                auto iterator = transaction.generate_edge_delta_iterator(thread_id);
-#pragma omp for schedule(dynamic, 64)
-                for (uint64_t v = 1; v <= max_vertex_id; v++) {
-                    if (degrees[v-1] == numeric_limits<uint64_t>::max()) { continue; } // the vertex does not exist
-
-                    double incoming_total = 0;
-                    //auto iterator = transaction.simple_get_edges(v, /* label ? */1,thread_id); // fixme: incoming edges for directed graphs
-                    transaction.simple_get_edges(v, /* label ? */1,thread_id,iterator);
-                    while (iterator.valid()) {
-                        uint64_t u = iterator.dst_id();
-                        incoming_total += outgoing_contrib[u-1];
-                        //iterator.next();
-                    }
-                    iterator.close();
-                    // update the score
-                    scores[v-1] = base_score + damping_factor * (incoming_total + dangling_sum);
-                }
-                transaction.thread_on_openmp_section_finish(thread_id);
-            }
-            graph->on_openmp_section_finishing();
-        }
-        #endif
-        // pagerank iterations
-        for(uint64_t iteration = 0; iteration < num_iterations && !timer.is_timeout(); iteration++){
-            double dangling_sum = 0.0;
-
-            // for each node, precompute its contribution to all of its outgoing neighbours and, if it's a sink,
-            // add its rank to the `dangling sum' (to be added to all nodes).
-#pragma omp parallel for reduction(+:dangling_sum)
-            for(uint64_t v = 1; v <= max_vertex_id; v++){
-                uint64_t out_degree = degrees[v-1];
-                if(out_degree == numeric_limits<uint64_t>::max()){
-                    continue; // the vertex does not exist
-                } else if (out_degree == 0){ // this is a sink
-                    dangling_sum += scores[v-1];
-                } else {
-                    outgoing_contrib[v-1] = scores[v-1] / out_degree;
-                }
-            }
-
-            dangling_sum /= num_vertices;
-
-            // compute the new score for each node in the graph
-            //fixme: currently our txn does not support being executed by mutiple threads. It requires fetching thread_id for each operation execution from the table.
-//#pragma omp parallel for schedule(dynamic, 64)
-#pragma omp parallel
-            {
-                uint8_t thread_id = graph->get_openmp_worker_thread_id();
-                auto iterator = transaction.generate_edge_delta_iterator(thread_id);
-#pragma omp for schedule(dynamic, 64)
-                for (uint64_t v = 1; v <= max_vertex_id; v++) {
-                    if (degrees[v-1] == numeric_limits<uint64_t>::max()) { continue; } // the vertex does not exist
-
-                    double incoming_total = 0;
-                    //auto iterator = transaction.simple_get_edges(v, /* label ? */1,thread_id); // fixme: incoming edges for directed graphs
-                    transaction.simple_get_edges(v, /* label ? */1,thread_id,iterator);
-                    while (iterator.valid()) {
-                        uint64_t u = iterator.dst_id();
-                        incoming_total += outgoing_contrib[u-1];
-                        //iterator.next();
-                    }
-                    iterator.close();
-                    // update the score
-                    scores[v-1] = base_score + damping_factor * (incoming_total + dangling_sum);
-                }
-                transaction.thread_on_openmp_section_finish(thread_id);
-            }
-            graph->on_openmp_section_finishing();
-        }
-
-        return ptr_scores;
-    }
-    static
-    unique_ptr<double[]> do_static_pagerank(gt::SharedROTransaction& transaction, uint64_t num_vertices, uint64_t max_vertex_id, uint64_t num_iterations, double damping_factor, utility::TimeoutService& timer) {
-        const double init_score = 1.0 / num_vertices;
-        const double base_score = (1.0 - damping_factor) / num_vertices;
-
-        unique_ptr<double[]> ptr_scores{ new double[max_vertex_id]() }; // avoid memory leaks
-        unique_ptr<uint64_t[]> ptr_degrees{ new uint64_t[max_vertex_id]() }; // avoid memory leaks
-        double* scores = ptr_scores.get();
-        uint64_t* __restrict degrees = ptr_degrees.get();
-        //auto graph = transaction.get_graph();
-
-#pragma omp parallel
-        {
-            //uint8_t thread_ud = graph->get_openmp_worker_thread_id();
-            auto iterator = transaction.generate_static_edge_delta_iterator();
-#pragma omp for
-            for (uint64_t v = 1; v <= max_vertex_id; v++) {
-                scores[v - 1] = init_score;
-
-                // compute the outdegree of the vertex
-                if (!transaction.static_get_vertex(v).empty()) { // check the vertex exists
-                    //uint64_t degree = 0;
-                    //auto iterator = transaction.static_get_edges(v, /* label ? */ 1);
-                    transaction.static_get_edges(v,1, iterator);
-                    /*while (iterator.valid()) {
-                        degree++; //iterator.next();
-                    }*/
-                    //iterator.close();
-                    //degrees[v - 1] = degree;
-                    degrees[v-1]=iterator.vertex_degree();
-                } else {
-                    degrees[v - 1] = numeric_limits<uint64_t>::max();
-                }
-            }
-        }
-        //graph->on_openmp_section_finishing();
-        gapbs::pvector<double> outgoing_contrib(max_vertex_id, 0.0);
-
-        // pagerank iterations
-        for(uint64_t iteration = 0; iteration < num_iterations && !timer.is_timeout(); iteration++){
-            double dangling_sum = 0.0;
-
-            // for each node, precompute its contribution to all of its outgoing neighbours and, if it's a sink,
-            // add its rank to the `dangling sum' (to be added to all nodes).
-#pragma omp parallel for reduction(+:dangling_sum)
-            for(uint64_t v = 1; v <= max_vertex_id; v++){
-                uint64_t out_degree = degrees[v-1];
-                if(out_degree == numeric_limits<uint64_t>::max()){
-                    continue; // the vertex does not exist
-                } else if (out_degree == 0){ // this is a sink
-                    dangling_sum += scores[v-1];
-                } else {
-                    outgoing_contrib[v-1] = scores[v-1] / out_degree;
-                }
-            }
-
-            dangling_sum /= num_vertices;
-
-            // compute the new score for each node in the graph
-            //fixme: currently our txn does not support being executed by mutiple threads. It requires fetching thread_id for each operation execution from the table.
-//#pragma omp parallel for schedule(dynamic, 64)
-#pragma omp parallel
-            {
-                //uint8_t thread_id = graph->get_openmp_worker_thread_id();
-                auto iterator = transaction.generate_static_edge_delta_iterator();
-#pragma omp for schedule(dynamic, 64)
-                for (uint64_t v = 1; v <= max_vertex_id; v++) {
-                    if (degrees[v-1] == numeric_limits<uint64_t>::max()) { continue; } // the vertex does not exist
-
-                    double incoming_total = 0;
-                    /*auto iterator = transaction.static_get_edges(v, 
-                                                                 1); // fixme: incoming edges for directed graphs*/
-                    transaction.static_get_edges(v,1,iterator);
-                    while (iterator.valid()) {
-                        uint64_t u = iterator.dst_id();
-                        incoming_total += outgoing_contrib[u-1];
-                        //iterator.next();
-                    }
-                    //iterator.close();
-                    // update the score
-                    scores[v-1] = base_score + damping_factor * (incoming_total + dangling_sum);
-                }
-            }
-            //graph->on_openmp_section_finishing();
-        }
-
-        return ptr_scores;
-    }
-
     void GTXDriver::pagerank(uint64_t num_iterations, double damping_factor, const char* dump2file) {
-        if(m_is_directed) { ERROR("This implementation of PageRank does not support directed graphs"); }
-
         // Init
         utility::TimeoutService timeout { m_timeout };
         Timer timer; timer.start();
-        //gt::SharedROTransaction transaction = GTX->begin_shared_read_only_transaction();
-        uint64_t num_vertices = m_num_vertices;
-        //reuse data structures
-       /*auto result = GTX->compute_pagerank(num_vertices,num_iterations,damping_factor);
-        if(dump2file != nullptr)
-            save_results(*result,dump2file);*/
-        //direct access method
-        auto handler =  GTX->get_pagerank_handler(num_vertices);
-        handler.compute(num_iterations,damping_factor);
-        if(dump2file != nullptr)
-            save_results(*handler.get_result(),dump2file);
+        gt::SharedROTransaction transaction = GTX->begin_shared_read_only_transaction();
+        uint64_t max_vertex_id = GTX->get_max_allocated_vid();
 
-        /*uint64_t max_vertex_id = GTX->get_max_allocated_vid();
         // Run the PageRank algorithm
-        unique_ptr<double[]> ptr_result = do_pagerank(transaction, num_vertices, max_vertex_id, num_iterations, damping_factor, timeout);
-        //unique_ptr<double[]> ptr_result = do_sstatic_pagerank(transaction, num_vertices, max_vertex_id, num_iterations, damping_factor, timeout);
+        View view { &transaction, max_vertex_id, m_is_directed };
+        unique_ptr<double[]> ptr_result = kernels::pagerank(view, num_iterations, damping_factor, timeout);
         if(timeout.is_timeout()){ transaction.commit(); RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);  }
 
         // Retrieve the external node ids
         auto external_ids = translate(&transaction, ptr_result.get(), max_vertex_id);
-        //auto external_ids = static_translate(&transaction, ptr_result.get(), max_vertex_id);
         transaction.commit(); // read-only transaction, abort == commit
         if(timeout.is_timeout()){ RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer); }
 
         // Store the results in the given file
         if(dump2file != nullptr)
-            save_results(external_ids, dump2file);*/
+            save_results(external_ids, dump2file);
     }
+
 /*****************************************************************************
  *                                                                           *
  *  WCC                                                                      *
  *                                                                           *
  *****************************************************************************/
-// Implementation based on the reference WCC for the GAP Benchmark Suite
-// https://github.com/sbeamer/gapbs
-// The reference implementation has been written by Scott Beamer
-//
-// Copyright (c) 2015, The Regents of the University of California (Regents)
-// All Rights Reserved.
-//
-// Redistribution and use in source and binary forms, with or without
-// modification, are permitted provided that the following conditions are met:
-// 1. Redistributions of source code must retain the above copyright
-//    notice, this list of conditions and the following disclaimer.
-// 2. Redistributions in binary form must reproduce the above copyright
-//    notice, this list of conditions and the following disclaimer in the
-//    documentation and/or other materials provided with the distribution.
-// 3. Neither the name of the Regents nor the
-//    names of its contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
-// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
-// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-// DISCLAIMED. IN NO EVENT SHALL REGENTS BE LIABLE FOR ANY
-// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
-// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
-// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
-// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-#define DEBUG_WCC
-#if defined(DEBUG_WCC)
-#define COUT_DEBUG_WCC(msg) COUT_DEBUG(msg)
-#else
-#define COUT_DEBUG_WCC(msg)
-#endif
-/*
-GAP Benchmark Suite
-Kernel: Connected Components (CC)
-Author: Scott Beamer
-
-Will return comp array labelling each vertex with a connected component ID
-
-This CC implementation makes use of the Shiloach-Vishkin [2] algorithm with
-implementation optimizations from Bader et al. [1]. Michael Sutton contributed
-a fix for directed graphs using the min-max swap from [3], and it also produces
-more consistent performance for undirected graphs.
-
-[1] David A Bader, Guojing Cong, and John Feo. "On the architectural
-    requirements for efficient execution of graph algorithms." International
-    Conference on Parallel Processing, Jul 2005.
-
-[2] Yossi Shiloach and Uzi Vishkin. "An o(logn) parallel connectivity algorithm"
-    Journal of Algorithms, 3(1):57–67, 1982.
-
-[3] Kishore Kothapalli, Jyothish Soman, and P. J. Narayanan. "Fast GPU
-    algorithms for graph connectivity." Workshop on Large Scale Parallel
-    Processing, 2010.
-*/
-
-// The hooking condition (comp_u < comp_v) may not coincide with the edge's
-// direction, so we use a min-max swap such that lower component IDs propagate
-// independent of the edge's direction.
-/*
- * Libin: gtx read-txn not thread safe, so these analytical functions can only be done in read-only environment
- */
-    static
-    unique_ptr<uint64_t[]> do_wcc(gt::SharedROTransaction& transaction, uint64_t max_vertex_id, utility::TimeoutService& timer) {
-        // init
-        COUT_DEBUG_WCC("max_vertex_id: " << max_vertex_id);
-        unique_ptr<uint64_t[]> ptr_components { new uint64_t[max_vertex_id] };
-        uint64_t* comp = ptr_components.get();
-
-#pragma omp parallel for
-        for (uint64_t n = 1; n <= max_vertex_id; n++){
-            if(transaction.get_vertex(n).empty()){ // the vertex does not exist
-                COUT_DEBUG_WCC("Vertex #" << n << " does not exist");
-                comp[n] = numeric_limits<uint64_t>::max();
-            } else {
-                comp[n] = n;
-            }
-        }
-
-        bool change = true;
-        while (change && !timer.is_timeout()) {
-            change = false;
-
-#pragma omp parallel for schedule(dynamic, 64)
-            for (uint64_t u = 1; u <= max_vertex_id; u++){
-                if(comp[u] == numeric_limits<uint64_t>::max()) continue; // the vertex does not exist
-
-                auto iterator = transaction.simple_get_edges(u, 1);
-                while(iterator.valid()){
-                    uint64_t v = iterator.dst_id();
-
-                    uint64_t comp_u = comp[u];
-                    uint64_t comp_v = comp[v];
-                    if (comp_u != comp_v) {
-                        // Hooking condition so lower component ID wins independent of direction
-                        uint64_t high_comp = std::max(comp_u, comp_v);
-                        uint64_t low_comp = std::min(comp_u, comp_v);
-                        if (high_comp == comp[high_comp]) {
-                            change = true;
-                            COUT_DEBUG_WCC("comp[" << high_comp << "] = " << low_comp);
-                            comp[high_comp] = low_comp;
-                        }
-                    }
-
-                    //iterator.next();
-                }
-                iterator.close();
-            }
-
-#pragma omp parallel for schedule(dynamic, 64)
-            for (uint64_t n = 1; n <= max_vertex_id; n++){
-                if(comp[n] == numeric_limits<uint64_t>::max()) continue; // the vertex does not exist
-
-                while (comp[n] != comp[comp[n]]) {
-                    comp[n] = comp[comp[n]];
-                }
-            }
-
-
-            COUT_DEBUG_WCC("change: " << change);
-        }
-
-        return ptr_components;
-    }
-    static void do_weighted_scan(gt::SharedROTransaction& transaction, uint64_t max_vertex_id){
-        uint64_t total_edge_num = 0;
-        uint64_t total_vid_sum = 0;
-        double total_weight = 0;
-        auto graph = transaction.get_graph();
-#pragma omp parallel
-        {
-            uint8_t thread_id = graph->get_openmp_worker_thread_id();
-            auto iterator = transaction.generate_edge_delta_iterator(thread_id);
-            uint64_t local_degree = 0;
-            uint64_t  local_vid = 0;
-            double local_weight = 0;
-#pragma omp for
-            for (uint64_t v = 1; v <= max_vertex_id; v++) {
-                     // compute the outdegree of the vertex
-                //if (!transaction.get_vertex(v, thread_id).empty()) { // check the vertex exists
-                    //auto iterator = transaction.simple_get_edges(v, /* label ? */ 1,thread_id);
-                    transaction.simple_get_edges(v,1,thread_id,iterator);
-                    while (iterator.valid()) {
-                        local_degree++; //iterator.next();
-                        local_vid+=iterator.dst_id();
-                        //string_view payload = iterator.edge_delta_data();
-                        //double w = *reinterpret_cast<const double*>(payload.data());
-                        double w = iterator.edge_delta_weight();
-                        local_weight +=w;
-                    }
-                    iterator.close();
-               // } 
-            }
-#pragma omp critical
-{
-                total_edge_num += local_degree;
-                total_vid_sum += local_vid;
-                total_weight+=local_weight;
-}
-            transaction.thread_on_openmp_section_finish(thread_id);
-        }
-        graph->on_openmp_section_finishing();
-        std::cout<<"total degree is "<<total_edge_num<<std::endl;
-        std::cout<<"total vid sum is "<<total_vid_sum<<std::endl;
-        std::cout<<"total weight is "<<total_weight<<std::endl;
-    }
     void GTXDriver::wcc(const char* dump2file) {
-        /*utility::TimeoutService timeout { m_timeout };
+        utility::TimeoutService timeout { m_timeout };
         Timer timer; timer.start();
-        auto transaction =GTX->begin_shared_read_only_transaction();
+        gt::SharedROTransaction transaction = GTX->begin_shared_read_only_transaction();
         uint64_t max_vertex_id = GTX->get_max_allocated_vid();
 
         // run wcc
-        unique_ptr<uint64_t[]> ptr_components = do_wcc(transaction, max_vertex_id, timeout);
+        View view { &transaction, max_vertex_id, m_is_directed };
+        unique_ptr<uint64_t[]> ptr_components = kernels::wcc(view, timeout);
         if(timeout.is_timeout()){ transaction.commit(); RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer); }
 
         // translate the vertex IDs
@@ -1731,34 +1041,90 @@ more consistent performance for undirected graphs.
 
         // store the results in the given file
         if(dump2file != nullptr)
-            save_results(external_ids, dump2file);*/
-        auto transaction =GTX->begin_shared_read_only_transaction();
-        uint64_t max_vertex_id = GTX->get_max_allocated_vid();
-        do_weighted_scan(transaction,max_vertex_id);
+            save_results(external_ids, dump2file);
     }
+
 /*****************************************************************************
  *                                                                           *
  *  CDLP                                                                     *
  *                                                                           *
  *****************************************************************************/
-// same impl~ as the one done for llama
+// Same algorithm as the one done for llama, with a histogram per thread, reused for all vertices, rather than a new
+// hash map for each vertex. GTX only stores the outgoing edges of directed graphs, thus the incoming edges are first
+// gathered from the snapshot into a CSR, consulted in all iterations.
     static
     unique_ptr<uint64_t[]> do_cdlp(gt::SharedROTransaction& transaction, uint64_t max_vertex_id, bool is_graph_directed, uint64_t max_iterations, utility::TimeoutService& timer) {
+        constexpr uint64_t VERTEX_MISSING = numeric_limits<uint64_t>::max();
         unique_ptr<uint64_t[]> ptr_labels0 { new uint64_t[max_vertex_id] };
         unique_ptr<uint64_t[]> ptr_labels1 { new uint64_t[max_vertex_id] };
         uint64_t* labels0 = ptr_labels0.get(); // current labels
         uint64_t* labels1 = ptr_labels1.get(); // labels for the next iteration
+        unique_ptr<uint64_t[]> ptr_degrees { new uint64_t[max_vertex_id] }; // out + in degree, to size the histograms
+        uint64_t* __restrict degrees = ptr_degrees.get();
+        unique_ptr<uint64_t[]> ptr_in_offsets; // directed graphs only, the incoming edges of v are in [in_offsets[v-1], in_offsets[v])
+        unique_ptr<uint64_t[]> ptr_in_sources; // directed graphs only, the sources of the incoming edges
+        auto graph = transaction.get_graph();
 
-        // initialisation
-#pragma omp parallel for
-        for(uint64_t v = 1; v <= max_vertex_id; v++){
-            string_view payload = transaction.get_vertex(v);
-            if(payload.empty()){ // the vertex does not exist
-                labels0[v] = labels1[v] = numeric_limits<uint64_t>::max();
-            } else {
-                labels0[v] = *reinterpret_cast<const uint64_t*>(payload.data());
+        // initialisation, the initial label is the external vertex ID
+        if(is_graph_directed){ ptr_in_offsets.reset(new uint64_t[max_vertex_id +1]()); }
+        uint64_t* in_offsets = ptr_in_offsets.get();
+#pragma omp parallel
+        {
+            uint8_t thread_id = graph->get_openmp_worker_thread_id();
+            auto iterator = transaction.generate_edge_delta_iterator(thread_id);
+#pragma omp for schedule(dynamic, 4096)
+            for(uint64_t v = 1; v <= max_vertex_id; v++){
+                string_view payload = transaction.get_vertex(v, thread_id);
+                if(payload.empty()){ // the vertex does not exist
+                    labels0[v -1] = labels1[v -1] = degrees[v -1] = VERTEX_MISSING;
+                } else {
+                    labels0[v -1] = *reinterpret_cast<const uint64_t*>(payload.data());
+                    uint64_t degree = 0;
+                    transaction.simple_get_edges(v, 1, thread_id, iterator);
+                    while(iterator.valid()){
+                        uint64_t u = iterator.dst_id();
+                        if(is_graph_directed && u <= max_vertex_id){ __atomic_fetch_add(in_offsets + u, 1, __ATOMIC_RELAXED); }
+                        degree++;
+                    }
+                    iterator.close();
+                    degrees[v -1] = degree;
+                }
+            }
+            transaction.thread_on_openmp_section_finish(thread_id);
+        }
+        graph->on_openmp_section_finishing();
+
+        // directed graphs, materialise the incoming edges
+        if(is_graph_directed && !timer.is_timeout()){
+            for(uint64_t v = 1; v <= max_vertex_id; v++){ // prefix sum
+                if(degrees[v -1] != VERTEX_MISSING){ degrees[v -1] += in_offsets[v]; }
+                in_offsets[v] += in_offsets[v -1];
+            }
+            ptr_in_sources.reset(new uint64_t[in_offsets[max_vertex_id]]);
+            uint64_t* in_sources = ptr_in_sources.get();
+            unique_ptr<uint64_t[]> ptr_in_cursors { new uint64_t[max_vertex_id +1] };
+            uint64_t* in_cursors = ptr_in_cursors.get();
+            memcpy(in_cursors, in_offsets, (max_vertex_id +1) * sizeof(uint64_t));
+
+#pragma omp parallel
+            {
+                uint8_t thread_id = graph->get_openmp_worker_thread_id();
+                auto iterator = transaction.generate_edge_delta_iterator(thread_id);
+#pragma omp for schedule(dynamic, 4096)
+                for(uint64_t v = 1; v <= max_vertex_id; v++){
+                    if(degrees[v -1] == VERTEX_MISSING) continue;
+                    transaction.simple_get_edges(v, 1, thread_id, iterator);
+                    while(iterator.valid()){
+                        uint64_t u = iterator.dst_id();
+                        if(u <= max_vertex_id){ in_sources[__atomic_fetch_add(in_cursors + u -1, 1, __ATOMIC_RELAXED)] = v; }
+                    }
+                    iterator.close();
+                }
+                transaction.thread_on_openmp_section_finish(thread_id);
             }
+            graph->on_openmp_section_finishing();
         }
+        const uint64_t* __restrict in_sources = ptr_in_sources.get();
 
         // algorithm pass
         bool change = true;
@@ -1766,34 +1132,38 @@ more consistent performance for undirected graphs.
         while(current_iteration < max_iterations && change && !timer.is_timeout()){
             change = false; // reset the flag
 
-#pragma omp parallel for schedule(dynamic, 64) shared(change)
-            for(uint64_t v = 1; v <= max_vertex_id; v++){
-                if(labels0[v] == numeric_limits<uint64_t>::max()) continue; // the vertex does not exist
-
-                unordered_map<uint64_t, uint64_t> histogram;
+#pragma omp parallel reduction(||:change)
+            {
+                uint8_t thread_id = graph->get_openmp_worker_thread_id();
+                auto iterator = transaction.generate_edge_delta_iterator(thread_id);
+                LabelHistogram histogram;
 
-                // compute the histogram from both the outgoing & incoming edges. The aim is to find the number of each label
-                // is shared among the neighbours of node_id
-                auto iterator = transaction.simple_get_edges(v, 1); // out edges
-                while(iterator.valid()){
-                    uint64_t u = iterator.dst_id();
-                    histogram[labels0[u]]++;
-                   // iterator.next();
-                }
-                iterator.close();
-                // get the max label
-                uint64_t label_max = numeric_limits<int64_t>::max();
-                uint64_t count_max = 0;
-                for(const auto pair : histogram){
-                    if(pair.second > count_max || (pair.second == count_max && pair.first < label_max)){
-                        label_max = pair.first;
-                        count_max = pair.second;
+#pragma omp for schedule(dynamic, 64)
+                for(uint64_t v = 1; v <= max_vertex_id; v++){
+                    if(degrees[v -1] == VERTEX_MISSING) continue; // the vertex does not exist
+
+                    // compute the histogram from both the outgoing & incoming edges. The aim is to find the number of each label
+                    // is shared among the neighbours of node_id
+                    histogram.reserve(degrees[v -1]);
+                    transaction.simple_get_edges(v, 1, thread_id, iterator); // out edges
+                    while(iterator.valid()){
+                        uint64_t u = iterator.dst_id();
+                        if(u <= max_vertex_id){ histogram.insert(labels0[u -1]); }
+                    }
+                    iterator.close();
+                    if(is_graph_directed){ // in edges
+                        for(uint64_t i = in_offsets[v -1], end = in_offsets[v]; i < end; i++){
+                            histogram.insert(labels0[in_sources[i] -1]);
+                        }
                     }
-                }
 
-                labels1[v] = label_max;
-                change |= (labels0[v] != labels1[v]);
+                    // get the max label, a vertex without neighbours keeps its own label
+                    labels1[v -1] = histogram.pop_max(labels0[v -1]);
+                    change = change || (labels0[v -1] != labels1[v -1]);
+                }
+                transaction.thread_on_openmp_section_finish(thread_id);
             }
+            graph->on_openmp_section_finishing();
 
             std::swap(labels0, labels1); // next iteration
             current_iteration++;
@@ -1866,21 +1236,9 @@ more consistent performance for undirected graphs.
     }
     //todo:: fix iterator
     void GTXDriver::cdlp(uint64_t max_iterations, const char* dump2file) {
-         /*std::vector<uint64_t> vertices(two_hop_neighbor_size);
-         std::unordered_set<uint64_t> unique_vertices;
-         for(uint64_t i=0; i<two_hop_neighbor_size; i++){
-            vertices[i]= rand()%max_vertex_id+1;
-         }
-         auto handler = GTX->get_two_hop_neighbors_handler();
-         handler.compute(vertices);*/
-        /*auto transaction =GTX->begin_shared_read_only_transaction();
-        uint64_t max_vertex_id = GTX->get_max_allocated_vid();
-        do_topology_scan(transaction,max_vertex_id);*/
-     /*   if(m_is_directed) { ERROR("This implementation of the CDLP does not support directed graphs"); }
-
         utility::TimeoutService timeout { m_timeout };
         Timer timer; timer.start();
-        auto transaction =GTX->begin_shared_read_only_transaction();
+        gt::SharedROTransaction transaction = GTX->begin_shared_read_only_transaction();
         uint64_t max_vertex_id = GTX->get_max_allocated_vid();
 
         // Run the CDLP algorithm
@@ -1894,8 +1252,7 @@ more consistent performance for undirected graphs.
 
         // Store the results in the given file
         if(dump2file != nullptr)
-            save_results(external_ids, dump2file);*/
-        
+            save_results(external_ids, dump2file);
     }
 /*****************************************************************************
  *                                                                           *
@@ -1908,90 +1265,136 @@ more consistent performance for undirected graphs.
 #else
 #define COUT_DEBUG_LCC(msg)
 #endif
-// loosely based on the impl~ made for GraphOne
+// Triangle counting on the graph oriented by degree. Each vertex keeps, in a sorted buffer, only its neighbours with
+// a higher rank, i.e. a greater degree or, with the same degree, a greater vertex ID. A triangle is then found only once,
+// from its lowest ranked vertex v, intersecting the buffer of v with the buffer of each neighbour u in it, and it is
+// credited to all its three vertices. The buffers are built by each thread, in its own array, from a single scan of
+// the edges in the snapshot. The vertex IDs are stored 0-based, with 32 bits when they fit, to take the vectorised
+// path of the intersection.
+    template<typename T>
     static
     unique_ptr<double[]> do_lcc_undirected(gt::SharedROTransaction& transaction, uint64_t max_vertex_id, utility::TimeoutService& timer) {
-        unique_ptr<double[]> ptr_lcc { new double[max_vertex_id] };
-        double* lcc = ptr_lcc.get();
-        unique_ptr<uint32_t[]> ptr_degrees_out { new uint32_t[max_vertex_id] };
-        uint32_t* __restrict degrees_out = ptr_degrees_out.get();
-
-        // precompute the degrees of the vertices
-#pragma omp parallel for schedule(dynamic, 4096)
-        for(uint64_t v = 1; v <= max_vertex_id; v++){
-            bool vertex_exists = !transaction.get_vertex(v).empty();
-            if(!vertex_exists){
-                lcc[v] = numeric_limits<double>::signaling_NaN();
-            } else {
-                { // out degree, restrict the scope
-                    uint32_t count = 0;
-                    auto iterator = transaction.simple_get_edges(v, 1);
-                    while(iterator.valid()){ count ++; //iterator.next();
-                    }
+        constexpr uint64_t VERTEX_MISSING = numeric_limits<uint64_t>::max();
+        unique_ptr<uint64_t[]> ptr_degrees { new uint64_t[max_vertex_id] }; // to rank the vertices
+        uint64_t* __restrict degrees = ptr_degrees.get();
+        unique_ptr<uint64_t[]> ptr_num_neighbours { new uint64_t[max_vertex_id] }; // all neighbours of a vertex, as scanned
+        uint64_t* __restrict num_neighbours = ptr_num_neighbours.get();
+        unique_ptr<uint64_t[]> ptr_offsets { new uint64_t[max_vertex_id] }; // where the neighbours with a higher rank start
+        uint64_t* __restrict offsets = ptr_offsets.get();
+        unique_ptr<uint32_t[]> ptr_lengths { new uint32_t[max_vertex_id] }; // how many neighbours have a higher rank
+        uint32_t* __restrict lengths = ptr_lengths.get();
+        unique_ptr<uint16_t[]> ptr_owners { new uint16_t[max_vertex_id] }; // which thread holds the buffer
+        uint16_t* __restrict owners = ptr_owners.get();
+        vector<vector<T>> buffers ( omp_get_max_threads() ); // one per thread
+        auto graph = transaction.get_graph();
+
+        // precompute the degrees of the vertices, only used to rank them
+#pragma omp parallel
+        {
+            uint8_t thread_id = graph->get_openmp_worker_thread_id();
+            auto iterator = transaction.generate_edge_delta_iterator(thread_id);
+#pragma omp for schedule(dynamic, 4096)
+            for(uint64_t v = 1; v <= max_vertex_id; v++){
+                if(transaction.get_vertex(v, thread_id).empty()){ // the vertex does not exist
+                    degrees[v -1] = VERTEX_MISSING;
+                } else {
+                    transaction.simple_get_edges(v, 1, thread_id, iterator);
+                    degrees[v -1] = iterator.get_vertex_degree();
                     iterator.close();
-                    degrees_out[v] = count;
                 }
             }
+            transaction.thread_on_openmp_section_finish(thread_id);
         }
+        graph->on_openmp_section_finishing();
+        if(timer.is_timeout()) return nullptr;
 
+        // build the sorted buffers of the neighbours with a higher rank
+        auto has_higher_rank = [degrees](uint64_t u, uint64_t v){ // u, v 0-based
+            return degrees[u] > degrees[v] || (degrees[u] == degrees[v] && u > v);
+        };
+#pragma omp parallel
+        {
+            uint8_t thread_id = graph->get_openmp_worker_thread_id();
+            auto iterator = transaction.generate_edge_delta_iterator(thread_id);
+            const uint16_t owner = omp_get_thread_num();
+            vector<T>& buffer = buffers[owner];
+#pragma omp for schedule(dynamic, 4096)
+            for(uint64_t v = 1; v <= max_vertex_id; v++){
+                owners[v -1] = owner;
+                offsets[v -1] = buffer.size();
+                lengths[v -1] = 0;
+                if(degrees[v -1] == VERTEX_MISSING){ num_neighbours[v -1] = VERTEX_MISSING; continue; }
 
-#pragma omp parallel for schedule(dynamic, 64)
-        for(uint64_t v = 1; v <= max_vertex_id; v++){
-            if(degrees_out[v] == numeric_limits<uint32_t>::max()) continue; // the vertex does not exist
-
-            COUT_DEBUG_LCC("> Node " << v);
-            if(timer.is_timeout()) continue; // exhausted the budget of available time
-            lcc[v] = 0.0;
-            uint64_t num_triangles = 0; // number of triangles found so far for the node v
-
-            // Cfr. Spec v.0.9.0 pp. 15: "If the number of neighbors of a vertex is less than two, its coefficient is defined as zero"
-            uint64_t v_degree_out = degrees_out[v];
-            if(v_degree_out < 2) continue;
-
-            // Build the list of neighbours of v
-            unordered_set<uint64_t> neighbours;
-
-            { // Fetch the list of neighbours of v
-                auto iterator1 = transaction.simple_get_edges(v, 1);
-                while(iterator1.valid()){
-                    uint64_t u = iterator1.dst_id();
-                    neighbours.insert(u);
-                    iterator1.next();
+                uint64_t count = 0;
+                transaction.simple_get_edges(v, 1, thread_id, iterator);
+                while(iterator.valid()){
+                    uint64_t u = iterator.dst_id();
+                    count++;
+                    // ignore the vertices created after the snapshot has been acquired
+                    if(u <= max_vertex_id && has_higher_rank(u -1, v -1)){
+                        buffer.push_back(u -1);
+                    }
                 }
-                iterator1.close();
+                iterator.close();
+
+                num_neighbours[v -1] = count;
+                lengths[v -1] = buffer.size() - offsets[v -1];
+                sort(buffer.begin() + offsets[v -1], buffer.end());
             }
+            transaction.thread_on_openmp_section_finish(thread_id);
+        }
+        graph->on_openmp_section_finishing();
+        ptr_degrees.reset();
+        if(timer.is_timeout()) return nullptr;
 
-            // again, visit all neighbours of v
-            // for directed graphs, edges1 contains the intersection of both the incoming and the outgoing edges
-            auto iterator1 = transaction.simple_get_edges(v, /* label */ 1);
-            while(iterator1.valid()){
-                uint64_t u = iterator1.dst_id();
-                COUT_DEBUG_LCC("[" << i << "/" << edges.size() << "] neighbour: " << u);
-                assert(neighbours.count(u) == 1 && "The set `neighbours' should contain all neighbours of v");
-
-                // For the Graphalytics spec v 0.9.0, only consider the outgoing edges for the neighbours u
-                auto iterator2 = transaction.simple_get_edges(u, /* label */ 1);
-                while(iterator2.valid()){
-                    uint64_t w = iterator2.dst_id();
-
-                    COUT_DEBUG_LCC("---> [" << j << "/" << /* degree */ (u_out_interval.second - u_out_interval.first) << "] neighbour: " << w);
-                    // check whether it's also a neighbour of v
-                    if(neighbours.count(w) == 1){
-                        COUT_DEBUG_LCC("Triangle found " << v << " - " << u << " - " << w);
-                        num_triangles++;
-                    }
+        // the buffers are not resized anymore
+        vector<const T*> base ( buffers.size() );
+        for(uint64_t i = 0; i < buffers.size(); i++){ base[i] = buffers[i].data(); }
 
-                    iterator2.next();
+        // count the triangles
+        unique_ptr<uint64_t[]> ptr_triangles { new uint64_t[max_vertex_id]() };
+        uint64_t* triangles = ptr_triangles.get();
+#pragma omp parallel for schedule(dynamic, 64)
+        for(uint64_t v = 0; v < max_vertex_id; v++){
+            if(timer.is_timeout()) continue; // exhausted the budget of available time
+            const T* __restrict v_neighbours = base[owners[v]] + offsets[v];
+            const uint32_t v_length = lengths[v];
+            if(v_length < 2) continue; // we need at least two neighbours with a higher rank to close a triangle
+
+            uint64_t v_triangles = 0;
+            for(uint32_t i = 0; i < v_length; i++){
+                const uint64_t u = v_neighbours[i];
+                uint64_t u_triangles = 0;
+                intersection::for_each_common(v_neighbours, v_length, base[owners[u]] + offsets[u], lengths[u], [&](T w){
+                    COUT_DEBUG_LCC("Triangle found " << (v +1) << " - " << (u +1) << " - " << (w +1));
+                    __atomic_fetch_add(triangles + w, 1, __ATOMIC_RELAXED);
+                    u_triangles++;
+                });
+                if(u_triangles > 0){
+                    __atomic_fetch_add(triangles + u, u_triangles, __ATOMIC_RELAXED);
+                    v_triangles += u_triangles;
                 }
-                iterator2.close();
-                iterator1.next();
             }
-            iterator1.close();
+            if(v_triangles > 0){ __atomic_fetch_add(triangles + v, v_triangles, __ATOMIC_RELAXED); }
+        }
+        if(timer.is_timeout()) return nullptr;
 
-            // register the final score
-            uint64_t max_num_edges = v_degree_out * (v_degree_out -1);
-            lcc[v] = static_cast<double>(num_triangles) / max_num_edges;
-            COUT_DEBUG_LCC("Score computed: " << (num_triangles) << "/" << max_num_edges << " = " << lcc[v]);
+        // compute the scores
+        unique_ptr<double[]> ptr_lcc { new double[max_vertex_id] };
+        double* lcc = ptr_lcc.get();
+#pragma omp parallel for
+        for(uint64_t v = 0; v < max_vertex_id; v++){
+            const uint64_t degree = num_neighbours[v];
+            if(degree == VERTEX_MISSING){
+                lcc[v] = numeric_limits<double>::signaling_NaN();
+            } else if(degree < 2){
+                // Cfr. Spec v.0.9.0 pp. 15: "If the number of neighbors of a vertex is less than two, its coefficient is defined as zero"
+                lcc[v] = 0.0;
+            } else {
+                // each triangle is an edge between two neighbours of v, out of degree * (degree -1) /2 possible edges
+                lcc[v] = 2.0 * triangles[v] / (static_cast<double>(degree) * (degree -1));
+                COUT_DEBUG_LCC("Vertex " << (v +1) << ", score computed: " << triangles[v] << "/" << (degree * (degree -1) /2) << " = " << lcc[v]);
+            }
         }
 
         return ptr_lcc;
@@ -2005,7 +1408,12 @@ more consistent performance for undirected graphs.
         uint64_t max_vertex_id = GTX->get_max_allocated_vid();
 
         // Run the LCC algorithm
-        unique_ptr<double[]> scores = do_lcc_undirected(transaction, max_vertex_id, timeout);
+        unique_ptr<double[]> scores;
+        if(max_vertex_id <= numeric_limits<uint32_t>::max()){
+            scores = do_lcc_undirected<uint32_t>(transaction, max_vertex_id, timeout);
+        } else {
+            scores = do_lcc_undirected<uint64_t>(transaction, max_vertex_id, timeout);
+        }
         if(timeout.is_timeout()){ transaction.commit(); RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);  }
 
         // Translate the vertex IDs
@@ -2022,264 +1430,26 @@ more consistent performance for undirected graphs.
  *  SSSP                                                                     *
  *                                                                           *
  *****************************************************************************/
-// Implementation based on the reference SSSP for the GAP Benchmark Suite
-// https://github.com/sbeamer/gapbs
-// The reference implementation has been written by Scott Beamer
-//
-// Copyright (c) 2015, The Regents of the University of California (Regents)
-// All Rights Reserved.
-//
-// Redistribution and use in source and binary forms, with or without
-// modification, are permitted provided that the following conditions are met:
-// 1. Redistributions of source code must retain the above copyright
-//    notice, this list of conditions and the following disclaimer.
-// 2. Redistributions in binary form must reproduce the above copyright
-//    notice, this list of conditions and the following disclaimer in the
-//    documentation and/or other materials provided with the distribution.
-// 3. Neither the name of the Regents nor the
-//    names of its contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
-// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
-// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-// DISCLAIMED. IN NO EVENT SHALL REGENTS BE LIABLE FOR ANY
-// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
-// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
-// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
-// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-
-    using NodeID = uint64_t;
-    using WeightT = double;
-    static const size_t kMaxBin = numeric_limits<size_t>::max()/2;
-    static
-    gapbs::pvector<WeightT> do_sssp(gt::SharedROTransaction& transaction, uint64_t num_edges, uint64_t max_vertex_id, uint64_t source, double delta, utility::TimeoutService& timer) {
-        // Init
-        gapbs::pvector<WeightT> dist(max_vertex_id, numeric_limits<WeightT>::infinity());
-        dist[source-1] = 0;
-        gapbs::pvector<NodeID> frontier(num_edges);
-        // two element arrays for double buffering curr=iter&1, next=(iter+1)&1
-        size_t shared_indexes[2] = {0, kMaxBin};
-        size_t frontier_tails[2] = {1, 0};
-        frontier[0] = source;
-         auto graph = transaction.get_graph();
-#pragma omp parallel
-        {
-            uint8_t thread_id = graph->get_openmp_worker_thread_id();
-            auto iterator = transaction.generate_edge_delta_iterator(thread_id);
-            vector<vector<NodeID> > local_bins(0);
-            size_t iter = 0;
-
-            while (shared_indexes[iter&1] != kMaxBin) {
-                size_t &curr_bin_index = shared_indexes[iter&1];
-                size_t &next_bin_index = shared_indexes[(iter+1)&1];
-                size_t &curr_frontier_tail = frontier_tails[iter&1];
-                size_t &next_frontier_tail = frontier_tails[(iter+1)&1];
-#pragma omp for nowait schedule(dynamic, 64)
-                for (size_t i=0; i < curr_frontier_tail; i++) {
-                    NodeID u = frontier[i];
-                    if (dist[u-1] >= delta * static_cast<WeightT>(curr_bin_index)) {
-                        //auto iterator = transaction.simple_get_edges(u, /* label */ 1,thread_id);
-                        transaction.simple_get_edges(u,1,thread_id,iterator);
-                        while(iterator.valid()){
-                            uint64_t v = iterator.dst_id();
-                           // string_view payload = iterator.edge_delta_data();
-                           // double w = *reinterpret_cast<const double*>(payload.data());
-                            double w = iterator.edge_delta_weight();
-                            WeightT old_dist = dist[v-1];
-                            WeightT new_dist = dist[u-1] + w;
-                            if (new_dist < old_dist) {
-                                bool changed_dist = true;
-                                while (!gapbs::compare_and_swap(dist[v-1], old_dist, new_dist)) {
-                                    old_dist = dist[v-1];
-                                    if (old_dist <= new_dist) {
-                                        changed_dist = false;
-                                        break;
-                                    }
-                                }
-                                if (changed_dist) {
-                                    size_t dest_bin = new_dist/delta;
-                                    if (dest_bin >= local_bins.size()) {
-                                        local_bins.resize(dest_bin+1);
-                                    }
-                                    local_bins[dest_bin].push_back(v);
-                                }
-                            }
-
-                            //iterator.next();
-                        }
-                        //iterator.close();
-                    }
-                }
-                iterator.close();
-                for (size_t i=curr_bin_index; i < local_bins.size(); i++) {
-                    if (!local_bins[i].empty()) {
-#pragma omp critical
-                        next_bin_index = min(next_bin_index, i);
-                        break;
-                    }
-                }
-
-#pragma omp barrier
-#pragma omp single nowait
-                {
-                    curr_bin_index = kMaxBin;
-                    curr_frontier_tail = 0;
-                }
-
-                if (next_bin_index < local_bins.size()) {
-                    size_t copy_start = gapbs::fetch_and_add(next_frontier_tail, local_bins[next_bin_index].size());
-                    copy(local_bins[next_bin_index].begin(), local_bins[next_bin_index].end(), frontier.data() + copy_start);
-                    local_bins[next_bin_index].resize(0);
-                }
-
-                iter++;
-#pragma omp barrier
-            }
-
-#if defined(DEBUG)
-            #pragma omp single
-        COUT_DEBUG("took " << iter << " iterations");
-#endif
-            transaction.thread_on_openmp_section_finish(thread_id);
-        }
-        graph->on_openmp_section_finishing();
-
-        return dist;
-    }
-
-    static
-    gapbs::pvector<WeightT> do_static_sssp(gt::SharedROTransaction& transaction, uint64_t num_edges, uint64_t max_vertex_id, uint64_t source, double delta, utility::TimeoutService& timer) {
-        // Init
-        gapbs::pvector<WeightT> dist(max_vertex_id, numeric_limits<WeightT>::infinity());
-        dist[source-1] = 0;
-        gapbs::pvector<NodeID> frontier(num_edges);
-        // two element arrays for double buffering curr=iter&1, next=(iter+1)&1
-        size_t shared_indexes[2] = {0, kMaxBin};
-        size_t frontier_tails[2] = {1, 0};
-        frontier[0] = source;
-         //auto graph = transaction.get_graph();
-#pragma omp parallel
-        {
-            //uint8_t thread_id = graph->get_openmp_worker_thread_id();
-            auto iterator = transaction.generate_static_edge_delta_iterator();
-            vector<vector<NodeID> > local_bins(0);
-            size_t iter = 0;
-
-            while (shared_indexes[iter&1] != kMaxBin) {
-                size_t &curr_bin_index = shared_indexes[iter&1];
-                size_t &next_bin_index = shared_indexes[(iter+1)&1];
-                size_t &curr_frontier_tail = frontier_tails[iter&1];
-                size_t &next_frontier_tail = frontier_tails[(iter+1)&1];
-#pragma omp for nowait schedule(dynamic, 64)
-                for (size_t i=0; i < curr_frontier_tail; i++) {
-                    NodeID u = frontier[i];
-                    if (dist[u-1] >= delta * static_cast<WeightT>(curr_bin_index)) {
-                        //auto iterator = transaction.static_get_edges(u, /* label */ 1);
-                        transaction.static_get_edges(u,1,iterator);
-                        while(iterator.valid()){
-                            uint64_t v = iterator.dst_id();
-                            /*string_view payload = iterator.edge_delta_data();
-                            double w = *reinterpret_cast<const double*>(payload.data());*/
-                            double w = iterator.get_weight();
-                            WeightT old_dist = dist[v-1];
-                            WeightT new_dist = dist[u-1] + w;
-                            if (new_dist < old_dist) {
-                                bool changed_dist = true;
-                                while (!gapbs::compare_and_swap(dist[v-1], old_dist, new_dist)) {
-                                    old_dist = dist[v-1];
-                                    if (old_dist <= new_dist) {
-                                        changed_dist = false;
-                                        break;
-                                    }
-                                }
-                                if (changed_dist) {
-                                    size_t dest_bin = new_dist/delta;
-                                    if (dest_bin >= local_bins.size()) {
-                                        local_bins.resize(dest_bin+1);
-                                    }
-                                    local_bins[dest_bin].push_back(v);
-                                }
-                            }
-
-                            //iterator.next();
-                        }
-                        //iterator.close();
-                    }
-                }
-
-                for (size_t i=curr_bin_index; i < local_bins.size(); i++) {
-                    if (!local_bins[i].empty()) {
-#pragma omp critical
-                        next_bin_index = min(next_bin_index, i);
-                        break;
-                    }
-                }
-
-#pragma omp barrier
-#pragma omp single nowait
-                {
-                    curr_bin_index = kMaxBin;
-                    curr_frontier_tail = 0;
-                }
-
-                if (next_bin_index < local_bins.size()) {
-                    size_t copy_start = gapbs::fetch_and_add(next_frontier_tail, local_bins[next_bin_index].size());
-                    copy(local_bins[next_bin_index].begin(), local_bins[next_bin_index].end(), frontier.data() + copy_start);
-                    local_bins[next_bin_index].resize(0);
-                }
-
-                iter++;
-#pragma omp barrier
-            }
-
-#if defined(DEBUG)
-            #pragma omp single
-        COUT_DEBUG("took " << iter << " iterations");
-#endif
-            //transaction.thread_on_openmp_section_finish(thread_id);
-        }
-        //graph->on_openmp_section_finishing();
-
-        return dist;
-    }
-
     void GTXDriver::sssp(uint64_t source_vertex_id, const char* dump2file) {
-        //std::cout<<"sssp running"<<std::endl;
-        uint64_t max_vertex_id = GTX->get_max_allocated_vid();
-        uint64_t root = ext2int(source_vertex_id);
-        //uint64_t root = 128;
-       auto handler = GTX->get_sssp_handler(max_vertex_id);
-        double delta = 2.0;
-        //std::cout<<"before entering compute"<<std::endl;
-        handler.compute(root,delta);
-        if(dump2file != nullptr)
-            save_results<double, false>(*handler.get_result(),dump2file);
-        //std::cout<<"sssp ran"<<std::endl;
-       /*utility::TimeoutService timeout { m_timeout };
+        utility::TimeoutService timeout { m_timeout };
         Timer timer; timer.start();
         gt::SharedROTransaction transaction = GTX->begin_shared_read_only_transaction();
-        uint64_t num_edges = m_num_edges;
         uint64_t max_vertex_id = GTX->get_max_allocated_vid();
         uint64_t root = ext2int(source_vertex_id);
 
         // Run the SSSP algorithm
         double delta = 2.0; // same value used in the GAPBS, at least for most graphs
-        //auto distances = do_sssp(transaction, num_edges, max_vertex_id, root, delta, timeout);
-        auto distances = do_static_sssp(transaction, num_edges, max_vertex_id, root, delta, timeout);
+        View view { &transaction, max_vertex_id, m_is_directed };
+        auto distances = kernels::sssp(view, root -1, delta, timeout);
         if(timeout.is_timeout()){ transaction.commit(); RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);  }
 
         // Translate the vertex IDs
-        //auto external_ids = translate(&transaction, distances.data(), max_vertex_id);
-        auto external_ids = static_translate(&transaction, distances.data(), max_vertex_id);
+        auto external_ids = translate(&transaction, distances.data(), max_vertex_id);
         transaction.commit(); // read-only transaction, abort == commit
         if(timeout.is_timeout()){ RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer); }
 
         // Store the results in the given file
         if(dump2file != nullptr)
-            save_results(external_ids, dump2file);*/
-        //std::cout<<"sssp ran"<<std::endl;
+            save_results(external_ids, dump2file);
     }
 }//namespace gfe::library
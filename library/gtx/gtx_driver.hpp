@@ -5,9 +5,11 @@
 #pragma once
 #include <atomic>
 #include <chrono>
+#include <memory>
 #include <vector>
 //#include "library/interface.hpp"
 #include "../interface.hpp"
+#include "../common/vertex_dictionary.hpp"
 #include "../../graph/edge.hpp"
 #include <tbb/enumerable_thread_specific.h>//to count the time
 #define GTX_SET_THREAD_NUM true
@@ -24,7 +26,10 @@ namespace gfe::library {
 
     protected:
         void* m_pImpl; // pointer to the GTX handle
-        void* m_pHashMap; // pointer to the TBB HashMap to translate the vertex identifiers into the dense IDs for gtx
+        VertexDictionary m_vertex_dictionary; // translate the vertex identifiers into the dense IDs for gtx
+        std::unique_ptr<std::atomic<uint64_t>[]> m_dense_vertices; // flat array to translate the external vertex IDs in [0, m_dense_capacity), in place of the vertex dictionary
+        const uint64_t m_dense_capacity; // number of slots in m_dense_vertices, 0 if the dense mode is disabled
+        std::unique_ptr<std::atomic<std::atomic<uint64_t>*>[]> m_int2ext; // directory of the segments translating the internal vertex IDs into the external vertex IDs
         const bool m_is_directed; // whether the underlying graph is directed or undirected
         const bool m_read_only; // whether to used read only transactions for graphalytics
         std::atomic<uint64_t> m_num_vertices {0}; // keep track of the total number of vertices
@@ -34,6 +39,34 @@ namespace gfe::library {
         // Retrieve the internal vertex ID for the given external vertex. If the vertex does not exist, it raises an internal error
         uint64_t ext2int(uint64_t external_vertex_id) const;
 
+        // Check whether the given external vertex is translated by the flat array m_dense_vertices
+        bool is_dense_vertex(uint64_t external_vertex_id) const { return external_vertex_id < m_dense_capacity; }
+
+        // Retrieve the internal vertex ID of a vertex in the dense ID space. If the vertex is being created by another
+        // thread, wait for it to complete. Return false if the vertex does not exist.
+        bool dense_vertex_find(uint64_t external_vertex_id, uint64_t* out_internal_vertex_id) const;
+
+        // Retrieve the internal vertex ID of a vertex in the dense ID space, creating it if it does not exist yet
+        // @param out_inserted if not null, set to true if the vertex has been created by this invocation
+        uint64_t dense_vertex_get_or_create(uint64_t external_vertex_id, bool* out_inserted = nullptr);
+
+        // Create a new vertex in GTX, in its own transaction, and return its internal vertex ID
+        uint64_t create_vertex(uint64_t external_vertex_id);
+
+        // Retrieve the internal vertex ID of the given external vertex, either from the flat array or the vertex dictionary.
+        // Return false if the vertex does not exist.
+        bool vertex_find(uint64_t external_vertex_id, uint64_t* out_internal_vertex_id) const;
+
+        // Retrieve the internal vertex ID of the given external vertex, creating it if it does not exist yet
+        // @param out_inserted if not null, set to true if the vertex has been created by this invocation
+        uint64_t vertex_get_or_create(uint64_t external_vertex_id, bool* out_inserted = nullptr);
+
+        // Record the external vertex ID of a vertex just created, for the reverse translation
+        void int2ext_publish(uint64_t internal_vertex_id, uint64_t external_vertex_id);
+
+        // Retrieve the external vertex ID from the reverse translation array, or uint64_t::max() if it has not been published
+        uint64_t int2ext_lookup(uint64_t internal_vertex_id) const;
+
         // Retrieve the internal vertex ID for the given internal vertex ID. If the vertex does not exist, it returns uint64_t::max()
         uint64_t int2ext(void* transaction, uint64_t internal_vertex_id) const;
         // Retrieve the internal vertex ID for the given internal vertex ID. If the vertex does not exist, it returns uint64_t::max()
@@ -46,12 +79,34 @@ namespace gfe::library {
         template <typename T>
         std::vector<std::pair<uint64_t, T>> static_translate(void* /* transaction object */ lgtxn, const T* __restrict data, uint64_t data_sz);
 
+        // Adapter to run the generic kernels of library/common/kernels.hpp over a shared read-only transaction of GTX
+        class View;
+
         // Helper, save the content of the vector to the given output file
         template <typename T, bool negative_scores = true>
         void save_results(const std::vector<std::pair<uint64_t, T>>& result, const char* dump2file);
+
+        // Helper for #update_batch: create the vertices referred by the insertions and retrieve the internal IDs of the
+        // source and destination of each update, or uint64_t::max() if a vertex does not exist
+        void update_batch_vertices(const SingleUpdate* updates, uint64_t num_updates, uint64_t* out_internal_ids);
+
+        // Helper for #update_batch: execute the group of updates in a single transaction. Return false if the transaction
+        // has been rolled back and it needs to be restarted
+        bool update_batch_tx(const SingleUpdate* updates, const uint64_t* internal_ids, uint64_t num_updates, bool all_or_nothing, bool* out_applied, uint64_t* out_num_applied);
+
+        // Helper for #update_batch: execute the group of updates, splitting it in smaller transactions on conflicts
+        uint64_t update_batch_best_effort(const SingleUpdate* updates, const uint64_t* internal_ids, uint64_t num_updates, bool* out_applied);
         
     public:
-        GTXDriver(bool is_directed, bool read_only = true);
+        /**
+         * Create a new instance of the driver
+         * @param is_directed whether the graph is directed
+         * @param read_only whether to use read-only transactions for the Graphalytics kernels
+         * @param dense_vertex_ids if > 0, the external vertex IDs in [0, dense_vertex_ids) are translated with a flat array
+         *        of atomic slots, rather than the vertex dictionary. Meant for graphs whose vertex IDs are dense or known in advance.
+         *        The vertices outside this range are still translated with the vertex dictionary.
+         */
+        GTXDriver(bool is_directed, bool read_only = true, uint64_t dense_vertex_ids = 0);
 
         virtual void set_worker_thread_num(uint64_t new_num);
         virtual void on_edge_writes_finish();
@@ -132,6 +187,17 @@ namespace gfe::library {
          */
         virtual bool remove_edge(gfe::graph::Edge e);
 
+        /**
+         * Perform a group of updates. With the atomicity PER_BATCH or BEST_EFFORT, the updates are committed together
+         * in a single GTX transaction. In case of conflicts, BEST_EFFORT retries the group in smaller transactions.
+         */
+        virtual uint64_t update_batch(const SingleUpdate* updates, uint64_t num_updates, BatchAtomicity atomicity, bool* out_applied = nullptr);
+
+        /**
+         * GTX supports atomic groups of updates
+         */
+        virtual bool has_atomic_batches() const;
+
         /**
          * Dump the content of the graph to given stream.
          */
@@ -142,7 +208,7 @@ namespace gfe::library {
         * For Debugging & Testing only
         */
         void* gtx();
-        void* vertex_dictionary(); // tbb::concurrent_hash_map<uint64_t, lg::vertex_t>
+        void* vertex_dictionary(); // gfe::library::VertexDictionary
 
         /**
      * Perform a BFS from source_vertex_id to all the other vertices in the graph.
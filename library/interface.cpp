@@ -119,6 +119,12 @@ std::unique_ptr<Interface> generate_csr_numa(bool directed_graph){
 std::unique_ptr<Interface> generate_csr_lcc_numa(bool directed_graph){
     return unique_ptr<Interface>{ new CSR_LCC(directed_graph, /* numa interleaved ? */ true) };
 }
+std::unique_ptr<Interface> generate_csr_compressed(bool directed_graph){
+    return unique_ptr<Interface>{ new CSR_Compressed(directed_graph, CSR_Compressed::Weights::FLOAT32, /* numa interleaved ? */ false) };
+}
+std::unique_ptr<Interface> generate_csr_compressed_noweights(bool directed_graph){
+    return unique_ptr<Interface>{ new CSR_Compressed(directed_graph, CSR_Compressed::Weights::NONE, /* numa interleaved ? */ false) };
+}
 
 std::unique_ptr<Interface> generate_dummy(bool directed_graph){
     return unique_ptr<Interface>{ new Dummy(directed_graph) };
@@ -247,10 +253,10 @@ std::unique_ptr<Interface> generate_sortledton_v2(bool directed_graph) {
 
 #if defined(HAVE_GTX)
 std::unique_ptr<Interface> generate_gtx_ro(bool directed_graph){ // read only transactions for Graphalytics
-    return unique_ptr<Interface>( new GTXDriver(directed_graph, /*read_only ? */ true));
+    return unique_ptr<Interface>( new GTXDriver(directed_graph, /*read_only ? */ true, configuration().get_dense_vertices()));
 }
 std::unique_ptr<Interface> generate_gtx_rw(bool directed_graph){ // read-write transactions for Graphalytics
-    return unique_ptr<Interface>( new GTXDriver(directed_graph, /*read_only ? */ false));
+    return unique_ptr<Interface>( new GTXDriver(directed_graph, /*read_only ? */ false, configuration().get_dense_vertices()));
 }
 #endif
 
@@ -278,6 +284,8 @@ vector<ImplementationManifest> implementations() {
     result.emplace_back("csr3-lcc", "CSR baseline, sort-merge impl for the LCC kernel", &generate_csr_lcc);
     result.emplace_back("csr3-numa", "CSR baseline, allocate the internal arrays using all NUMA nodes", &generate_csr_numa);
     result.emplace_back("csr3-lcc-numa", "CSR baseline, allocate the internal arrays using all NUMA nodes, sort-merge impl for the LCC kernel", &generate_csr_lcc_numa);
+    result.emplace_back("csr3-compressed", "CSR baseline, neighbour lists compressed with delta + varint encoding, weights as floats", &generate_csr_compressed);
+    result.emplace_back("csr3-compressed-noweights", "CSR baseline, neighbour lists compressed with delta + varint encoding, without weights", &generate_csr_compressed_noweights);
 
     // Temporary, we run csr3-lcc on a single NUMA node to pin down if NUMA effects are resposible for SortedVectorAL being faster some times
     result.emplace_back("single-numa-node-csr3-lcc", "CSR baseline, sort-merge impl for the LCC kernel", &generate_csr_lcc);
@@ -591,6 +599,50 @@ bool UpdateInterface::batch(const SingleUpdate* array, size_t array_sz, bool for
     return result;
 }
 
+uint64_t UpdateInterface::update_batch(const SingleUpdate* updates, uint64_t num_updates, BatchAtomicity atomicity, bool* out_applied){
+    if(atomicity == BatchAtomicity::PER_BATCH) ERROR("This library does not support atomic batches of updates");
+    uint64_t num_applied = 0;
+
+    for(uint64_t i = 0; i < num_updates; i++){
+        bool applied = false;
+        if(updates[i].m_weight >= 0){ // insert
+            applied = add_edge_v2(graph::WeightedEdge{updates[i].m_source, updates[i].m_destination, updates[i].m_weight});
+        } else { // remove
+            applied = remove_edge(graph::Edge{updates[i].m_source, updates[i].m_destination});
+        }
+
+        num_applied += applied;
+        if(out_applied != nullptr){ out_applied[i] = applied; }
+    }
+
+    return num_applied;
+}
+
+bool UpdateInterface::has_atomic_batches() const {
+    return false;
+}
+
+string batch_atomicity_to_string(UpdateInterface::BatchAtomicity atomicity){
+    switch(atomicity){
+    case UpdateInterface::BatchAtomicity::PER_EDGE: return "per_edge";
+    case UpdateInterface::BatchAtomicity::PER_BATCH: return "per_batch";
+    case UpdateInterface::BatchAtomicity::BEST_EFFORT: return "best_effort";
+    default: return "unknown";
+    }
+}
+
+UpdateInterface::BatchAtomicity parse_batch_atomicity(const std::string& value){
+    if(value == "per_edge"){
+        return UpdateInterface::BatchAtomicity::PER_EDGE;
+    } else if(value == "per_batch"){
+        return UpdateInterface::BatchAtomicity::PER_BATCH;
+    } else if(value == "best_effort"){
+        return UpdateInterface::BatchAtomicity::BEST_EFFORT;
+    } else {
+        INVALID_ARGUMENT("Invalid atomicity: `" << value << "'. Valid values are: per_edge, per_batch and best_effort");
+    }
+}
+
 template<typename Action, typename Edge>
 void UpdateInterface::batch_try_again(Action action, Edge edge){
     constexpr chrono::seconds timeout = 10min;
@@ -271,7 +271,7 @@ public:
      * Perform a batch of edge insertions/deletions.
      * -- LIBRARY IMPLEMENTATIONS SHALL NOT OVERRIDE THIS METHOD: this is only used by the driver in client-server
      * mode. The point is not to measure the performance of ``batch updates'' in the library, but to amortize the
-     * cost of many RPC calls over the network.
+     * cost of many RPC calls over the network. To measure group updates in the library, see #update_batch.
      *
      * @param array the list of edge updates, insertions/deletions
      * @param array_sz the size of the list of edge updates
@@ -284,8 +284,44 @@ public:
         double m_weight; // if < 0, this is an edge removal, otherwise it's an edge insertion with the given weight
     };
     virtual bool batch(const SingleUpdate* array, size_t array_sz, bool force = true);
+
+    /**
+     * The atomicity of a group of updates performed with #update_batch:
+     * - PER_EDGE: each update is applied on its own, as by a sequence of invocations to #add_edge_v2 and #remove_edge;
+     * - PER_BATCH: either all updates of the group are applied, or none of them. If any update cannot be applied (e.g.
+     *   the edge to remove does not exist), the whole group is discarded;
+     * - BEST_EFFORT: the library is free to apply the updates in as few transactions as it can. An update that cannot be
+     *   applied is skipped and it does not affect the others.
+     */
+    enum class BatchAtomicity { PER_EDGE, PER_BATCH, BEST_EFFORT };
+
+    /**
+     * Perform a group of edge insertions/deletions. Insertions implicitly create the referred vertices, as in #add_edge_v2.
+     * Unlike #batch, this method is meant to be overridden by the libraries that can commit many updates at once, e.g.
+     * in a single transaction. The default implementation performs a sequence of #add_edge_v2 and #remove_edge, and it
+     * does not support the atomicity PER_BATCH.
+     * The vertices referred by the group may be created even when the group is discarded.
+     *
+     * @param updates the list of edge updates, insertions/deletions
+     * @param num_updates the number of updates in the list
+     * @param atomicity how the updates in the group are applied
+     * @param out_applied if not null, an array of num_updates entries, set to whether each update has been applied
+     * @return the number of updates applied
+     */
+    virtual uint64_t update_batch(const SingleUpdate* updates, uint64_t num_updates, BatchAtomicity atomicity, bool* out_applied = nullptr);
+
+    /**
+     * Check whether the library supports #update_batch with the atomicity PER_BATCH
+     */
+    virtual bool has_atomic_batches() const;
 };
 
+// Retrieve a string representation of the given atomicity (per_edge, per_batch, best_effort)
+std::string batch_atomicity_to_string(UpdateInterface::BatchAtomicity atomicity);
+
+// Parse the given string into an atomicity for #update_batch. Raise an error if the string is not valid
+UpdateInterface::BatchAtomicity parse_batch_atomicity(const std::string& value);
+
 /**
  * The six algorithms required by the Graphalytics benchmark suite
  * See https://github.com/ldbc/ldbc_graphalytics_docs/
@@ -24,16 +24,17 @@
 #include <iostream>
 #include <mutex>
 #include <limits>
+#include <memory>
 #include <sstream>
 #include <thread>
 #include <unordered_set>
 
 #include "common/system.hpp"
 #include "common/timer.hpp"
-#include "tbb/concurrent_hash_map.h"
-#include "third-party/gapbs/gapbs.hpp"
+#include "library/common/kernels.hpp"
 #include "third-party/libcuckoo/cuckoohash_map.hh"
 #include "third-party/livegraph/livegraph.hpp"
+#include "utility/result_writer.hpp"
 #include "utility/timeout_service.hpp"
 
 using namespace common;
@@ -41,8 +42,6 @@ using namespace libcuckoo;
 using namespace std;
 
 #define LiveGraph reinterpret_cast<lg::Graph*>(m_pImpl)
-using vertex_dictionary_t = tbb::concurrent_hash_map<uint64_t, lg::vertex_t>;
-#define VertexDictionary reinterpret_cast<vertex_dictionary_t*>(m_pHashMap)
 
 /*****************************************************************************
  *                                                                           *
@@ -65,14 +64,12 @@ namespace gfe::library {
  *  Init                                                                     *
  *                                                                           *
  *****************************************************************************/
-LiveGraphDriver::LiveGraphDriver(bool is_directed, bool read_only) : m_pImpl(nullptr), m_pHashMap(nullptr), m_is_directed(is_directed), m_read_only(read_only) {
+LiveGraphDriver::LiveGraphDriver(bool is_directed, bool read_only) : m_pImpl(nullptr), m_is_directed(is_directed), m_read_only(read_only) {
     m_pImpl = new lg::Graph();
-    m_pHashMap = new tbb::concurrent_hash_map<uint64_t, /* vertex_t */ uint64_t>();
 }
 
 LiveGraphDriver::~LiveGraphDriver(){
     delete LiveGraph; m_pImpl = nullptr;
-    delete VertexDictionary; m_pHashMap = nullptr;
 }
 
 /*****************************************************************************
@@ -101,13 +98,13 @@ void* LiveGraphDriver::livegraph() {
 }
 
 void* LiveGraphDriver::vertex_dictionary() {
-    return m_pHashMap;
+    return &m_vertex_dictionary;
 }
 
 uint64_t LiveGraphDriver::ext2int(uint64_t external_vertex_id) const {
-    vertex_dictionary_t::const_accessor accessor;
-    if ( VertexDictionary->find(accessor, external_vertex_id ) ){
-        return accessor->second;
+    uint64_t internal_vertex_id = 0;
+    if ( m_vertex_dictionary.find(external_vertex_id, &internal_vertex_id ) ){
+        return internal_vertex_id;
     } else {
         ERROR("The given vertex does not exist: " << external_vertex_id);
     }
@@ -128,40 +125,46 @@ uint64_t LiveGraphDriver::int2ext(void* opaque_transaction, uint64_t internal_ve
  *  Updates                                                                  *
  *                                                                           *
  *****************************************************************************/
-bool LiveGraphDriver::add_vertex(uint64_t external_id){
-    //COUT_DEBUG("vertex_id: " << external_id);
-    vertex_dictionary_t::accessor accessor; // xlock
-    bool inserted = VertexDictionary->insert(accessor, external_id);
-    if ( inserted ){
-        lg::vertex_t internal_id = 0;
-        bool done = false;
-        do {
-            try {
-                auto tx = LiveGraph->begin_transaction();
-                internal_id = tx.new_vertex();
-                string_view data { (char*) &external_id, sizeof(external_id) };
-                tx.put_vertex(internal_id, data);
-                tx.commit();
-                done = true;
-            } catch(lg::Transaction::RollbackExcept& e){
-                COUT_DEBUG("Rollback, vertex id: " << external_id);
-                // retry ...
-            }
-        } while(!done);
+uint64_t LiveGraphDriver::create_vertex(uint64_t external_id){
+    lg::vertex_t internal_id = 0;
+    bool done = false;
+    do {
+        try {
+            auto tx = LiveGraph->begin_transaction();
+            internal_id = tx.new_vertex();
+            string_view data { (char*) &external_id, sizeof(external_id) };
+            tx.put_vertex(internal_id, data);
+            tx.commit();
+            done = true;
+        } catch(lg::Transaction::RollbackExcept& e){
+            COUT_DEBUG("Rollback, vertex id: " << external_id);
+            // retry ...
+        }
+    } while(!done);
 
-        accessor->second = internal_id;
-        m_num_vertices++;
-    }
+    return internal_id;
+}
+
+uint64_t LiveGraphDriver::vertex_get_or_create(uint64_t external_id, bool* out_inserted){
+    bool inserted = false;
+    uint64_t internal_id = m_vertex_dictionary.get_or_create(external_id, [&](){ return create_vertex(external_id); }, &inserted);
+    if(inserted){ m_num_vertices++; }
+    if(out_inserted != nullptr){ *out_inserted = inserted; }
+    return internal_id;
+}
 
+bool LiveGraphDriver::add_vertex(uint64_t external_id){
+    //COUT_DEBUG("vertex_id: " << external_id);
+    bool inserted = false;
+    vertex_get_or_create(external_id, &inserted);
     return inserted;
 }
 
 bool LiveGraphDriver::remove_vertex(uint64_t external_id){
     COUT_DEBUG("vertex_id: " << external_id);
-    vertex_dictionary_t::accessor accessor; // xlock
-    bool found = VertexDictionary->find(accessor, external_id);
+    uint64_t internal_id = 0;
+    bool found = m_vertex_dictionary.remove(external_id, &internal_id);
     if(found){
-        lg::vertex_t internal_id = accessor->second;
         bool done = false;
         do {
             try {
@@ -173,26 +176,21 @@ bool LiveGraphDriver::remove_vertex(uint64_t external_id){
                 // retry ...
             }
         } while(!done);
-
-        VertexDictionary->erase(accessor);
     }
     m_num_vertices--;
     return found;
 }
 
 bool LiveGraphDriver::has_vertex(uint64_t vertex_id) const {
-    vertex_dictionary_t::const_accessor accessor;
-    return VertexDictionary->find(accessor, vertex_id);
+    return m_vertex_dictionary.contains(vertex_id);
 }
 
 bool LiveGraphDriver::add_edge(gfe::graph::WeightedEdge e){
     //COUT_DEBUG("Edge: " << e);
 
-    vertex_dictionary_t::const_accessor accessor1, accessor2;  // shared lock on the dictionary
-    if(!VertexDictionary->find(accessor1, e.source())){ return false; }
-    if(!VertexDictionary->find(accessor2, e.destination())) { return false; }
-    lg::vertex_t internal_source_id = accessor1->second;
-    lg::vertex_t internal_destination_id = accessor2->second;
+    uint64_t internal_source_id = 0, internal_destination_id = 0;
+    if(!m_vertex_dictionary.find(e.source(), &internal_source_id)){ return false; }
+    if(!m_vertex_dictionary.find(e.destination(), &internal_destination_id)) { return false; }
 
     bool done = false;
     do {
@@ -228,52 +226,15 @@ bool LiveGraphDriver::add_edge(gfe::graph::WeightedEdge e){
 }
 
 bool LiveGraphDriver::add_edge_v2(gfe::graph::WeightedEdge edge){
-    uint64_t internal_source_id = numeric_limits<uint64_t>::max();
-    uint64_t internal_destination_id = 0;
-    bool insert_source = false;
-    bool insert_destination = false;
-    vertex_dictionary_t::const_accessor slock1, slock2;
-    vertex_dictionary_t::accessor xlock1, xlock2;
-
-    if(VertexDictionary->find(slock1, edge.m_source)){ // insert the vertex e.m_source
-        internal_source_id = slock1->second;
-    } else {
-        slock1.release();
-        if ( VertexDictionary->insert(xlock1, edge.m_source) ) {
-            insert_source = true;
-        } else {
-            internal_source_id = xlock1->second;
-        }
-    }
-
-    if(VertexDictionary->find(slock2, edge.m_destination)){ // insert the vertex e.m_destination
-        internal_destination_id = slock2->second;
-    } else {
-        slock2.release();
-        if( VertexDictionary->insert(xlock2, edge.m_destination) ) {
-            insert_destination = true;
-        } else {
-            internal_destination_id = xlock2->second;
-        }
-    }
+    // the vertices are created, if they do not exist, in their own transactions
+    lg::vertex_t internal_source_id = vertex_get_or_create(edge.m_source);
+    lg::vertex_t internal_destination_id = vertex_get_or_create(edge.m_destination);
 
     bool done = false;
     do {
         try {
             auto tx = LiveGraph->begin_transaction();
 
-            // create the vertices in LiveGraph
-            if(insert_source){
-                internal_source_id = tx.new_vertex();
-                string_view data { (char*) &edge.m_source, sizeof(edge.m_source) };
-                tx.put_vertex(internal_source_id, data);
-            }
-            if(insert_destination){
-                internal_destination_id = tx.new_vertex();
-                string_view data { (char*) &edge.m_destination, sizeof(edge.m_destination) };
-                tx.put_vertex(internal_destination_id, data);
-            }
-
             // insert the edge
             string_view weight { (char*) &edge.m_weight, sizeof(edge.m_weight) };
             tx.put_edge(internal_source_id, /* label */ 0, internal_destination_id, weight);
@@ -294,26 +255,13 @@ bool LiveGraphDriver::add_edge_v2(gfe::graph::WeightedEdge edge){
         }
     } while(!done);
 
-    if(insert_source){
-        assert(internal_source_id != numeric_limits<uint64_t>::max());
-        xlock1->second = internal_source_id;
-        m_num_vertices++;
-    }
-    if(insert_destination){
-        assert(internal_destination_id != numeric_limits<uint64_t>::max());
-        xlock2->second = internal_destination_id;
-       m_num_vertices++;
-    }
-
     return true;
 }
 
 bool LiveGraphDriver::remove_edge(gfe::graph::Edge e){
-    vertex_dictionary_t::const_accessor slock1, slock2;
-    if(!VertexDictionary->find(slock1, e.source())){ return false; }
-    if(!VertexDictionary->find(slock2, e.destination())){ return false; }
-    lg::vertex_t internal_source_id = slock1->second;
-    lg::vertex_t internal_destination_id = slock2->second;
+    uint64_t internal_source_id = 0, internal_destination_id = 0;
+    if(!m_vertex_dictionary.find(e.source(), &internal_source_id)){ return false; }
+    if(!m_vertex_dictionary.find(e.destination(), &internal_destination_id)){ return false; }
 
     while(true){
         try {
@@ -331,13 +279,116 @@ bool LiveGraphDriver::remove_edge(gfe::graph::Edge e){
     }
 }
 
+bool LiveGraphDriver::has_atomic_batches() const {
+    return true;
+}
+
+uint64_t LiveGraphDriver::update_batch(const SingleUpdate* updates, uint64_t num_updates, BatchAtomicity atomicity, bool* out_applied){
+    if(atomicity == BatchAtomicity::PER_EDGE){ return UpdateInterface::update_batch(updates, num_updates, atomicity, out_applied); }
+    if(num_updates == 0){ return 0; }
+
+    unique_ptr<bool[]> ptr_applied;
+    if(out_applied == nullptr){
+        ptr_applied.reset(new bool[num_updates]);
+        out_applied = ptr_applied.get();
+    }
+    unique_ptr<uint64_t[]> ptr_internal_ids { new uint64_t[2 * num_updates] };
+    update_batch_vertices(updates, num_updates, ptr_internal_ids.get());
+
+    if(atomicity == BatchAtomicity::PER_BATCH){
+        uint64_t num_applied = 0;
+        while(!update_batch_tx(updates, ptr_internal_ids.get(), num_updates, /* all or nothing */ true, out_applied, &num_applied)){ /* retry ... */ }
+        return num_applied;
+    } else { // best effort
+        return update_batch_best_effort(updates, ptr_internal_ids.get(), num_updates, out_applied);
+    }
+}
+
+void LiveGraphDriver::update_batch_vertices(const SingleUpdate* updates, uint64_t num_updates, uint64_t* out_internal_ids){
+    // the vertices are created one at the time, with the same logic of #add_vertex, each in its own transaction
+    for(uint64_t i = 0; i < num_updates; i++){
+        const uint64_t endpoints[2] = { updates[i].m_source, updates[i].m_destination };
+        for(uint64_t j = 0; j < 2; j++){
+            uint64_t internal_vertex_id = numeric_limits<uint64_t>::max();
+            if(updates[i].m_weight >= 0){ // insertion
+                internal_vertex_id = vertex_get_or_create(endpoints[j]);
+            } else {
+                m_vertex_dictionary.find(endpoints[j], &internal_vertex_id);
+            }
+            out_internal_ids[2*i +j] = internal_vertex_id;
+        }
+    }
+}
+
+bool LiveGraphDriver::update_batch_tx(const SingleUpdate* updates, const uint64_t* internal_ids, uint64_t num_updates, bool all_or_nothing, bool* out_applied, uint64_t* out_num_applied){
+    int64_t num_edges_delta = 0; // how much the number of edges changes with this transaction
+    uint64_t num_applied = 0;
+
+    try {
+        auto tx = LiveGraph->begin_transaction();
+
+        for(uint64_t i = 0; i < num_updates; i++){
+            lg::vertex_t internal_source_id = internal_ids[2*i];
+            lg::vertex_t internal_destination_id = internal_ids[2*i +1];
+            bool result = false;
+
+            if(internal_source_id == numeric_limits<uint64_t>::max() || internal_destination_id == numeric_limits<uint64_t>::max()){
+                result = false; // removal of an edge referring a non existing vertex
+            } else if(updates[i].m_weight >= 0){ // insertion, as in #add_edge_v2
+                string_view weight { (char*) &(updates[i].m_weight), sizeof(updates[i].m_weight) };
+                tx.put_edge(internal_source_id, /* label */ 0, internal_destination_id, weight);
+                lg::label_t label = m_is_directed ? 1 : 0;
+                tx.put_edge(internal_destination_id, /* label */ label, internal_source_id, weight);
+                num_edges_delta++;
+                result = true;
+            } else { // removal, as in #remove_edge
+                result = tx.del_edge(internal_source_id, /* label */ 0, internal_destination_id);
+                if(result && !m_is_directed){
+                    tx.del_edge(internal_destination_id, /* label */ 0, internal_source_id);
+                }
+                if(result){ num_edges_delta--; }
+            }
+
+            if(!result && all_or_nothing){ // discard the whole group
+                tx.abort();
+                for(uint64_t j = 0; j < num_updates; j++){ out_applied[j] = false; }
+                *out_num_applied = 0;
+                return true;
+            }
+
+            out_applied[i] = result;
+            num_applied += result;
+        }
+
+        tx.commit();
+    } catch(lg::Transaction::RollbackExcept& e){
+        COUT_DEBUG("Rollback, group of " << num_updates << " updates");
+        return false; // retry ...
+    }
+
+    m_num_edges += num_edges_delta;
+    *out_num_applied = num_applied;
+    return true;
+}
+
+uint64_t LiveGraphDriver::update_batch_best_effort(const SingleUpdate* updates, const uint64_t* internal_ids, uint64_t num_updates, bool* out_applied){
+    uint64_t num_applied = 0;
+    if(num_updates == 1){
+        while(!update_batch_tx(updates, internal_ids, 1, /* all or nothing */ false, out_applied, &num_applied)){ /* retry ... */ }
+    } else if(!update_batch_tx(updates, internal_ids, num_updates, /* all or nothing */ false, out_applied, &num_applied)){
+        // conflict with another writer, retry with two smaller transactions
+        uint64_t half = num_updates / 2;
+        num_applied = update_batch_best_effort(updates, internal_ids, half, out_applied);
+        num_applied += update_batch_best_effort(updates + half, internal_ids + 2 * half, num_updates - half, out_applied + half);
+    }
+    return num_applied;
+}
+
 double LiveGraphDriver::get_weight(uint64_t source, uint64_t destination) const {
     // check whether the referred vertices exist
-    vertex_dictionary_t::const_accessor slock1, slock2;
-    if(!VertexDictionary->find(slock1, source)){ return numeric_limits<double>::signaling_NaN(); }
-    if(!VertexDictionary->find(slock2, destination)){ return numeric_limits<double>::signaling_NaN(); }
-    lg::vertex_t internal_source_id = slock1->second;
-    lg::vertex_t internal_destination_id = slock2->second;
+    uint64_t internal_source_id = 0, internal_destination_id = 0;
+    if(!m_vertex_dictionary.find(source, &internal_source_id)){ return numeric_limits<double>::signaling_NaN(); }
+    if(!m_vertex_dictionary.find(destination, &internal_destination_id)){ return numeric_limits<double>::signaling_NaN(); }
 
     auto tx = LiveGraph->begin_read_only_transaction();
     string_view lg_weight = tx.get_edge(internal_source_id, /* label */ 0, internal_destination_id);
@@ -412,251 +463,95 @@ void LiveGraphDriver::save_results(const vector<pair<uint64_t, T>>& result, cons
     assert(dump2file != nullptr);
     COUT_DEBUG("save the results to: " << dump2file);
 
-    fstream handle(dump2file, ios_base::out);
-    if (!handle.good()) ERROR("Cannot save the result to `" << dump2file << "'");
-
-    for (const auto &p : result) {
-        if(p.first == numeric_limits<uint64_t>::max()) continue; // invalid node
-
-        handle << p.first << " ";
-
-        if(!negative_scores && p.second < 0){
-            handle << numeric_limits<T>::max();
-        } else {
-            handle << p.second;
-        }
-
-        handle << "\n";
-    }
-
-    handle.close();
+    utility::save_results<T, negative_scores>(result, dump2file);
 }
 
-
-/*****************************************************************************
- *                                                                           *
- *  BFS                                                                      *
- *                                                                           *
- *****************************************************************************/
-// Implementation based on the reference BFS for the GAP Benchmark Suite
-// https://github.com/sbeamer/gapbs
-// The reference implementation has been written by Scott Beamer
-//
-// Copyright (c) 2015, The Regents of the University of California (Regents)
-// All Rights Reserved.
-//
-// Redistribution and use in source and binary forms, with or without
-// modification, are permitted provided that the following conditions are met:
-// 1. Redistributions of source code must retain the above copyright
-//    notice, this list of conditions and the following disclaimer.
-// 2. Redistributions in binary form must reproduce the above copyright
-//    notice, this list of conditions and the following disclaimer in the
-//    documentation and/or other materials provided with the distribution.
-// 3. Neither the name of the Regents nor the
-//    names of its contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
-// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
-// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-// DISCLAIMED. IN NO EVENT SHALL REGENTS BE LIABLE FOR ANY
-// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
-// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
-// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
-// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-
-/*
-
-Will return parent array for a BFS traversal from a source vertex
-This BFS implementation makes use of the Direction-Optimizing approach [1].
-It uses the alpha and beta parameters to determine whether to switch search
-directions. For representing the frontier, it uses a SlidingQueue for the
-top-down approach and a Bitmap for the bottom-up approach. To reduce
-false-sharing for the top-down approach, thread-local QueueBuffer's are used.
-To save time computing the number of edges exiting the frontier, this
-implementation precomputes the degrees in bulk at the beginning by storing
-them in parent array as negative numbers. Thus the encoding of parent is:
-  parent[x] < 0 implies x is unvisited and parent[x] = -out_degree(x)
-  parent[x] >= 0 implies x been visited
-[1] Scott Beamer, Krste Asanović, and David Patterson. "Direction-Optimizing
-    Breadth-First Search." International Conference on High Performance
-    Computing, Networking, Storage and Analysis (SC), Salt Lake City, Utah,
-    November 2012.
-
-*/
-//#define DEBUG_BFS
-#if defined(DEBUG_BFS)
-#define COUT_DEBUG_BFS(msg) COUT_DEBUG(msg)
-#else
-#define COUT_DEBUG_BFS(msg)
-#endif
-
-
-static
-int64_t do_bfs_BUStep(lg::Transaction& transaction, uint64_t max_vertex_id, int64_t* distances, int64_t distance, gapbs::Bitmap &front, gapbs::Bitmap &next) {
-    int64_t awake_count = 0;
-    next.reset();
-
-    #pragma omp parallel for schedule(dynamic, 1024) reduction(+ : awake_count)
-    for (uint64_t u = 0; u < max_vertex_id; u++) {
-        if(distances[u] == numeric_limits<int64_t>::max()) continue; // the vertex does not exist
-        COUT_DEBUG_BFS("explore: " << u << ", distance: " << distances[u]);
-
-        if (distances[u] < 0){ // the node has not been visited yet
-            auto iterator = transaction.get_edges(u, /* label */ 0); // fixme: incoming edges for directed graphs
-
-            while(iterator.valid()){
-                uint64_t dst = iterator.dst_id();
-                COUT_DEBUG_BFS("\tincoming edge: " << dst);
-
-                if(front.get_bit(dst)) {
-                    COUT_DEBUG_BFS("\t-> distance updated to " << distance << " via vertex #" << dst);
-                    distances[u] = distance; // on each BUStep, all nodes will have the same distance
-                    awake_count++;
-                    next.set_bit(u);
-                    break;
-                }
-
-                iterator.next();
-            }
-        }
-    }
-
-    return awake_count;
-}
-
-static
-int64_t do_bfs_TDStep(lg::Transaction& transaction, uint64_t max_vertex_id, int64_t* distances, int64_t distance, gapbs::SlidingQueue<int64_t>& queue) {
-    int64_t scout_count = 0;
-
-    #pragma omp parallel reduction(+ : scout_count)
-    {
-        gapbs::QueueBuffer<int64_t> lqueue(queue);
-
-        #pragma omp for schedule(dynamic, 64)
-        for (auto q_iter = queue.begin(); q_iter < queue.end(); q_iter++) {
-            int64_t u = *q_iter;
-            COUT_DEBUG_BFS("explore: " << u);
-            auto iterator = transaction.get_edges(u, /* label */ 0);
-            while(iterator.valid()){
-                uint64_t dst = iterator.dst_id();
-                COUT_DEBUG_BFS("\toutgoing edge: " << dst);
-
-                int64_t curr_val = distances[dst];
-                if (curr_val < 0 && gapbs::compare_and_swap(distances[dst], curr_val, distance)) {
-                    COUT_DEBUG_BFS("\t-> distance updated to " << distance << " via vertex #" << dst);
-                    lqueue.push_back(dst);
-                    scout_count += -curr_val;
-                }
-
-                iterator.next();
+// The kernels of the Graphalytics suite are implemented in library/common/kernels.hpp. This adapter exposes a LiveGraph
+// transaction through the view expected by the kernels. LiveGraph does not store the degree of the vertices, thus the
+// view computes the degrees of all vertices once, in a single scan of the edges, when it is created.
+class LiveGraphDriver::View {
+    lg::Transaction* m_transaction;
+    const uint64_t m_max_vertex_id; // the logical IDs are in [0, max_vertex_id)
+    const bool m_is_directed;
+    unique_ptr<uint64_t[]> m_degrees; // the out degree of each vertex, or uint64_t::max() if the vertex does not exist
+    uint64_t m_num_edges = 0; // number of edges visible to the transaction
+
+public:
+    View(lg::Transaction* transaction, uint64_t max_vertex_id, bool is_directed) : m_transaction(transaction), m_max_vertex_id(max_vertex_id), m_is_directed(is_directed), m_degrees(new uint64_t[max_vertex_id]) {
+        uint64_t* __restrict degrees = m_degrees.get();
+        uint64_t num_edges = 0;
+
+        #pragma omp parallel for reduction(+:num_edges)
+        for(uint64_t v = 0; v < max_vertex_id; v++){
+            if(transaction->get_vertex(v).empty()){ // the vertex does not exist
+                degrees[v] = numeric_limits<uint64_t>::max();
+            } else {
+                uint64_t degree = 0;
+                auto iterator = transaction->get_edges(v, /* label */ 0);
+                while(iterator.valid()){ degree++; iterator.next(); }
+                degrees[v] = degree;
+                num_edges += degree;
             }
         }
 
-        lqueue.flush();
+        m_num_edges = is_directed ? num_edges : num_edges / 2; // undirected edges are stored twice, as a -> b and b -> a
     }
 
-    return scout_count;
-}
+    uint64_t num_vertices() const { return m_max_vertex_id; }
+    bool has_vertex(uint64_t v) const { return m_degrees[v] != numeric_limits<uint64_t>::max(); }
+    uint64_t num_edges() const { return m_num_edges; }
+    bool is_directed() const { return m_is_directed; }
+    void on_thread_enter() const { } // the transaction can be shared among the threads as it is
+    void on_thread_leave() const { }
 
-static
-void do_bfs_QueueToBitmap(lg::Transaction& transaction, uint64_t max_vertex_id, const gapbs::SlidingQueue<int64_t> &queue, gapbs::Bitmap &bm) {
-    #pragma omp parallel for
-    for (auto q_iter = queue.begin(); q_iter < queue.end(); q_iter++) {
-        int64_t u = *q_iter;
-        bm.set_bit_atomic(u);
+    uint64_t out_degree(uint64_t v) const {
+        return has_vertex(v) ? m_degrees[v] : 0;
     }
-}
 
-static
-void do_bfs_BitmapToQueue(lg::Transaction& transaction, uint64_t max_vertex_id, const gapbs::Bitmap &bm, gapbs::SlidingQueue<int64_t> &queue) {
-    #pragma omp parallel
-    {
-        gapbs::QueueBuffer<int64_t> lqueue(queue);
-        #pragma omp for
-        for (uint64_t n=0; n < max_vertex_id; n++)
-            if (bm.get_bit(n))
-                lqueue.push_back(n);
-        lqueue.flush();
+    // Only the outgoing edges are stored, the kernels relying on the incoming edges are restricted to undirected graphs
+    uint64_t in_degree(uint64_t v) const {
+        return out_degree(v);
     }
-    queue.slide_window();
-}
-
-static
-unique_ptr<int64_t[]> do_bfs_init_distances(lg::Transaction& transaction, uint64_t max_vertex_id) {
-    unique_ptr<int64_t[]> distances{ new int64_t[max_vertex_id] };
-    #pragma omp parallel for
-    for (uint64_t n = 0; n < max_vertex_id; n++){
-        if(transaction.get_vertex(n).empty()){ // the vertex does not exist
-            distances[n] = numeric_limits<int64_t>::max();
-        } else { // the vertex exists
-            // Retrieve the out degree for the vertex n
-            uint64_t out_degree = 0;
-            auto iterator = transaction.get_edges(n, /* label */ 0);
-            while(iterator.valid()){
-                out_degree++;
-                iterator.next();
-            }
 
-            distances[n] = out_degree != 0 ? - out_degree : -1;
+    template<typename F>
+    void for_each_out_neighbour(uint64_t v, F&& f) const {
+        if(!has_vertex(v)) return;
+        auto iterator = m_transaction->get_edges(v, /* label */ 0);
+        while(iterator.valid()){
+            if(!f(static_cast<uint64_t>(iterator.dst_id()))) break;
+            iterator.next();
         }
     }
 
-    return distances;
-}
-
-static
-unique_ptr<int64_t[]> do_bfs(lg::Transaction& transaction, uint64_t num_vertices, uint64_t num_edges, uint64_t max_vertex_id, uint64_t root, utility::TimeoutService& timer, int alpha = 15, int beta = 18) {
-    // The implementation from GAP BS reports the parent (which indeed it should make more sense), while the one required by
-    // Graphalytics only returns the distance
-    unique_ptr<int64_t[]> ptr_distances = do_bfs_init_distances(transaction, max_vertex_id);
-    int64_t* __restrict distances = ptr_distances.get();
-    distances[root] = 0;
-
-    gapbs::SlidingQueue<int64_t> queue(max_vertex_id);
-    queue.push_back(root);
-    queue.slide_window();
-    gapbs::Bitmap curr(max_vertex_id);
-    curr.reset();
-    gapbs::Bitmap front(max_vertex_id);
-    front.reset();
-    int64_t edges_to_check = num_edges; //g.num_edges_directed();
-
-
-    int64_t scout_count = 0;
-    { // retrieve the out degree of the root
-        auto iterator = transaction.get_edges(root, 0);
-        while(iterator.valid()){ scout_count++; iterator.next(); }
+    template<typename F>
+    void for_each_in_neighbour(uint64_t v, F&& f) const {
+        for_each_out_neighbour(v, f);
     }
-    int64_t distance = 1; // current distance
-
-    while (!timer.is_timeout() && !queue.empty()) {
-
-        if (scout_count > edges_to_check / alpha) {
-            int64_t awake_count, old_awake_count;
-            do_bfs_QueueToBitmap(transaction, max_vertex_id, queue, front);
-            awake_count = queue.size();
-            queue.slide_window();
-            do {
-                old_awake_count = awake_count;
-                awake_count = do_bfs_BUStep(transaction, max_vertex_id, distances, distance, front, curr);
-                front.swap(curr);
-                distance++;
-            } while ((awake_count >= old_awake_count) || (awake_count > (int64_t) num_vertices / beta));
-            do_bfs_BitmapToQueue(transaction, max_vertex_id, front, queue);
-            scout_count = 1;
-        } else {
-            edges_to_check -= scout_count;
-            scout_count = do_bfs_TDStep(transaction, max_vertex_id, distances, distance, queue);
-            queue.slide_window();
-            distance++;
+
+    template<typename F>
+    void for_each_out_edge(uint64_t v, F&& f) const {
+        if(!has_vertex(v)) return;
+        auto iterator = m_transaction->get_edges(v, /* label */ 0);
+        while(iterator.valid()){
+            string_view payload = iterator.edge_data();
+            double weight = *reinterpret_cast<const double*>(payload.data());
+            if(!f(static_cast<uint64_t>(iterator.dst_id()), weight)) break;
+            iterator.next();
         }
     }
+};
 
-    return ptr_distances;
-}
+/*****************************************************************************
+ *                                                                           *
+ *  BFS                                                                      *
+ *                                                                           *
+ *****************************************************************************/
+//#define DEBUG_BFS
+#if defined(DEBUG_BFS)
+#define COUT_DEBUG_BFS(msg) COUT_DEBUG(msg)
+#else
+#define COUT_DEBUG_BFS(msg)
+#endif
 
 void LiveGraphDriver::bfs(uint64_t external_source_id, const char* dump2file) {
     if(m_is_directed) { ERROR("This implementation of the BFS does not support directed graphs"); }
@@ -666,13 +561,12 @@ void LiveGraphDriver::bfs(uint64_t external_source_id, const char* dump2file) {
     Timer timer; timer.start();
     lg::Transaction transaction = m_read_only ? LiveGraph->begin_read_only_transaction() : LiveGraph->begin_transaction();
     uint64_t max_vertex_id = LiveGraph->get_max_vertex_id();
-    uint64_t num_vertices = m_num_vertices;
-    uint64_t num_edges = m_num_edges;
     uint64_t root = ext2int(external_source_id);
     COUT_DEBUG_BFS("root: " << root << " [external vertex: " << external_source_id << "]");
 
     // Run the BFS algorithm
-    unique_ptr<int64_t[]> ptr_result = do_bfs(transaction, num_vertices, num_edges, max_vertex_id, root, timeout);
+    View view { &transaction, max_vertex_id, m_is_directed };
+    unique_ptr<int64_t[]> ptr_result = kernels::bfs(view, root, timeout);
     if(timeout.is_timeout()){
         transaction.abort(); // not sure if strictly necessary
         RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);
@@ -694,124 +588,6 @@ void LiveGraphDriver::bfs(uint64_t external_source_id, const char* dump2file) {
  *  PageRank                                                                 *
  *                                                                           *
  *****************************************************************************/
-//#define DEBUG_PAGERANK
-#if defined(DEBUG_PAGERANK)
-#define COUT_DEBUG_PAGERANK(msg) COUT_DEBUG(msg)
-#else
-#define COUT_DEBUG_PAGERANK(msg)
-#endif
-
-// Implementation based on the reference PageRank for the GAP Benchmark Suite
-// https://github.com/sbeamer/gapbs
-// The reference implementation has been written by Scott Beamer
-//
-// Copyright (c) 2015, The Regents of the University of California (Regents)
-// All Rights Reserved.
-//
-// Redistribution and use in source and binary forms, with or without
-// modification, are permitted provided that the following conditions are met:
-// 1. Redistributions of source code must retain the above copyright
-//    notice, this list of conditions and the following disclaimer.
-// 2. Redistributions in binary form must reproduce the above copyright
-//    notice, this list of conditions and the following disclaimer in the
-//    documentation and/or other materials provided with the distribution.
-// 3. Neither the name of the Regents nor the
-//    names of its contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
-// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
-// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-// DISCLAIMED. IN NO EVENT SHALL REGENTS BE LIABLE FOR ANY
-// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
-// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
-// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
-// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-
-/*
-GAP Benchmark Suite
-Kernel: PageRank (PR)
-Author: Scott Beamer
-
-Will return pagerank scores for all vertices once total change < epsilon
-
-This PR implementation uses the traditional iterative approach. This is done
-to ease comparisons to other implementations (often use same algorithm), but
-it is not necessarily the fastest way to implement it. It does perform the
-updates in the pull direction to remove the need for atomics.
-*/
-
-static
-unique_ptr<double[]> do_pagerank(lg::Transaction& transaction, uint64_t num_vertices, uint64_t max_vertex_id, uint64_t num_iterations, double damping_factor, utility::TimeoutService& timer) {
-    const double init_score = 1.0 / num_vertices;
-    const double base_score = (1.0 - damping_factor) / num_vertices;
-
-    unique_ptr<double[]> ptr_scores{ new double[max_vertex_id]() }; // avoid memory leaks
-    unique_ptr<uint64_t[]> ptr_degrees{ new uint64_t[max_vertex_id]() }; // avoid memory leaks
-    double* scores = ptr_scores.get();
-    uint64_t* __restrict degrees = ptr_degrees.get();
-
-
-    #pragma omp parallel for
-    for(uint64_t v = 0; v < max_vertex_id; v++){
-        scores[v] = init_score;
-
-        // compute the outdegree of the vertex
-        if(!transaction.get_vertex(v).empty()){ // check the vertex exists
-            uint64_t degree = 0;
-            auto iterator = transaction.get_edges(v, /* label ? */ 0);
-            while(iterator.valid()){ degree++; iterator.next(); }
-            degrees[v] = degree;
-        } else {
-            degrees[v] = numeric_limits<uint64_t>::max();
-        }
-    }
-
-    gapbs::pvector<double> outgoing_contrib(max_vertex_id, 0.0);
-
-    // pagerank iterations
-    for(uint64_t iteration = 0; iteration < num_iterations && !timer.is_timeout(); iteration++){
-        double dangling_sum = 0.0;
-
-        // for each node, precompute its contribution to all of its outgoing neighbours and, if it's a sink,
-        // add its rank to the `dangling sum' (to be added to all nodes).
-        #pragma omp parallel for reduction(+:dangling_sum)
-        for(uint64_t v = 0; v < max_vertex_id; v++){
-            uint64_t out_degree = degrees[v];
-            if(out_degree == numeric_limits<uint64_t>::max()){
-                continue; // the vertex does not exist
-            } else if (out_degree == 0){ // this is a sink
-                dangling_sum += scores[v];
-            } else {
-                outgoing_contrib[v] = scores[v] / out_degree;
-            }
-        }
-
-        dangling_sum /= num_vertices;
-
-        // compute the new score for each node in the graph
-        #pragma omp parallel for schedule(dynamic, 64)
-        for(uint64_t v = 0; v < max_vertex_id; v++){
-            if(degrees[v] == numeric_limits<uint64_t>::max()){ continue; } // the vertex does not exist
-
-            double incoming_total = 0;
-            auto iterator = transaction.get_edges(v, /* label ? */ 0); // fixme: incoming edges for directed graphs
-            while(iterator.valid()){
-                uint64_t u = iterator.dst_id();
-                incoming_total += outgoing_contrib[u];
-                iterator.next();
-            }
-
-            // update the score
-            scores[v] = base_score + damping_factor * (incoming_total + dangling_sum);
-        }
-    }
-
-    return ptr_scores;
-}
-
 void LiveGraphDriver::pagerank(uint64_t num_iterations, double damping_factor, const char* dump2file) {
     if(m_is_directed) { ERROR("This implementation of PageRank does not support directed graphs"); }
 
@@ -819,11 +595,11 @@ void LiveGraphDriver::pagerank(uint64_t num_iterations, double damping_factor, c
     utility::TimeoutService timeout { m_timeout };
     Timer timer; timer.start();
     lg::Transaction transaction = m_read_only? LiveGraph->begin_read_only_transaction() : LiveGraph->begin_transaction();
-    uint64_t num_vertices = m_num_vertices;
     uint64_t max_vertex_id = LiveGraph->get_max_vertex_id();
 
     // Run the PageRank algorithm
-    unique_ptr<double[]> ptr_result = do_pagerank(transaction, num_vertices, max_vertex_id, num_iterations, damping_factor, timeout);
+    View view { &transaction, max_vertex_id, m_is_directed };
+    unique_ptr<double[]> ptr_result = kernels::pagerank(view, num_iterations, damping_factor, timeout);
     if(timeout.is_timeout()){ transaction.abort(); RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);  }
 
     // Retrieve the external node ids
@@ -1022,28 +798,6 @@ void LiveGraphDriver::wcc(const char* dump2file) {
     do_weight_scan(transaction,max_vertex_id);
 }
 
-static uint64_t total_edge_count(lg::Transaction& transaction, uint64_t max_vertex_id){
-    uint64_t total_edge_num = 0;
-#pragma omp parallel
-        {
-        uint64_t local_degree = 0;
-#pragma omp for
-        for(uint64_t v=0; v<max_vertex_id;v++){
-            auto iterator = transaction.get_edges(v, /* label ? */ 0); // fixme: incoming edges for directed graphs
-            while(iterator.valid()){
-                uint64_t u = iterator.dst_id();
-                local_degree++;
-                iterator.next();
-            }
-        }
-#pragma omp critical
-        {
-                total_edge_num += local_degree;
-        }
-    }
-        return total_edge_num/2;
-}
-
 static void do_topology_scan(lg::Transaction& transaction, uint64_t max_vertex_id){
     uint64_t total_edge_num = 0;
     uint64_t total_vid_sum = 0;
@@ -1172,98 +926,6 @@ void LiveGraphDriver::cdlp(uint64_t max_iterations, const char* dump2file) {
  *  LCC                                                                      *
  *                                                                           *
  *****************************************************************************/
-//#define DEBUG_LCC
-#if defined(DEBUG_LCC)
-#define COUT_DEBUG_LCC(msg) COUT_DEBUG(msg)
-#else
-#define COUT_DEBUG_LCC(msg)
-#endif
-
-// loosely based on the impl~ made for GraphOne
-static
-unique_ptr<double[]> do_lcc_undirected(lg::Transaction& transaction, uint64_t max_vertex_id, utility::TimeoutService& timer) {
-    unique_ptr<double[]> ptr_lcc { new double[max_vertex_id] };
-    double* lcc = ptr_lcc.get();
-    unique_ptr<uint32_t[]> ptr_degrees_out { new uint32_t[max_vertex_id] };
-    uint32_t* __restrict degrees_out = ptr_degrees_out.get();
-
-    // precompute the degrees of the vertices
-    #pragma omp parallel for schedule(dynamic, 4096)
-    for(uint64_t v = 0; v < max_vertex_id; v++){
-        bool vertex_exists = !transaction.get_vertex(v).empty();
-        if(!vertex_exists){
-            lcc[v] = numeric_limits<double>::signaling_NaN();
-        } else {
-            { // out degree, restrict the scope
-                uint32_t count = 0;
-                auto iterator = transaction.get_edges(v, 0);
-                while(iterator.valid()){ count ++; iterator.next(); }
-                degrees_out[v] = count;
-            }
-        }
-    }
-
-
-    #pragma omp parallel for schedule(dynamic, 64)
-    for(uint64_t v = 0; v < max_vertex_id; v++){
-        if(degrees_out[v] == numeric_limits<uint32_t>::max()) continue; // the vertex does not exist
-
-        COUT_DEBUG_LCC("> Node " << v);
-        if(timer.is_timeout()) continue; // exhausted the budget of available time
-        lcc[v] = 0.0;
-        uint64_t num_triangles = 0; // number of triangles found so far for the node v
-
-        // Cfr. Spec v.0.9.0 pp. 15: "If the number of neighbors of a vertex is less than two, its coefficient is defined as zero"
-        uint64_t v_degree_out = degrees_out[v];
-        if(v_degree_out < 2) continue;
-
-        // Build the list of neighbours of v
-        unordered_set<uint64_t> neighbours;
-
-        { // Fetch the list of neighbours of v
-            auto iterator1 = transaction.get_edges(v, 0);
-            while(iterator1.valid()){
-                uint64_t u = iterator1.dst_id();
-                neighbours.insert(u);
-                iterator1.next();
-            }
-        }
-
-        // again, visit all neighbours of v
-        // for directed graphs, edges1 contains the intersection of both the incoming and the outgoing edges
-        auto iterator1 = transaction.get_edges(v, /* label */ 0);
-        while(iterator1.valid()){
-            uint64_t u = iterator1.dst_id();
-            COUT_DEBUG_LCC("[" << i << "/" << edges.size() << "] neighbour: " << u);
-            assert(neighbours.count(u) == 1 && "The set `neighbours' should contain all neighbours of v");
-
-            // For the Graphalytics spec v 0.9.0, only consider the outgoing edges for the neighbours u
-            auto iterator2 = transaction.get_edges(u, /* label */ 0);
-            while(iterator2.valid()){
-                uint64_t w = iterator2.dst_id();
-
-                COUT_DEBUG_LCC("---> [" << j << "/" << /* degree */ (u_out_interval.second - u_out_interval.first) << "] neighbour: " << w);
-                // check whether it's also a neighbour of v
-                if(neighbours.count(w) == 1){
-                    COUT_DEBUG_LCC("Triangle found " << v << " - " << u << " - " << w);
-                    num_triangles++;
-                }
-
-                iterator2.next();
-            }
-
-            iterator1.next();
-        }
-
-        // register the final score
-        uint64_t max_num_edges = v_degree_out * (v_degree_out -1);
-        lcc[v] = static_cast<double>(num_triangles) / max_num_edges;
-        COUT_DEBUG_LCC("Score computed: " << (num_triangles) << "/" << max_num_edges << " = " << lcc[v]);
-    }
-
-    return ptr_lcc;
-}
-
 void LiveGraphDriver::lcc(const char* dump2file) {
     if(m_is_directed) { ERROR("Implementation of LCC supports only undirected graphs"); }
 
@@ -1273,7 +935,8 @@ void LiveGraphDriver::lcc(const char* dump2file) {
     uint64_t max_vertex_id = LiveGraph->get_max_vertex_id();
 
     // Run the LCC algorithm
-    unique_ptr<double[]> scores = do_lcc_undirected(transaction, max_vertex_id, timeout);
+    View view { &transaction, max_vertex_id, m_is_directed };
+    unique_ptr<double[]> scores = kernels::lcc(view, timeout);
     if(timeout.is_timeout()){ transaction.abort(); RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);  }
 
     // Translate the vertex IDs
@@ -1291,141 +954,17 @@ void LiveGraphDriver::lcc(const char* dump2file) {
  *  SSSP                                                                     *
  *                                                                           *
  *****************************************************************************/
-// Implementation based on the reference SSSP for the GAP Benchmark Suite
-// https://github.com/sbeamer/gapbs
-// The reference implementation has been written by Scott Beamer
-//
-// Copyright (c) 2015, The Regents of the University of California (Regents)
-// All Rights Reserved.
-//
-// Redistribution and use in source and binary forms, with or without
-// modification, are permitted provided that the following conditions are met:
-// 1. Redistributions of source code must retain the above copyright
-//    notice, this list of conditions and the following disclaimer.
-// 2. Redistributions in binary form must reproduce the above copyright
-//    notice, this list of conditions and the following disclaimer in the
-//    documentation and/or other materials provided with the distribution.
-// 3. Neither the name of the Regents nor the
-//    names of its contributors may be used to endorse or promote products
-//    derived from this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
-// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
-// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-// DISCLAIMED. IN NO EVENT SHALL REGENTS BE LIABLE FOR ANY
-// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
-// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
-// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
-// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-
-using NodeID = uint64_t;
-using WeightT = double;
-static const size_t kMaxBin = numeric_limits<size_t>::max()/2;
-
-static
-gapbs::pvector<WeightT> do_sssp(lg::Transaction& transaction, uint64_t num_edges, uint64_t max_vertex_id, uint64_t source, double delta, utility::TimeoutService& timer) {
-    // Init
-    gapbs::pvector<WeightT> dist(max_vertex_id, numeric_limits<WeightT>::infinity());
-    dist[source] = 0;
-    gapbs::pvector<NodeID> frontier(num_edges);
-    // two element arrays for double buffering curr=iter&1, next=(iter+1)&1
-    size_t shared_indexes[2] = {0, kMaxBin};
-    size_t frontier_tails[2] = {1, 0};
-    frontier[0] = source;
-
-    #pragma omp parallel
-    {
-        vector<vector<NodeID> > local_bins(0);
-        size_t iter = 0;
-
-        while (shared_indexes[iter&1] != kMaxBin) {
-            size_t &curr_bin_index = shared_indexes[iter&1];
-            size_t &next_bin_index = shared_indexes[(iter+1)&1];
-            size_t &curr_frontier_tail = frontier_tails[iter&1];
-            size_t &next_frontier_tail = frontier_tails[(iter+1)&1];
-            #pragma omp for nowait schedule(dynamic, 64)
-            for (size_t i=0; i < curr_frontier_tail; i++) {
-                NodeID u = frontier[i];
-                if (dist[u] >= delta * static_cast<WeightT>(curr_bin_index)) {
-                    auto iterator = transaction.get_edges(u, /* label */ 0);
-                    while(iterator.valid()){
-                        uint64_t v = iterator.dst_id();
-                        string_view payload = iterator.edge_data();
-                        double w = *reinterpret_cast<const double*>(payload.data());
-
-                        WeightT old_dist = dist[v];
-                        WeightT new_dist = dist[u] + w;
-                        if (new_dist < old_dist) {
-                            bool changed_dist = true;
-                            while (!gapbs::compare_and_swap(dist[v], old_dist, new_dist)) {
-                                old_dist = dist[v];
-                                if (old_dist <= new_dist) {
-                                    changed_dist = false;
-                                    break;
-                                }
-                            }
-                            if (changed_dist) {
-                                size_t dest_bin = new_dist/delta;
-                                if (dest_bin >= local_bins.size()) {
-                                    local_bins.resize(dest_bin+1);
-                                }
-                                local_bins[dest_bin].push_back(v);
-                            }
-                        }
-
-                        iterator.next();
-                    }
-                }
-            }
-
-            for (size_t i=curr_bin_index; i < local_bins.size(); i++) {
-                if (!local_bins[i].empty()) {
-                    #pragma omp critical
-                    next_bin_index = min(next_bin_index, i);
-                    break;
-                }
-            }
-
-            #pragma omp barrier
-            #pragma omp single nowait
-            {
-                curr_bin_index = kMaxBin;
-                curr_frontier_tail = 0;
-            }
-
-            if (next_bin_index < local_bins.size()) {
-                size_t copy_start = gapbs::fetch_and_add(next_frontier_tail, local_bins[next_bin_index].size());
-                copy(local_bins[next_bin_index].begin(), local_bins[next_bin_index].end(), frontier.data() + copy_start);
-                local_bins[next_bin_index].resize(0);
-            }
-
-            iter++;
-            #pragma omp barrier
-        }
-
-#if defined(DEBUG)
-        #pragma omp single
-        COUT_DEBUG("took " << iter << " iterations");
-#endif
-    }
-
-    return dist;
-}
-
 void LiveGraphDriver::sssp(uint64_t source_vertex_id, const char* dump2file) {
     utility::TimeoutService timeout { m_timeout };
     Timer timer; timer.start();
     lg::Transaction transaction = m_read_only ? LiveGraph->begin_read_only_transaction() : LiveGraph->begin_transaction();
-     uint64_t max_vertex_id = LiveGraph->get_max_vertex_id();
-    //uint64_t num_edges = m_num_edges;
-    uint64_t num_edges = total_edge_count(transaction,max_vertex_id);
+    uint64_t max_vertex_id = LiveGraph->get_max_vertex_id();
     uint64_t root = ext2int(source_vertex_id);
 
     // Run the SSSP algorithm
+    View view { &transaction, max_vertex_id, m_is_directed }; // the number of edges is taken from the snapshot of the transaction
     double delta = 2.0; // same value used in the GAPBS, at least for most graphs
-    auto distances = do_sssp(transaction, num_edges, max_vertex_id, root, delta, timeout);
+    auto distances = kernels::sssp(view, root, delta, timeout);
     if(timeout.is_timeout()){ transaction.abort(); RAISE_EXCEPTION(TimeoutError, "Timeout occurred after " << timer);  }
 
     // Translate the vertex IDs
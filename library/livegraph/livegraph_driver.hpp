@@ -19,6 +19,7 @@
 
 #include <atomic>
 #include <chrono>
+#include "library/common/vertex_dictionary.hpp"
 #include "library/interface.hpp"
 
 namespace gfe::library {
@@ -32,7 +33,7 @@ class LiveGraphDriver : public virtual UpdateInterface, public virtual Graphalyt
 
 protected:
     void* m_pImpl; // pointer to the LiveGraph handle
-    void* m_pHashMap; // pointer to the TBB HashMap to translate the vertex identifiers into the dense IDs for livegraph
+    VertexDictionary m_vertex_dictionary; // translate the vertex identifiers into the dense IDs for livegraph
     const bool m_is_directed; // whether the underlying graph is directed or undirected
     const bool m_read_only; // whether to used read only transactions for graphalytics
     std::atomic<uint64_t> m_num_vertices {0}; // keep track of the total number of vertices
@@ -46,13 +47,34 @@ protected:
     // Retrieve the internal vertex ID for the given internal vertex ID. If the vertex does not exist, it returns uint64_t::max()
     uint64_t int2ext(void* transaction, uint64_t internal_vertex_id) const;
 
+    // Create a new vertex in LiveGraph, in its own transaction, and return its internal vertex ID
+    uint64_t create_vertex(uint64_t external_vertex_id);
+
+    // Retrieve the internal vertex ID of the given external vertex, creating it if it does not exist yet
+    // @param out_inserted if not null, set to true if the vertex has been created by this invocation
+    uint64_t vertex_get_or_create(uint64_t external_vertex_id, bool* out_inserted = nullptr);
+
     // Helper for Graphalytics: translate the logical IDs into external IDs
     template <typename T>
     std::vector<std::pair<uint64_t, T>> translate(void* /* transaction object */ lgtxn, const T* __restrict data, uint64_t data_sz);
 
+    // Adapter to run the generic kernels of library/common/kernels.hpp over a LiveGraph transaction
+    class View;
+
     // Helper, save the content of the vector to the given output file
     template <typename T, bool negative_scores = true>
     void save_results(const std::vector<std::pair<uint64_t, T>>& result, const char* dump2file);
+
+    // Helper for #update_batch: create the vertices referred by the insertions and retrieve the internal IDs of the
+    // source and destination of each update, or uint64_t::max() if a vertex does not exist
+    void update_batch_vertices(const SingleUpdate* updates, uint64_t num_updates, uint64_t* out_internal_ids);
+
+    // Helper for #update_batch: execute the group of updates in a single transaction. Return false if the transaction
+    // has been rolled back and it needs to be restarted
+    bool update_batch_tx(const SingleUpdate* updates, const uint64_t* internal_ids, uint64_t num_updates, bool all_or_nothing, bool* out_applied, uint64_t* out_num_applied);
+
+    // Helper for #update_batch: execute the group of updates, splitting it in smaller transactions on conflicts
+    uint64_t update_batch_best_effort(const SingleUpdate* updates, const uint64_t* internal_ids, uint64_t num_updates, bool* out_applied);
 public:
     /**
      * Create an instance of LiveGraph
@@ -129,6 +151,17 @@ public:
      */
     virtual bool remove_edge(gfe::graph::Edge e);
 
+    /**
+     * Perform a group of updates. With the atomicity PER_BATCH or BEST_EFFORT, the updates are committed together
+     * in a single LiveGraph transaction. In case of conflicts, BEST_EFFORT retries the group in smaller transactions.
+     */
+    virtual uint64_t update_batch(const SingleUpdate* updates, uint64_t num_updates, BatchAtomicity atomicity, bool* out_applied = nullptr);
+
+    /**
+     * LiveGraph supports atomic groups of updates
+     */
+    virtual bool has_atomic_batches() const;
+
     /**
      * Dump the content of the graph to given stream.
      */
@@ -139,7 +172,7 @@ public:
      * For Debugging & Testing only
      */
     void* livegraph(); // lg::Graph*
-    void* vertex_dictionary(); // tbb::concurrent_hash_map<uint64_t, lg::vertex_t>
+    void* vertex_dictionary(); // gfe::library::VertexDictionary
 
     /**
      * Perform a BFS from source_vertex_id to all the other vertices in the graph.
@@ -25,6 +25,7 @@
 #include <shared_mutex> // shared_lock
 
 #include "common/time.hpp"
+#include "utility/result_writer.hpp"
 
 using namespace common;
 using namespace std;
@@ -669,22 +670,7 @@ void LLAMAClass::save_results(const vector<pair<uint64_t, T>>& result, const cha
     assert(dump2file != nullptr);
     COUT_DEBUG("save the results to: " << dump2file);
 
-    fstream handle(dump2file, ios_base::out);
-    if (!handle.good()) ERROR("Cannot save the result to `" << dump2file << "'");
-
-    for (const auto &p : result) {
-        handle << p.first << " ";
-
-        if(!negative_scores && p.second < 0){
-            handle << numeric_limits<T>::max();
-        } else {
-            handle << p.second;
-        }
-
-        handle << "\n";
-    }
-
-    handle.close();
+    utility::save_results<T, negative_scores>(result, dump2file);
 }
 
 // Explicitly instantiate the templates
@@ -49,19 +49,18 @@ namespace gfe::library {
      * Returns true if the given vertex is present, false otherwise
      */
     bool MicroBenchmarksDriver::has_vertex(uint64_t vertex_id) const {
-      vertex_mapping::const_accessor a;
-      if (external_2_internal.find(a, vertex_id)) {
-        return ds->has_vertex(a->second);
+      uint64_t internal_id = 0;
+      if (external_2_internal.find(vertex_id, &internal_id)) {
+        return ds->has_vertex(internal_id);
       } else {
         return false;
       }
     }
 
     bool MicroBenchmarksDriver::has_edge(uint64_t source, uint64_t destination) const {
-      vertex_mapping::const_accessor a;
-      vertex_mapping::const_accessor b;
-      if (external_2_internal.find(a, source) && external_2_internal.find(b, destination)) {
-        edge_t internal_edge {a->second, b->second};
+      uint64_t a = 0, b = 0;
+      if (external_2_internal.find(source, &a) && external_2_internal.find(destination, &b)) {
+        edge_t internal_edge {a, b};
         return ds->has_edge(internal_edge);
       } else {
         return false;
@@ -72,10 +71,9 @@ namespace gfe::library {
      * Returns the weight of the given edge is the edge is present, or NaN otherwise
      */
     double MicroBenchmarksDriver::get_weight(uint64_t source, uint64_t destination) const {
-      vertex_mapping::const_accessor a;
-      vertex_mapping::const_accessor b;
-      if (external_2_internal.find(a, source) && external_2_internal.find(b, destination)) {
-        edge_t internal_edge {a->second, b->second};
+      uint64_t a = 0, b = 0;
+      if (external_2_internal.find(source, &a) && external_2_internal.find(destination, &b)) {
+        edge_t internal_edge {a, b};
         return ds->get_weight(internal_edge);
       } else {
         return numeric_limits<double>::quiet_NaN();
@@ -101,24 +99,22 @@ namespace gfe::library {
      * @return true if the vertex has been inserted, false otherwise (that is, the vertex already exists)
      */
     bool MicroBenchmarksDriver::add_vertex(uint64_t vertex_id) {
-      scoped_lock<mutex> l(vertex_add_mutex);
-      vertex_mapping::accessor a;
-      if (!external_2_internal.insert(a, vertex_id)) { // This does not seem to block until a is released. It seems to continue with the information that another thread is !currently! inserting this key.
-        return false;
-      } else {
+      bool inserted = false;
+      // only one thread creates the vertex, the others wait for its internal id
+      external_2_internal.get_or_create(vertex_id, [&]() {
         auto internal_id = next_vertex_id.fetch_add(1);
         if (ds->insert_vertex(internal_id)) {
-          a->second = internal_id;
           grow_vector_if_smaller(internal_2_external, internal_id);
 
           assert(internal_2_external[internal_id] == numeric_limits<uint64_t>::max());
 
           internal_2_external[internal_id] = vertex_id;
-          return true;
+          return internal_id;
         } else {
           throw exception();
         }
-      }
+      }, &inserted);
+      return inserted;
     }
 
     /**
@@ -135,14 +131,13 @@ namespace gfe::library {
      * Adds a given edge to the graph if both vertices exists already
      */
     bool MicroBenchmarksDriver::add_edge(gfe::graph::WeightedEdge e) {
-      vertex_mapping::const_accessor a;
-      vertex_mapping::const_accessor b;
+      uint64_t a = 0, b = 0;
 
-      if (!(external_2_internal.find(a, e.source()) && external_2_internal.find(b, e.destination()))) {
+      if (!(external_2_internal.find(e.source(), &a) && external_2_internal.find(e.destination(), &b))) {
         return false;
       } else {
-        edge_t internal_edge{a->second, b->second};
-        edge_t opposite{b->second, a->second};
+        edge_t internal_edge{a, b};
+        edge_t opposite{b, a};
         auto ret = ds->insert_edge(internal_edge, e.weight());
         ret &= ds->insert_edge(opposite, e.weight());
         return ret;
@@ -150,19 +145,12 @@ namespace gfe::library {
     }
 
     bool MicroBenchmarksDriver::add_edge_v2(gfe::graph::WeightedEdge e) {
-      {
-        vertex_mapping::const_accessor a;
-        vertex_mapping::const_accessor b;
-
-        if (!external_2_internal.find(a, e.source())) {
-          a.release();
-          add_vertex(e.source());
-        }
+      if (!external_2_internal.contains(e.source())) {
+        add_vertex(e.source());
+      }
 
-        if (!external_2_internal.find(b, e.destination())) {
-          b.release();
-          add_vertex(e.destination());
-        }
+      if (!external_2_internal.contains(e.destination())) {
+        add_vertex(e.destination());
       }
 
       return add_edge(e);
@@ -176,32 +164,17 @@ namespace gfe::library {
       assert(dump2file != nullptr);
 //      COUT_DEBUG("save the results to: " << dump2file)
 
-      fstream handle(dump2file, ios_base::out);
-      if (!handle.good()) ERROR("Cannot save the result to `" << dump2file << "'");
-
-      for (const auto &p : result) {
-        handle << p.first << " ";
-
-        // if  the vertex was not reached, the algorithm sets its distance to < 0
-        if (p.second == numeric_limits<uint>::max()) {
-          handle << numeric_limits<int64_t>::max();
-        } else {
-          handle << (int64_t) p.second;
-        }
-        handle << "\n";
-      }
-      handle.close();
+      utility::save_results_with<int64_t, /* negative scores */ false>(result.size(), [&result](uint64_t i){ // unreached vertices have the distance uint::max
+        return make_pair(result[i].first, result[i].second == numeric_limits<uint>::max() ? (int64_t) -1 : (int64_t) result[i].second);
+      }, dump2file);
     }
 
     void MicroBenchmarksDriver::bfs(uint64_t source_vertex_id, const char *dump2file) {
-      vertex_mapping::const_accessor a;
-      if (!external_2_internal.find(a, source_vertex_id)) {
+      uint64_t internal_source = 0;
+      if (!external_2_internal.find(source_vertex_id, &internal_source)) {
         throw exception();
       }
 
-      auto internal_source = a->second;
-      a.release();
-
       auto distances = Gapbs::bfs(*ds, internal_source);
 
       size_t N = distances.size();
@@ -262,14 +235,11 @@ namespace gfe::library {
     }
 
     void MicroBenchmarksDriver::sssp(uint64_t source_vertex_id, const char *dump2file) {
-      vertex_mapping::const_accessor a;
-      if (!external_2_internal.find(a, source_vertex_id)) {
+      uint64_t internal_source = 0;
+      if (!external_2_internal.find(source_vertex_id, &internal_source)) {
         throw exception();
       }
 
-      auto internal_source = a->second;
-      a.release();
-
       auto distances = Gapbs::sssp(*ds, internal_source, 2.0);
 
       auto external_ids = translate<double>(distances);
@@ -9,10 +9,11 @@
 #include <cassert>
 #include <fstream>
 #include <unordered_set>
-#include <tbb/concurrent_hash_map.h>
 #include <tbb/concurrent_vector.h>
 
+#include "library/common/vertex_dictionary.hpp"
 #include "library/interface.hpp"
+#include "utility/result_writer.hpp"
 
 #include <TopologyInterface.h>
 
@@ -20,17 +21,14 @@ namespace gfe::library {
     using namespace microbenchmarks;
     using namespace tbb;
 
-    typedef concurrent_hash_map<uint64_t, uint64_t> vertex_mapping;
-
     class MicroBenchmarksDriver : public virtual UpdateInterface, public virtual GraphalyticsInterface {
         MicroBenchmarksDriver(const MicroBenchmarksDriver &) = delete;
         MicroBenchmarksDriver &operator=(const MicroBenchmarksDriver &) = delete;
 
         std::atomic<uint64_t> next_vertex_id = 0ul;
-        vertex_mapping external_2_internal;
+        VertexDictionary external_2_internal;
         mutex growing_vector_mutex;
         concurrent_vector<uint64_t> internal_2_external = concurrent_vector<uint64_t>(1024, numeric_limits<uint64_t>::max());
-        mutex vertex_add_mutex;
 
         unordered_set<uint64_t> registered_vertices;
 
@@ -71,15 +69,7 @@ namespace gfe::library {
           assert(dump2file != nullptr);
 //          COUT_DEBUG("save the results to: " << dump2file)
 
-          fstream handle(dump2file, ios_base::out);
-          if (!handle.good()) ERROR("Cannot save the result to `" << dump2file << "'");
-
-          for (const auto &p : result) {
-            handle << p.first << " ";
-            handle << p.second;
-            handle << "\n";
-          }
-          handle.close();
+          utility::save_results(result, dump2file);
         }
 
     public:
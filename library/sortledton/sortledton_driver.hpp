@@ -11,6 +11,7 @@
 #include "third-party/libcuckoo/cuckoohash_map.hh"
 
 #include "library/interface.hpp"
+#include "utility/result_writer.hpp"
 
 #include "data-structure/TransactionManager.h"
 #include "data-structure/VersioningBlockedSkipListAdjacencyList.h"
@@ -61,15 +62,7 @@ namespace gfe::library {
           assert(dump2file != nullptr);
           COUT_DEBUG("save the results to: " << dump2file)
 
-          fstream handle(dump2file, ios_base::out);
-          if (!handle.good()) ERROR("Cannot save the result to `" << dump2file << "'");
-
-          for (const auto &p : result) {
-            handle << p.first << " ";
-            handle << p.second;
-            handle << "\n";
-          }
-          handle.close();
+          utility::save_results(result, dump2file);
         }
 
         void run_gc();
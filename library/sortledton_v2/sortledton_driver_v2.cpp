@@ -283,21 +283,9 @@ namespace gfe::library {
       assert(dump2file != nullptr);
       COUT_DEBUG("save the results to: " << dump2file)
 
-      fstream handle(dump2file, ios_base::out);
-      if (!handle.good()) ERROR("Cannot save the result to `" << dump2file << "'");
-
-      for (const auto &p : result) {
-        handle << p.first << " ";
-
-        // if  the vertex was not reached, the algorithm sets its distance to < 0
-        if (p.second == numeric_limits<uint>::max()) {
-          handle << numeric_limits<int64_t>::max();
-        } else {
-          handle << (int64_t) p.second;
-        }
-        handle << "\n";
-      }
-      handle.close();
+      utility::save_results_with<int64_t, /* negative scores */ false>(result.size(), [&result](uint64_t i){ // unreached vertices have the distance uint::max
+        return make_pair(result[i].first, result[i].second == numeric_limits<uint>::max() ? (int64_t) -1 : (int64_t) result[i].second);
+      }, dump2file);
     }
 
     static vector <pair<uint64_t, uint>> translate_bfs(sortledton::storage::GraphStorageForwarder &tx, pvector <int64_t> &values) {
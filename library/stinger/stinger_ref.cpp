@@ -25,6 +25,7 @@
 #include "common/system.hpp"
 #include "common/timer.hpp"
 #include "third-party/gapbs/gapbs.hpp"
+#include "utility/result_writer.hpp"
 #include "utility/timeout_service.hpp"
 #include "stinger_core/stinger.h"
 #include "stinger_error.hpp"
@@ -245,22 +246,7 @@ static void save_bfs(vector<pair<uint64_t, int64_t>>& result, const char* dump2f
     assert(dump2file != nullptr);
     COUT_DEBUG("save the results to: " << dump2file)
 
-    fstream handle(dump2file, ios_base::out);
-    if(!handle.good()) ERROR("Cannot save the result to `" << dump2file << "'");
-
-    for(auto p : result){
-        handle << p.first << " ";
-
-        // if  the vertex was not reached, the algorithm sets its distance to < 0
-        if(p.second < 0){
-            handle << numeric_limits<int64_t>::max();
-        } else {
-            handle << p.second;
-        }
-        handle << "\n";
-    }
-
-    handle.close();
+    utility::save_results<int64_t, /* negative scores */ false>(result, dump2file);
 }
 
 void StingerRef::bfs(uint64_t source_external_id, const char* dump2file){
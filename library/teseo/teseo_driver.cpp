@@ -27,6 +27,7 @@
 #include "common/timer.hpp"
 #include "third-party/gapbs/gapbs.hpp"
 #include "third-party/libcuckoo/cuckoohash_map.hh"
+#include "utility/result_writer.hpp"
 #include "utility/timeout_service.hpp"
 #include "teseo_openmp.hpp"
 #include "teseo/context/global_context.hpp"
@@ -323,21 +324,7 @@ Libin: may need to search exist, if so, remove and insert, otherwise direct inse
 
         COUT_DEBUG("save the results to: " << dump2file);
 
-        fstream handle(dump2file, ios_base::out);
-        if (!handle.good()) ERROR("Cannot save the result to `" << dump2file << "'");
-
-        for (const auto &p: result) {
-            handle << p.first << " ";
-
-            if (!negative_scores && p.second < 0) {
-                handle << numeric_limits<T>::max();
-            } else {
-                handle << p.second;
-            }
-
-            handle << "\n";
-        }
-        handle.close();
+        utility::save_results<T, negative_scores>(result, dump2file);
     }
 
 /*****************************************************************************
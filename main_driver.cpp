@@ -21,15 +21,19 @@
 #include "common/system.hpp"
 #include "common/timer.hpp"
 #include "experiment/aging2_experiment.hpp"
+#include "experiment/details/query_scheduler.hpp"
 #include "experiment/mixed_workload.hpp"
 #include "experiment/mixed_workload_result.hpp"
 #include "experiment/insert_only.hpp"
 #include "experiment/graphalytics.hpp"
 #include "experiment/validate.hpp"
 #include "graph/edge_stream.hpp"
+#include "graph/vertex_reordering.hpp"
+#include "library/baseline/csr.hpp"
 #include "library/interface.hpp"
 #include "third-party/cxxopts/cxxopts.hpp"
 #include "utility/memory_usage.hpp"
+#include "utility/result_writer.hpp"
 
 #include "configuration.hpp"
 #if defined(HAVE_OPENMP)
@@ -43,6 +47,35 @@ using namespace gfe;
 using namespace gfe::experiment;
 using namespace std;
 
+/**
+ * Load the graph into a library that does not reorder the vertices by itself. The vertices are inserted first, in
+ * the new order, so that the libraries assigning their internal vertex IDs in order of insertion store them in the
+ * same order, then the edges.
+ * @return the time spent to compute the new order, in microseconds
+ */
+static uint64_t load_with_vertex_reordering(library::UpdateInterface* impl, const string& path_graph, graph::VertexReordering reordering){
+    graph::WeightedEdgeStream stream { path_graph };
+
+    LOG("[driver] Reordering the vertices, algorithm: " << graph::vertex_reordering_to_string(reordering) << " ...");
+    Timer timer; timer.start();
+    vector<uint64_t> vertices = graph::compute_vertex_order(reordering, stream);
+    timer.stop();
+    LOG("[driver] Vertices reordered in " << timer);
+
+    for(uint64_t vertex_id : vertices){
+        bool inserted = impl->add_vertex(vertex_id);
+        if(!inserted){ ERROR("[driver] Cannot insert the vertex " << vertex_id); }
+    }
+    for(uint64_t i = 0, end = stream.num_edges(); i < end; i++){
+        auto edge = stream.get(i);
+        bool inserted = impl->add_edge(edge);
+        if(!inserted){ ERROR("[driver] Cannot insert the edge " << edge); }
+    }
+    impl->build();
+
+    return timer.microseconds();
+}
+
 static void run_standalone(int argc, char* argv[]){
     configuration().initialise(argc, argv);
     if(configuration().get_aging_memfp() && !configuration().get_aging_memfp_physical()){
@@ -79,6 +112,18 @@ static void run_standalone(int argc, char* argv[]){
 
     LOG("[driver] The library is set for a directed graph: " << (configuration().is_graph_directed() ? "yes" : "no"));
 
+    // vertex reordering
+    auto reordering = graph::parse_vertex_reordering(configuration().get_vertex_reordering());
+    auto impl_csr = dynamic_pointer_cast<library::CSR>(impl);
+    auto impl_reorder = dynamic_pointer_cast<library::UpdateInterface>(impl); // the other libraries, through their updates
+    uint64_t reorder_time = 0; // microseconds
+    if(reordering != graph::VertexReordering::NONE){
+        if(!configuration().is_load()){ ERROR("The vertex reordering is only supported together with the option --load"); }
+        if(impl_csr.get() == nullptr && impl_reorder.get() == nullptr){ ERROR("The library `" << configuration().get_library_name() << "' does not support the vertex reordering"); }
+        LOG("[driver] Vertex reordering: " << graph::vertex_reordering_to_string(reordering));
+        if(impl_csr.get() != nullptr){ impl_csr->set_vertex_reordering(reordering); }
+    }
+
     uint64_t random_vertex = numeric_limits<uint64_t>::max();
     int64_t num_validation_errors = -1; // -1 => no validation performed
     if(configuration().is_load()){
@@ -89,7 +134,11 @@ static void run_standalone(int argc, char* argv[]){
 
         LOG("[driver] Loading the graph: " << path_graph);
         common::Timer timer; timer.start();
-        impl_load->load(path_graph);
+        if(reordering == graph::VertexReordering::NONE || impl_csr.get() != nullptr){
+            impl_load->load(path_graph);
+        } else {
+            reorder_time = load_with_vertex_reordering(impl_reorder.get(), path_graph, reordering);
+        }
         timer.stop();
         LOG("[driver] Load performed in " << timer);
 
@@ -121,6 +170,7 @@ static void run_standalone(int argc, char* argv[]){
             InsertOnly experiment { impl_upd, stream, configuration().num_threads(THREADS_WRITE) };
             experiment.set_build_frequency(chrono::milliseconds{ configuration().get_build_frequency() });
             experiment.set_scheduler_granularity(1ull < 20);
+            experiment.set_update_batch(configuration().get_update_batch_size(), library::parse_batch_atomicity(configuration().get_update_batch_atomicity()));
             experiment.execute();
             if(configuration().has_database()) experiment.save();
 
@@ -132,7 +182,15 @@ static void run_standalone(int argc, char* argv[]){
               LOG("[driver] Number of write threads: " << configuration().num_threads(THREADS_WRITE));
               LOG("[driver] Number of read threads: " << configuration().num_threads(THREADS_READ));
               LOG("[driver] Aging2, path to the log of updates: " << configuration().get_update_log());
-              impl_upd->configure_distinct_reader_and_writer_threads(configuration().num_threads(THREADS_READ),configuration().num_threads(THREADS_WRITE));
+              // Pools of readers for the short queries
+              shared_ptr<experiment::details::QueryScheduler> short_queries;
+              if(!configuration().get_mixed_queries().empty()){
+                if(impl_ga.get() == nullptr){ ERROR("The library `" << configuration().get_library_name() << "' does not support the short queries"); }
+                short_queries = make_shared<experiment::details::QueryScheduler>(impl_ga, experiment::details::QueryScheduler::parse(configuration().get_mixed_queries()));
+                LOG("[driver] Short queries: " << configuration().get_mixed_queries() << ", number of reader threads: " << short_queries->num_threads());
+              }
+              uint64_t num_short_query_threads = short_queries ? short_queries->num_threads() : 0;
+              impl_upd->configure_distinct_reader_and_writer_threads(configuration().num_threads(THREADS_READ) + num_short_query_threads,configuration().num_threads(THREADS_WRITE));
               // Configure aging experiment
               Aging2Experiment agingExperiment;
               agingExperiment.set_library(impl_upd);
@@ -144,12 +202,16 @@ static void run_standalone(int argc, char* argv[]){
               agingExperiment.set_build_frequency(chrono::milliseconds{configuration().get_build_frequency()});
               agingExperiment.set_max_weight(configuration().max_weight());
               agingExperiment.set_measure_latency(configuration().measure_latency());
+              agingExperiment.set_timeline(chrono::milliseconds{configuration().get_timeline_interval()});
               agingExperiment.set_num_reports_per_ops(configuration().get_num_recordings_per_ops());
               agingExperiment.set_timeout(chrono::seconds{configuration().get_timeout_aging2()});
               agingExperiment.set_measure_memfp(configuration().measure_memfp());
               agingExperiment.set_memfp_physical(configuration().get_aging_memfp_physical());
               agingExperiment.set_memfp_threshold(configuration().get_aging_memfp_threshold());
               agingExperiment.set_cooloff(chrono::seconds{configuration().get_aging_cooloff_seconds()});
+              agingExperiment.set_num_decoders(configuration().get_aging_num_decoders());
+              agingExperiment.set_stream_buffer(configuration().get_aging_stream_buffer());
+              agingExperiment.set_update_batch(configuration().get_update_batch_size(), library::parse_batch_atomicity(configuration().get_update_batch_atomicity()));
               
               // Configure analytics experiment
               GraphalyticsAlgorithms properties { path_graph };
@@ -163,6 +225,7 @@ static void run_standalone(int argc, char* argv[]){
               GraphalyticsSequential exp_seq { impl_ga, configuration().num_repetitions(), properties };
 
               MixedWorkload experiment(agingExperiment, exp_seq, configuration().num_threads(ThreadsType::THREADS_READ));
+              experiment.set_short_queries(short_queries);
               auto result = experiment.execute();
               experiment.report_graphalytics();
               cout << "Saving result" << endl;
@@ -184,12 +247,16 @@ static void run_standalone(int argc, char* argv[]){
               experiment.set_build_frequency(chrono::milliseconds{configuration().get_build_frequency()});
               experiment.set_max_weight(configuration().max_weight());
               experiment.set_measure_latency(configuration().measure_latency());
+              experiment.set_timeline(chrono::milliseconds{configuration().get_timeline_interval()});
               experiment.set_num_reports_per_ops(configuration().get_num_recordings_per_ops());
               experiment.set_timeout(chrono::seconds{configuration().get_timeout_aging2()});
               experiment.set_measure_memfp(configuration().measure_memfp());
               experiment.set_memfp_physical(configuration().get_aging_memfp_physical());
               experiment.set_memfp_threshold(configuration().get_aging_memfp_threshold());
               experiment.set_cooloff(chrono::seconds{configuration().get_aging_cooloff_seconds()});
+              experiment.set_num_decoders(configuration().get_aging_num_decoders());
+              experiment.set_stream_buffer(configuration().get_aging_stream_buffer());
+              experiment.set_update_batch(configuration().get_update_batch_size(), library::parse_batch_atomicity(configuration().get_update_batch_atomicity()));
 
               auto result = experiment.execute();
               if (configuration().has_database()) result.save(configuration().db());
@@ -207,6 +274,10 @@ static void run_standalone(int argc, char* argv[]){
     if(configuration().has_database()){
         vector<pair<string, string>> params;
         params.push_back(make_pair("num_validation_errors", to_string(num_validation_errors)));
+        if(impl_csr.get() != nullptr){ reorder_time = impl_csr->get_vertex_reordering_time(); }
+        if(impl_csr.get() != nullptr || reordering != graph::VertexReordering::NONE){ // microseconds, 0 if the vertices have not been reordered
+            params.push_back(make_pair("reorder_time", to_string(reorder_time)));
+        }
         configuration().db()->store_parameters(params);
     }
 
@@ -241,6 +312,10 @@ static void run_standalone(int argc, char* argv[]){
 
         if(configuration().validate_output()){
             LOG("[driver] Enabling validation mode");
+            if(configuration().validate_output_binary()){
+                LOG("[driver] Results saved in the binary format");
+                utility::set_result_format(utility::ResultFormat::BINARY);
+            }
             exp_seq.set_validate_output( configuration().get_validation_graph() );
             if(configuration().get_validation_graph() != path_graph){
                 exp_seq.set_validate_remap_vertices( path_graph );
@@ -17,16 +17,23 @@
 
 #include "client.hpp"
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <cassert>
 #include <cstring>
+#include <linux/errqueue.h> // MSG_ZEROCOPY notifications
+#include <memory>
 #include <netdb.h> // gethostbyname
+#include <netinet/in.h> // IP_RECVERR
+#include <poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h> // iovec
 #include <type_traits>
 #include <unistd.h>
 
 #include "configuration.hpp"
 #include "internal.hpp"
+#include "shared_memory.hpp"
 
 using namespace std;
 
@@ -43,10 +50,24 @@ namespace gfe::network {
 
 thread_local int Client::m_worker_id { 0 };
 
-Client::Client(const std::string& host, int port) : m_server_host(host), m_server_port(port) {
+static const string shm_prefix = "shm://";
+
+static bool is_shared_memory(const string& host){
+    return host.compare(0, shm_prefix.size(), shm_prefix) == 0;
+}
+
+// Remove the prefix shm:// from the host
+static string remote_host(const string& host){
+    if(!is_shared_memory(host)) return host;
+    string result = host.substr(shm_prefix.size());
+    return result.empty() ? "localhost" : result;
+}
+
+Client::Client(const std::string& host, int port) : m_server_host(remote_host(host)), m_server_port(port), m_shared_memory(is_shared_memory(host)) {
     // reset the content of the connections
     for(int i = 0; i < max_num_connections; i++){
         m_connections[i].m_fd = -1;
+        m_connections[i].m_channel = nullptr;
         m_connections[i].m_buffer_read = m_connections[i].m_buffer_write = nullptr;
     }
 
@@ -95,10 +116,28 @@ void Client::connect(){
     constexpr uint32_t buffer_default_sz = 4096; // bytes
 
     m_connections[m_worker_id].m_fd = fd;
+    m_connections[m_worker_id].m_sequence = 0;
     m_connections[m_worker_id].m_buffer_read_sz = buffer_default_sz;
     m_connections[m_worker_id].m_buffer_write_sz = buffer_default_sz;
     m_connections[m_worker_id].m_buffer_read = (char*) malloc(sizeof(char) * buffer_default_sz);
     m_connections[m_worker_id].m_buffer_write = (char*) malloc(sizeof(char) * buffer_default_sz);
+    m_connections[m_worker_id].m_stream_block_size = 0; // not initialised yet
+    m_connections[m_worker_id].m_stream_credits = 0;
+    m_connections[m_worker_id].m_zerocopy = false;
+    m_connections[m_worker_id].m_zerocopy_sent = 0;
+    m_connections[m_worker_id].m_zerocopy_completed = 0;
+
+    // move the connection to shared memory
+    if(m_shared_memory){
+        unique_ptr<SharedMemoryChannel> channel { SharedMemoryChannel::create(shm_ring_capacity, fd) };
+        request(RequestType::TRANSPORT_SHM, channel->name());
+        channel->unlink(); // the server already attached to the segment, or it failed to
+        if(response()->type() == ResponseType::ERROR){
+            RPC_ERROR(response()->get_string(0));
+        }
+        assert(response()->type() == ResponseType::OK);
+        m_connections[m_worker_id].m_channel = channel.release();
+    }
 }
 
 void Client::disconnect(){
@@ -108,6 +147,7 @@ void Client::disconnect(){
 void Client::disconnect(int worker_id){
     if(worker_id >= max_num_connections) ERROR("Invalid worker_id: " << worker_id);
     if(m_connections[worker_id].m_fd == -1) return;
+    delete m_connections[worker_id].m_channel; m_connections[worker_id].m_channel = nullptr;
     close(m_connections[worker_id].m_fd); m_connections[worker_id].m_fd = -1;
     free(m_connections[worker_id].m_buffer_read); m_connections[worker_id].m_buffer_read = nullptr;
     free(m_connections[worker_id].m_buffer_write); m_connections[worker_id].m_buffer_write = nullptr;
@@ -128,23 +168,58 @@ template<typename... Args>
 void Client::request(RequestType type, Args... args){
     assert(m_worker_id >= 0 && m_worker_id < max_num_connections && "Invalid worker id");
     char* buffer = m_connections[m_worker_id].m_buffer_write;
-    new (buffer) Request(type, forward<Args>(args)...);
+    Request* request = new (buffer) Request(type, forward<Args>(args)...);
+    request->set_sequence(++m_connections[m_worker_id].m_sequence);
     uint32_t message_sz = reinterpret_cast<uint32_t*>(buffer)[0];
 //    cout << "send message_sz: " << message_sz << endl;
 
     // send the request to the server
-    ssize_t bytes_sent = send(m_connections[m_worker_id].m_fd, buffer, message_sz, /* flags */ 0);
-    if(bytes_sent == -1) ERROR_ERRNO("send_request, connection error");
-    assert(bytes_sent == message_sz && "Message not fully sent");
+    send_write_buffer(message_sz);
 
     // receive the reply from the server
     wait_response();
+    assert(response()->sequence() == m_connections[m_worker_id].m_sequence && "Response to another request");
+}
+
+void Client::reserve_write_buffer(uint64_t num_bytes){
+    assert(m_worker_id >= 0 && m_worker_id < max_num_connections && "Invalid worker id");
+    if(num_bytes > m_connections[m_worker_id].m_buffer_write_sz){
+        uint32_t new_size = pow(2, ceil(log2(num_bytes))); // next power of 2
+        LOG("[worker: " << m_worker_id << "] Reallocate the write buffer to " << new_size << " bytes");
+        free(m_connections[m_worker_id].m_buffer_write);
+        m_connections[m_worker_id].m_buffer_write = (char*) malloc(new_size);
+        m_connections[m_worker_id].m_buffer_write_sz = new_size;
+    }
+}
+
+void Client::send_write_buffer(uint64_t num_bytes){
+    const char* buffer = m_connections[m_worker_id].m_buffer_write;
+    if(m_connections[m_worker_id].m_channel != nullptr){ // shared memory
+        m_connections[m_worker_id].m_channel->send(buffer, num_bytes);
+        return;
+    }
+
+    uint64_t num_bytes_sent = 0;
+    while(num_bytes_sent < num_bytes){
+        ssize_t bytes_sent = send(m_connections[m_worker_id].m_fd, buffer + num_bytes_sent, num_bytes - num_bytes_sent, /* flags */ 0);
+        if(bytes_sent == -1){
+            if(errno == EINTR) continue;
+            ERROR_ERRNO("send_request, connection error");
+        }
+        num_bytes_sent += bytes_sent;
+    }
 }
 
 void Client::wait_response() {
     int64_t num_bytes_read { 0 }, recv_bytes { 0 };
     char* buffer = m_connections[m_worker_id].m_buffer_read;
-    recv_bytes = recv(m_connections[m_worker_id].m_fd, buffer + num_bytes_read, sizeof(uint32_t), /* flags */ 0);
+    SharedMemoryChannel* channel = m_connections[m_worker_id].m_channel;
+    if(channel != nullptr){ // shared memory
+        if(!channel->receive(buffer, sizeof(uint32_t))) ERROR("The server closed the shared memory channel");
+        recv_bytes = sizeof(uint32_t);
+    } else {
+        recv_bytes = recv(m_connections[m_worker_id].m_fd, buffer + num_bytes_read, sizeof(uint32_t), /* flags */ 0);
+    }
     if(recv_bytes == -1) ERROR_ERRNO("recv, connection interrupted?");
     assert(recv_bytes == sizeof(uint32_t) && "What the heck have we read?");
     num_bytes_read += recv_bytes;
@@ -158,6 +233,10 @@ void Client::wait_response() {
         (reinterpret_cast<uint32_t*>(buffer))[0] = message_sz;
     }
     // read the rest of the message
+    if(channel != nullptr){
+        if(!channel->receive(buffer + num_bytes_read, message_sz - num_bytes_read)) ERROR("The server closed the shared memory channel");
+        num_bytes_read = message_sz;
+    }
     while(num_bytes_read < message_sz){
         recv_bytes = read(m_connections[m_worker_id].m_fd, buffer + num_bytes_read, message_sz - num_bytes_read);
         if(recv_bytes == -1) ERROR_ERRNO("recv, connection interrupted?");
@@ -284,6 +363,15 @@ bool Client::add_edge(graph::WeightedEdge e){
     return response()->get<bool>(0);
 }
 
+bool Client::add_edge_v2(graph::WeightedEdge e){
+    request(RequestType::ADD_EDGE_V2, e.source(), e.destination(), e.weight());
+    if(response()->type() == ResponseType::NOT_SUPPORTED){
+        ERROR("add_edge_v2(" << e.source() << ", " << e.destination() << ", " << e.weight() << "): operation not supported by the remote interface");
+    }
+    assert(response()->type() == ResponseType::OK);
+    return response()->get<bool>(0);
+}
+
 bool Client::remove_edge(graph::Edge e){
     request(RequestType::REMOVE_EDGE, e.source(), e.destination());
     if(response()->type() == ResponseType::NOT_SUPPORTED){
@@ -306,25 +394,16 @@ bool Client::batch(const library::UpdateInterface::SingleUpdate* batch, uint64_t
     assert(m_worker_id >= 0 && m_worker_id < max_num_connections && "Invalid worker id");
 
     constexpr uint32_t header_sz = (uint32_t) sizeof(Request);
-    static_assert(header_sz == 8 && "Expected two int32_t fields: the message size and the message type");
+    static_assert(header_sz == 16 && "Expected the message size, the message type and the sequence number");
     uint32_t body_sz = (uint32_t) sizeof(library::UpdateInterface::SingleUpdate) * batch_sz;
     uint32_t message_sz = header_sz + body_sz;
+    reserve_write_buffer(message_sz);
 
-    if(message_sz > m_connections[m_worker_id].m_buffer_write_sz){
-        uint32_t new_size = pow(2, ceil(log2(message_sz))); // next power of 2
-        LOG("[worker: " << m_worker_id << "] Reallocate the write buffer to " << new_size << " bytes");
-        free(m_connections[m_worker_id].m_buffer_write);
-        m_connections[m_worker_id].m_buffer_write = (char*) malloc(new_size);
-        m_connections[m_worker_id].m_buffer_write_sz = new_size;
-    }
-
-    uint32_t* __restrict buffer_write = reinterpret_cast<uint32_t*>(m_connections[m_worker_id].m_buffer_write);
-    buffer_write[0] = message_sz;
-    buffer_write[1] = (uint32_t) (force ? RequestType::BATCH_PLAIN_FORCE_YES : RequestType::BATCH_PLAIN_FORCE_NO );
-    memcpy(buffer_write + 2, batch, batch_sz * sizeof(library::UpdateInterface::SingleUpdate));
-    ssize_t bytes_sent = send(m_connections[m_worker_id].m_fd, (void*) buffer_write, message_sz, /* flags */ 0);
-    if(bytes_sent == -1) ERROR_ERRNO("send_request, connection error");
-    assert(bytes_sent == message_sz && "Message not fully sent");
+    Request* request = new (m_connections[m_worker_id].m_buffer_write) Request(force ? RequestType::BATCH_PLAIN_FORCE_YES : RequestType::BATCH_PLAIN_FORCE_NO);
+    request->set_sequence(++m_connections[m_worker_id].m_sequence);
+    reinterpret_cast<uint32_t*>(request)[0] = message_sz; // include the body
+    memcpy(request->buffer(), batch, batch_sz * sizeof(library::UpdateInterface::SingleUpdate));
+    send_write_buffer(message_sz);
 
     // this is actually more expensive than memcpy into the buffer and doing one send();
 //    // send the header
@@ -353,6 +432,58 @@ bool Client::batch(const library::UpdateInterface::SingleUpdate* batch, uint64_t
     return response()->get<bool>(0);
 }
 
+uint64_t Client::update_batch(const SingleUpdate* updates, uint64_t num_updates, BatchAtomicity atomicity, bool* out_applied){
+    if(atomicity == BatchAtomicity::PER_BATCH) ERROR("The remote interface does not support atomic batches of updates");
+    if(num_updates == 0) return 0;
+    assert(m_worker_id >= 0 && m_worker_id < max_num_connections && "Invalid worker id");
+    ConnectionState& connection = m_connections[m_worker_id];
+
+    constexpr uint64_t max_request_sz = sizeof(Request) + 3 * sizeof(uint64_t); // source, destination and weight
+    const uint64_t first_sequence = connection.m_sequence +1; // the sequence number of the first update
+    uint64_t num_requests_sent = 0;
+    uint64_t num_responses_received = 0;
+    uint64_t num_applied = 0;
+
+    while(num_responses_received < num_updates){
+        // keep up to max_requests_in_flight requests in flight
+        uint64_t window_end = std::min(num_updates, num_responses_received + max_requests_in_flight);
+        if(num_requests_sent < window_end){
+            uint64_t num_requests = window_end - num_requests_sent;
+            reserve_write_buffer(num_requests * max_request_sz);
+            uint64_t num_bytes = 0;
+            for(uint64_t i = num_requests_sent; i < window_end; i++){
+                const SingleUpdate& update = updates[i];
+                char* buffer = connection.m_buffer_write + num_bytes;
+                Request* request = (update.m_weight >= 0) ?
+                        new (buffer) Request(RequestType::ADD_EDGE_V2, update.m_source, update.m_destination, update.m_weight) :
+                        new (buffer) Request(RequestType::REMOVE_EDGE, update.m_source, update.m_destination);
+                request->set_sequence(first_sequence + i);
+                num_bytes += request->message_size();
+            }
+            connection.m_sequence += num_requests;
+            send_write_buffer(num_bytes); // all requests with a single call
+            num_requests_sent = window_end;
+        }
+
+        // match the next response to its update
+        wait_response();
+        uint64_t index = response()->sequence() - first_sequence;
+        if(index >= num_updates) ERROR("Invalid sequence number in the response: " << response()->sequence());
+        if(response()->type() == ResponseType::NOT_SUPPORTED){
+            ERROR("update_batch: operation not supported by the remote interface");
+        } else if (response()->type() == ResponseType::ERROR){
+            RPC_ERROR(response()->get_string(0));
+        }
+        assert(response()->type() == ResponseType::OK);
+        bool applied = response()->get<bool>(0);
+        num_applied += applied;
+        if(out_applied != nullptr){ out_applied[index] = applied; }
+        num_responses_received++;
+    }
+
+    return num_applied;
+}
+
 void Client::set_timeout(uint64_t seconds){
     const_cast<Client*>(this)->request(RequestType::SET_TIMEOUT, seconds);
     assert(response()->type() == ResponseType::OK);
@@ -471,4 +602,206 @@ void Client::sssp(uint64_t source_vertex_id, const char* dump2file){
     }
 }
 
+/*****************************************************************************
+ *                                                                           *
+ * Streams                                                                   *
+ *                                                                           *
+ *****************************************************************************/
+
+uint64_t Client::stream_updates(const uint64_t* sources, const uint64_t* destinations, const double* weights, uint64_t num_updates){
+    if(num_updates == 0) return 0;
+    assert(m_worker_id >= 0 && m_worker_id < max_num_connections && "Invalid worker id");
+    ConnectionState& connection = m_connections[m_worker_id];
+    if(connection.m_stream_block_size == 0) stream_begin();
+
+    const uint64_t block_size = connection.m_stream_block_size;
+    const uint64_t num_blocks = (num_updates + block_size -1) / block_size;
+    const uint64_t first_sequence = connection.m_sequence +1; // the sequence number of the first block
+
+    // the headers of all blocks are kept in the write buffer until the kernel releases them, as with MSG_ZEROCOPY
+    // the pages are sent only after sendmsg returns
+    reserve_write_buffer(num_blocks * stream_columns_offset);
+    char* headers = connection.m_buffer_write;
+    memset(headers, 0, num_blocks * stream_columns_offset);
+
+    uint64_t num_blocks_sent = 0;
+    uint64_t num_responses_received = 0;
+    uint64_t num_applied = 0;
+    ResponseType error_type = ResponseType::OK; // the first failure reported by the server, raised once all responses have been received
+    string error_message;
+
+    while(num_responses_received < num_blocks){
+        // send as many blocks as the credits allow
+        while(num_blocks_sent < num_blocks && connection.m_stream_credits > 0){
+            uint64_t offset = num_blocks_sent * block_size;
+            uint64_t length = std::min(block_size, num_updates - offset);
+            stream_send_block(headers + num_blocks_sent * stream_columns_offset, sources + offset, destinations + offset, weights + offset, length);
+            connection.m_stream_credits--;
+            num_blocks_sent++;
+        }
+        if(num_blocks_sent == num_responses_received) ERROR("stream_updates: no credits left to send the next block");
+
+        // the blocks are processed in order
+        wait_response();
+        if(response()->sequence() != first_sequence + num_responses_received) ERROR("Invalid sequence number in the response: " << response()->sequence() << ", expected: " << (first_sequence + num_responses_received));
+        num_responses_received++;
+
+        if(response()->type() == ResponseType::OK){
+            num_applied += response()->get(0);
+            connection.m_stream_credits += response()->get(1);
+        } else {
+            connection.m_stream_credits++; // the block has been consumed anyway
+            if(error_type == ResponseType::OK){
+                error_type = response()->type();
+                if(error_type == ResponseType::ERROR){ error_message = response()->get_string(0); }
+            }
+        }
+    }
+
+    zerocopy_wait(); // before returning the ownership of the arrays to the caller
+
+    switch(error_type){
+    case ResponseType::OK:
+        /* nop */
+        break;
+    case ResponseType::NOT_SUPPORTED:
+        ERROR("stream_updates: operation not supported by the remote interface");
+        break;
+    case ResponseType::TIMEOUT:
+        TIMEOUT_ERROR
+        break;
+    case ResponseType::ERROR:
+        RPC_ERROR(error_message);
+        break;
+    default:
+        ERROR("Invalid response type: " << error_type)
+    }
+
+    return num_applied;
+}
+
+void Client::stream_begin(){
+    ConnectionState& connection = m_connections[m_worker_id];
+
+    request(RequestType::STREAM_BEGIN, stream_block_size);
+    if(response()->type() == ResponseType::NOT_SUPPORTED){
+        ERROR("stream_updates: operation not supported by the remote interface");
+    } else if (response()->type() == ResponseType::ERROR){
+        RPC_ERROR(response()->get_string(0));
+    }
+    assert(response()->type() == ResponseType::OK);
+    uint64_t block_size = response()->get(0);
+    uint64_t num_credits = response()->get(1);
+    if(block_size == 0 || num_credits == 0) ERROR("stream_updates: invalid parameters from the server, block size: " << block_size << ", credits: " << num_credits);
+
+    // pinning the pages and waiting for their release only pays off with large blocks
+    connection.m_zerocopy = false;
+    connection.m_zerocopy_sent = connection.m_zerocopy_completed = 0;
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+    if(connection.m_channel == nullptr && 3 * sizeof(uint64_t) * block_size >= zerocopy_min_bytes){
+        int enable = 1;
+        connection.m_zerocopy = setsockopt(connection.m_fd, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) == 0;
+    }
+#endif
+
+    connection.m_stream_block_size = block_size;
+    connection.m_stream_credits = num_credits;
+}
+
+void Client::stream_send_block(char* header, const uint64_t* sources, const uint64_t* destinations, const double* weights, uint64_t num_updates){
+    ConnectionState& connection = m_connections[m_worker_id];
+    const uint64_t column_sz = num_updates * sizeof(uint64_t);
+
+    Request* request = new (header) Request(RequestType::STREAM_UPDATES, num_updates);
+    request->set_sequence(++connection.m_sequence);
+    reinterpret_cast<uint32_t*>(header)[0] = (uint32_t) (stream_columns_offset + 3 * column_sz); // include the columns
+
+    struct iovec iov[4];
+    iov[0].iov_base = header; iov[0].iov_len = stream_columns_offset;
+    iov[1].iov_base = const_cast<uint64_t*>(sources); iov[1].iov_len = column_sz;
+    iov[2].iov_base = const_cast<uint64_t*>(destinations); iov[2].iov_len = column_sz;
+    iov[3].iov_base = const_cast<double*>(weights); iov[3].iov_len = column_sz;
+    struct iovec* iov_next = iov; // the first segment not sent yet
+    int iov_sz = 4;
+
+    if(connection.m_channel != nullptr){ // shared memory
+        for(int i = 0; i < iov_sz; i++){ connection.m_channel->send(iov[i].iov_base, iov[i].iov_len); }
+        return;
+    }
+
+    int flags = MSG_NOSIGNAL;
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+    if(connection.m_zerocopy){ flags |= MSG_ZEROCOPY; }
+#endif
+
+    while(iov_sz > 0){
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = iov_next;
+        message.msg_iovlen = iov_sz;
+        ssize_t bytes_sent = sendmsg(connection.m_fd, &message, flags);
+        if(bytes_sent == -1){
+            if(errno == EINTR) continue;
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+            if(errno == ENOBUFS && (flags & MSG_ZEROCOPY)){ flags &= ~MSG_ZEROCOPY; continue; } // too many pages pinned, copy the rest
+#endif
+            ERROR_ERRNO("stream_updates, connection error");
+        }
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+        if(flags & MSG_ZEROCOPY){ connection.m_zerocopy_sent++; } // each successful call is acknowledged with a notification
+#endif
+
+        // skip the segments sent
+        while(iov_sz > 0 && static_cast<size_t>(bytes_sent) >= iov_next->iov_len){
+            bytes_sent -= iov_next->iov_len;
+            iov_next++;
+            iov_sz--;
+        }
+        if(iov_sz > 0){
+            iov_next->iov_base = reinterpret_cast<char*>(iov_next->iov_base) + bytes_sent;
+            iov_next->iov_len -= bytes_sent;
+        }
+    }
+}
+
+void Client::zerocopy_wait(){
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+    ConnectionState& connection = m_connections[m_worker_id];
+
+    while(connection.m_zerocopy_completed != connection.m_zerocopy_sent){
+        char control[128];
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        if(recvmsg(connection.m_fd, &message, MSG_ERRQUEUE) == -1){
+            if(errno == EINTR) continue;
+            if(errno != EAGAIN && errno != EWOULDBLOCK) ERROR_ERRNO("zerocopy, cannot read the notifications");
+
+            // the notifications are not ready yet, POLLERR is always reported once the error queue is not empty
+            struct pollfd descriptor;
+            descriptor.fd = connection.m_fd;
+            descriptor.events = 0;
+            descriptor.revents = 0;
+            if(poll(&descriptor, 1, /* no timeout */ -1) == -1 && errno != EINTR) ERROR_ERRNO("zerocopy, poll");
+            if(descriptor.revents & POLLHUP) ERROR("zerocopy, connection closed while waiting for the notifications");
+            continue;
+        }
+
+        for(struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg)){
+            if(!((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))) continue;
+            const struct sock_extended_err* notification = reinterpret_cast<const struct sock_extended_err*>(CMSG_DATA(cmsg));
+            if(notification->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+            if(notification->ee_errno != 0) ERROR("zerocopy, error in the notification: " << strerror(notification->ee_errno));
+
+            connection.m_zerocopy_completed += notification->ee_data - notification->ee_info +1; // range [ee_info, ee_data] of the calls completed
+            if(notification->ee_code & SO_EE_CODE_ZEROCOPY_COPIED){ // e.g. over the loopback interface, the kernel copied the data anyway
+                connection.m_zerocopy = false;
+            }
+        }
+    }
+#endif
+}
+
 } // namespace
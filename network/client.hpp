@@ -25,6 +25,8 @@
 
 namespace gfe::network {
 
+class SharedMemoryChannel; // forward decl.
+
 /**
  * A Client acts as a proxy for a remote interface, reachable by a Server (gfe_server).
  * All requests performed to an instance of a Client are forwarded to the end and result propagated back
@@ -35,6 +37,17 @@ namespace gfe::network {
  *
  * The class is thread-safe only if different threads access it with a different worker_id,
  * previously set through #on_thread_init(int worker_id).
+ *
+ * The updates sent with #update_batch are pipelined: up to max_requests_in_flight requests are sent before waiting for
+ * their responses, which are matched to the updates by their sequence number.
+ *
+ * Bulk ingestion is provided by #stream_updates: the updates are sent in blocks with the columnar layout of the graphlog,
+ * directly from the arrays of the caller, without copying them in the write buffer. The number of blocks in flight is
+ * bounded by the credits granted by the server. Large blocks are sent with MSG_ZEROCOPY, when the kernel supports it.
+ *
+ * With a host in the form `shm://host', e.g. shm://localhost, the client and the server must run on the same machine.
+ * Each connection is established over TCP and then moved to a shared memory channel, with a pair of ring buffers, one
+ * for the requests and one for the responses.
  */
 class Client : public virtual library::UpdateInterface, public virtual library::LoaderInterface, public virtual library::GraphalyticsInterface {
     Client(const Client&) = delete;
@@ -43,14 +56,26 @@ class Client : public virtual library::UpdateInterface, public virtual library::
     static thread_local int m_worker_id; // keep track which worker
     const std::string m_server_host;
     const int m_server_port;
+    const bool m_shared_memory; // whether to exchange the requests and the responses over shared memory, rather than TCP
     static constexpr int max_num_connections = 1024;
+    static constexpr uint64_t max_requests_in_flight = 256; // max number of pipelined requests, in #update_batch
+    static constexpr uint64_t stream_block_size = (1ull << 16); // number of updates in a block sent by #stream_updates, as requested to the server
+    static constexpr uint64_t zerocopy_min_bytes = (1ull << 14); // min size of a block to be sent with MSG_ZEROCOPY
+    static constexpr uint64_t shm_ring_capacity = (1ull << 20); // capacity of each ring buffer, in bytes, with the shared memory transport
 
     struct ConnectionState {
         int m_fd; // file descriptor for the connection
+        SharedMemoryChannel* m_channel; // the shared memory channel, or nullptr when the requests are sent over TCP
+        uint64_t m_sequence; // the sequence number of the last request sent
         uint32_t m_buffer_read_sz; // current size of the read buffer
         uint32_t m_buffer_write_sz; // current size of the write buffer
         char* m_buffer_read; // read buffer
         char* m_buffer_write; // write buffer
+        uint64_t m_stream_block_size; // max number of updates in a block for STREAM_UPDATES, 0 if the stream has not been initialised yet
+        uint64_t m_stream_credits; // number of blocks that can still be sent before waiting for a response
+        bool m_zerocopy; // whether the blocks are sent with MSG_ZEROCOPY
+        uint32_t m_zerocopy_sent; // number of calls to sendmsg with MSG_ZEROCOPY
+        uint32_t m_zerocopy_completed; // number of calls to sendmsg with MSG_ZEROCOPY whose buffers have been released by the kernel
     };
 
     ConnectionState m_connections[max_num_connections]; // keep track of all connections
@@ -81,6 +106,32 @@ class Client : public virtual library::UpdateInterface, public virtual library::
      */
     void wait_response();
 
+    /**
+     * Ensure the write buffer of the current connection can store at least the given amount of bytes
+     */
+    void reserve_write_buffer(uint64_t num_bytes);
+
+    /**
+     * Send the content of the write buffer of the current connection
+     */
+    void send_write_buffer(uint64_t num_bytes);
+
+    /**
+     * Negotiate the size of the blocks and the number of credits for #stream_updates
+     */
+    void stream_begin();
+
+    /**
+     * Send a single block of updates. The header of the message is stored in the given buffer, while the columns are sent
+     * straight from the given arrays.
+     */
+    void stream_send_block(char* header, const uint64_t* sources, const uint64_t* destinations, const double* weights, uint64_t num_updates);
+
+    /**
+     * Wait for the kernel to release all buffers sent with MSG_ZEROCOPY
+     */
+    void zerocopy_wait();
+
     /**
      * Retrieve the current response from the server
      */
@@ -88,7 +139,7 @@ class Client : public virtual library::UpdateInterface, public virtual library::
 
 public:
     /**
-     * Connect the proxy to the server at the given host/port
+     * Connect the proxy to the server at the given host/port. Prefix the host with shm:// to use the shared memory transport.
      */
     Client(const std::string& host, int port);
 
@@ -137,10 +188,21 @@ public:
     virtual bool add_vertex(uint64_t vertex_id) override;
     virtual bool remove_vertex(uint64_t vertex_id) override;
     virtual bool add_edge(graph::WeightedEdge e) override;
+    virtual bool add_edge_v2(graph::WeightedEdge e) override;
     virtual bool remove_edge(graph::Edge e) override;
     virtual void build() override;
     virtual bool batch(const library::UpdateInterface::SingleUpdate* batch, uint64_t batch_sz, bool force) override;
+    virtual uint64_t update_batch(const SingleUpdate* updates, uint64_t num_updates, BatchAtomicity atomicity, bool* out_applied = nullptr) override;
     virtual void set_timeout(uint64_t seconds) override;
+
+    /**
+     * Stream the given updates to the server, in the columnar layout of the graphlog: the sources, the destinations and
+     * the weights in three separate arrays. A negative weight represents an edge removal. The updates are applied as by
+     * #update_batch with the atomicity PER_EDGE. The arrays must not be altered until the method returns.
+     * @return the number of updates applied
+     */
+    uint64_t stream_updates(const uint64_t* sources, const uint64_t* destinations, const double* weights, uint64_t num_updates);
+
     virtual void bfs(uint64_t source_vertex_id, const char* dump2file = nullptr) override; // graphalytics
     virtual void pagerank(uint64_t num_iterations, double damping_factor = 0.85, const char* dump2file = nullptr) override; // graphalytics
     virtual void wcc(const char* dump2file = nullptr) override; // graphalytics
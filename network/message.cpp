@@ -26,6 +26,7 @@ std::ostream& operator<<(std::ostream& out, RequestType type){
     case RequestType::TERMINATE_ON_LAST_CONNECTION: out << "TERMINATE_ON_LAST_CONNECTION"; break;
     case RequestType::LIBRARY_NAME: out << "LIBRARY_NAME"; break;
     case RequestType::SET_TIMEOUT: out << "SET_TIMEOUT"; break;
+    case RequestType::TRANSPORT_SHM: out << "TRANSPORT_SHM"; break;
     case RequestType::ON_MAIN_INIT: out << "ON_MAIN_INIT"; break;
     case RequestType::ON_THREAD_INIT: out << "ON_THREAD_INIT"; break;
     case RequestType::ON_THREAD_DESTROY: out << "ON_THREAD_DESTROY"; break;
@@ -41,8 +42,11 @@ std::ostream& operator<<(std::ostream& out, RequestType type){
     case RequestType::REMOVE_VERTEX: out << "REMOVE_VERTEX"; break;
     case RequestType::ADD_EDGE: out << "ADD_EDGE"; break;
     case RequestType::REMOVE_EDGE: out << "REMOVE_EDGE"; break;
+    case RequestType::ADD_EDGE_V2: out << "ADD_EDGE_V2"; break;
     case RequestType::BATCH_PLAIN_FORCE_NO: out << "BATCH_PLAIN (force = false)"; break;
     case RequestType::BATCH_PLAIN_FORCE_YES: out << "BATCH_PLAIN (force = true)"; break;
+    case RequestType::STREAM_BEGIN: out << "STREAM_BEGIN"; break;
+    case RequestType::STREAM_UPDATES: out << "STREAM_UPDATES"; break;
     case RequestType::BUILD: out << "BUILD"; break;
     case RequestType::DUMP_CLIENT: out << "DUMP_CLIENT"; break;
     case RequestType::DUMP_STDOUT: out << "DUMP_STDOUT"; break;
@@ -59,7 +63,7 @@ std::ostream& operator<<(std::ostream& out, RequestType type){
 }
 
 std::ostream& operator<<(std::ostream& out, const Request& request){
-    out << "[REQUEST " << request.type() << ", message size: " << request.message_size();
+    out << "[REQUEST " << request.type() << ", message size: " << request.message_size() << ", sequence: " << request.sequence();
     switch(request.type()){
     case RequestType::ON_MAIN_INIT:
         out << ", num threads: " << request.get(0);
@@ -79,11 +83,18 @@ std::ostream& operator<<(std::ostream& out, const Request& request){
         out << ", vertex_id: " << request.get(0);
         break;
     case RequestType::ADD_EDGE:
-        out << ", source: " << request.get(0) << ", destination: " << request.get(1)<< ", weight: " << request.get(2);
+    case RequestType::ADD_EDGE_V2:
+        out << ", source: " << request.get(0) << ", destination: " << request.get(1)<< ", weight: " << request.get<double>(2);
         break;
     case RequestType::REMOVE_EDGE:
         out << ", source: " << request.get(0) << ", destination: " << request.get(1);
         break;
+    case RequestType::STREAM_BEGIN:
+        out << ", max block size: " << request.get(0);
+        break;
+    case RequestType::STREAM_UPDATES:
+        out << ", num updates: " << request.get(0);
+        break;
     case RequestType::BFS:
     case RequestType::SSSP:
         out << ", source: " << request.get(0);
@@ -121,7 +132,7 @@ std::ostream& operator<<(std::ostream& out, ResponseType type){
 }
 
 std::ostream& operator<<(std::ostream& out, const Response& response){
-    out << "[RESPONSE " << response.type() << ", message size: " << response.message_size();
+    out << "[RESPONSE " << response.type() << ", message size: " << response.message_size() << ", sequence: " << response.sequence();
 
     for(int i = 0, end = response.num_arguments(); i < end; i++){
         out << ", arg[" << i << "]: " << response.get<int64_t>(i);
@@ -36,12 +36,15 @@ enum class RequestType : uint32_t {
     TERMINATE_ON_LAST_CONNECTION, // terminate the server when there no are more connections active
     LIBRARY_NAME, // the name of the library being evaluated
     SET_TIMEOUT, // avoid a computation running more than the given amount of  seconds
+    TRANSPORT_SHM, // continue the communication over the shared memory segment with the given name
     ON_MAIN_INIT, ON_THREAD_INIT, ON_THREAD_DESTROY, ON_MAIN_DESTROY,
     NUM_EDGES, NUM_VERTICES, IS_DIRECTED,
     HAS_VERTEX, HAS_EDGE, GET_WEIGHT,
     LOAD, // load the graph from disk
-    ADD_VERTEX, REMOVE_VERTEX, ADD_EDGE, REMOVE_EDGE,
+    ADD_VERTEX, REMOVE_VERTEX, ADD_EDGE, REMOVE_EDGE, ADD_EDGE_V2,
     BATCH_PLAIN_FORCE_NO, BATCH_PLAIN_FORCE_YES,
+    STREAM_BEGIN, // negotiate the size of the blocks and the number of credits for STREAM_UPDATES
+    STREAM_UPDATES, // a block of updates in the columnar layout of the graphlog, see stream_columns_offset
     BUILD, // create a new snapshot
     DUMP_CLIENT, DUMP_STDOUT, DUMP_FILE, // #dump()
     BFS, PAGERANK, WCC, CDLP, LCC, SSSP // graphalytics interface
@@ -58,12 +61,15 @@ enum class ResponseType: uint32_t {
 };
 
 /**
- * A generic message, type + arguments, sent between the clients and the server
+ * A generic message, type + arguments, sent between the clients and the server.
+ * A response carries the same sequence number of the request it answers, so that a client can keep multiple requests
+ * in flight on the same connection.
  */
 template<typename Type>
 class Message {
     uint32_t m_message_size; // size of the message, in bytes, including the header (that is sizeof(Message))
     const Type m_type;
+    uint64_t m_sequence { 0 }; // sequence number, set by the client and echoed back by the server
 
 public:
     template<typename... Args>
@@ -78,6 +84,10 @@ public:
     // The type associated to this message
     Type type() const;
 
+    // The sequence number of the message
+    uint64_t sequence() const;
+    void set_sequence(uint64_t sequence);
+
     // Get the given argument
     template<typename T = uint64_t>
     T get(int index) const;
@@ -94,6 +104,13 @@ public:
 // Specific message sent from the clients to the server
 using Request = Message<RequestType>;
 
+/**
+ * A STREAM_UPDATES request consists of the header of the message, the number of updates in the block as the first
+ * argument, padding and, from this offset onwards, three columns with the sources, the destinations and the weights
+ * of the updates, as in the blocks of a graphlog. A negative weight represents an edge removal.
+ */
+constexpr uint64_t stream_columns_offset = 64; // bytes, from the start of the message
+
 // Specific message sent from the server to the client
 using Response = Message<ResponseType>;
 
@@ -198,6 +215,16 @@ Type Message<Type>::type() const {
     return m_type;
 }
 
+template<typename Type>
+uint64_t Message<Type>::sequence() const {
+    return m_sequence;
+}
+
+template<typename Type>
+void Message<Type>::set_sequence(uint64_t sequence) {
+    m_sequence = sequence;
+}
+
 template<typename Type>
 const char* Message<Type>::buffer() const{
     return reinterpret_cast<const char*>(this) + sizeof(Message<Type>);
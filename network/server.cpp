@@ -19,13 +19,22 @@
 
 #include <arpa/inet.h> // inet_ntoa
 #include <cassert>
+#include <cmath>
+#include <cstdlib> // aligned_alloc
 #include <cstring>
+#include <fcntl.h>
+#include <mutex>
 #include <netinet/ip.h> // TCP/IP protocol
+#include <netinet/tcp.h> // TCP_NODELAY
 #include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/select.h>
 #include <sys/socket.h>
+#include <sys/uio.h> // iovec
 #include <thread>
 #include <unistd.h>
+#include <unordered_set>
 
 #include "common/filesystem.hpp"
 #include "common/system.hpp"
@@ -34,6 +43,7 @@
 #include "configuration.hpp"
 #include "internal.hpp"
 #include "message.hpp"
+#include "shared_memory.hpp"
 
 using namespace std;
 
@@ -94,13 +104,250 @@ static void signal_handler_uninstall(){
 
 
 
+/*****************************************************************************
+ *                                                                           *
+ * Reactor                                                                   *
+ *                                                                           *
+ *****************************************************************************/
+/**
+ * A thread serving multiple connections, in the event driven mode
+ */
+class Server::Reactor {
+    Server* m_instance; // the server this reactor belongs to
+    const int m_reactor_id; // the ID of this reactor, in [0, num_reactors)
+    int m_epoll_fd { -1 }; // the epoll instance to wait for the events of the connections
+    int m_event_fd { -1 }; // wake up the reactor when new connections are assigned or it needs to terminate
+    mutex m_mutex; // protect m_incoming
+    vector<ConnectionHandler*> m_incoming; // connections assigned to this reactor, not yet registered in the epoll instance
+    unordered_set<ConnectionHandler*> m_connections; // connections served by this reactor
+    atomic<bool> m_terminate { false }; // flag to stop the reactor
+    thread m_thread; // the thread of the reactor
+
+    // Main loop of the reactor
+    void main_thread();
+
+    // Start serving the given connection
+    void adopt(ConnectionHandler* connection);
+
+    // Close, migrate or update the events for the connection, after its requests have been processed
+    void update(ConnectionHandler* connection);
+
+    // Close the given connection
+    void close(ConnectionHandler* connection);
+
+    // Move the connection to a dedicated thread, once it switched to a shared memory channel
+    void handover(ConnectionHandler* connection);
+
+    // Wake up the reactor
+    void notify();
+
+public:
+    Reactor(Server* instance, int reactor_id);
+
+    // Terminate the reactor and close all its connections
+    ~Reactor();
+
+    // Assign the given connection to this reactor. It can be invoked by any thread.
+    void assign(ConnectionHandler* connection);
+};
+
+Server::Reactor::Reactor(Server* instance, int reactor_id) : m_instance(instance), m_reactor_id(reactor_id) {
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if(m_epoll_fd < 0) ERROR_ERRNO("Cannot create the epoll instance");
+    m_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(m_event_fd < 0) ERROR_ERRNO("Cannot create the event fd");
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr; // the event fd
+    if(epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_event_fd, &event) != 0) ERROR_ERRNO("epoll_ctl, cannot register the event fd");
+
+    m_thread = thread(&Reactor::main_thread, this);
+}
+
+Server::Reactor::~Reactor(){
+    m_terminate = true;
+    notify();
+    if(m_thread.joinable()) m_thread.join();
+
+    for(auto connection : m_incoming){ m_connections.insert(connection); }
+    m_incoming.clear();
+    for(auto connection : m_connections){
+        delete connection;
+        m_instance->m_num_active_connections--;
+    }
+    m_connections.clear();
+
+    ::close(m_event_fd); m_event_fd = -1;
+    ::close(m_epoll_fd); m_epoll_fd = -1;
+}
+
+void Server::Reactor::assign(ConnectionHandler* connection){
+    {
+        scoped_lock<mutex> lock(m_mutex);
+        m_incoming.push_back(connection);
+    }
+    notify();
+}
+
+void Server::Reactor::notify(){
+    uint64_t value = 1;
+    [[maybe_unused]] ssize_t rc = write(m_event_fd, &value, sizeof(value));
+}
+
+void Server::Reactor::main_thread(){
+    common::concurrency::set_thread_name("Reactor #" + to_string(m_reactor_id));
+    COUT_DEBUG("[reactor " << m_reactor_id << "] started");
+
+    constexpr int max_num_events = 64;
+    struct epoll_event events[max_num_events];
+
+    while(!m_terminate){
+        int num_events = epoll_wait(m_epoll_fd, events, max_num_events, /* timeout, in millisecs */ 1000);
+        if(num_events < 0){
+            if(errno == EINTR) continue;
+            LOG("[server] [reactor " << m_reactor_id << "] epoll_wait failed: " << strerror(errno) << " (errno: " << errno << ")");
+            break;
+        }
+
+        for(int i = 0; i < num_events; i++){
+            ConnectionHandler* connection = reinterpret_cast<ConnectionHandler*>(events[i].data.ptr);
+
+            if(connection == nullptr){ // new connections assigned to this reactor
+                uint64_t value;
+                [[maybe_unused]] ssize_t rc = read(m_event_fd, &value, sizeof(value));
+                vector<ConnectionHandler*> incoming;
+                {
+                    scoped_lock<mutex> lock(m_mutex);
+                    incoming.swap(m_incoming);
+                }
+                for(auto c : incoming){ adopt(c); }
+                continue;
+            }
+
+            bool is_open = true;
+            try {
+                if(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)){
+                    is_open = connection->receive();
+                    connection->handle_pending_requests();
+                }
+                connection->flush();
+            } catch(common::Error& e){
+                LOG("[server] [reactor " << m_reactor_id << "] " << e);
+                is_open = false;
+            }
+
+            if(is_open){
+                update(connection);
+            } else {
+                close(connection);
+            }
+        }
+    }
+
+    COUT_DEBUG("[reactor " << m_reactor_id << "] terminated");
+}
+
+void Server::Reactor::adopt(ConnectionHandler* connection){
+    connection->m_reactor = this;
+    connection->m_migrate = false;
+    connection->m_events = EPOLLIN;
+    m_connections.insert(connection);
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = connection->m_events;
+    event.data.ptr = connection;
+    if(epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, connection->m_fd, &event) != 0){
+        LOG("[server] [reactor " << m_reactor_id << "] epoll_ctl, cannot register the connection: " << strerror(errno) << " (errno: " << errno << ")");
+        close(connection);
+        return;
+    }
+
+    // the connection may have been migrated from another reactor, with requests already received
+    try {
+        connection->handle_pending_requests();
+        connection->flush();
+    } catch(common::Error& e){
+        LOG("[server] [reactor " << m_reactor_id << "] " << e);
+        close(connection);
+        return;
+    }
+
+    update(connection);
+}
+
+void Server::Reactor::update(ConnectionHandler* connection){
+    if(connection->m_terminate && !connection->has_pending_output()){ // done
+        close(connection);
+    } else if(connection->m_channel != nullptr){ // shared memory
+        handover(connection);
+    } else if(connection->m_migrate){ // move the connection to the reactor responsible of its worker ID
+        Reactor* reactor = m_instance->reactor_for(connection->m_worker_id);
+        assert(reactor != this && "The connection does not need to be migrated");
+        COUT_DEBUG("[reactor " << m_reactor_id << "] migrate the connection of worker " << connection->m_worker_id << " to the reactor " << reactor->m_reactor_id);
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, connection->m_fd, nullptr);
+        m_connections.erase(connection);
+        reactor->assign(connection);
+    } else { // wait to send the rest of the output, or to receive the next requests
+        uint32_t events = (connection->m_terminate ? 0 : EPOLLIN) | (connection->has_pending_output() ? EPOLLOUT : 0);
+        if(events != connection->m_events){
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = events;
+            event.data.ptr = connection;
+            if(epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, connection->m_fd, &event) != 0){
+                LOG("[server] [reactor " << m_reactor_id << "] epoll_ctl, cannot modify the connection: " << strerror(errno) << " (errno: " << errno << ")");
+                close(connection);
+                return;
+            }
+            connection->m_events = events;
+        }
+    }
+}
+
+void Server::Reactor::handover(ConnectionHandler* connection){
+    COUT_DEBUG("[reactor " << m_reactor_id << "] hand over the connection of worker " << connection->m_worker_id << " to a dedicated thread");
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, connection->m_fd, nullptr);
+    m_connections.erase(connection);
+    connection->m_reactor = nullptr;
+
+    // the socket is only used to detect when the client terminates
+    int flags = fcntl(connection->m_fd, F_GETFL, 0);
+    if(flags >= 0){ fcntl(connection->m_fd, F_SETFL, flags & ~O_NONBLOCK); }
+
+    Server* instance = m_instance;
+    auto t = thread([instance, connection](){
+        connection->serve();
+        delete connection;
+        instance->m_num_active_connections--;
+    });
+    t.detach(); // as in the mode thread per connection
+}
+
+void Server::Reactor::close(ConnectionHandler* connection){
+    if(!connection->m_terminate){
+        LOG("[server] [reactor " << m_reactor_id << "] Connection closed by the remote end without sending a TERMINATE_WORKER message");
+    }
+
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, connection->m_fd, nullptr);
+    m_connections.erase(connection);
+    delete connection;
+    [[maybe_unused]] int num_active_connections = --(m_instance->m_num_active_connections);
+    COUT_DEBUG("[reactor " << m_reactor_id << "] Connection closed, remaining active connections: " << num_active_connections);
+}
+
+
 /*****************************************************************************
  *                                                                           *
  * Server                                                                    *
  *                                                                           *
  *****************************************************************************/
 
-Server::Server(shared_ptr<library::Interface> interface, int port) : m_interface(interface), m_port(port){
+Server::Server(shared_ptr<library::Interface> interface, int port, int num_reactors) : m_interface(interface), m_port(port), m_num_reactors(num_reactors){
+    if(m_num_reactors < 0) ERROR("Invalid number of reactors: " << m_num_reactors);
+
     int fd = socket(AF_INET, SOCK_STREAM, 0);
     if(fd < 0) ERROR_ERRNO("Cannot initialise the socket");
     m_server_fd = fd;
@@ -147,8 +394,18 @@ void Server::handle_signals(){
     signal_handler_install();
 }
 
+Server::Reactor* Server::reactor_for(int worker_id) const {
+    assert(!m_reactors.empty() && "Not in the event driven mode");
+    return m_reactors[std::max(worker_id, 0) % m_reactors.size()];
+}
+
 void Server::main_loop(){
     cout << "[server] Server listening to port: " << m_port << endl;
+    for(int i = 0; i < m_num_reactors; i++){
+        m_reactors.push_back(new Reactor(this, i));
+    }
+    if(m_num_reactors > 0){ cout << "[server] Event driven mode, number of reactors: " << m_num_reactors << endl; }
+    uint64_t next_reactor = 0; // initially, assign the connections in round robin, until the clients declare their worker ID
 
     while(!m_server_stop){
         // Set the timeout to 1 second (it may be changed after each call to select)
@@ -189,10 +446,23 @@ void Server::main_loop(){
 
 //        LOG("[server] Connection received from: " << inet_ntoa(address.sin_addr) << ":" << address.sin_port);
 
-        auto t = thread(&ConnectionHandler::execute, new ConnectionHandler(this, connection_fd));
-        t.detach(); // do not explicitly wait for the thread to terminate
+        if(m_reactors.empty()){ // thread per connection
+            auto t = thread(&ConnectionHandler::execute, new ConnectionHandler(this, connection_fd));
+            t.detach(); // do not explicitly wait for the thread to terminate
+        } else { // event driven
+            int flags = fcntl(connection_fd, F_GETFL, 0);
+            if(flags < 0 || fcntl(connection_fd, F_SETFL, flags | O_NONBLOCK) != 0) ERROR_ERRNO("Cannot set the connection as non blocking");
+            int nodelay = 1; // do not delay the responses to pipelined requests
+            setsockopt(connection_fd, IPPROTO_TCP, TCP_NODELAY, (void*) &nodelay, sizeof(nodelay));
+
+            m_num_active_connections++;
+            m_reactors[next_reactor++ % m_reactors.size()]->assign(new ConnectionHandler(this, connection_fd));
+        }
     }
 
+    for(auto reactor : m_reactors){ delete reactor; } // wait for the reactors to terminate
+    m_reactors.clear();
+
     cout << "[server] Connection loop terminated" << endl;
 }
 
@@ -202,67 +472,144 @@ void Server::main_loop(){
  * Connection Handler                                                        *
  *                                                                           *
  *****************************************************************************/
+// The read buffer is aligned to a cache line, so are the columns of STREAM_UPDATES received at its start
+constexpr static size_t buffer_read_alignment = 64;
+static_assert(stream_columns_offset % buffer_read_alignment == 0);
+
 Server::ConnectionHandler::ConnectionHandler(Server* instance, int fd) : m_instance(instance), m_fd(fd) {
-    m_buffer_read = (char*) malloc(m_buffer_read_sz);
+    m_buffer_read = (char*) aligned_alloc(buffer_read_alignment, m_buffer_read_sz);
     m_buffer_write = (char*) malloc(m_buffer_write_sz);
     assert(m_buffer_read != nullptr && m_buffer_write != nullptr && "malloc error (no memory space left?)");
 }
 
 Server::ConnectionHandler::~ConnectionHandler() {
+    delete m_channel; m_channel = nullptr; // notify the client before closing the socket
     close(m_fd);
     m_fd = -1;
 
     free(m_buffer_read); m_buffer_read = nullptr;
     free(m_buffer_write); m_buffer_write = nullptr;
+
+    delete m_channel_pending; m_channel_pending = nullptr;
 }
 
 void Server::ConnectionHandler::execute(){
     [[maybe_unused]] int num_active_connections = ++(m_instance->m_num_active_connections);
-    int64_t thread_id = common::concurrency::get_thread_id();
+    [[maybe_unused]] int64_t thread_id = common::concurrency::get_thread_id();
     struct sockaddr_in address; socklen_t address_len { sizeof(address) };
     /* ignore rc */ getpeername(m_fd, (struct sockaddr *) &address, &address_len);
     string remote_host { inet_ntoa(address.sin_addr) }; // thread-unsafe?
     int remote_port [[maybe_unused]] = address.sin_port;
     COUT_DEBUG("[server] [thread " << thread_id << "] Connected with " << remote_host << ":" << remote_port << ", num active connections: " << num_active_connections);
 
-    while(!m_terminate){
-        int64_t num_bytes_read { 0 }, recv_bytes { 0 };
+    serve();
+
+    num_active_connections = --(m_instance->m_num_active_connections);
+    COUT_DEBUG("[server] [thread " << thread_id << "] Disconnected with " << remote_host << ":" << remote_port << ", remaining active connections: " << num_active_connections);
 
+    delete this; // done!
+}
+
+void Server::ConnectionHandler::serve(){
+    while(!m_terminate){
         // read the size of the message
-        recv_bytes = recv(m_fd, m_buffer_read + num_bytes_read, sizeof(uint32_t), /* flags */ 0);
-        if(recv_bytes == -1) {
-            ERROR_ERRNO("recv, connection interrupted?");
-        } else if(recv_bytes == 0){
-            LOG("[server] [thread " << thread_id << "] Connection closed by the remote end without sending a TERMINATE_WORKER message");
+        if(!receive_blocking(m_buffer_read, sizeof(uint32_t))){
+            LOG("[server] [thread " << common::concurrency::get_thread_id() << "] Connection closed by the remote end without sending a TERMINATE_WORKER message");
             m_terminate = true;
             break;
         }
+        m_buffer_read_filled = sizeof(uint32_t);
+        uint32_t message_sz = *(reinterpret_cast<uint32_t*>(m_buffer_read));
+        if(message_sz < sizeof(Request)) ERROR("Invalid message size: " << message_sz);
+        reserve_input(message_sz); // realloc the buffer if it is too small
+
+        // read the rest of the message, straight into the read buffer
+        if(!receive_blocking(m_buffer_read + sizeof(uint32_t), message_sz - sizeof(uint32_t))){
+            ERROR("Only able to read " << sizeof(uint32_t) << " out of " << message_sz << " bytes, then the connection was closed by the remote end");
+        }
+        m_buffer_read_filled = message_sz;
+        m_request_offset = 0;
 
-        assert(recv_bytes == sizeof(uint32_t) && "Expected to read 4 bytes, while we probably read something less");
-        num_bytes_read += recv_bytes;
-        int64_t message_sz = static_cast<int64_t>(*(reinterpret_cast<uint32_t*>(m_buffer_read)));
+        handle_request();
+        flush();
+    }
+}
 
-        if(message_sz > (int64_t) m_buffer_read_sz){ // realloc the buffer if it is too small
-            m_buffer_read_sz = pow(2, ceil(log2(message_sz))); // next power of 2
-            LOG("[server] [thread " << thread_id << "] Reallocate the internal read buffer to " << m_buffer_read_sz << " bytes");
-            m_buffer_read = (char*) realloc(m_buffer_read, m_buffer_read_sz);
-            assert(m_buffer_read != nullptr && "realloc error (no memory space left?)");
+bool Server::ConnectionHandler::receive_blocking(char* buffer, size_t num_bytes){
+    if(m_channel != nullptr) return m_channel->receive(buffer, num_bytes);
+
+    size_t num_bytes_read = 0;
+    while(num_bytes_read < num_bytes){
+        ssize_t recv_bytes = recv(m_fd, buffer + num_bytes_read, num_bytes - num_bytes_read, MSG_WAITALL);
+        if(recv_bytes == -1 && errno == EINTR) continue;
+        if(recv_bytes == -1) ERROR_ERRNO("recv, only able to read " << num_bytes_read << " out of " << num_bytes << " bytes, then the connection was interrupted?");
+        if(recv_bytes == 0){
+            if(num_bytes_read == 0) return false;
+            ERROR("recv, only able to read " << num_bytes_read << " out of " << num_bytes << " bytes, then the connection was closed by the remote end");
         }
-        // read the rest of the message
-        while(num_bytes_read < message_sz){
-            recv_bytes = read(m_fd, m_buffer_read + num_bytes_read, message_sz - num_bytes_read);
-            if(recv_bytes == -1) ERROR_ERRNO("recv, only able to read " << num_bytes_read << " out of " << num_bytes_read <<" bytes, then the connection was interrupted?");
-            num_bytes_read += recv_bytes;
+        num_bytes_read += recv_bytes;
+    }
+
+    return true;
+}
+
+bool Server::ConnectionHandler::receive(){
+    assert(m_reactor != nullptr && "Only in the event driven mode");
+    assert(m_request_offset == 0 && "The read buffer should have been compacted");
+
+    // ensure there is enough space to receive the whole message being read
+    if(m_buffer_read_filled >= sizeof(uint32_t)){
+        reserve_input(*(reinterpret_cast<uint32_t*>(m_buffer_read)));
+    }
+    if(m_buffer_read_filled == m_buffer_read_sz){
+        reserve_input(m_buffer_read_sz * 2);
+    }
+
+    ssize_t recv_bytes = 0;
+    do {
+        recv_bytes = recv(m_fd, m_buffer_read + m_buffer_read_filled, m_buffer_read_sz - m_buffer_read_filled, /* flags */ 0);
+    } while(recv_bytes == -1 && errno == EINTR);
+
+    if(recv_bytes > 0){
+        m_buffer_read_filled += recv_bytes;
+        return true;
+    } else if(recv_bytes == 0){ // connection closed by the remote end
+        return false;
+    } else if(errno == EAGAIN || errno == EWOULDBLOCK){ // spurious wake up
+        return true;
+    } else {
+        ERROR_ERRNO("recv, connection interrupted?");
+    }
+}
+
+void Server::ConnectionHandler::handle_pending_requests(){
+    while(!m_terminate && !m_migrate && m_channel_pending == nullptr){
+        uint64_t num_bytes_available = m_buffer_read_filled - m_request_offset;
+        if(num_bytes_available < sizeof(uint32_t)) break; // the message size has not been received yet
+        uint32_t message_sz = *(reinterpret_cast<uint32_t*>(m_buffer_read + m_request_offset));
+        if(message_sz < sizeof(Request)) ERROR("Invalid message size: " << message_sz);
+        if(num_bytes_available < message_sz) break; // incomplete message
+
+        // process the requests of a worker in the thread of its reactor
+        if(m_reactor != nullptr && request()->type() == RequestType::ON_THREAD_INIT){
+            int worker_id = request()->get<int>(0);
+            if(m_instance->reactor_for(worker_id) != m_reactor){
+                m_worker_id = worker_id;
+                m_migrate = true;
+                break;
+            }
         }
-        assert(num_bytes_read == message_sz && "Message read");
 
         handle_request();
+        m_request_offset += message_sz;
     }
 
-    num_active_connections = --(m_instance->m_num_active_connections);
-    COUT_DEBUG("[server] [thread " << thread_id << "] Disconnected with " << remote_host << ":" << remote_port << ", remaining active connections: " << num_active_connections);
-
-    delete this; // done!
+    // move the incomplete message at the start of the read buffer
+    if(m_request_offset > 0){
+        memmove(m_buffer_read, m_buffer_read + m_request_offset, m_buffer_read_filled - m_request_offset);
+        m_buffer_read_filled -= m_request_offset;
+        m_request_offset = 0;
+    }
 }
 
 void Server::ConnectionHandler::handle_request(){
@@ -289,12 +636,20 @@ void Server::ConnectionHandler::handle_request(){
         interface()->set_timeout(request()->get(0));
         response(ResponseType::OK);
         break;
+    case RequestType::TRANSPORT_SHM: {
+        if(m_channel != nullptr || m_channel_pending != nullptr) ERROR("The connection is already using a shared memory channel");
+        string name = request()->get_string(0);
+        COUT_DEBUG("TRANSPORT_SHM: " << name);
+        m_channel_pending = SharedMemoryChannel::open(name, m_fd);
+        response(ResponseType::OK);
+    } break;
     case RequestType::ON_MAIN_INIT:
         interface()->on_main_init((int) request()->get<int>(0));
         response(ResponseType::OK);
         break;
     case RequestType::ON_THREAD_INIT:
         COUT_DEBUG("ON_THREAD_INIT: " << request()->get<int>(0));
+        m_worker_id = request()->get<int>(0);
         interface()->on_thread_init((int) request()->get<int>(0));
         response(ResponseType::OK);
         break;
@@ -377,6 +732,18 @@ void Server::ConnectionHandler::handle_request(){
             response(ResponseType::OK, result);
         }
     } break;
+    case RequestType::ADD_EDGE_V2: {
+        library::UpdateInterface* update_interface = dynamic_cast<library::UpdateInterface*>(interface());
+        if(update_interface == nullptr){
+            LOG("Operation not supported by the current interface: " << request()->type());
+            response(ResponseType::NOT_SUPPORTED);
+        } else {
+            graph::WeightedEdge edge { request()->get(0),  request()->get(1), request()->get<double>(2)};
+            COUT_DEBUG("ADD_EDGE_V2: " << edge);
+            bool result = update_interface->add_edge_v2(edge);
+            response(ResponseType::OK, result);
+        }
+    } break;
     case RequestType::REMOVE_EDGE: {
         library::UpdateInterface* update_interface = dynamic_cast<library::UpdateInterface*>(interface());
         if(update_interface == nullptr){
@@ -410,6 +777,48 @@ void Server::ConnectionHandler::handle_request(){
             }
         }
     } break;
+    case RequestType::STREAM_BEGIN: {
+        library::UpdateInterface* update_interface = dynamic_cast<library::UpdateInterface*>(interface());
+        if(update_interface == nullptr){
+            LOG("Operation not supported by the current interface: " << request()->type());
+            response(ResponseType::NOT_SUPPORTED);
+        } else {
+            uint64_t block_size = std::min<uint64_t>(std::max<uint64_t>(1, request()->get(0)), stream_max_block_size);
+            uint64_t message_sz = stream_columns_offset + 3 * sizeof(uint64_t) * block_size;
+            COUT_DEBUG("STREAM_BEGIN, block size: " << block_size << ", message size: " << message_sz << " bytes");
+
+            // grow the read buffer once, for all blocks that can be in flight
+            reserve_input(message_sz * (m_reactor == nullptr ? 1 : stream_num_credits));
+            response(ResponseType::OK, block_size, stream_num_credits);
+        }
+    } break;
+    case RequestType::STREAM_UPDATES: {
+        library::UpdateInterface* update_interface = dynamic_cast<library::UpdateInterface*>(interface());
+        if(update_interface == nullptr){
+            LOG("Operation not supported by the current interface: " << request()->type());
+            response(ResponseType::NOT_SUPPORTED);
+        } else {
+            uint64_t num_updates = request()->get(0);
+            if(request()->message_size() != stream_columns_offset + 3 * sizeof(uint64_t) * num_updates){
+                ERROR("Invalid size for a block of " << num_updates << " updates: " << request()->message_size() << " bytes");
+            }
+
+            // apply the updates in place, from the columns in the read buffer
+            const uint64_t* __restrict sources = reinterpret_cast<const uint64_t*>(reinterpret_cast<const char*>(request()) + stream_columns_offset);
+            const uint64_t* __restrict destinations = sources + num_updates;
+            const double* __restrict weights = reinterpret_cast<const double*>(destinations + num_updates);
+            uint64_t num_applied = 0;
+            for(uint64_t i = 0; i < num_updates; i++){
+                if(weights[i] >= 0){ // insert
+                    num_applied += update_interface->add_edge_v2(graph::WeightedEdge{sources[i], destinations[i], weights[i]});
+                } else { // remove
+                    num_applied += update_interface->remove_edge(graph::Edge{sources[i], destinations[i]});
+                }
+            }
+
+            response(ResponseType::OK, num_applied, /* credits returned */ (uint64_t) 1);
+        }
+    } break;
     case RequestType::BUILD: {
         library::UpdateInterface* update_interface = dynamic_cast<library::UpdateInterface*>(interface());
         if(update_interface == nullptr){
@@ -440,13 +849,15 @@ void Server::ConnectionHandler::handle_request(){
         uint64_t message_sz = header_sz + body_sz;
 
         // send the header
-        reinterpret_cast<uint32_t*>(m_buffer_write)[0] = (uint32_t) message_sz;
-        reinterpret_cast<uint32_t*>(m_buffer_write)[1] = (uint32_t) ResponseType::OK;
-        reinterpret_cast<uint64_t*>(m_buffer_write)[1] = body_sz -1;
-        send_data(m_buffer_write, header_sz);
-
-        // send the body
-        send_data(result.c_str(), body_sz);
+        char* buffer = reserve_output(header_sz);
+        Response* header = new (buffer) Response(ResponseType::OK, body_sz -1);
+        header->set_sequence(request()->sequence());
+        reinterpret_cast<uint32_t*>(buffer)[0] = (uint32_t) message_sz; // include the body
+        commit_output(header_sz);
+
+        // send the body, without copying it into the write buffer
+        result.resize(body_sz); // with the terminating null character
+        send_blob(std::move(result));
     } break;
     case RequestType::BFS: {
         auto graphalytics = dynamic_cast<library::GraphalyticsInterface*>(interface());
@@ -539,29 +950,137 @@ void Server::ConnectionHandler::handle_request(){
  * Retrieve the request being current processed
  */
 const Request* Server::ConnectionHandler::request() const {
-    return reinterpret_cast<const Request*>(m_buffer_read);
+    return reinterpret_cast<const Request*>(m_buffer_read + m_request_offset);
 }
 
+// Upper bound on the space required to store the given argument in a message
+static size_t argument_size(const char* value){ return sizeof(uint64_t) * (2 + (value == nullptr ? 0 : strlen(value)) / sizeof(uint64_t)); }
+static size_t argument_size(const string& value){ return sizeof(uint64_t) * (2 + value.size() / sizeof(uint64_t)); }
+template<typename T> static size_t argument_size(T){ return sizeof(uint64_t); }
+
 template<typename... Args>
 void Server::ConnectionHandler::response(ResponseType type, Args... args){
-    new (m_buffer_write) Response(type, std::forward<Args>(args)...);
+    size_t message_sz = sizeof(Response) + (0 + ... + argument_size(args));
+    Response* response = new (reserve_output(message_sz)) Response(type, std::forward<Args>(args)...);
+    response->set_sequence(request()->sequence());
+
+    assert(response->message_size() <= message_sz && "The message is too long");
+    commit_output(response->message_size());
+}
+
+char* Server::ConnectionHandler::reserve_output(size_t num_bytes){
+    if(m_buffer_write_filled + num_bytes > m_buffer_write_sz){ // realloc the buffer if it is too small
+        m_buffer_write_sz = pow(2, ceil(log2(m_buffer_write_filled + num_bytes))); // next power of 2
+        m_buffer_write = (char*) realloc(m_buffer_write, m_buffer_write_sz);
+        assert(m_buffer_write != nullptr && "realloc error (no memory space left?)");
+    }
 
-    assert(/* message_sz */ (*(reinterpret_cast<uint32_t*>(m_buffer_write))) < m_buffer_write_sz && "The message is too long");
-    send_data(m_buffer_write);
+    return m_buffer_write + m_buffer_write_filled;
 }
 
-void Server::ConnectionHandler::send_data(const char* buffer){
-    ssize_t message_sz = *(reinterpret_cast<const uint32_t*>(buffer));
-    send_data(buffer, message_sz);
+void Server::ConnectionHandler::commit_output(size_t num_bytes){
+    assert(m_buffer_write_filled + num_bytes <= m_buffer_write_sz && "Overflow");
+    if(!m_output.empty() && m_output.back().m_blob.empty() && m_output.back().m_offset + m_output.back().m_length == m_buffer_write_filled){
+        m_output.back().m_length += num_bytes; // extend the last segment
+    } else {
+        m_output.push_back(OutputSegment{ m_buffer_write_filled, num_bytes, string{} });
+    }
+    m_buffer_write_filled += num_bytes;
 }
 
 void Server::ConnectionHandler::send_data(const char* buffer, uint32_t buffer_sz){
-    ssize_t message_sz = (ssize_t) buffer_sz; // cast
-    ssize_t bytes_sent = send(m_fd, buffer, message_sz, /* flags */ 0);
-    if(bytes_sent == -1) ERROR_ERRNO("send_response, connection error");
-    assert(bytes_sent == message_sz && "Message not fully sent");
+    memcpy(reserve_output(buffer_sz), buffer, buffer_sz);
+    commit_output(buffer_sz);
+}
+
+void Server::ConnectionHandler::send_blob(string&& blob){
+    if(blob.empty()) return;
+    size_t length = blob.size();
+    m_output.push_back(OutputSegment{ 0, length, std::move(blob) });
+}
+
+bool Server::ConnectionHandler::has_pending_output() const {
+    return !m_output.empty();
 }
 
+bool Server::ConnectionHandler::flush(){
+    constexpr int max_num_segments = 64; // per call to sendmsg
+
+    if(m_channel != nullptr){ // shared memory
+        for(size_t i = 0; i < m_output.size(); i++){
+            const OutputSegment& segment = m_output[i];
+            const char* base = segment.m_blob.empty() ? m_buffer_write + segment.m_offset : segment.m_blob.data();
+            size_t skip = (i == 0) ? m_output_sent : 0; // already sent
+            m_channel->send(base + skip, segment.m_length - skip);
+        }
+        m_output.clear();
+        m_output_sent = 0;
+        m_buffer_write_filled = 0;
+        return true;
+    }
+
+    while(!m_output.empty()){
+        struct iovec iov[max_num_segments];
+        int iov_sz = 0;
+        for(size_t i = 0; i < m_output.size() && iov_sz < max_num_segments; i++){
+            const OutputSegment& segment = m_output[i];
+            const char* base = segment.m_blob.empty() ? m_buffer_write + segment.m_offset : segment.m_blob.data();
+            size_t skip = (i == 0) ? m_output_sent : 0; // already sent
+            iov[iov_sz].iov_base = const_cast<char*>(base + skip);
+            iov[iov_sz].iov_len = segment.m_length - skip;
+            iov_sz++;
+        }
+
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = iov;
+        message.msg_iovlen = iov_sz;
+        ssize_t bytes_sent = sendmsg(m_fd, &message, MSG_NOSIGNAL);
+        if(bytes_sent == -1){
+            if(errno == EINTR) continue;
+            if(m_reactor != nullptr && (errno == EAGAIN || errno == EWOULDBLOCK)) return false; // the socket buffer is full
+            ERROR_ERRNO("send_response, connection error");
+        }
+
+        // remove the segments sent
+        uint64_t num_segments_sent = 0;
+        while(bytes_sent > 0){
+            size_t remaining = m_output[num_segments_sent].m_length - m_output_sent;
+            if(static_cast<size_t>(bytes_sent) >= remaining){
+                bytes_sent -= remaining;
+                num_segments_sent++;
+                m_output_sent = 0;
+            } else {
+                m_output_sent += bytes_sent;
+                bytes_sent = 0;
+            }
+        }
+        m_output.erase(m_output.begin(), m_output.begin() + num_segments_sent);
+    }
+
+    m_buffer_write_filled = 0;
+
+    // the response to TRANSPORT_SHM has been sent over TCP, continue over the shared memory channel
+    if(m_channel_pending != nullptr){
+        m_channel = m_channel_pending;
+        m_channel_pending = nullptr;
+    }
+
+    return true;
+}
+
+void Server::ConnectionHandler::reserve_input(size_t num_bytes){
+    if(num_bytes <= m_buffer_read_sz) return;
+    m_buffer_read_sz = pow(2, ceil(log2(num_bytes))); // next power of 2
+    COUT_DEBUG("Reallocate the internal read buffer to " << m_buffer_read_sz << " bytes");
+
+    // realloc() does not preserve the alignment
+    char* buffer = (char*) aligned_alloc(buffer_read_alignment, m_buffer_read_sz);
+    if(buffer == nullptr) ERROR("Cannot allocate the read buffer of " << m_buffer_read_sz << " bytes");
+    memcpy(buffer, m_buffer_read, m_buffer_read_filled);
+    free(m_buffer_read);
+    m_buffer_read = buffer;
+}
 
 library::Interface* Server::ConnectionHandler::interface(){
     return m_instance->m_interface.get();
@@ -19,6 +19,8 @@
 
 #include <atomic>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "message.hpp"
 
@@ -26,31 +28,78 @@ namespace gfe::library { class Interface; } // forward decl.
 
 namespace gfe::network {
 
+class SharedMemoryChannel; // forward decl.
+
 /**
  * This class bridges the remote requests (made by a client) and forwards them to a given library instance (library::Interface).
- * The communication client - server is synchronous:
+ * The communication client - server is request/response:
  * 1- The client makes a request, e.g. an action to perform on the graph.
  * 2- The server receives the request and invokes the related method in the library instance.
  * 3- The server sends the result back to the client.
  * 4- The client receives the response and resumes its execution.
  *
+ * Requests can be pipelined: a client can send multiple requests on the same connection before waiting for their
+ * responses. The requests of a connection are processed in order and each response carries the sequence number of its
+ * request.
+ *
+ * Bulk ingestion relies on streams: after STREAM_BEGIN, the client sends the updates in blocks with the same columnar
+ * layout of the graphlog (STREAM_UPDATES). The blocks are received in the read buffer of the connection, which is reused
+ * and kept aligned, and applied in place. The server grants a fixed number of credits, each block in flight consumes one
+ * credit and its response returns it to the client.
+ *
+ * Clients on the same host can move their connection to a shared memory channel with TRANSPORT_SHM: the requests and
+ * the responses are then exchanged through a pair of ring buffers in the segment created by the client, while the TCP
+ * connection is only kept open to detect when the client terminates. These connections are always served by a
+ * dedicated thread, also in the event driven mode.
+ *
+ * The server can operate in two modes:
+ * - thread per connection (num_reactors = 0): each connection is served by a dedicated thread, with blocking I/O.
+ * - event driven (num_reactors > 0): a fixed pool of reactor threads serves all connections with epoll. Each
+ *   reactor is responsible for the worker IDs w such that w % num_reactors == reactor ID: a connection is migrated to
+ *   its reactor when the client declares its worker ID with ON_THREAD_INIT. The library is invoked directly by the
+ *   reactors, therefore, with less reactors than client workers, it must tolerate multiple workers on the same thread.
+ *
  * The class is not thread safe.
  */
 class Server {
     std::shared_ptr<library::Interface> m_interface; // the interface we are serving
     const int m_port; // server port
+    const int m_num_reactors; // number of reactor threads in the event driven mode, 0 => one thread per connection
     int m_server_fd {-1}; // file descriptor used by the server to listen for connections
-    bool m_server_stop { false }; // flag to stop the server accepting connections
+    std::atomic<bool> m_server_stop { false }; // flag to stop the server accepting connections
     std::atomic<bool> m_terminate_on_last_connection { false }; // requested by the client, if true the server should terminate when there are no more connections active (e.g. the client terminated)
     std::atomic<int> m_num_active_connections = 0;
 
+    class Reactor; // forward decl.
+    std::vector<Reactor*> m_reactors; // the pool of reactors, in the event driven mode
+
+    // Streams of updates (STREAM_BEGIN, STREAM_UPDATES)
+    static constexpr uint64_t stream_max_block_size = (1ull << 20); // max number of updates in a block, the message must fit in 4 GB
+    static constexpr uint64_t stream_num_credits = 4; // max number of blocks a client can have in flight
+
     class ConnectionHandler {
+        friend class Reactor;
+
         Server* m_instance;
         int m_fd;
+        Reactor* m_reactor { nullptr }; // the reactor serving this connection, nullptr in the mode thread per connection
+        int m_worker_id { -1 }; // the worker ID declared by the client with ON_THREAD_INIT
         size_t m_buffer_read_sz = 4096, m_buffer_write_sz = 4096; // capacity of the internal buffers, in bytes
-        char* m_buffer_read; // read buffer (for requests)
+        char* m_buffer_read; // read buffer (for requests), aligned to a cache line
         char* m_buffer_write; // write buffer (for responses)
+        size_t m_buffer_read_filled = 0; // number of bytes received in the read buffer
+        size_t m_request_offset = 0; // offset of the request being processed in the read buffer
+        size_t m_buffer_write_filled = 0; // number of bytes of the responses queued in the write buffer
         bool m_terminate { false }; // flag to signal to terminate the handler
+        bool m_migrate { false }; // flag to move the connection to the reactor of m_worker_id
+        SharedMemoryChannel* m_channel { nullptr }; // if set, the requests and responses are exchanged over this channel rather than TCP
+        SharedMemoryChannel* m_channel_pending { nullptr }; // channel requested with TRANSPORT_SHM, activated once the response has been sent over TCP
+        uint32_t m_events { 0 }; // the events the reactor is polling for this connection
+
+        // The responses are sent with vectored writes, each segment is either a slice of the write buffer or an external blob
+        struct OutputSegment { size_t m_offset; size_t m_length; std::string m_blob; };
+        std::vector<OutputSegment> m_output; // segments still to send
+        size_t m_output_sent = 0; // number of bytes of the first segment already sent
 
         /**
          * Send the given response to the client
@@ -59,10 +108,25 @@ class Server {
         void response(ResponseType type, Args... args);
 
         /**
-         * Send the given message to the client
+         * Append the given data to the output of the connection
          */
-        void send_data(const char* raw_message); // assume that ((uint32_t*)(raw_message))[0] is the message_sz
         void send_data(const char* data, uint32_t data_sz);
+        void send_blob(std::string&& blob);
+
+        /**
+         * Reserve the given amount of bytes at the end of the write buffer
+         */
+        char* reserve_output(size_t num_bytes);
+
+        /**
+         * Append to the output the given amount of bytes, previously written in the space obtained with #reserve_output
+         */
+        void commit_output(size_t num_bytes);
+
+        /**
+         * Ensure the read buffer can store at least the given amount of bytes. The content already received is preserved.
+         */
+        void reserve_input(size_t num_bytes);
 
         /**
          * Retrieve the request being current processed
@@ -74,6 +138,34 @@ class Server {
          */
         void handle_request();
 
+        /**
+         * Process all the complete requests in the read buffer, until the connection needs to be terminated or migrated
+         */
+        void handle_pending_requests();
+
+        /**
+         * Send the queued responses. With non blocking I/O, it can send only part of them.
+         * @return true if all responses have been sent
+         */
+        bool flush();
+
+        /**
+         * Read exactly the given amount of bytes, from the shared memory channel or the blocking socket
+         * @return false if the connection was closed by the remote end before any byte could be read
+         */
+        bool receive_blocking(char* buffer, size_t num_bytes);
+
+        /**
+         * Receive the data available from a non blocking socket, in the event driven mode
+         * @return false if the connection has been closed by the remote end
+         */
+        bool receive();
+
+        /**
+         * Whether there are responses yet to send
+         */
+        bool has_pending_output() const;
+
         /**
          * The library we are evaluating
          */
@@ -88,19 +180,30 @@ class Server {
         ~ConnectionHandler();
 
         /**
-         * Handle all remote requests from the associated file descriptor
+         * Handle all remote requests from the associated file descriptor, in the mode thread per connection
          */
         void execute();
+
+        /**
+         * Process the requests one at the time with blocking I/O, until the client terminates the connection
+         */
+        void serve();
     };
     friend class ConnectionHandler;
 
+    /**
+     * Retrieve the reactor responsible for the given worker ID
+     */
+    Reactor* reactor_for(int worker_id) const;
+
 public:
     /**
      * Initialise the server and listen for connections from the given port
      * @param interface pass all requests to the given interface
      * @param port the port to listen for TCP connections
+     * @param num_reactors the number of reactor threads in the event driven mode, or 0 to serve each connection with a dedicated thread
      */
-    Server(std::shared_ptr<library::Interface> interface, int port);
+    Server(std::shared_ptr<library::Interface> interface, int port, int num_reactors = 0);
 
     /**
      * Destructor
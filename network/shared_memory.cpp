@@ -0,0 +1,313 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "shared_memory.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <memory>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "internal.hpp"
+
+using namespace std;
+
+namespace gfe::network {
+
+/*****************************************************************************
+ *                                                                           *
+ * Layout of the segment                                                     *
+ *                                                                           *
+ *****************************************************************************/
+
+static_assert(atomic<uint64_t>::is_always_lock_free && atomic<uint32_t>::is_always_lock_free, "Atomics shared between processes must be lock free");
+static_assert(sizeof(atomic<uint32_t>) == sizeof(uint32_t), "Futex words must be 32 bit integers");
+
+struct SharedMemoryChannel::Ring {
+    alignas(64) atomic<uint64_t> m_head; // total number of bytes read by the consumer
+    alignas(64) atomic<uint64_t> m_tail; // total number of bytes written by the producer
+    alignas(64) atomic<uint32_t> m_data_futex; // incremented by the producer to wake up the consumer
+    atomic<uint32_t> m_consumer_waiting; // whether the consumer is about to sleep on m_data_futex
+    alignas(64) atomic<uint32_t> m_space_futex; // incremented by the consumer to wake up the producer
+    atomic<uint32_t> m_producer_waiting; // whether the producer is about to sleep on m_space_futex
+};
+
+struct SharedMemoryChannel::Segment {
+    constexpr static uint64_t MAGIC = 0x6766652e73686d31; // gfe.shm1
+    uint64_t m_magic; // to validate the segment
+    uint64_t m_ring_capacity; // the capacity of each ring, in bytes
+    atomic<uint32_t> m_closed[2]; // whether the client (0) or the server (1) closed the channel
+    Ring m_rings[2]; // 0: client -> server, 1: server -> client
+
+    // the content of the rings follows the header, m_ring_capacity bytes each
+    char* buffer(int ring_id) { return reinterpret_cast<char*>(this) + sizeof(Segment) + ring_id * m_ring_capacity; }
+};
+
+static void cpu_relax(){
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+// The futex words are shared between processes, the operations cannot be FUTEX_PRIVATE_FLAG
+static void futex_wait(atomic<uint32_t>* futex, uint32_t expected_value, const struct timespec* timeout){
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(futex), FUTEX_WAIT, expected_value, timeout, nullptr, 0);
+}
+
+static void futex_wake(atomic<uint32_t>* futex){
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(futex), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+
+/*****************************************************************************
+ *                                                                           *
+ * Initialisation                                                            *
+ *                                                                           *
+ *****************************************************************************/
+
+SharedMemoryChannel::SharedMemoryChannel(const string& name, bool is_owner, int fd_liveness) : m_name(name), m_is_owner(is_owner), m_fd_liveness(fd_liveness) {
+
+}
+
+SharedMemoryChannel::~SharedMemoryChannel(){
+    if(m_segment != nullptr){
+        m_segment->m_closed[m_is_owner ? 0 : 1] = 1;
+        if(m_input != nullptr){ // wake up the other side, in case it is waiting
+            notify(m_input, /* consumer ? */ false);
+            notify(m_output, /* consumer ? */ true);
+        }
+        munmap(m_segment, m_segment_sz);
+        m_segment = nullptr;
+    }
+
+    unlink();
+}
+
+SharedMemoryChannel* SharedMemoryChannel::create(uint64_t ring_capacity, int fd_liveness){
+    if(ring_capacity == 0 || (ring_capacity & (ring_capacity -1)) != 0) INVALID_ARGUMENT("The capacity of the rings must be a power of 2: " << ring_capacity);
+
+    static atomic<uint64_t> next_segment_id { 0 };
+    string name = "/gfe.client." + to_string(getpid()) + "." + to_string(next_segment_id++);
+    unique_ptr<SharedMemoryChannel> channel { new SharedMemoryChannel(name, /* owner */ true, fd_liveness) };
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if(fd < 0) ERROR_ERRNO("Cannot create the shared memory segment `" << name << "'");
+    channel->m_is_linked = true;
+
+    size_t segment_sz = sizeof(Segment) + 2 * ring_capacity;
+    if(ftruncate(fd, segment_sz) != 0){
+        int error = errno;
+        close(fd);
+        errno = error;
+        ERROR_ERRNO("Cannot resize the shared memory segment `" << name << "' to " << segment_sz << " bytes");
+    }
+
+    try {
+        channel->map(fd, segment_sz, /* initialise */ true);
+    } catch(...){
+        close(fd);
+        throw;
+    }
+    close(fd); // the mapping is still valid
+
+    return channel.release();
+}
+
+SharedMemoryChannel* SharedMemoryChannel::open(const string& name, int fd_liveness){
+    unique_ptr<SharedMemoryChannel> channel { new SharedMemoryChannel(name, /* owner */ false, fd_liveness) };
+
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if(fd < 0) ERROR_ERRNO("Cannot open the shared memory segment `" << name << "'");
+
+    try {
+        struct stat properties;
+        if(fstat(fd, &properties) != 0) ERROR_ERRNO("Cannot retrieve the size of the shared memory segment `" << name << "'");
+        if(static_cast<size_t>(properties.st_size) < sizeof(Segment)) ERROR("Invalid shared memory segment `" << name << "', size: " << properties.st_size << " bytes");
+        channel->map(fd, properties.st_size, /* initialise */ false);
+    } catch(...){
+        close(fd);
+        throw;
+    }
+    close(fd);
+
+    return channel.release();
+}
+
+void SharedMemoryChannel::map(int fd, size_t segment_sz, bool initialise){
+    void* address = mmap(nullptr, segment_sz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(address == MAP_FAILED) ERROR_ERRNO("Cannot map the shared memory segment `" << m_name << "'");
+    m_segment = reinterpret_cast<Segment*>(address);
+    m_segment_sz = segment_sz;
+
+    if(initialise){ // the content is already zeroed by ftruncate
+        new (m_segment) Segment();
+        m_segment->m_magic = Segment::MAGIC;
+        m_segment->m_ring_capacity = (segment_sz - sizeof(Segment)) / 2;
+    } else if(m_segment->m_magic != Segment::MAGIC || sizeof(Segment) + 2 * m_segment->m_ring_capacity != segment_sz){
+        ERROR("Invalid shared memory segment `" << m_name << "'");
+    }
+
+    // the client writes in the ring 0, the server in the ring 1
+    int output_ring_id = m_is_owner ? 0 : 1;
+    m_output = m_segment->m_rings + output_ring_id;
+    m_output_buffer = m_segment->buffer(output_ring_id);
+    m_input = m_segment->m_rings + (1 - output_ring_id);
+    m_input_buffer = m_segment->buffer(1 - output_ring_id);
+}
+
+void SharedMemoryChannel::unlink(){
+    if(m_is_owner && m_is_linked){
+        shm_unlink(m_name.c_str()); // ignore rc
+        m_is_linked = false;
+    }
+}
+
+/*****************************************************************************
+ *                                                                           *
+ * Synchronisation                                                           *
+ *                                                                           *
+ *****************************************************************************/
+
+bool SharedMemoryChannel::is_peer_closed() const {
+    if(m_segment->m_closed[m_is_owner ? 1 : 0]) return true;
+
+    // the process of the other side may have terminated without closing the channel
+    struct pollfd descriptor;
+    descriptor.fd = m_fd_liveness;
+    descriptor.events = POLLRDHUP;
+    descriptor.revents = 0;
+    return poll(&descriptor, 1, /* do not wait */ 0) > 0 && (descriptor.revents & (POLLRDHUP | POLLHUP | POLLERR | POLLNVAL));
+}
+
+template<typename Condition>
+bool SharedMemoryChannel::wait(Ring* ring, bool wait_for_data, Condition condition){
+    // first spin for a while, the other side is likely to be active
+    constexpr uint64_t num_spins = 1ull << 10;
+    for(uint64_t i = 0; i < num_spins; i++){
+        if(condition()) return true;
+        cpu_relax();
+    }
+
+    atomic<uint32_t>& futex = wait_for_data ? ring->m_data_futex : ring->m_space_futex;
+    atomic<uint32_t>& waiting = wait_for_data ? ring->m_consumer_waiting : ring->m_producer_waiting;
+    while(true){
+        uint32_t value = futex.load();
+        waiting.store(1);
+        atomic_thread_fence(memory_order_seq_cst); // pairs with the fence in #notify
+        if(condition()){
+            waiting.store(0);
+            return true;
+        } else if(is_peer_closed()){
+            waiting.store(0);
+            return condition();
+        }
+
+        // the other side increments the futex word before waking us up, wake up periodically to check whether it is still alive
+        struct timespec timeout { 0, 100'000'000 }; // 100 ms
+        futex_wait(&futex, value, &timeout);
+        waiting.store(0);
+        if(condition()) return true;
+    }
+}
+
+void SharedMemoryChannel::notify(Ring* ring, bool wake_up_consumer){
+    atomic<uint32_t>& futex = wake_up_consumer ? ring->m_data_futex : ring->m_space_futex;
+    atomic<uint32_t>& waiting = wake_up_consumer ? ring->m_consumer_waiting : ring->m_producer_waiting;
+
+    atomic_thread_fence(memory_order_seq_cst); // pairs with the fence in #wait
+    if(waiting.load(memory_order_relaxed)){
+        futex++;
+        futex_wake(&futex);
+    }
+}
+
+/*****************************************************************************
+ *                                                                           *
+ * Send & receive                                                            *
+ *                                                                           *
+ *****************************************************************************/
+
+void SharedMemoryChannel::send(const void* data, size_t num_bytes){
+    const char* source = reinterpret_cast<const char*>(data);
+    const uint64_t capacity = m_segment->m_ring_capacity;
+    uint64_t tail = m_output->m_tail.load(memory_order_relaxed); // only altered by this side
+    size_t num_bytes_sent = 0;
+
+    while(num_bytes_sent < num_bytes){
+        uint64_t space = capacity - (tail - m_output->m_head.load(memory_order_acquire));
+        if(space == 0){ // the ring is full
+            bool has_space = wait(m_output, /* data ? */ false, [&](){ return m_output->m_head.load(memory_order_acquire) + capacity != tail; });
+            if(!has_space) ERROR("Cannot send the data, the shared memory channel has been closed by the other side");
+            continue;
+        }
+
+        // the chunk may wrap around the end of the ring
+        size_t chunk_sz = std::min<uint64_t>(space, num_bytes - num_bytes_sent);
+        uint64_t offset = tail & (capacity -1);
+        size_t chunk1_sz = std::min<uint64_t>(chunk_sz, capacity - offset);
+        memcpy(m_output_buffer + offset, source + num_bytes_sent, chunk1_sz);
+        memcpy(m_output_buffer, source + num_bytes_sent + chunk1_sz, chunk_sz - chunk1_sz);
+
+        tail += chunk_sz;
+        num_bytes_sent += chunk_sz;
+        m_output->m_tail.store(tail, memory_order_release);
+        notify(m_output, /* consumer ? */ true);
+    }
+}
+
+bool SharedMemoryChannel::receive(void* buffer, size_t num_bytes){
+    char* destination = reinterpret_cast<char*>(buffer);
+    const uint64_t capacity = m_segment->m_ring_capacity;
+    uint64_t head = m_input->m_head.load(memory_order_relaxed); // only altered by this side
+    size_t num_bytes_read = 0;
+
+    while(num_bytes_read < num_bytes){
+        uint64_t tail = m_input->m_tail.load(memory_order_acquire);
+        if(tail == head){ // the ring is empty
+            bool has_data = wait(m_input, /* data ? */ true, [&](){ return m_input->m_tail.load(memory_order_acquire) != head; });
+            if(!has_data){
+                if(num_bytes_read == 0) return false;
+                ERROR("Shared memory channel closed by the other side, only able to read " << num_bytes_read << " out of " << num_bytes << " bytes");
+            }
+            continue;
+        }
+
+        size_t chunk_sz = std::min<uint64_t>(tail - head, num_bytes - num_bytes_read);
+        uint64_t offset = head & (capacity -1);
+        size_t chunk1_sz = std::min<uint64_t>(chunk_sz, capacity - offset);
+        memcpy(destination + num_bytes_read, m_input_buffer + offset, chunk1_sz);
+        memcpy(destination + num_bytes_read + chunk1_sz, m_input_buffer, chunk_sz - chunk1_sz);
+
+        head += chunk_sz;
+        num_bytes_read += chunk_sz;
+        m_input->m_head.store(head, memory_order_release);
+        notify(m_input, /* consumer ? */ false);
+    }
+
+    return true;
+}
+
+} // namespace
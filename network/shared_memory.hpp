@@ -0,0 +1,116 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <string>
+
+namespace gfe::network {
+
+/**
+ * A bidirectional channel between a client and a server on the same host, over a segment of shared memory.
+ *
+ * The segment contains two lock-free ring buffers, single producer & single consumer, one for each direction. The
+ * content of the rings is a stream of bytes, as for a socket, therefore messages larger than the capacity of a ring are
+ * transferred in multiple chunks. A side waiting for data (or for space, if the ring is full) spins for a short while,
+ * then it sleeps on a futex, woken up by the other side.
+ *
+ * The segment is created by the client, with a unique name, and attached by the server with #open. The TCP connection
+ * used to exchange the name of the segment is kept open, only to detect when the other side terminates abruptly.
+ *
+ * The class is not thread safe: each side must be accessed by a single thread at the time.
+ */
+class SharedMemoryChannel {
+    SharedMemoryChannel(const SharedMemoryChannel&) = delete;
+    SharedMemoryChannel& operator=(const SharedMemoryChannel&) = delete;
+
+    struct Segment; // forward decl.
+    struct Ring; // forward decl.
+
+    std::string m_name; // name of the segment, as for shm_open
+    const bool m_is_owner; // whether this side created the segment
+    bool m_is_linked { false }; // whether the name of the segment has not been removed yet, only for the owner
+    const int m_fd_liveness; // file descriptor of the TCP connection with the other side, to check whether it is still alive
+    Segment* m_segment { nullptr }; // the mapped segment
+    size_t m_segment_sz { 0 }; // size of the mapped segment, in bytes
+    Ring* m_input { nullptr }; // ring to receive the data from the other side
+    char* m_input_buffer { nullptr }; // content of the input ring
+    Ring* m_output { nullptr }; // ring to send the data to the other side
+    char* m_output_buffer { nullptr }; // content of the output ring
+
+    // Internal ctor
+    SharedMemoryChannel(const std::string& name, bool is_owner, int fd_liveness);
+
+    // Map the segment from the given descriptor and set the input & output rings for this side
+    void map(int fd, size_t segment_sz, bool initialise);
+
+    // Wait until the given condition holds, the other side has closed the channel, or it has terminated
+    template<typename Condition>
+    bool wait(Ring* ring, bool wait_for_data, Condition condition);
+
+    // Wake up the other side, if it is waiting on the given ring
+    void notify(Ring* ring, bool wake_up_consumer);
+
+    // Check whether the other side has closed the channel or its process terminated
+    bool is_peer_closed() const;
+
+public:
+    /**
+     * Create a new segment, on the client side
+     * @param ring_capacity the capacity of each ring, in bytes. It must be a power of 2.
+     * @param fd_liveness the file descriptor of the TCP connection with the server
+     */
+    static SharedMemoryChannel* create(uint64_t ring_capacity, int fd_liveness);
+
+    /**
+     * Attach to the segment with the given name, on the server side
+     * @param name the name of the segment, as retrieved by the client with #name()
+     * @param fd_liveness the file descriptor of the TCP connection with the client
+     */
+    static SharedMemoryChannel* open(const std::string& name, int fd_liveness);
+
+    /**
+     * Close the channel, the other side is notified
+     */
+    ~SharedMemoryChannel();
+
+    /**
+     * The name of the segment
+     */
+    const std::string& name() const { return m_name; }
+
+    /**
+     * Remove the name of the segment. The segment is still valid for the sides that already attached to it.
+     */
+    void unlink();
+
+    /**
+     * Send the given data to the other side. Block until all data has been written in the ring.
+     */
+    void send(const void* data, size_t num_bytes);
+
+    /**
+     * Receive exactly the given amount of bytes. Block until all data has been read.
+     * @return false if the channel was closed by the other side before any byte could be read
+     */
+    bool receive(void* buffer, size_t num_bytes);
+};
+
+} // namespace
@@ -0,0 +1,288 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "graphlog_cache.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+#undef CURRENT_ERROR_TYPE
+#define CURRENT_ERROR_TYPE ::gfe::reader::ReaderError
+
+namespace gfe::reader::graphlog {
+
+/*****************************************************************************
+ *                                                                           *
+ *  Debug                                                                    *
+ *                                                                           *
+ *****************************************************************************/
+//#define DEBUG
+#define COUT_DEBUG_FORCE(msg) { std::cout << "[Graphlog::" << __FUNCTION__ << "] " << msg << std::endl; }
+#if defined(DEBUG)
+    #define COUT_DEBUG(msg) COUT_DEBUG_FORCE(msg)
+#else
+    #define COUT_DEBUG(msg)
+#endif
+
+/*****************************************************************************
+ *                                                                           *
+ *  Format                                                                   *
+ *                                                                           *
+ *****************************************************************************/
+struct CacheHeader {
+    char m_magic[8]; // GLCACHE1
+    uint64_t m_version; // 1
+    uint64_t m_graphlog_size; // the size of the original graphlog, to detect stale caches
+    uint64_t m_file_size; // the size of the cache file, to detect truncated caches
+    uint64_t m_properties_offset; // offset of the properties, as plain text
+    uint64_t m_properties_length; // length of the properties, in bytes
+    uint64_t m_vertices_final_offset; // offset of the array of final vertices
+    uint64_t m_vertices_final_cardinality; // number of final vertices
+    uint64_t m_vertices_temporary_offset; // offset of the array of temporary vertices
+    uint64_t m_vertices_temporary_cardinality; // number of temporary vertices
+    uint64_t m_directory_offset; // offset of the directory of the blocks
+    uint64_t m_num_blocks; // number of blocks of edges
+};
+
+namespace {
+constexpr char CACHE_MAGIC[8] = { 'G', 'L', 'C', 'A', 'C', 'H', 'E', '1' };
+constexpr uint64_t CACHE_VERSION = 1;
+constexpr uint64_t CACHE_ALIGNMENT = 4096; // all sections start at a page boundary
+static_assert(sizeof(CacheHeader) <= CACHE_ALIGNMENT);
+
+uint64_t get_file_size(const std::string& path){
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0) ERROR("Cannot stat the file `" << path << "': " << strerror(errno));
+    return st.st_size;
+}
+
+// Append the given content to the output file, return the offset where the content was written
+uint64_t append(fstream& handle, const void* content, uint64_t length){
+    uint64_t offset = handle.tellp();
+    assert(offset % CACHE_ALIGNMENT == 0 && "Sections should start at a page boundary");
+    handle.write((const char*) content, length);
+    if(length % CACHE_ALIGNMENT != 0){ // pad to the next page
+        static const char padding[CACHE_ALIGNMENT] = {0};
+        handle.write(padding, CACHE_ALIGNMENT - (length % CACHE_ALIGNMENT));
+    }
+    if(!handle.good()) ERROR("Cannot write the cache file");
+    return offset;
+}
+} // anon namespace
+
+/*****************************************************************************
+ *                                                                           *
+ *  Cache                                                                    *
+ *                                                                           *
+ *****************************************************************************/
+Cache::Cache(const std::string& path_cache) : m_path(path_cache) {
+    int fd = ::open(m_path.c_str(), O_RDONLY);
+    if(fd < 0) ERROR("Cannot open the file `" << m_path << "': " << strerror(errno));
+    m_mapping_sz = get_file_size(m_path);
+    if(m_mapping_sz < CACHE_ALIGNMENT){ ::close(fd); ERROR("Invalid cache file, too small: " << m_path); }
+    m_mapping = ::mmap(nullptr, m_mapping_sz, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps its own reference to the file
+    if(m_mapping == MAP_FAILED){ m_mapping = nullptr; ERROR("Cannot memory map the file `" << m_path << "': " << strerror(errno)); }
+
+    const CacheHeader* hdr = header();
+    if(memcmp(hdr->m_magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || hdr->m_version != CACHE_VERSION){
+        ERROR("Invalid cache file: " << m_path);
+    }
+    if(hdr->m_file_size != m_mapping_sz){
+        ERROR("Truncated cache file: " << m_path << ", expected size: " << hdr->m_file_size << " bytes, actual size: " << m_mapping_sz << " bytes");
+    }
+
+    // properties
+    string line;
+    stringstream ss { string{ reinterpret_cast<const char*>(m_mapping) + hdr->m_properties_offset, hdr->m_properties_length } };
+    while(getline(ss, line)){
+        auto pos = line.find(" = ");
+        if(pos == string::npos) continue;
+        m_properties[line.substr(0, pos)] = line.substr(pos + 3);
+    }
+
+    // blocks
+    m_num_blocks = hdr->m_num_blocks;
+    m_directory = reinterpret_cast<const uint64_t*>(reinterpret_cast<const char*>(m_mapping) + hdr->m_directory_offset);
+}
+
+Cache::~Cache(){
+    if(m_mapping != nullptr){
+        ::munmap(m_mapping, m_mapping_sz);
+        m_mapping = nullptr;
+    }
+}
+
+const CacheHeader* Cache::header() const {
+    return reinterpret_cast<const CacheHeader*>(m_mapping);
+}
+
+string Cache::default_path(const std::string& path_graphlog){
+    return path_graphlog + ".cache";
+}
+
+unique_ptr<Cache> Cache::open(const std::string& path_graphlog){
+    string path_cache = default_path(path_graphlog);
+    struct stat st;
+    if(stat(path_cache.c_str(), &st) != 0) return nullptr; // the cache does not exist
+
+    unique_ptr<Cache> cache { new Cache(path_cache) };
+    if(cache->header()->m_graphlog_size != get_file_size(path_graphlog)){
+        COUT_DEBUG("Stale cache file: " << path_cache);
+        return nullptr;
+    }
+
+    return cache;
+}
+
+const uint64_t* Cache::block(uint64_t block_id, uint64_t* out_num_edges) const {
+    if(block_id >= m_num_blocks) INVALID_ARGUMENT("Invalid block_id: " << block_id << ", num blocks: " << m_num_blocks);
+    const uint64_t offset = m_directory[2 * block_id];
+    if(out_num_edges != nullptr) *out_num_edges = m_directory[2 * block_id +1];
+    return reinterpret_cast<const uint64_t*>(reinterpret_cast<const char*>(m_mapping) + offset);
+}
+
+void Cache::prefetch(uint64_t block_id) const {
+    if(block_id >= m_num_blocks) return;
+    const uint64_t offset = m_directory[2 * block_id];
+    const uint64_t length = m_directory[2 * block_id +1] * 3 * sizeof(uint64_t);
+    ::madvise(reinterpret_cast<char*>(m_mapping) + offset, length, MADV_WILLNEED); // it is only an hint, ignore failures
+}
+
+const uint64_t* Cache::vertices_final(uint64_t* out_num_vertices) const {
+    if(out_num_vertices != nullptr) *out_num_vertices = header()->m_vertices_final_cardinality;
+    return reinterpret_cast<const uint64_t*>(reinterpret_cast<const char*>(m_mapping) + header()->m_vertices_final_offset);
+}
+
+const uint64_t* Cache::vertices_temporary(uint64_t* out_num_vertices) const {
+    if(out_num_vertices != nullptr) *out_num_vertices = header()->m_vertices_temporary_cardinality;
+    return reinterpret_cast<const uint64_t*>(reinterpret_cast<const char*>(m_mapping) + header()->m_vertices_temporary_offset);
+}
+
+void Cache::create(const std::string& path_graphlog, const std::string& path_cache, uint64_t num_threads){
+    Properties properties = parse_properties(path_graphlog);
+    const uint64_t block_size = stoull(properties["internal.edges.block_size"]); // bytes
+
+    string path_tmp = path_cache + "." + to_string(::getpid()); // write & rename, do not leave partial caches around
+    fstream handle{path_tmp, ios_base::out | ios_base::binary | ios_base::trunc};
+    if(!handle.good()) ERROR("Cannot create the file: " << path_tmp);
+
+    try {
+        CacheHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.m_magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.m_version = CACHE_VERSION;
+        header.m_graphlog_size = get_file_size(path_graphlog);
+        append(handle, &header, sizeof(header)); // placeholder, rewritten at the end
+
+        // properties
+        stringstream ss;
+        for(auto& p : properties){ ss << p.first << " = " << p.second << "\n"; }
+        string str_properties = ss.str();
+        header.m_properties_offset = append(handle, str_properties.data(), str_properties.size());
+        header.m_properties_length = str_properties.size();
+
+        // vertices
+        vector<uint64_t> vertices_final, vertices_temporary;
+        load_vertices(path_graphlog, vertices_final, vertices_temporary);
+        header.m_vertices_final_offset = append(handle, vertices_final.data(), vertices_final.size() * sizeof(uint64_t));
+        header.m_vertices_final_cardinality = vertices_final.size();
+        header.m_vertices_temporary_offset = append(handle, vertices_temporary.data(), vertices_temporary.size() * sizeof(uint64_t));
+        header.m_vertices_temporary_cardinality = vertices_temporary.size();
+
+        // edges
+        vector<uint64_t> directory;
+        unique_ptr<uint64_t[]> ptr_array { new uint64_t[block_size / sizeof(uint64_t)] };
+        uint64_t* array = ptr_array.get();
+        ParallelEdgeLoader loader(path_graphlog, num_threads);
+        uint64_t num_edges = 0;
+        while( (num_edges = loader.load(array, block_size / (3 * sizeof(uint64_t)))) > 0 ){
+            directory.push_back(append(handle, array, num_edges * 3 * sizeof(uint64_t)));
+            directory.push_back(num_edges);
+        }
+        header.m_num_blocks = directory.size() / 2;
+        header.m_directory_offset = append(handle, directory.data(), directory.size() * sizeof(uint64_t));
+        header.m_file_size = handle.tellp();
+
+        // finalise the header
+        handle.seekp(0);
+        handle.write((const char*) &header, sizeof(header));
+        if(!handle.good()) ERROR("Cannot write the cache file: " << path_tmp);
+        handle.close();
+    } catch (...){
+        handle.close();
+        ::unlink(path_tmp.c_str());
+        throw;
+    }
+
+    if(::rename(path_tmp.c_str(), path_cache.c_str()) != 0){
+        int rc = errno;
+        ::unlink(path_tmp.c_str());
+        ERROR("Cannot rename `" << path_tmp << "' into `" << path_cache << "': " << strerror(rc));
+    }
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  EdgeBlockSource                                                          *
+ *                                                                           *
+ *****************************************************************************/
+EdgeBlockSource::EdgeBlockSource(const std::string& path_graphlog, uint64_t num_threads) : m_cache(Cache::open(path_graphlog)) {
+    if(m_cache.get() != nullptr){
+        m_cache->prefetch(0);
+    } else {
+        Properties properties = parse_properties(path_graphlog);
+        m_buffer_capacity = stoull(properties["internal.edges.block_size"]) / (3 * sizeof(uint64_t));
+        m_buffer.reset(new uint64_t[3 * m_buffer_capacity]);
+        m_loader.reset(new ParallelEdgeLoader(path_graphlog, num_threads));
+    }
+}
+
+EdgeBlockSource::~EdgeBlockSource(){ }
+
+const uint64_t* EdgeBlockSource::next(uint64_t* out_num_edges){
+    uint64_t num_edges = 0;
+    const uint64_t* block = nullptr;
+
+    if(m_cache.get() != nullptr){
+        if(m_next_block < m_cache->num_blocks()){
+            block = m_cache->block(m_next_block, &num_edges);
+            m_next_block++;
+            m_cache->prefetch(m_next_block);
+        }
+    } else {
+        num_edges = m_loader->load(m_buffer.get(), m_buffer_capacity);
+        if(num_edges > 0){ block = m_buffer.get(); }
+    }
+
+    if(out_num_edges != nullptr) *out_num_edges = num_edges;
+    return block;
+}
+
+} // namespace
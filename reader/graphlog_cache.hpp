@@ -0,0 +1,120 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "graphlog_reader.hpp"
+
+namespace gfe::reader::graphlog {
+
+/**
+ * A pre-decoded copy of a graphlog, to be created once with the tool `graphlog_cache' and then memory mapped by
+ * each run, without inflating the log again. The cache consists of:
+ * 1- A header of one page, with the size of the original graphlog (to detect stale caches) and the offsets of the
+ *    other sections in the file;
+ * 2- The properties of the graphlog, in the same plain format `key = value' of the original log;
+ * 3- The final and the temporary vertices, as two arrays of uint64_t;
+ * 4- The blocks of the edges, each one with the same columnar layout returned by EdgeLoader#load, that is the
+ *    sources, the destinations and the weights of the edges in the block;
+ * 5- The directory of the blocks, that is the offset and the number of edges of each block.
+ * All sections start at a page boundary. The file is mapped shared and read only, so that the decoded pages are shared
+ * through the page cache among concurrent runs on the same log.
+ */
+class Cache {
+    Cache(const Cache&) = delete;
+    Cache& operator=(const Cache&) = delete;
+
+    const std::string m_path; // path to the cache file
+    void* m_mapping = nullptr; // start of the memory mapping
+    uint64_t m_mapping_sz = 0; // size of the memory mapping, in bytes
+    Properties m_properties; // the properties of the original graphlog
+    const uint64_t* m_directory = nullptr; // pairs <offset, num_edges> for each block
+    uint64_t m_num_blocks = 0; // total number of blocks
+
+    // Retrieve the header of the cache file
+    const struct CacheHeader* header() const;
+
+public:
+    // Memory map the given cache file
+    Cache(const std::string& path_cache);
+
+    // Destructor
+    ~Cache();
+
+    // Convert the given graphlog into a cache file. The blocks of the log are decompressed with `num_threads' threads.
+    static void create(const std::string& path_graphlog, const std::string& path_cache, uint64_t num_threads = 1);
+
+    // The default path of the cache for the given graphlog, that is `<path_graphlog>.cache'
+    static std::string default_path(const std::string& path_graphlog);
+
+    // Open the cache at the default path of the given graphlog. Return nullptr if the cache does not exist or it is stale.
+    static std::unique_ptr<Cache> open(const std::string& path_graphlog);
+
+    // The properties of the original graphlog
+    const Properties& properties() const { return m_properties; }
+
+    // Total number of blocks of edges
+    uint64_t num_blocks() const { return m_num_blocks; }
+
+    // Retrieve the given block of edges, with the same columnar layout of EdgeLoader#load
+    const uint64_t* block(uint64_t block_id, uint64_t* out_num_edges) const;
+
+    // Hint the kernel to start reading the given block
+    void prefetch(uint64_t block_id) const;
+
+    // Retrieve the final vertices of the graph
+    const uint64_t* vertices_final(uint64_t* out_num_vertices) const;
+
+    // Retrieve the temporary vertices of the graph
+    const uint64_t* vertices_temporary(uint64_t* out_num_vertices) const;
+};
+
+/**
+ * Hand out whole blocks of edges, either without copies from the cache of the log, when present, or by decompressing
+ * the log with a ParallelEdgeLoader.
+ */
+class EdgeBlockSource {
+    EdgeBlockSource(const EdgeBlockSource&) = delete;
+    EdgeBlockSource& operator=(const EdgeBlockSource&) = delete;
+
+    std::unique_ptr<Cache> m_cache; // the cache of the log, if present
+    uint64_t m_next_block = 0; // next block to retrieve from the cache
+    std::unique_ptr<ParallelEdgeLoader> m_loader; // otherwise, decompress the blocks of the log
+    std::unique_ptr<uint64_t[]> m_buffer; // where the blocks are decompressed
+    uint64_t m_buffer_capacity = 0; // max number of edges that can be stored in m_buffer
+
+public:
+    // Initialise the source for the given graphlog. `num_threads' is the number of threads to decompress the log when the cache is not present.
+    EdgeBlockSource(const std::string& path_graphlog, uint64_t num_threads = 1);
+
+    // Destructor
+    ~EdgeBlockSource();
+
+    // Retrieve the next block of edges, in columnar layout: sources, destinations and weights. The block is valid until the
+    // next invocation of this method. Return nullptr when the log has been depleted.
+    const uint64_t* next(uint64_t* out_num_edges);
+
+    // Whether the blocks are read from the cache of the log
+    bool is_cached() const { return m_cache.get() != nullptr; }
+};
+
+} // namespace
@@ -18,12 +18,16 @@
 #include "graphlog_reader.hpp"
 
 #include <cassert>
+#include <cerrno>
 #include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
 #include <regex>
 #include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "zlib.h"
 
 #include "common/filesystem.hpp"
@@ -203,6 +207,42 @@ uint64_t VertexLoader::load(uint64_t* array, uint64_t array_sz){
     return num_elements_loaded;
 }
 
+void load_vertices(const std::string& path_graphlog, std::vector<uint64_t>& out_final, std::vector<uint64_t>& out_temporary){
+    Properties properties = parse_properties(path_graphlog);
+    out_final.resize(stoull(properties["internal.vertices.final.cardinality"]));
+    out_temporary.resize(stoull(properties["internal.vertices.temporary.cardinality"]));
+
+    // each section is a single zlib stream, decompress both of them concurrently with their own handle & zstream
+    auto load_section = [&path_graphlog, &properties](Section section, std::vector<uint64_t>& vertices){
+        fstream handle{path_graphlog, ios_base::in | ios_base::binary};
+        if(!handle.good()) ERROR("Cannot open the file: " << path_graphlog);
+        set_marker(properties, handle, section);
+        VertexLoader loader { handle };
+        uint64_t num_vertices = 0, num_loaded = 0;
+        while(num_vertices < vertices.size() && (num_loaded = loader.load(vertices.data() + num_vertices, vertices.size() - num_vertices)) > 0){
+            num_vertices += num_loaded;
+        }
+        if(num_vertices != vertices.size()) ERROR("Vertices loaded: " << num_vertices << ", expected: " << vertices.size());
+    };
+
+    std::exception_ptr error_temporary;
+    std::thread thread_temporary { [&](){
+        try {
+            load_section(Section::VTX_TEMP, out_temporary);
+        } catch(...) {
+            error_temporary = std::current_exception();
+        }
+    }};
+    try {
+        load_section(Section::VTX_FINAL, out_final);
+    } catch(...){
+        thread_temporary.join();
+        throw;
+    }
+    thread_temporary.join();
+    if(error_temporary){ std::rethrow_exception(error_temporary); }
+}
+
 } // namespace
 
 /*****************************************************************************
@@ -315,6 +355,234 @@ uint64_t EdgeLoader::load(uint64_t* array, uint64_t num_edges){
 
 }
 
+/*****************************************************************************
+ *                                                                           *
+ *  ParallelEdgeLoader                                                       *
+ *                                                                           *
+ *****************************************************************************/
+
+namespace graphlog {
+
+namespace {
+struct BlockOffsetsHeader { // header of the sidecar file
+    char m_magic[8]; // GLBLOCKS
+    uint64_t m_version; // 1
+    uint64_t m_file_size; // the size of the graphlog, to detect stale sidecar files
+    uint64_t m_num_offsets; // the number of offsets that follow the header
+};
+constexpr char BLOCK_OFFSETS_MAGIC[8] = { 'G', 'L', 'B', 'L', 'O', 'C', 'K', 'S' };
+constexpr uint64_t BLOCK_OFFSETS_VERSION = 1;
+
+uint64_t get_file_size(const std::string& path){
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0) ERROR("Cannot stat the file `" << path << "': " << strerror(errno));
+    return st.st_size;
+}
+} // anon namespace
+
+ParallelEdgeLoader::ParallelEdgeLoader(const std::string& path_graphlog, uint64_t num_threads) : m_path(path_graphlog) {
+    Properties properties = parse_properties(path_graphlog);
+    m_block_size = stoull(properties["internal.edges.block_size"]);
+    if(m_block_size % (3 * sizeof(uint64_t)) != 0) ERROR("Invalid block size: " << m_block_size);
+    uint64_t edges_begin = stoull(properties["internal.edges.begin"]);
+
+    if(num_threads > 1 && read_block_offsets(edges_begin)){ // parallel mode
+        m_fd = ::open(m_path.c_str(), O_RDONLY);
+        if(m_fd < 0) ERROR("Cannot open the file `" << m_path << "': " << strerror(errno));
+
+        m_slots.resize(2 * num_threads);
+        for(auto& slot : m_slots){ slot.m_buffer.reset(new uint64_t[m_block_size / sizeof(uint64_t)]); }
+        m_threads.reserve(num_threads);
+        for(uint64_t i = 0; i < num_threads; i++){
+            m_threads.emplace_back(&ParallelEdgeLoader::main_thread, this);
+        }
+    } else { // sequential mode
+        m_handle.open(m_path, ios_base::in | ios_base::binary);
+        if(!m_handle.good()) ERROR("Cannot open the file: " << m_path);
+        set_marker(properties, m_handle, Section::EDGES);
+        m_sequential_loader.reset(new EdgeLoader(m_handle));
+        if(num_threads > 1){ // record the boundaries of the blocks for the next runs
+            m_block_offsets.clear();
+            m_block_offsets.push_back(edges_begin);
+        }
+    }
+}
+
+ParallelEdgeLoader::~ParallelEdgeLoader(){
+    { // stop the background threads
+        scoped_lock<mutex> lock(m_mutex);
+        m_terminate = true;
+    }
+    m_condvar.notify_all();
+    for(auto& t : m_threads){ t.join(); }
+    m_threads.clear();
+
+    if(m_fd >= 0){ ::close(m_fd); m_fd = -1; }
+    m_sequential_loader.reset();
+    if(m_handle.is_open()){ m_handle.close(); }
+}
+
+string ParallelEdgeLoader::path_block_offsets() const {
+    return m_path + ".blocks";
+}
+
+bool ParallelEdgeLoader::read_block_offsets(uint64_t edges_begin){
+    fstream handle{path_block_offsets(), ios_base::in | ios_base::binary};
+    if(!handle.good()) return false;
+
+    BlockOffsetsHeader header;
+    handle.read((char*) &header, sizeof(header));
+    if(!handle.good() || memcmp(header.m_magic, BLOCK_OFFSETS_MAGIC, sizeof(BLOCK_OFFSETS_MAGIC)) != 0 || header.m_version != BLOCK_OFFSETS_VERSION){
+        COUT_DEBUG("Invalid sidecar file: " << path_block_offsets());
+        return false;
+    }
+    if(header.m_file_size != get_file_size(m_path) || header.m_num_offsets == 0){
+        COUT_DEBUG("Stale sidecar file: " << path_block_offsets());
+        return false;
+    }
+
+    m_block_offsets.resize(header.m_num_offsets);
+    handle.read((char*) m_block_offsets.data(), header.m_num_offsets * sizeof(uint64_t));
+    if(!handle.good() || m_block_offsets[0] != edges_begin){
+        m_block_offsets.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void ParallelEdgeLoader::write_block_offsets() const {
+    string path = path_block_offsets();
+    string path_tmp = path + "." + to_string(::getpid()); // write & rename, in case multiple processes are racing to create the same file
+    fstream handle{path_tmp, ios_base::out | ios_base::binary | ios_base::trunc};
+    if(!handle.good()) return; // e.g. read only directory
+
+    BlockOffsetsHeader header;
+    memcpy(header.m_magic, BLOCK_OFFSETS_MAGIC, sizeof(BLOCK_OFFSETS_MAGIC));
+    header.m_version = BLOCK_OFFSETS_VERSION;
+    header.m_file_size = get_file_size(m_path);
+    header.m_num_offsets = m_block_offsets.size();
+    handle.write((const char*) &header, sizeof(header));
+    handle.write((const char*) m_block_offsets.data(), m_block_offsets.size() * sizeof(uint64_t));
+    bool success = handle.good();
+    handle.close();
+
+    if(!success || ::rename(path_tmp.c_str(), path.c_str()) != 0){
+        ::unlink(path_tmp.c_str());
+    }
+}
+
+uint64_t ParallelEdgeLoader::load(uint64_t* array, uint64_t num_edges){
+    if(array == nullptr) INVALID_ARGUMENT("The argument `array' is null");
+    if(m_sequential_loader) return load_sequential(array, num_edges);
+
+    const uint64_t num_blocks = m_block_offsets.size() - 1;
+    unique_lock<mutex> lock(m_mutex);
+    if(m_next_block_load >= num_blocks) return 0; // depleted
+    Slot& slot = m_slots[m_next_block_load % m_slots.size()];
+    m_condvar.wait(lock, [&slot](){ return slot.m_ready; });
+    if(slot.m_error){ std::rethrow_exception(slot.m_error); }
+    if(slot.m_num_edges > num_edges) return 0; // the array is not big enough
+
+    uint64_t num_edges_loaded = slot.m_num_edges;
+    memcpy(array, slot.m_buffer.get(), num_edges_loaded * 3 * sizeof(uint64_t));
+    slot.m_ready = false;
+    slot.m_num_edges = 0;
+    m_next_block_load++;
+    lock.unlock();
+    m_condvar.notify_all(); // the slot is available again
+
+    return num_edges_loaded;
+}
+
+uint64_t ParallelEdgeLoader::load_sequential(uint64_t* array, uint64_t num_edges){
+    uint64_t num_edges_loaded = m_sequential_loader->load(array, num_edges);
+
+    if(!m_block_offsets.empty()){ // record the boundaries of the blocks
+        if(num_edges_loaded > 0){
+            m_block_offsets.push_back(m_handle.tellg());
+        } else if(num_edges >= m_block_size / (3 * sizeof(uint64_t))){ // depleted
+            write_block_offsets();
+            m_block_offsets.clear();
+        }
+    }
+
+    return num_edges_loaded;
+}
+
+void ParallelEdgeLoader::main_thread(){
+    const uint64_t num_blocks = m_block_offsets.size() - 1;
+    vector<uint8_t> input; // compressed content of the block
+    z_stream zstream;
+    zstream.zalloc = Z_NULL;
+    zstream.zfree = Z_NULL;
+    zstream.opaque = Z_NULL;
+    zstream.avail_in = 0;
+    zstream.next_in = Z_NULL;
+    int rc = inflateInit2(&zstream, -15);
+    bool zstream_init = (rc == Z_OK);
+
+    while(true){
+        unique_lock<mutex> lock(m_mutex);
+        // wait for the slot of the next block to decompress to be consumed by #load
+        m_condvar.wait(lock, [this, num_blocks](){ return m_terminate || m_next_block_decode >= num_blocks || m_next_block_decode < m_next_block_load + m_slots.size(); });
+        if(m_terminate || m_next_block_decode >= num_blocks) break;
+        uint64_t block_id = m_next_block_decode++;
+        Slot& slot = m_slots[block_id % m_slots.size()];
+        lock.unlock();
+
+        uint64_t num_edges = 0;
+        std::exception_ptr error;
+        try {
+            if(!zstream_init) ERROR("Cannot initialise the library zlib");
+            num_edges = decompress_block(block_id, slot.m_buffer.get(), input, &zstream);
+        } catch(...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        slot.m_num_edges = num_edges;
+        slot.m_error = error;
+        slot.m_ready = true;
+        lock.unlock();
+        m_condvar.notify_all();
+    }
+
+    if(zstream_init){ inflateEnd(&zstream); }
+}
+
+uint64_t ParallelEdgeLoader::decompress_block(uint64_t block_id, uint64_t* buffer, vector<uint8_t>& input, void* ptr_zstream){
+    z_stream* zstream = reinterpret_cast<z_stream*>(ptr_zstream);
+    const uint64_t offset = m_block_offsets[block_id];
+    const uint64_t input_sz = m_block_offsets[block_id +1] - offset;
+
+    // read the compressed block
+    if(input.size() < input_sz) input.resize(input_sz);
+    uint64_t bytes_read = 0;
+    while(bytes_read < input_sz){
+        ssize_t rc = ::pread(m_fd, input.data() + bytes_read, input_sz - bytes_read, offset + bytes_read);
+        if(rc < 0 && errno == EINTR) continue;
+        if(rc <= 0) ERROR("Cannot read the block " << block_id << " from the input file: " << (rc < 0 ? strerror(errno) : "unexpected EOF"));
+        bytes_read += rc;
+    }
+
+    // decompress it
+    int rc = inflateReset(zstream);
+    if(rc != Z_OK) ERROR("Cannot reset the zlib stream (rc: " << rc << ")");
+    zstream->next_in = input.data();
+    zstream->avail_in = input_sz;
+    zstream->next_out = (unsigned char*) buffer;
+    zstream->avail_out = m_block_size;
+    rc = inflate(zstream, Z_FINISH);
+    if(rc != Z_STREAM_END) ERROR("Cannot decompress the block " << block_id << " (rc: " << rc << ")");
+    uint64_t output_sz = m_block_size - zstream->avail_out;
+    assert(output_sz % (3 * sizeof(uint64_t)) == 0);
+
+    return output_sz / (3 * sizeof(uint64_t));
+}
+
+} // namespace
+
 /*****************************************************************************
  *                                                                           *
  *  EdgeBlockReader                                                          *
@@ -19,12 +19,17 @@
 
 #include "reader.hpp"
 
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <exception>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <random>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace gfe::graph { class WeightedEdge; } // forward decl.
 
@@ -91,6 +96,9 @@ public:
     uint64_t load(uint64_t* array, uint64_t array_sz);
 };
 
+// Load both the final and the temporary vertices of the given graphlog, decompressing the two sections concurrently
+void load_vertices(const std::string& path_graphlog, std::vector<uint64_t>& out_final, std::vector<uint64_t>& out_temporary);
+
 // Read one vertex at the time from the input file
 class VertexReader {
     VertexReader(const VertexLoader&) = delete;
@@ -135,6 +143,74 @@ public:
     uint64_t load(uint64_t* array, uint64_t num_edges);
 };
 
+/**
+ * Load whole blocks of edges, decompressing up to `num_threads' blocks concurrently. The blocks are still returned in the
+ * same order they are stored in the file, with the same contract of EdgeLoader#load.
+ *
+ * The properties of the log do not record where each block starts. The boundaries of the blocks are read from the
+ * sidecar file `<path_graphlog>.blocks', when present. Otherwise the loader falls back to decompress the blocks one at
+ * the time and, once the whole log has been read, it saves the boundaries found in the sidecar file for the next runs.
+ */
+class ParallelEdgeLoader {
+    ParallelEdgeLoader(const ParallelEdgeLoader&) = delete;
+    ParallelEdgeLoader& operator=(const ParallelEdgeLoader&) = delete;
+
+    const std::string m_path; // path to the graphlog
+    uint64_t m_block_size; // the size of an uncompressed block, in bytes (internal.edges.block_size)
+    std::vector<uint64_t> m_block_offsets; // the offset of each block in the file, plus the end of the last block
+
+    // sequential mode, when the boundaries of the blocks are not known
+    std::fstream m_handle; // handle used by m_sequential_loader
+    std::unique_ptr<EdgeLoader> m_sequential_loader; // decompress the blocks one at the time
+
+    // parallel mode
+    struct Slot { // a block being decompressed
+        std::unique_ptr<uint64_t[]> m_buffer; // the uncompressed edges
+        uint64_t m_num_edges = 0; // number of edges in the buffer
+        bool m_ready = false; // whether the block has been decompressed and it can be returned by #load
+        std::exception_ptr m_error; // set if the decompression of the block failed
+    };
+    int m_fd = -1; // file descriptor of the graphlog, each thread reads its blocks with pread
+    std::vector<Slot> m_slots; // block k is decompressed in m_slots[k % m_slots.size()]
+    uint64_t m_next_block_decode = 0; // the next block to decompress by the background threads
+    uint64_t m_next_block_load = 0; // the next block to return with #load
+    bool m_terminate = false; // signal the background threads to terminate
+    std::mutex m_mutex; // sync the background threads and #load
+    std::condition_variable m_condvar; // as above
+    std::vector<std::thread> m_threads; // background threads
+
+    // Path to the sidecar file with the boundaries of the blocks
+    std::string path_block_offsets() const;
+
+    // Read the boundaries of the blocks from the sidecar file. Return false if the file does not exist or it is not valid.
+    bool read_block_offsets(uint64_t edges_begin);
+
+    // Save the boundaries of the blocks in the sidecar file. Failures are ignored, the sidecar is only an optimisation.
+    void write_block_offsets() const;
+
+    // Logic of the background threads in the parallel mode
+    void main_thread();
+
+    // Decompress the given block in the given buffer, return the number of edges decompressed
+    uint64_t decompress_block(uint64_t block_id, uint64_t* buffer, std::vector<uint8_t>& input, void* zstream);
+
+    // Load the next block in sequential mode
+    uint64_t load_sequential(uint64_t* array, uint64_t num_edges);
+
+public:
+    // Initialise the loader for the given graphlog
+    ParallelEdgeLoader(const std::string& path_graphlog, uint64_t num_threads);
+
+    // Destructor
+    ~ParallelEdgeLoader();
+
+    // Load a whole block of edges in the given buffer. Return the number of edges loaded, or 0 if the log has been depleted or the array is not big enough to load the whole block
+    uint64_t load(uint64_t* array, uint64_t num_edges);
+
+    // Whether the blocks are being decompressed concurrently
+    bool is_parallel() const { return !m_threads.empty(); }
+};
+
 // Iterate over an edge at the time from a block of edges
 class EdgeBlockReader {
     std::shared_ptr<uint64_t[]> m_ptr_block; // the block of edges
@@ -17,7 +17,14 @@
 
 #include "gtest/gtest.h"
 
+#include <cstdlib> // mkstemp
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
 #include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
 
 #include "common/filesystem.hpp"
 #include "graph/edge_stream.hpp"
@@ -67,3 +74,161 @@ TEST(CSR, LoadUndirected){
     }
 }
 
+
+// Check that a snapshot of the CSR, once memory mapped, contains the same arrays of the original CSR
+TEST(CSR, Snapshot){
+    for(bool is_directed : { true, false }){
+        string graph_path = common::filesystem::directory_executable() + "/graphs/ldbc_graphalytics/" + (is_directed ? "example-directed" : "example-undirected") + ".properties";
+        char path_snapshot[] = "/tmp/gfe_XXXXXX";
+        int fd = mkstemp(path_snapshot);
+        ASSERT_GE( fd, 0 );
+        close(fd); // overwritten by CSR::save
+
+        CSR csr { is_directed };
+        csr.load(graph_path);
+        csr.save(path_snapshot, graph_path);
+
+        CSR snapshot { is_directed };
+        snapshot.open(path_snapshot, /* populate */ true);
+        ASSERT_EQ( snapshot.num_vertices(), csr.num_vertices() );
+        ASSERT_EQ( snapshot.num_edges(), csr.num_edges() );
+        const uint64_t num_edge_entries = is_directed ? csr.num_edges() : 2 * csr.num_edges();
+        for(uint64_t i = 0; i < csr.num_vertices(); i++){
+            ASSERT_EQ( snapshot.out_v()[i], csr.out_v()[i] );
+            ASSERT_EQ( snapshot.in_v()[i], csr.in_v()[i] );
+        }
+        for(uint64_t i = 0; i < num_edge_entries; i++){
+            ASSERT_EQ( snapshot.out_e()[i], csr.out_e()[i] );
+            ASSERT_EQ( snapshot.out_w()[i], csr.out_w()[i] );
+            ASSERT_EQ( snapshot.in_e()[i], csr.in_e()[i] );
+            ASSERT_EQ( snapshot.in_w()[i], csr.in_w()[i] );
+        }
+
+        gfe::graph::WeightedEdgeStream stream { graph_path };
+        for(uint64_t i = 0; i < stream.num_edges(); i++){
+            auto edge = stream.get(i);
+            ASSERT_TRUE( snapshot.has_vertex(edge.source()) );
+            ASSERT_EQ( snapshot.get_weight(edge.source(), edge.destination()), edge.weight() );
+        }
+
+        unlink(path_snapshot);
+    }
+}
+
+// Check that a snapshot is not used when the edge file of the graph has been regenerated after the snapshot was created
+TEST(CSR, StaleSnapshot){
+    char path_dir[] = "/tmp/gfe_XXXXXX";
+    ASSERT_NE( mkdtemp(path_dir), nullptr );
+    const string path_properties = string(path_dir) + "/graph.properties";
+    const string path_vertices = string(path_dir) + "/graph.v";
+    const string path_edges = string(path_dir) + "/graph.e";
+    { ofstream f(path_properties); f << "graph.graph.vertex-file = graph.v\ngraph.graph.edge-file = graph.e\ngraph.graph.directed = true\n"
+            "graph.graph.edge-properties.names = weight\ngraph.graph.edge-properties.types = real\n"; }
+    { ofstream f(path_vertices); f << "1\n2\n3\n"; }
+    { ofstream f(path_edges); f << "1 2 0.5\n2 3 0.25\n"; }
+
+    { // create the snapshot
+        CSR csr { /* directed */ true };
+        csr.load(path_properties);
+        csr.save(CSR::snapshot_path(path_properties), path_properties);
+    }
+    { // the snapshot is up to date
+        CSR csr { /* directed */ true };
+        csr.load(path_properties);
+        ASSERT_EQ( csr.get_weight(1, 2), 0.5 );
+    }
+
+    // same size of the edge file, different weights and modification time
+    { ofstream f(path_edges); f << "1 2 0.7\n2 3 0.25\n"; }
+    struct timespec times[2];
+    times[0].tv_sec = times[1].tv_sec = time(nullptr) + 10;
+    times[0].tv_nsec = times[1].tv_nsec = 0;
+    ASSERT_EQ( utimensat(AT_FDCWD, path_edges.c_str(), times, 0), 0 );
+    {
+        CSR csr { /* directed */ true };
+        csr.load(path_properties);
+        ASSERT_EQ( csr.get_weight(1, 2), 0.7 );
+    }
+
+    unlink(CSR::snapshot_path(path_properties).c_str());
+    unlink(path_properties.c_str()); unlink(path_vertices.c_str()); unlink(path_edges.c_str()); rmdir(path_dir);
+}
+
+// Check that all edges are properly loaded in the compressed CSR, with and without the weights
+TEST(CSR, Compressed){
+    for(bool is_directed : { true, false }){
+        for(auto weights : { CSR_Compressed::Weights::FLOAT32, CSR_Compressed::Weights::NONE }){
+            string graph_path = common::filesystem::directory_executable() + "/graphs/ldbc_graphalytics/" + (is_directed ? "example-directed" : "example-undirected") + ".properties";
+
+            CSR_Compressed csr { is_directed, weights };
+            csr.load(graph_path);
+            //csr.dump();
+
+            gfe::graph::WeightedEdgeStream stream { graph_path };
+            ASSERT_EQ( csr.num_edges(), stream.num_edges() );
+            for(uint64_t i = 0; i < stream.num_edges(); i++){
+                auto edge = stream.get(i);
+                double expected_weight = (weights == CSR_Compressed::Weights::FLOAT32) ? static_cast<float>(edge.weight()) : 1.0;
+                ASSERT_TRUE( csr.has_vertex(edge.source()) );
+                ASSERT_TRUE( csr.has_vertex(edge.destination()) );
+                ASSERT_TRUE( csr.has_edge(edge.source(), edge.destination()) );
+                ASSERT_EQ( csr.get_weight(edge.source(), edge.destination()), expected_weight );
+                if(!is_directed){
+                    ASSERT_EQ( csr.get_weight(edge.destination(), edge.source()), expected_weight );
+                }
+            }
+        }
+    }
+}
+
+// Check the compressed lists of high degree vertices, with consecutive IDs, spanning multiple blocks: the lookups go
+// through the offsets of the blocks, while the kernels decode runs of single byte gaps
+TEST(CSR, CompressedHighDegree){
+    const uint64_t num_vertices = 4096;
+    vector<gfe::graph::WeightedEdge> edges;
+    for(uint64_t v = 2; v <= num_vertices; v++){ edges.emplace_back(1, v, v * 0.5); } // all gaps of one
+    for(uint64_t v = 4; v <= num_vertices; v += 3){ edges.emplace_back(2, v, v * 0.25); } // all gaps of three
+    for(uint64_t v = 203; v <= num_vertices; v += 200){ edges.emplace_back(3, v, 1.0); } // gaps of two bytes
+    for(uint64_t v = 5, i = 0; v <= num_vertices; v += (i++ % 20 == 0) ? 150 : 1){ edges.emplace_back(4, v, 2.0); } // mixed
+
+    auto read_file = [](const string& path){ ifstream f(path); return string { istreambuf_iterator<char>(f), istreambuf_iterator<char>() }; };
+    char path_expected[] = "/tmp/gfe_XXXXXX";
+    char path_actual[] = "/tmp/gfe_XXXXXX";
+    int fd = mkstemp(path_expected); ASSERT_GE( fd, 0 ); close(fd);
+    fd = mkstemp(path_actual); ASSERT_GE( fd, 0 ); close(fd);
+
+    for(bool is_directed : { true, false }){
+        CSR csr { is_directed };
+        gfe::graph::WeightedEdgeStream stream1 { edges };
+        csr.load(stream1);
+        CSR_Compressed compressed { is_directed };
+        gfe::graph::WeightedEdgeStream stream2 { edges };
+        compressed.load(stream2);
+
+        ASSERT_EQ( compressed.num_edges(), edges.size() );
+        for(const auto& edge : edges){
+            ASSERT_TRUE( compressed.has_edge(edge.source(), edge.destination()) );
+            ASSERT_EQ( compressed.get_weight(edge.source(), edge.destination()), static_cast<float>(edge.weight()) );
+            if(!is_directed){
+                ASSERT_EQ( compressed.get_weight(edge.destination(), edge.source()), static_cast<float>(edge.weight()) );
+            }
+        }
+        ASSERT_FALSE( compressed.has_edge(2, 5) );
+        ASSERT_FALSE( compressed.has_edge(2, num_vertices -1) );
+        ASSERT_FALSE( compressed.has_edge(3, 204) );
+        ASSERT_FALSE( compressed.has_edge(4, 7) );
+
+        csr.bfs(1, path_expected);
+        compressed.bfs(1, path_actual);
+        ASSERT_EQ( read_file(path_actual), read_file(path_expected) );
+        csr.wcc(path_expected);
+        compressed.wcc(path_actual);
+        ASSERT_EQ( read_file(path_actual), read_file(path_expected) );
+        csr.cdlp(10, path_expected);
+        compressed.cdlp(10, path_actual);
+        ASSERT_EQ( read_file(path_actual), read_file(path_expected) );
+    }
+
+    unlink(path_expected);
+    unlink(path_actual);
+}
@@ -17,11 +17,18 @@
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib> // mkdtemp
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include "common/error.hpp"
 #include "common/filesystem.hpp"
+#include "graph/cbytearray.hpp"
 #include "graph/edge.hpp"
 #include "graph/edge_stream.hpp"
+#include "reader/graphalytics_reader.hpp"
 
 using namespace gfe::graph;
 using namespace std;
@@ -95,4 +102,100 @@ TEST(EdgeStream, Sanity) {
     }
 }
 
+// The edge files in the Graphalytics format are loaded in parallel, check the result against the sequential reader
+static void validate_graphalytics(const string& path){
+    WeightedEdgeStream stream(path);
+    gfe::reader::GraphalyticsReader reader(path);
+
+    WeightedEdge edge;
+    uint64_t num_edges = 0;
+    uint64_t max_vertex_id = 0;
+    while(reader.read(edge)){
+        ASSERT_LT(num_edges, stream.num_edges());
+        ASSERT_EQ(stream[num_edges].source(), edge.source());
+        ASSERT_EQ(stream[num_edges].destination(), edge.destination());
+        ASSERT_EQ(stream[num_edges].weight(), edge.weight());
+        max_vertex_id = max(max_vertex_id, max(edge.source(), edge.destination()));
+        num_edges++;
+    }
+    ASSERT_EQ(stream.num_edges(), num_edges);
+    ASSERT_EQ(stream.max_vertex_id(), max_vertex_id);
+}
+
+TEST(EdgeStream, GraphalyticsDirected) {
+    validate_graphalytics(common::filesystem::directory_executable() + "/graphs/ldbc_graphalytics/example-directed.properties");
+}
+
+TEST(EdgeStream, GraphalyticsUndirected) {
+    validate_graphalytics(common::filesystem::directory_executable() + "/graphs/ldbc_graphalytics/example-undirected.properties");
+}
 
+TEST(EdgeStream, BytesPerElement) {
+    ASSERT_EQ(CByteArray::compute_bytes_per_elements(0), 1);
+    ASSERT_EQ(CByteArray::compute_bytes_per_elements(255), 1);
+    ASSERT_EQ(CByteArray::compute_bytes_per_elements(256), 2);
+    ASSERT_EQ(CByteArray::compute_bytes_per_elements(65535), 2);
+    ASSERT_EQ(CByteArray::compute_bytes_per_elements(65536), 3);
+    ASSERT_EQ(CByteArray::compute_bytes_per_elements(numeric_limits<uint64_t>::max()), 8);
+
+    CByteArray array(/* bytes per element */ 3, /* capacity */ 4);
+    for(uint64_t i = 0; i < 4; i++){ array[i] = (1ull << 24) - 1 - i; }
+    for(uint64_t i = 0; i < 4; i++){ ASSERT_EQ(array[i], (1ull << 24) - 1 - i); }
+}
+
+TEST(EdgeStream, PermutationIsStable) {
+    // enough edges to be split in multiple chunks and buckets
+    const uint64_t num_edges = 1000000;
+    vector<WeightedEdge> edges;
+    edges.reserve(num_edges);
+    for(uint64_t i = 0; i < num_edges; i++){ edges.emplace_back(i, i + 1, static_cast<double>(i)); }
+
+    WeightedEdgeStream stream1(edges);
+    stream1.permute(42);
+    WeightedEdgeStream stream2(edges);
+    stream2.permute(42);
+    WeightedEdgeStream stream3(edges);
+    stream3.permute(43);
+
+    ASSERT_EQ(stream1.num_edges(), num_edges);
+    vector<bool> found(num_edges, false);
+    uint64_t num_moved = 0;
+    uint64_t num_diff_seed = 0;
+    for(uint64_t i = 0; i < num_edges; i++){
+        auto edge = stream1[i];
+        // the columns have been permuted together
+        ASSERT_EQ(edge.destination(), edge.source() + 1);
+        ASSERT_EQ(edge.weight(), static_cast<double>(edge.source()));
+        ASSERT_FALSE(found[edge.source()]);
+        found[edge.source()] = true;
+        num_moved += (edge.source() != i);
+
+        // same seed, same order
+        ASSERT_EQ(stream2[i], edge);
+        num_diff_seed += (stream3[i].source() != edge.source());
+    }
+    ASSERT_GT(num_moved, num_edges / 2);
+    ASSERT_GT(num_diff_seed, num_edges / 2);
+}
+
+TEST(EdgeStream, WeightsWithSignAndLeadingPoint) {
+    char path_dir[] = "/tmp/gfe_XXXXXX";
+    ASSERT_NE(mkdtemp(path_dir), nullptr);
+    const string path_properties = string(path_dir) + "/graph.properties";
+    const string path_vertices = string(path_dir) + "/graph.v";
+    const string path_edges = string(path_dir) + "/graph.e";
+    { ofstream f(path_properties); f << "graph.graph.vertex-file = graph.v\ngraph.graph.edge-file = graph.e\ngraph.graph.directed = true\n"
+            "graph.graph.edge-properties.names = weight\ngraph.graph.edge-properties.types = real\n"; }
+    { ofstream f(path_vertices); f << "1\n2\n3\n"; }
+    // a negative weight would be rejected by WeightedEdge
+    { ofstream f(path_edges); f << "1 2 .5\n2 3 -0.0\n3 1 +2\n1 3 1e-3\n"; }
+
+    WeightedEdgeStream stream(path_properties);
+    ASSERT_EQ(stream.num_edges(), 4);
+    vector<double> weights;
+    for(uint64_t i = 0; i < stream.num_edges(); i++){ weights.push_back(stream[i].weight()); }
+    sort(weights.begin(), weights.end());
+    ASSERT_EQ(weights, (vector<double>{ 0, 1e-3, 0.5, 2 }));
+
+    remove(path_properties.c_str()); remove(path_vertices.c_str()); remove(path_edges.c_str()); remove(path_dir);
+}
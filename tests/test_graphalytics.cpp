@@ -52,6 +52,7 @@
 #include "library/interface.hpp"
 #include "reader/graphalytics_reader.hpp"
 #include "utility/graphalytics_validate.hpp"
+#include "utility/result_writer.hpp"
 
 using namespace gfe::library;
 using namespace gfe::utility;
@@ -203,6 +204,43 @@ TEST(CSR, GraphalyticsUndirected){
     validate(csr.get(), path_example_undirected);
 }
 
+TEST(CSR_Compressed, GraphalyticsDirected){
+    auto csr = make_unique<CSR_Compressed>(/* directed */ true);
+    csr->load(path_example_directed + ".properties");
+    validate(csr.get(), path_example_directed);
+}
+
+TEST(CSR_Compressed, GraphalyticsUndirected){
+    auto csr = make_unique<CSR_Compressed>(/* directed */ false);
+    csr->load(path_example_undirected + ".properties");
+    validate(csr.get(), path_example_undirected);
+}
+
+TEST(CSR, GraphalyticsReordering){
+    using gfe::graph::VertexReordering;
+    for(auto reordering : { VertexReordering::DEGREE, VertexReordering::HUB_CLUSTER, VertexReordering::RCM, VertexReordering::GORDER }){
+        LOG("Vertex reordering: " << gfe::graph::vertex_reordering_to_string(reordering));
+        for(bool is_directed : { true, false }){
+            const string& path_graph = is_directed ? path_example_directed : path_example_undirected;
+            auto csr = make_unique<CSR>(is_directed);
+            csr->set_vertex_reordering(reordering);
+            csr->load(path_graph + ".properties");
+            validate(csr.get(), path_graph);
+        }
+    }
+}
+
+TEST(CSR, GraphalyticsBinaryResults){
+    set_result_format(ResultFormat::BINARY);
+    for(bool is_directed : { true, false }){
+        const string& path_graph = is_directed ? path_example_directed : path_example_undirected;
+        auto csr = make_unique<CSR>(is_directed);
+        csr->load(path_graph + ".properties");
+        validate(csr.get(), path_graph);
+    }
+    set_result_format(ResultFormat::TEXT);
+}
+
 #if defined(HAVE_LLAMA)
 TEST(LLAMA, GraphalyticsDirected){
     auto graph = make_unique<LLAMAClass>(/* directed */ true);
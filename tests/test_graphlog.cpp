@@ -17,10 +17,13 @@
 
 #include "gtest/gtest.h"
 
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 
 #include "common/filesystem.hpp"
 #include "graph/edge.hpp"
+#include "reader/graphlog_cache.hpp"
 #include "reader/graphlog_reader.hpp"
 
 using namespace std;
@@ -170,6 +173,108 @@ TEST(Graphlog, EdgeLoader){
     handle.close();
 }
 
+TEST(Graphlog, ParallelEdgeLoader){
+    const string path_blocks = path_graph + ".blocks";
+    std::remove(path_blocks.c_str()); // start without the boundaries of the blocks
+
+    Properties properties = parse_properties(path_graph);
+    const uint64_t array_sz = stoull(properties["internal.edges.block_size"]) / sizeof(uint64_t);
+    std::unique_ptr<uint64_t[]> ptr_expected { new uint64_t[array_sz] };
+    uint64_t* expected = ptr_expected.get();
+    std::unique_ptr<uint64_t[]> ptr_array { new uint64_t[array_sz] };
+    uint64_t* array = ptr_array.get();
+
+    // first run: sequential, it records the boundaries of the blocks; second & third runs: parallel
+    for(uint64_t run = 0; run < 3; run++){
+        fstream handle(path_graph, ios_base::in | ios_base::binary);
+        graphlog::set_marker(parse_properties(handle), handle, Section::EDGES);
+        EdgeLoader reference { handle };
+
+        ParallelEdgeLoader loader { path_graph, /* num threads */ 4 };
+        ASSERT_EQ(loader.is_parallel(), run > 0);
+
+        uint64_t num_edges = 0; uint64_t num_edges_total = 0;
+        while( (num_edges = reference.load(expected, array_sz) ) > 0 ){
+            ASSERT_EQ(loader.load(array, array_sz), num_edges);
+            for(uint64_t i = 0; i < num_edges * 3; i++){
+                ASSERT_EQ(array[i], expected[i]);
+            }
+            num_edges_total += num_edges;
+        }
+        ASSERT_EQ( loader.load(array, array_sz), 0ull ); // depleted
+        ASSERT_EQ( loader.load(array, array_sz), 0ull ); // depleted
+        ASSERT_EQ( num_edges_total, stoull(properties["internal.edges.cardinality"]) );
+
+        handle.close();
+    }
+
+    std::remove(path_blocks.c_str());
+}
+
+TEST(Graphlog, LoadVerticesConcurrently){
+    vector<uint64_t> vertices_final, vertices_temporary;
+    load_vertices(path_graph, vertices_final, vertices_temporary);
+
+    ASSERT_EQ(vertices_final.size(), 9ull);
+    for(uint64_t i = 0; i < vertices_final.size(); i++){
+        ASSERT_EQ(vertices_final[i], i + 2);
+    }
+    ASSERT_EQ(vertices_temporary.size(), 2ull);
+    ASSERT_EQ(vertices_temporary[0], 1ull);
+    ASSERT_EQ(vertices_temporary[1], 11ull);
+}
+
+TEST(Graphlog, Cache){
+    const string path_cache = Cache::default_path(path_graph);
+    std::remove(path_cache.c_str());
+    ASSERT_EQ(Cache::open(path_graph).get(), nullptr); // the cache does not exist yet
+    Cache::create(path_graph, path_cache, /* num threads */ 2);
+    auto cache = Cache::open(path_graph);
+    ASSERT_NE(cache.get(), nullptr);
+
+    // properties
+    Properties properties = parse_properties(path_graph);
+    ASSERT_EQ(cache->properties(), properties);
+
+    // vertices
+    uint64_t num_vertices = 0;
+    const uint64_t* vertices = cache->vertices_final(&num_vertices);
+    ASSERT_EQ(num_vertices, 9ull);
+    for(uint64_t i = 0; i < num_vertices; i++){ ASSERT_EQ(vertices[i], i + 2); }
+    vertices = cache->vertices_temporary(&num_vertices);
+    ASSERT_EQ(num_vertices, 2ull);
+    ASSERT_EQ(vertices[0], 1ull);
+    ASSERT_EQ(vertices[1], 11ull);
+
+    // edges, compare the blocks from the cache with those from the log
+    fstream handle(path_graph, ios_base::in | ios_base::binary);
+    graphlog::set_marker(properties, handle, Section::EDGES);
+    EdgeLoader reference { handle };
+    const uint64_t array_sz = stoull(properties["internal.edges.block_size"]) / sizeof(uint64_t);
+    std::unique_ptr<uint64_t[]> ptr_expected { new uint64_t[array_sz] };
+    uint64_t* expected = ptr_expected.get();
+
+    EdgeBlockSource source { path_graph };
+    ASSERT_TRUE(source.is_cached());
+    uint64_t num_edges = 0; uint64_t block_id = 0;
+    while( (num_edges = reference.load(expected, array_sz) ) > 0 ){
+        uint64_t num_edges_cache = 0;
+        const uint64_t* block = source.next(&num_edges_cache);
+        ASSERT_NE(block, nullptr);
+        ASSERT_EQ(num_edges_cache, num_edges);
+        ASSERT_EQ(memcmp(block, expected, num_edges * 3 * sizeof(uint64_t)), 0);
+        block_id++;
+    }
+    ASSERT_EQ(block_id, cache->num_blocks());
+    ASSERT_EQ(source.next(&num_edges), nullptr); // depleted
+    ASSERT_EQ(num_edges, 0ull);
+    handle.close();
+
+    cache.reset();
+    std::remove(path_cache.c_str());
+    std::remove((path_graph + ".blocks").c_str()); // created by the parallel loader in Cache::create
+}
+
 static void validate_edge(EdgeReader& reader, uint64_t expected_source_id, uint64_t expected_destination_id, double expected_weight){
     gfe::graph::WeightedEdge edge;
     bool has_read_edge = reader.read_edge(edge);
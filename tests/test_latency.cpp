@@ -0,0 +1,87 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+#include "experiment/details/latency.hpp"
+
+using namespace gfe::experiment::details;
+using namespace std;
+
+// check the value reported by the histogram is within its relative error w.r.t. the exact value
+static void validate_percentile(const LatencyHistogram& histogram, const vector<uint64_t>& sorted_values, double percentile){
+    uint64_t rank = ceil(percentile / 100. * sorted_values.size());
+    uint64_t expected = sorted_values[max<uint64_t>(rank, 1) -1];
+    uint64_t actual = histogram.percentile(percentile);
+    double error = abs(static_cast<double>(actual) - static_cast<double>(expected));
+    ASSERT_LE(error, expected * (1.0 / LatencyHistogram::SUB_BUCKET_COUNT)) << "percentile: " << percentile << ", expected: " << expected << ", actual: " << actual;
+}
+
+TEST(Latency, Empty){
+    auto histogram = make_unique<LatencyHistogram>();
+    ASSERT_EQ(histogram->num_values(), 0);
+    ASSERT_EQ(histogram->min(), 0);
+    ASSERT_EQ(histogram->max(), 0);
+    ASSERT_EQ(histogram->percentile(50), 0);
+    ASSERT_EQ(histogram->mean(), 0);
+}
+
+TEST(Latency, SmallValuesAreExact){
+    auto histogram = make_unique<LatencyHistogram>();
+    for(uint64_t i = 1; i <= 100; i++){ histogram->record(i); }
+    ASSERT_EQ(histogram->num_values(), 100);
+    ASSERT_EQ(histogram->min(), 1);
+    ASSERT_EQ(histogram->max(), 100);
+    ASSERT_EQ(histogram->percentile(50), 50);
+    ASSERT_EQ(histogram->percentile(90), 90);
+    ASSERT_EQ(histogram->percentile(99), 99);
+    ASSERT_EQ(histogram->percentile(100), 100);
+    ASSERT_DOUBLE_EQ(histogram->mean(), 50.5);
+}
+
+TEST(Latency, MergeAndPercentiles){
+    mt19937_64 random{ 42 };
+    lognormal_distribution<double> distribution { 10, 2 };
+    vector<uint64_t> values;
+
+    // four workers
+    auto merged = make_unique<LatencyHistogram>();
+    for(int worker = 0; worker < 4; worker++){
+        auto histogram = make_unique<LatencyHistogram>();
+        for(int i = 0; i < 100000; i++){
+            uint64_t value = distribution(random);
+            histogram->record(value);
+            values.push_back(value);
+        }
+        merged->merge(*histogram);
+    }
+    merged->record(numeric_limits<uint64_t>::max() / 2); // outlier
+    values.push_back(numeric_limits<uint64_t>::max() / 2);
+
+    sort(values.begin(), values.end());
+    ASSERT_EQ(merged->num_values(), values.size());
+    ASSERT_EQ(merged->min(), values.front());
+    ASSERT_EQ(merged->max(), values.back());
+    for(double percentile : {1., 10., 50., 90., 95., 97., 99., 99.9, 99.99, 100.}){
+        validate_percentile(*merged, values, percentile);
+    }
+}
@@ -310,6 +310,69 @@ static void parallel(shared_ptr<UpdateInterface> interface, uint64_t num_vertice
     interface->on_main_destroy();
 }
 
+// Insert and remove all edges with UpdateInterface#update_batch, in groups of `group_size' updates
+static void group_updates(shared_ptr<UpdateInterface> interface, UpdateInterface::BatchAtomicity atomicity, uint64_t num_vertices = 128, uint64_t group_size = 64){
+    using SingleUpdate = UpdateInterface::SingleUpdate;
+    interface->on_main_init(1);
+    interface->on_thread_init(0);
+
+    auto edge_list = generate_edge_stream(num_vertices);
+    edge_list->permute();
+    const uint64_t num_edges = edge_list->num_edges();
+    vector<SingleUpdate> group;
+    unique_ptr<bool[]> applied { new bool[group_size] };
+
+    // insert all edges
+    for(uint64_t start = 0; start < num_edges; start += group_size){
+        group.clear();
+        for(uint64_t i = start, end = std::min(num_edges, start + group_size); i < end; i++){
+            auto edge = edge_list->get(i);
+            group.push_back(SingleUpdate{edge.m_source, edge.m_destination, edge.m_weight});
+        }
+        ASSERT_EQ(interface->update_batch(group.data(), group.size(), atomicity, applied.get()), group.size());
+        for(uint64_t i = 0; i < group.size(); i++){ ASSERT_TRUE(applied[i]); }
+    }
+    interface->build();
+    ASSERT_EQ(interface->num_edges(), num_edges);
+    for(uint64_t i = 0; i < num_edges; i++){
+        auto edge = edge_list->get(i);
+        ASSERT_TRUE(interface->has_edge(edge.m_source, edge.m_destination));
+        ASSERT_TRUE(interface->has_edge(edge.m_destination, edge.m_source));
+    }
+
+    // a group with an edge that does not exist
+    group.clear();
+    group.push_back(SingleUpdate{edge_list->get(0).m_source, edge_list->get(0).m_destination, -1}); // remove an existing edge
+    group.push_back(SingleUpdate{1, 2, -1}); // the vertices 1 and 2 are never connected
+    uint64_t num_applied = interface->update_batch(group.data(), group.size(), atomicity, applied.get());
+    ASSERT_FALSE(applied[1]);
+    if(atomicity == UpdateInterface::BatchAtomicity::PER_BATCH){
+        ASSERT_EQ(num_applied, 0);
+        ASSERT_FALSE(applied[0]);
+        ASSERT_EQ(interface->num_edges(), num_edges);
+    } else {
+        ASSERT_EQ(num_applied, 1);
+        ASSERT_TRUE(applied[0]);
+        ASSERT_EQ(interface->num_edges(), num_edges -1);
+        ASSERT_TRUE(interface->add_edge_v2(edge_list->get(0))); // restore the edge
+    }
+
+    // remove all edges
+    for(uint64_t start = 0; start < num_edges; start += group_size){
+        group.clear();
+        for(uint64_t i = start, end = std::min(num_edges, start + group_size); i < end; i++){
+            auto edge = edge_list->get(i);
+            group.push_back(SingleUpdate{edge.m_destination, edge.m_source, -1}); // undirected, remove as <j, i>
+        }
+        ASSERT_EQ(interface->update_batch(group.data(), group.size(), atomicity, applied.get()), group.size());
+    }
+    interface->build();
+    ASSERT_EQ(interface->num_edges(), 0);
+
+    interface->on_thread_destroy(0);
+    interface->on_main_destroy();
+}
+
 TEST(AdjacencyList, UpdatesUndirected){
     auto adjlist = make_shared<AdjacencyList>(/* directed */ false);
     sequential(adjlist);
@@ -317,6 +380,12 @@ TEST(AdjacencyList, UpdatesUndirected){
     parallel(adjlist, 1024);
 }
 
+TEST(AdjacencyList, UpdateBatchUndirected){
+    group_updates(make_shared<AdjacencyList>(/* directed */ false), UpdateInterface::BatchAtomicity::PER_EDGE);
+    group_updates(make_shared<AdjacencyList>(/* directed */ false), UpdateInterface::BatchAtomicity::BEST_EFFORT);
+    ASSERT_ANY_THROW(group_updates(make_shared<AdjacencyList>(/* directed */ false), UpdateInterface::BatchAtomicity::PER_BATCH));
+}
+
 #if defined(HAVE_LLAMA)
 TEST(LLAMA, UpdatesUndirected){
     auto llama = make_shared<LLAMAClass>(/* directed */ false);
@@ -367,6 +436,12 @@ TEST(LiveGraph, UpdatesUndirected) {
     parallel_check = false; // global, reset to the default value
     parallel_vertex_deletions = true; // global, reset to the default value
 }
+
+TEST(LiveGraph, UpdateBatchUndirected) {
+    group_updates(make_shared<LiveGraphDriver>(/* directed */ false), UpdateInterface::BatchAtomicity::PER_EDGE);
+    group_updates(make_shared<LiveGraphDriver>(/* directed */ false), UpdateInterface::BatchAtomicity::PER_BATCH);
+    group_updates(make_shared<LiveGraphDriver>(/* directed */ false), UpdateInterface::BatchAtomicity::BEST_EFFORT);
+}
 #endif
 
 #if defined(HAVE_TESEO)
@@ -0,0 +1,140 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "library/common/vertex_dictionary.hpp"
+
+using namespace gfe::library;
+using namespace std;
+
+TEST(VertexDictionary, Sanity){
+    VertexDictionary dictionary;
+    uint64_t value = 0;
+
+    ASSERT_FALSE(dictionary.find(10, &value));
+    ASSERT_EQ(dictionary.insert(10, 100), (pair<uint64_t, bool>{100, true}));
+    ASSERT_EQ(dictionary.insert(10, 200), (pair<uint64_t, bool>{100, false}));
+    ASSERT_TRUE(dictionary.find(10, &value));
+    ASSERT_EQ(value, 100);
+    ASSERT_EQ(dictionary.size(), 1);
+
+    // remove & revive
+    ASSERT_TRUE(dictionary.remove(10, &value));
+    ASSERT_EQ(value, 100);
+    ASSERT_FALSE(dictionary.remove(10));
+    ASSERT_FALSE(dictionary.contains(10));
+    ASSERT_EQ(dictionary.size(), 0);
+    ASSERT_EQ(dictionary.insert(10, 300), (pair<uint64_t, bool>{300, true}));
+    ASSERT_TRUE(dictionary.find(10, &value));
+    ASSERT_EQ(value, 300);
+
+    // get_or_create
+    bool inserted = false;
+    ASSERT_EQ(dictionary.get_or_create(20, [](){ return 400; }, &inserted), 400);
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(dictionary.get_or_create(20, [](){ return 500; }, &inserted), 400);
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ(dictionary.size(), 2);
+
+    // reserved keys & values
+    ASSERT_ANY_THROW(dictionary.insert(numeric_limits<uint64_t>::max(), 0));
+    ASSERT_ANY_THROW(dictionary.insert(30, numeric_limits<uint64_t>::max()));
+    ASSERT_ANY_THROW(dictionary.get_or_create(30, [](){ return numeric_limits<uint64_t>::max(); }));
+    ASSERT_FALSE(dictionary.contains(30));
+    ASSERT_EQ(dictionary.get_or_create(30, [](){ return 600; }), 600);
+}
+
+TEST(VertexDictionary, Growth){
+    VertexDictionary dictionary { /* capacity */ 16 };
+    constexpr uint64_t num_keys = 100000;
+
+    for(uint64_t i = 0; i < num_keys; i++){
+        ASSERT_TRUE(dictionary.insert(i * 7, i).second);
+    }
+    ASSERT_GT(dictionary.num_tables(), 1);
+    ASSERT_EQ(dictionary.size(), num_keys);
+
+    for(uint64_t i = 0; i < num_keys; i++){
+        uint64_t value = 0;
+        ASSERT_TRUE(dictionary.find(i * 7, &value));
+        ASSERT_EQ(value, i);
+        ASSERT_FALSE(dictionary.contains(i * 7 + 1));
+    }
+}
+
+TEST(VertexDictionary, ConcurrentGetOrCreate){
+    VertexDictionary dictionary { /* capacity */ 16 };
+    constexpr uint64_t num_threads = 8;
+    constexpr uint64_t num_keys = 50000;
+    atomic<uint64_t> next_id = 0;
+    vector<atomic<uint64_t>> num_creations(num_keys);
+    for(auto& c : num_creations) c = 0;
+
+    // all threads attempt to create the same keys, each key must be created exactly once
+    vector<thread> threads;
+    for(uint64_t t = 0; t < num_threads; t++){
+        threads.emplace_back([&, t](){
+            for(uint64_t j = 0; j < num_keys; j++){
+                uint64_t key = (j * (t +1) ) % num_keys; // vary the order among the threads
+                dictionary.get_or_create(key, [&](){
+                    num_creations[key]++;
+                    return next_id++;
+                });
+            }
+        });
+    }
+    for(auto& t : threads) t.join();
+
+    ASSERT_EQ(dictionary.size(), num_keys);
+    ASSERT_EQ(next_id, num_keys);
+    vector<bool> ids_seen(num_keys, false);
+    for(uint64_t key = 0; key < num_keys; key++){
+        ASSERT_EQ(num_creations[key], 1);
+        uint64_t value = 0;
+        ASSERT_TRUE(dictionary.find(key, &value));
+        ASSERT_LT(value, num_keys);
+        ASSERT_FALSE(ids_seen[value]);
+        ids_seen[value] = true;
+    }
+}
+
+TEST(VertexDictionary, BulkLoad){
+    VertexDictionary dictionary;
+    constexpr uint64_t num_keys = 1ull << 18;
+    vector<uint64_t> keys(num_keys), values(num_keys);
+    for(uint64_t i = 0; i < num_keys; i++){
+        keys[i] = i * 13 + 5;
+        values[i] = i;
+    }
+
+    dictionary.bulk_load(keys.data(), values.data(), num_keys);
+    ASSERT_EQ(dictionary.size(), num_keys);
+    ASSERT_EQ(dictionary.num_tables(), 1);
+
+    for(uint64_t i = 0; i < num_keys; i++){
+        uint64_t value = 0;
+        ASSERT_TRUE(dictionary.find(keys[i], &value));
+        ASSERT_EQ(value, i);
+    }
+}
@@ -0,0 +1,268 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <getopt.h>
+#include <iomanip>
+#include <iostream>
+#include <omp.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(HAVE_TBB)
+#include "tbb/concurrent_hash_map.h"
+#endif
+
+// libcommon
+#include "common/filesystem.hpp"
+#include "common/timer.hpp"
+
+// gfe
+#include "library/common/vertex_dictionary.hpp"
+
+using namespace gfe;
+using namespace std;
+
+// globals
+static string g_path_vertices; // the .v file of a graphalytics graph
+static uint64_t g_scale = 20; // if g_path_vertices is not set, generate 2^scale vertex IDs
+static vector<uint64_t> g_num_threads { 1, 2, 4, 8, 16, 32, 64, 128 };
+static uint64_t g_seed = 42;
+
+// function prototypes
+static void parse_args(int argc, char* argv[]);
+static string string_usage(char* program_name);
+static vector<uint64_t> load_vertices();
+static vector<uint64_t> generate_vertices();
+template<typename Function> static uint64_t run_parallel(uint64_t num_threads, uint64_t num_keys, Function&& fn);
+static void report(const char* structure, const char* operation, uint64_t num_threads, uint64_t num_keys, uint64_t time_usecs);
+
+int main(int argc, char* argv[]){
+    parse_args(argc, argv);
+
+    vector<uint64_t> keys = g_path_vertices.empty() ? generate_vertices() : load_vertices();
+    const uint64_t num_keys = keys.size();
+    cout << "Vertices: " << num_keys << endl;
+
+    // the order in which the keys are inserted and looked up, as in the insertions of a random permuted graph
+    vector<uint64_t> lookups = keys;
+    shuffle(begin(keys), end(keys), mt19937_64{ g_seed });
+    shuffle(begin(lookups), end(lookups), mt19937_64{ g_seed +1 });
+
+    for(uint64_t num_threads : g_num_threads){
+        { // VertexDictionary
+            library::VertexDictionary dictionary;
+            atomic<uint64_t> next_id = 0;
+            uint64_t t_insert = run_parallel(num_threads, num_keys, [&](uint64_t i){
+                dictionary.get_or_create(keys[i], [&](){ return next_id++; });
+            });
+            report("VertexDictionary", "insert", num_threads, num_keys, t_insert);
+
+            atomic<uint64_t> checksum = 0;
+            uint64_t t_find = run_parallel(num_threads, num_keys, [&](uint64_t i){
+                uint64_t value = 0;
+                dictionary.find(lookups[i], &value);
+                checksum.fetch_add(value, memory_order_relaxed);
+            });
+            report("VertexDictionary", "find", num_threads, num_keys, t_find);
+        }
+
+        { // VertexDictionary, bulk load
+            library::VertexDictionary dictionary;
+            vector<uint64_t> values (num_keys);
+            for(uint64_t i = 0; i < num_keys; i++){ values[i] = i; }
+            common::Timer timer;
+            timer.start();
+            omp_set_num_threads(num_threads);
+            dictionary.bulk_load(keys.data(), values.data(), num_keys);
+            timer.stop();
+            report("VertexDictionary", "bulk_load", num_threads, num_keys, timer.microseconds());
+        }
+
+#if defined(HAVE_TBB)
+        { // tbb::concurrent_hash_map, as used by the drivers so far
+            tbb::concurrent_hash_map<uint64_t, uint64_t> dictionary;
+            atomic<uint64_t> next_id = 0;
+            uint64_t t_insert = run_parallel(num_threads, num_keys, [&](uint64_t i){
+                tbb::concurrent_hash_map<uint64_t, uint64_t>::accessor accessor;
+                if(dictionary.insert(accessor, keys[i])){
+                    accessor->second = next_id++;
+                }
+            });
+            report("tbb::concurrent_hash_map", "insert", num_threads, num_keys, t_insert);
+
+            atomic<uint64_t> checksum = 0;
+            uint64_t t_find = run_parallel(num_threads, num_keys, [&](uint64_t i){
+                tbb::concurrent_hash_map<uint64_t, uint64_t>::const_accessor accessor;
+                if(dictionary.find(accessor, lookups[i])){
+                    checksum.fetch_add(accessor->second, memory_order_relaxed);
+                }
+            });
+            report("tbb::concurrent_hash_map", "find", num_threads, num_keys, t_find);
+        }
+#endif
+    }
+
+    cout << "\nDone" << endl;
+    return 0;
+}
+
+// Execute fn(i) for all i in [0, num_keys), partitioned among the given number of threads. Return the time elapsed in microsecs.
+template<typename Function>
+static uint64_t run_parallel(uint64_t num_threads, uint64_t num_keys, Function&& fn){
+    vector<thread> threads;
+    atomic<uint64_t> num_ready = 0;
+    atomic<bool> start = false;
+
+    for(uint64_t thread_id = 0; thread_id < num_threads; thread_id++){
+        threads.emplace_back([&, thread_id](){
+            uint64_t begin = num_keys * thread_id / num_threads;
+            uint64_t end = num_keys * (thread_id +1) / num_threads;
+
+            num_ready++;
+            while(!start.load(memory_order_acquire)){ this_thread::yield(); }
+            for(uint64_t i = begin; i < end; i++){ fn(i); }
+        });
+    }
+
+    while(num_ready < num_threads){ this_thread::yield(); }
+    common::Timer timer;
+    timer.start();
+    start = true;
+    for(auto& t : threads){ t.join(); }
+    timer.stop();
+
+    return timer.microseconds();
+}
+
+static void report(const char* structure, const char* operation, uint64_t num_threads, uint64_t num_keys, uint64_t time_usecs){
+    double throughput = time_usecs == 0 ? 0 : static_cast<double>(num_keys) / time_usecs; // ops per microsec
+    cout << "[" << structure << "] " << operation << ", threads: " << num_threads << ", time: " << time_usecs << " us, "
+         << "throughput: " << fixed << setprecision(2) << throughput << " Mops/sec" << endl;
+}
+
+// Read the vertex IDs from a .v file, one vertex per line
+static vector<uint64_t> load_vertices(){
+    vector<uint64_t> result;
+    fstream handle(g_path_vertices, ios::in);
+    if(!handle.good()){
+        cerr << "ERROR: Cannot open the file `" << g_path_vertices << "'" << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t vertex_id = 0;
+    while(handle >> vertex_id){
+        result.push_back(vertex_id);
+    }
+    handle.close();
+    return result;
+}
+
+// Mimic the vertex IDs of the graph500 graphs in the graphalytics collection: they are sparse in the domain [0, 2^scale),
+// as the generator scrambles the IDs and the isolated vertices are dropped.
+static vector<uint64_t> generate_vertices(){
+    const uint64_t domain = 1ull << g_scale;
+    vector<uint64_t> result;
+    result.reserve(domain);
+    mt19937_64 random { g_seed };
+    bernoulli_distribution isolated { 0.15 };
+
+    for(uint64_t i = 0; i < domain; i++){
+        uint64_t vertex_id = (i * 0x9E3779B97F4A7C15ull) & (domain -1); // bijection in [0, 2^scale), the multiplier is odd
+        if(!isolated(random)){
+            result.push_back(vertex_id);
+        }
+    }
+
+    return result;
+}
+
+static void parse_args(int argc, char* argv[]) {
+    static struct option long_options[] = {
+        {"help", no_argument, nullptr, 'h'},
+        {"scale", required_argument, nullptr, 's'},
+        {"threads", required_argument, nullptr, 't'},
+        {"vertices", required_argument, nullptr, 'v'},
+        {0, 0, 0, 0} // keep at the end
+    };
+
+    int option { 0 };
+    int option_index = 0;
+    while( (option = getopt_long(argc, argv, "hs:t:v:", long_options, &option_index)) != -1 ){
+        switch(option){
+        case 'h': {
+            cout << "Compare the throughput of the VertexDictionary against tbb::concurrent_hash_map\n";
+            cout << string_usage(argv[0]) << endl;
+            exit(EXIT_SUCCESS);
+        } break;
+        case 's': {
+            int64_t scale = strtoll(optarg, nullptr, 10);
+            if(scale <= 0 || scale > 32){
+                cerr << "ERROR: Invalid scale: `" << optarg << "'" << endl;
+                exit(EXIT_FAILURE);
+            }
+            g_scale = scale;
+        } break;
+        case 't': {
+            g_num_threads.clear();
+            stringstream ss(optarg);
+            string token;
+            while(getline(ss, token, ',')){
+                int64_t num_threads = strtoll(token.c_str(), nullptr, 10);
+                if(num_threads <= 0){
+                    cerr << "ERROR: Invalid number of threads: `" << token << "'" << endl;
+                    exit(EXIT_FAILURE);
+                }
+                g_num_threads.push_back(num_threads);
+            }
+        } break;
+        case 'v': {
+            g_path_vertices = optarg;
+            if(!common::filesystem::file_exists(g_path_vertices)){
+                cerr << "ERROR: The file `" << g_path_vertices << "' does not exist" << endl;
+                exit(EXIT_FAILURE);
+            }
+        } break;
+        default:
+            assert(0 && "Invalid option");
+        }
+    }
+
+    if(g_num_threads.empty()){
+        cerr << "ERROR: the list of threads is empty\n";
+        cerr << string_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static string string_usage(char* program_name) {
+    stringstream ss;
+    ss << "Usage: " << program_name << " [-s <scale>] [-v <vertices>] [-t <threads>]\n";
+    ss << "Where: \n";
+    ss << "  -s <scale> generate 2^scale vertex IDs with the same distribution of the graph500 graphs, default: " << g_scale << "\n";
+    ss << "  -v <vertices> load the vertex IDs from the given .v file, rather than generating them\n";
+    ss << "  -t <threads> comma separated list of the number of threads to evaluate, default: 1,2,4,8,16,32,64,128\n";
+    return ss.str();
+}
@@ -0,0 +1,132 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <cassert>
+#include <cstdlib>
+#include <getopt.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// libcommon
+#include "common/filesystem.hpp"
+#include "common/timer.hpp"
+
+// gfe
+#include "graph/edge_stream.hpp"
+#include "graph/vertex_reordering.hpp"
+#include "library/baseline/csr.hpp"
+
+using namespace gfe;
+using namespace std;
+
+// globals
+static string g_destination;
+static string g_path_graph;
+static bool g_is_directed = true;
+static graph::VertexReordering g_reordering = graph::VertexReordering::NONE;
+
+// function prototypes
+static void parse_args(int argc, char* argv[]);
+static string string_usage(char* program_name);
+
+int main(int argc, char* argv[]){
+    parse_args(argc, argv);
+    cout << "Graph: " << g_path_graph << ", directed: " << boolalpha << g_is_directed << ", reordering: " << graph::vertex_reordering_to_string(g_reordering) << ", destination: " << g_destination << " ... " << endl;
+
+    common::Timer timer;
+    timer.start();
+    library::CSR csr { g_is_directed };
+    csr.set_vertex_reordering(g_reordering);
+    { // restrict the scope
+        graph::WeightedEdgeStream stream { g_path_graph };
+        csr.load(stream);
+    }
+    csr.save(g_destination, g_path_graph);
+    timer.stop();
+
+    library::CSR snapshot { g_is_directed }; // validate the result
+    snapshot.open(g_destination);
+    cout << "Vertices: " << snapshot.num_vertices() << ", edges: " << snapshot.num_edges() << ", completed in " << timer << endl;
+
+    cout << "\nDone" << endl;
+    return 0;
+}
+
+static void parse_args(int argc, char* argv[]) {
+    static struct option long_options[] = {
+        {"help", no_argument, nullptr, 'h'},
+        {"reorder", required_argument, nullptr, 'r'},
+        {"undirected", no_argument, nullptr, 'u'},
+        {0, 0, 0, 0} // keep at the end
+    };
+
+    int option { 0 };
+    int option_index = 0;
+    while( (option = getopt_long(argc, argv, "hr:u", long_options, &option_index)) != -1 ){
+        switch(option){
+        case 'h': {
+            cout << "Build the CSR of a graph and store it into a snapshot that can be memory mapped by the next runs of the csr3 libraries\n";
+            cout << string_usage(argv[0]) << endl;
+            exit(EXIT_SUCCESS);
+        } break;
+        case 'r': {
+            try {
+                g_reordering = graph::parse_vertex_reordering(optarg);
+            } catch(std::invalid_argument& e){
+                cerr << "ERROR: " << e.what() << endl;
+                exit(EXIT_FAILURE);
+            }
+        } break;
+        case 'u': {
+            g_is_directed = false;
+        } break;
+        default:
+            assert(0 && "Invalid option");
+        }
+    }
+
+    if(optind < argc){
+        g_path_graph = argv[optind];
+        if(!common::filesystem::file_exists(g_path_graph)){
+            cerr << "ERROR: The file `" << g_path_graph << "' does not exist" << endl;
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        cerr << "ERROR: input graph not set\n";
+        cerr << string_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if(optind +1 < argc){
+        g_destination = argv[optind +1];
+    } else {
+        g_destination = library::CSR::snapshot_path(g_path_graph);
+    }
+}
+
+static string string_usage(char* program_name) {
+    stringstream ss;
+    ss << "Usage: " << program_name << " [-u] [-r <reordering>] <graph> [<destination>]\n";
+    ss << "Where: \n";
+    ss << "  -r reorders the vertices as gfe_driver --reorder: none, degree, hub, rcm or gorder. The driver only uses the snapshot with the same reordering\n";
+    ss << "  -u states the graph is undirected, by default it is considered directed, as in gfe_driver\n";
+    ss << "  <graph> is the graph to convert, in any format accepted by gfe_driver\n";
+    ss << "  <destination> is the path where to store the snapshot, default: <graph>.csr. The driver only uses the snapshot at the default path\n";
+    return ss.str();
+}
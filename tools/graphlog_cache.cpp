@@ -0,0 +1,121 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <cassert>
+#include <cstdlib>
+#include <getopt.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// libcommon
+#include "common/filesystem.hpp"
+#include "common/timer.hpp"
+
+// gfe
+#include "reader/graphlog_cache.hpp"
+#include "reader/graphlog_reader.hpp"
+
+using namespace gfe;
+using namespace std;
+
+// globals
+static string g_destination;
+static string g_path_graphlog;
+static uint64_t g_num_threads = thread::hardware_concurrency();
+
+// function prototypes
+static void parse_args(int argc, char* argv[]);
+static string string_usage(char* program_name);
+
+int main(int argc, char* argv[]){
+    parse_args(argc, argv);
+    cout << "Graphlog: " << g_path_graphlog << ", destination: " << g_destination << ", threads: " << g_num_threads << " ... " << endl;
+
+    common::Timer timer;
+    timer.start();
+    reader::graphlog::Cache::create(g_path_graphlog, g_destination, g_num_threads);
+    timer.stop();
+
+    reader::graphlog::Cache cache { g_destination }; // validate the result
+    cout << "Blocks: " << cache.num_blocks() << ", completed in " << timer << endl;
+
+    cout << "\nDone" << endl;
+    return 0;
+}
+
+static void parse_args(int argc, char* argv[]) {
+    static struct option long_options[] = {
+        {"help", no_argument, nullptr, 'h'},
+        {"threads", required_argument, nullptr, 't'},
+        {0, 0, 0, 0} // keep at the end
+    };
+
+    int option { 0 };
+    int option_index = 0;
+    while( (option = getopt_long(argc, argv, "ht:", long_options, &option_index)) != -1 ){
+        switch(option){
+        case 'h': {
+            cout << "Decompress a graphlog into a cache that can be memory mapped by the aging2 experiment\n";
+            cout << string_usage(argv[0]) << endl;
+            exit(EXIT_SUCCESS);
+        } break;
+        case 't': {
+            int64_t num_threads = strtoll(optarg, nullptr, 10);
+            if(num_threads <= 0){
+                cerr << "ERROR: Invalid number of threads: `" << optarg << "'" << endl;
+                exit(EXIT_FAILURE);
+            }
+            g_num_threads = num_threads;
+        } break;
+        default:
+            assert(0 && "Invalid option");
+        }
+    }
+
+    if(optind < argc){
+        g_path_graphlog = argv[optind];
+        if(!common::filesystem::file_exists(g_path_graphlog)){
+            cerr << "ERROR: The file `" << g_path_graphlog << "' does not exist" << endl;
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        cerr << "ERROR: input graphlog not set\n";
+        cerr << string_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if(optind +1 < argc){
+        g_destination = argv[optind +1];
+    } else {
+        g_destination = reader::graphlog::Cache::default_path(g_path_graphlog);
+    }
+
+    if(g_num_threads == 0){ g_num_threads = 1; }
+}
+
+static string string_usage(char* program_name) {
+    stringstream ss;
+    ss << "Usage: " << program_name << " [-t <threads>] <graphlog> [<destination>]\n";
+    ss << "Where: \n";
+    ss << "  -t <threads> is the number of threads to decompress the graphlog, default: all the available cores\n";
+    ss << "  <graphlog> is the log of updates to convert\n";
+    ss << "  <destination> is the path where to store the cache, default: <graphlog>.cache. The aging2 experiment only uses the cache at the default path\n";
+    return ss.str();
+}
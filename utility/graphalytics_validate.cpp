@@ -29,6 +29,7 @@
 #include <utility>
 
 #include "common/error.hpp"
+#include "result_writer.hpp"
 
 using namespace std;
 
@@ -125,29 +126,50 @@ static pair<int64_t, int64_t> relabel(const pair<int64_t, int64_t>& tuple, uint6
 
 namespace { template<typename T> struct Tuple { int64_t vertex_id; T value; uint64_t lineno; }; }
 
+/**
+ * Invoke f(vertex id, value, lineno) for each entry of the given result file, either in the text or in the binary
+ * format of utility/result_writer.hpp. For the binary format, the `lineno' is the position of the entry in the file.
+ */
+template<typename T, typename F>
+static void read_result_file(const std::string& path_to_file, F&& f){
+    if(BinaryResultReader::is_binary(path_to_file)){
+        BinaryResultReader reader { path_to_file };
+        uint64_t lineno = 0;
+        uint64_t vertex_id = 0;
+        T value = 0;
+        while(reader.next(&vertex_id, &value)){
+            f(static_cast<int64_t>(vertex_id), value, lineno);
+            lineno++;
+        }
+    } else {
+        fstream handle(path_to_file, ios_base::in);
+        if(!handle.good()) FATAL("The result file does not exist or is not accessible. Path: `"  << path_to_file << "'");
+
+        uint64_t lineno = 0; // current line number
+        char buffer[BUFFER_SZ]; // read the current line from the file
+        while(true){
+            handle.getline(buffer, BUFFER_SZ);
+            if(handle.eof()) break;
+            auto v = parse_value<T>(lineno, buffer, "result");
+            f(v.first, v.second, lineno);
+            lineno++;
+        }
+
+        handle.close();
+    }
+}
+
 /**
  * Read the content of the given reference/expected file, return an hash map vertex id -> <value, line in the file>
  */
 template<typename T>
 static unordered_map</* vertex id */ int64_t, /* value */ Tuple<T>> read_results(const std::string& path_to_file){
-    fstream handle(path_to_file, ios_base::in);
-    if(!handle.good()) FATAL("The result file does not exist or is not accessible. Path: `"  << path_to_file << "'");
-
-    uint64_t lineno = 0; // current line number
-    char buffer[BUFFER_SZ]; // read the current line from the file
     unordered_map<int64_t, Tuple<T>> result;
 
-    lineno = 0;
-    while(true){
-        handle.getline(buffer, BUFFER_SZ);
-        if(handle.eof()) break;
-        auto v = parse_value<T>(lineno, buffer, "result");
-        auto rc = result.insert({ v.first, Tuple<T>{v.first, v.second, lineno} });
-        if(!rc.second){ FATAL("[lineno=" << lineno << ", file=" << path_to_file << "] The vertex " << v.first << " is a duplicate, already defined at line #" << rc.first->second.lineno); }
-        lineno++;
-    }
-
-    handle.close();
+    read_result_file<T>(path_to_file, [&](int64_t vertex_id, T value, uint64_t lineno){
+        auto rc = result.insert({ vertex_id, Tuple<T>{vertex_id, value, lineno} });
+        if(!rc.second){ FATAL("[lineno=" << lineno << ", file=" << path_to_file << "] The vertex " << vertex_id << " is a duplicate, already defined at line #" << rc.first->second.lineno); }
+    });
 
     return result;
 }
@@ -285,8 +307,6 @@ void GraphalyticsValidate::sssp(const std::string& result, const std::string& ex
 void GraphalyticsValidate::equivalence_match(const std::string& result, const std::string& expected, uint64_t max_num_errors, const vertex_map_t* vertex_map){
     ERROR_INIT
 
-    fstream handle_result(result, ios_base::in);
-    if(!handle_result.good()) FATAL("The result file does not exist or is not accessible. Path: `"  << result << "'");
     fstream handle_expected(expected, ios_base::in);
     if(!handle_expected.good()) FATAL("The reference file does not exist or is not accessible. Path: `" << expected << "'");
 
@@ -297,18 +317,11 @@ void GraphalyticsValidate::equivalence_match(const std::string& result, const st
     unordered_set<int64_t> unique_components; // check that component[exp] does not belong to different components in ref
 
     // process the file with the results
-    while(true){
-        handle_result.getline(buffer, BUFFER_SZ);
-        if(handle_result.eof()) break;
-        auto t = parse_value<int64_t>(lineno, buffer, "result");
-        components_result[t.first] = t.second;
-        lineno++;
-    }
-
-    handle_result.close();
+    read_result_file<int64_t>(result, [&components_result](int64_t vertex_id, int64_t component, uint64_t /* lineno */){
+        components_result[vertex_id] = component;
+    });
 
     // process the reference file
-    lineno = 0;
     while(true){
         handle_expected.getline(buffer, BUFFER_SZ);
         if(handle_expected.eof()) break;
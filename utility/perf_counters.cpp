@@ -0,0 +1,275 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "perf_counters.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstring> // strerror
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(HAVE_OPENMP)
+#include <omp.h>
+#endif
+
+#include "common/database.hpp"
+#include "common/error.hpp"
+#include "configuration.hpp"
+
+using namespace std;
+
+namespace gfe::utility {
+
+/*****************************************************************************
+ *                                                                           *
+ *   PerfCounters                                                            *
+ *                                                                           *
+ *****************************************************************************/
+
+// Whether a warning has already been reported for a counter that could not be opened
+static atomic<bool> g_warning_reported = false;
+
+static void init_attr(PerfCounters::Event event, struct perf_event_attr* attr){
+    memset(attr, 0, sizeof(struct perf_event_attr));
+    attr->size = sizeof(struct perf_event_attr);
+    attr->disabled = 1; // started by #start()
+    attr->exclude_kernel = 1; // allowed also with perf_event_paranoid = 2
+    attr->exclude_hv = 1;
+    attr->read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING; // scale the values when multiplexed
+
+    switch(event){
+    case PerfCounters::CYCLES:
+        attr->type = PERF_TYPE_HARDWARE;
+        attr->config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case PerfCounters::INSTRUCTIONS:
+        attr->type = PERF_TYPE_HARDWARE;
+        attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case PerfCounters::LLC_MISSES:
+        attr->type = PERF_TYPE_HARDWARE;
+        attr->config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case PerfCounters::DTLB_MISSES:
+        attr->type = PERF_TYPE_HW_CACHE;
+        attr->config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    case PerfCounters::BRANCH_MISSES:
+        attr->type = PERF_TYPE_HARDWARE;
+        attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    default:
+        assert(0 && "Invalid event");
+    }
+}
+
+PerfCounters::PerfCounters(){
+    for(int i = 0; i < NUM_EVENTS; i++){
+        struct perf_event_attr attr;
+        init_attr(static_cast<Event>(i), &attr);
+        m_fds[i] = syscall(__NR_perf_event_open, &attr, /* calling thread */ 0, /* any cpu */ -1, /* group */ -1, /* flags */ 0);
+        if(m_fds[i] < 0 && !g_warning_reported.exchange(true)){
+            LOG("[PerfCounters] WARNING: cannot open the hardware counter " << event_name(static_cast<Event>(i)) << ": " << strerror(errno) << " (" << errno << "). "
+                    "The counters not available will not be reported. Check /proc/sys/kernel/perf_event_paranoid");
+        }
+    }
+}
+
+PerfCounters::~PerfCounters(){
+    for(int i = 0; i < NUM_EVENTS; i++){
+        if(m_fds[i] >= 0){ close(m_fds[i]); }
+    }
+}
+
+void PerfCounters::start(){
+    for(int i = 0; i < NUM_EVENTS; i++){
+        if(m_fds[i] < 0) continue;
+        ioctl(m_fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(m_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void PerfCounters::stop(){
+    for(int i = 0; i < NUM_EVENTS; i++){
+        if(m_fds[i] < 0) continue;
+        ioctl(m_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+}
+
+PerfCounters::Values PerfCounters::read() const {
+    Values result;
+
+    for(int i = 0; i < NUM_EVENTS; i++){
+        if(m_fds[i] < 0) continue;
+
+        uint64_t buffer[3]; // value, time enabled, time running
+        if(::read(m_fds[i], buffer, sizeof(buffer)) != sizeof(buffer)) continue;
+
+        uint64_t value = buffer[0];
+        if(buffer[2] > 0 && buffer[2] < buffer[1]){ // the counter was multiplexed
+            value = static_cast<uint64_t>(static_cast<double>(value) * buffer[1] / buffer[2]);
+        }
+
+        result.m_values[i] = value;
+        result.m_available[i] = true;
+    }
+
+    return result;
+}
+
+const char* PerfCounters::event_name(Event event){
+    switch(event){
+    case CYCLES: return "cycles";
+    case INSTRUCTIONS: return "instructions";
+    case LLC_MISSES: return "llc_misses";
+    case DTLB_MISSES: return "dtlb_misses";
+    case BRANCH_MISSES: return "branch_misses";
+    default: return "unknown";
+    }
+}
+
+PerfCounters::Values& PerfCounters::Values::operator+=(const Values& other){
+    for(int i = 0; i < NUM_EVENTS; i++){
+        if(!other.m_available[i]) continue;
+        m_values[i] += other.m_values[i];
+        m_available[i] = true;
+    }
+    return *this;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *   PerfPhase                                                               *
+ *                                                                           *
+ *****************************************************************************/
+
+// The counters started by PerfPhase#start_openmp in the current thread
+static thread_local PerfCounters* tl_openmp_counters = nullptr;
+
+PerfPhase::PerfPhase(const string& name) : m_name(name) {
+
+}
+
+shared_ptr<PerfPhase> PerfPhase::create(const string& name){
+    if(configuration().measure_perf_counters()){
+        return make_shared<PerfPhase>(name);
+    } else {
+        return nullptr;
+    }
+}
+
+void PerfPhase::add(uint64_t thread_id, const PerfCounters::Values& values){
+    scoped_lock<mutex> lock(m_mutex);
+    if(m_threads.size() <= thread_id){ m_threads.resize(thread_id +1); }
+    m_threads[thread_id] += values;
+}
+
+void PerfPhase::add_operations(uint64_t num_operations){
+    scoped_lock<mutex> lock(m_mutex);
+    m_num_operations += num_operations;
+}
+
+static void openmp_start_thread(){
+    if(tl_openmp_counters == nullptr){ // otherwise, reuse the counters of a previous execution that was interrupted (e.g. timeout)
+        tl_openmp_counters = new PerfCounters();
+    }
+    tl_openmp_counters->start();
+}
+
+static void openmp_stop_thread(PerfPhase* phase, uint64_t thread_id){
+    if(tl_openmp_counters == nullptr) return; // the thread did not exist in the pool when the counters were started
+    tl_openmp_counters->stop();
+    phase->add(thread_id, tl_openmp_counters->read());
+    delete tl_openmp_counters; tl_openmp_counters = nullptr;
+}
+
+void PerfPhase::start_openmp(){
+#if defined(HAVE_OPENMP)
+    #pragma omp parallel
+    openmp_start_thread();
+#else
+    openmp_start_thread();
+#endif
+}
+
+void PerfPhase::stop_openmp(){
+#if defined(HAVE_OPENMP)
+    #pragma omp parallel
+    openmp_stop_thread(this, omp_get_thread_num());
+#else
+    openmp_stop_thread(this, 0);
+#endif
+}
+
+PerfCounters::Values PerfPhase::total() const {
+    scoped_lock<mutex> lock(m_mutex);
+    PerfCounters::Values result;
+    for(auto& values : m_threads){ result += values; }
+    return result;
+}
+
+void PerfPhase::save(common::Database* handle) const {
+    assert(handle != nullptr && "Null pointer");
+    if(handle == nullptr) INVALID_ARGUMENT("The handle to the database is a nullptr");
+    auto total = this->total();
+
+    scoped_lock<mutex> lock(m_mutex);
+    auto save_values = [this, handle](int64_t thread_id, const PerfCounters::Values& values){
+        for(int i = 0; i < PerfCounters::NUM_EVENTS; i++){
+            if(!values.m_available[i]) continue; // the counter could not be opened
+
+            auto db = handle->add("perf_counters");
+            db.add("phase", m_name);
+            db.add("thread_id", thread_id); // -1 => all threads
+            db.add("event", PerfCounters::event_name(static_cast<PerfCounters::Event>(i)));
+            db.add("value", values.m_values[i]);
+            db.add("num_operations", m_num_operations);
+            db.add("value_per_operation", m_num_operations > 0 ? static_cast<double>(values.m_values[i]) / m_num_operations : 0.0);
+        }
+    };
+
+    for(uint64_t thread_id = 0; thread_id < m_threads.size(); thread_id++){
+        save_values(thread_id, m_threads[thread_id]);
+    }
+    save_values(-1, total);
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *   ScopedPerfCounters                                                      *
+ *                                                                           *
+ *****************************************************************************/
+
+ScopedPerfCounters::ScopedPerfCounters(PerfPhase* phase, uint64_t thread_id) : m_phase(phase), m_thread_id(thread_id) {
+    if(m_phase != nullptr){
+        m_counters.reset(new PerfCounters());
+        m_counters->start();
+    }
+}
+
+ScopedPerfCounters::~ScopedPerfCounters(){
+    if(m_phase != nullptr){
+        m_counters->stop();
+        m_phase->add(m_thread_id, m_counters->read());
+    }
+}
+
+} // namespace
@@ -0,0 +1,160 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace common { class Database; } // forward declaration
+
+namespace gfe::utility {
+
+/**
+ * Hardware counters of the calling thread, read through perf_event_open. The counters that cannot be opened, e.g.
+ * because perf_event_paranoid restricts their access or the PMU does not support them, are simply reported as not
+ * available.
+ */
+class PerfCounters {
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+public:
+    enum Event { CYCLES, INSTRUCTIONS, LLC_MISSES, DTLB_MISSES, BRANCH_MISSES, NUM_EVENTS };
+
+    // A reading of the counters
+    struct Values {
+        uint64_t m_values[NUM_EVENTS] = {0}; // the value of each counter
+        bool m_available[NUM_EVENTS] = {false}; // whether the counter could be read
+
+        // Sum the readings of another thread or another execution
+        Values& operator+=(const Values& other);
+    };
+
+private:
+    int m_fds[NUM_EVENTS]; // file descriptors for each counter, or -1 if not available
+
+public:
+    /**
+     * Open the counters for the calling thread. The counters are initially stopped.
+     */
+    PerfCounters();
+
+    /**
+     * Close the counters
+     */
+    ~PerfCounters();
+
+    /**
+     * Reset and start the counters
+     */
+    void start();
+
+    /**
+     * Stop the counters
+     */
+    void stop();
+
+    /**
+     * Read the current value of the counters, scaled when they were multiplexed with other events
+     */
+    Values read() const;
+
+    /**
+     * Retrieve the name of the given event, as stored in the database
+     */
+    static const char* event_name(Event event);
+};
+
+/**
+ * Collect the hardware counters of all threads executing a phase of an experiment, and save them into the table
+ * `perf_counters', both per thread and aggregated, normalised by the number of operations performed.
+ *
+ * The methods of this class are thread-safe.
+ */
+class PerfPhase {
+    const std::string m_name; // the name of the phase, e.g. `insert_only'
+    mutable std::mutex m_mutex; // sync the threads adding their readings
+    std::vector<PerfCounters::Values> m_threads; // the counters of each thread
+    uint64_t m_num_operations = 0; // the number of operations (insertions, updates, edges traversed) performed in the phase
+
+public:
+    /**
+     * Create a new phase
+     * @param name the name of the phase, as stored in the database
+     */
+    PerfPhase(const std::string& name);
+
+    /**
+     * Add the reading of a thread. The readings for the same thread are summed up.
+     */
+    void add(uint64_t thread_id, const PerfCounters::Values& values);
+
+    /**
+     * Add the number of operations performed, to normalise the counters
+     */
+    void add_operations(uint64_t num_operations);
+
+    /**
+     * Start the counters in the calling thread and, when OpenMP is available, in all threads of its pool
+     */
+    void start_openmp();
+
+    /**
+     * Stop the counters started by #start_openmp and add their readings to the phase
+     */
+    void stop_openmp();
+
+    /**
+     * Retrieve the sum of the counters of all threads
+     */
+    PerfCounters::Values total() const;
+
+    /**
+     * Save the counters into the table `perf_counters' of the given database
+     */
+    void save(common::Database* handle) const;
+
+    /**
+     * Create a new phase if the measurement of the hardware counters has been requested in the configuration,
+     * otherwise return a nullptr
+     */
+    static std::shared_ptr<PerfPhase> create(const std::string& name);
+};
+
+/**
+ * Start the counters of the calling thread at construction, stop them and add their readings to the phase at
+ * destruction. If the phase is a nullptr, this is a nop.
+ */
+class ScopedPerfCounters {
+    ScopedPerfCounters(const ScopedPerfCounters&) = delete;
+    ScopedPerfCounters& operator=(const ScopedPerfCounters&) = delete;
+
+    PerfPhase* m_phase;
+    const uint64_t m_thread_id;
+    std::unique_ptr<PerfCounters> m_counters;
+
+public:
+    ScopedPerfCounters(PerfPhase* phase, uint64_t thread_id);
+    ~ScopedPerfCounters();
+};
+
+} // namespace
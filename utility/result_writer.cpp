@@ -0,0 +1,223 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "result_writer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <fcntl.h>
+#include <memory>
+#include <omp.h>
+#include <unistd.h>
+
+#include "common/error.hpp"
+
+using namespace std;
+
+namespace gfe::utility {
+
+/*****************************************************************************
+ *                                                                           *
+ *  Settings                                                                 *
+ *                                                                           *
+ *****************************************************************************/
+static ResultFormat g_result_format = ResultFormat::TEXT;
+
+void set_result_format(ResultFormat format){
+    g_result_format = format;
+}
+
+ResultFormat get_result_format(){
+    return g_result_format;
+}
+
+/*****************************************************************************
+ *                                                                           *
+ *  Writer                                                                   *
+ *                                                                           *
+ *****************************************************************************/
+namespace details {
+
+static constexpr uint64_t CHUNK_SZ = 1ull << 14; // number of entries serialised together by a thread
+
+// Write the whole buffer at the given offset, return 0 on success or the errno of the failure
+static int pwrite_all(int fd, const char* buffer, uint64_t buffer_sz, uint64_t offset){
+    while(buffer_sz > 0){
+        ssize_t rc = ::pwrite(fd, buffer, buffer_sz, offset);
+        if(rc < 0){
+            if(errno == EINTR) continue;
+            return errno;
+        }
+        buffer += rc;
+        buffer_sz -= rc;
+        offset += rc;
+    }
+    return 0;
+}
+
+void write_results(const char* path, ResultValueType value_type, uint64_t num_entries, const format_fn_t& format){
+    assert(path != nullptr && "File not specified");
+    const bool binary = get_result_format() == ResultFormat::BINARY;
+
+    int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) ERROR("Cannot save the result to `" << path << "': " << strerror(errno));
+
+    uint64_t offset = 0; // where the next round of chunks starts in the file
+    int error = 0; // errno of the first failed write
+    if(binary){
+        BinaryResultHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.m_magic, BINARY_RESULT_MAGIC, sizeof(header.m_magic));
+        header.m_value_type = static_cast<uint32_t>(value_type);
+        header.m_num_entries = num_entries;
+        error = pwrite_all(fd, reinterpret_cast<const char*>(&header), sizeof(header), 0);
+        offset = sizeof(header);
+    }
+
+    const uint64_t entry_sz = binary ? BINARY_ENTRY_SZ : TEXT_ENTRY_MAX_SZ;
+    const uint64_t num_chunks = (num_entries + CHUNK_SZ - 1) / CHUNK_SZ;
+    const int num_threads = static_cast<int>(max<uint64_t>(1, min<uint64_t>(omp_get_max_threads(), num_chunks)));
+    unique_ptr<char[]> buffers { new char[num_threads * CHUNK_SZ * entry_sz] };
+    unique_ptr<uint64_t[]> chunk_sizes { new uint64_t[num_threads] };
+
+    if(error == 0 && num_chunks > 0){
+        // each round, the i-th thread serialises the chunk round + i, then all threads write their chunks at once
+        #pragma omp parallel num_threads(num_threads)
+        {
+            const int thread_id = omp_get_thread_num();
+            const int team_sz = omp_get_num_threads();
+            char* buffer = buffers.get() + thread_id * CHUNK_SZ * entry_sz;
+
+            for(uint64_t round = 0; round < num_chunks; round += team_sz){
+                const uint64_t chunk = round + thread_id;
+                uint64_t buffer_sz = 0;
+                if(chunk < num_chunks){
+                    const uint64_t start = chunk * CHUNK_SZ;
+                    const uint64_t end = min(start + CHUNK_SZ, num_entries);
+                    buffer_sz = format(start, end, buffer) - buffer;
+                }
+                chunk_sizes[thread_id] = buffer_sz;
+
+                #pragma omp barrier
+
+                uint64_t chunk_offset = offset;
+                for(int i = 0; i < thread_id; i++){ chunk_offset += chunk_sizes[i]; }
+                int rc = pwrite_all(fd, buffer, buffer_sz, chunk_offset);
+                if(rc != 0){
+                    #pragma omp critical
+                    error = rc;
+                }
+
+                #pragma omp barrier
+
+                #pragma omp single
+                for(int i = 0; i < team_sz; i++){ offset += chunk_sizes[i]; }
+                // implicit barrier at the end of the single block
+            }
+        }
+    }
+
+    ::close(fd);
+    if(error != 0) ERROR("Cannot save the result to `" << path << "': " << strerror(error));
+}
+
+} // namespace details
+
+/*****************************************************************************
+ *                                                                           *
+ *  Reader                                                                   *
+ *                                                                           *
+ *****************************************************************************/
+
+BinaryResultReader::BinaryResultReader(const std::string& path) : m_handle(nullptr), m_value_type(details::ResultValueType::INT64), m_num_entries(0), m_position(0) {
+    m_handle = fopen(path.c_str(), "rb");
+    if(m_handle == nullptr) ERROR("The result file does not exist or is not accessible. Path: `" << path << "'");
+
+    details::BinaryResultHeader header;
+    if(fread(&header, sizeof(header), 1, m_handle) != 1 || memcmp(header.m_magic, details::BINARY_RESULT_MAGIC, sizeof(header.m_magic)) != 0){
+        fclose(m_handle);
+        ERROR("Invalid header for the binary result file `" << path << "'");
+    }
+    if(header.m_value_type != static_cast<uint32_t>(details::ResultValueType::INT64) && header.m_value_type != static_cast<uint32_t>(details::ResultValueType::DOUBLE)){
+        fclose(m_handle);
+        ERROR("Invalid type of values in the binary result file `" << path << "': " << header.m_value_type);
+    }
+    m_value_type = static_cast<details::ResultValueType>(header.m_value_type);
+    m_num_entries = header.m_num_entries;
+}
+
+BinaryResultReader::~BinaryResultReader(){
+    fclose(m_handle);
+}
+
+bool BinaryResultReader::is_binary(const std::string& path){
+    FILE* handle = fopen(path.c_str(), "rb");
+    if(handle == nullptr) return false;
+    char magic[sizeof(details::BINARY_RESULT_MAGIC)];
+    bool result = fread(magic, sizeof(magic), 1, handle) == 1 && memcmp(magic, details::BINARY_RESULT_MAGIC, sizeof(magic)) == 0;
+    fclose(handle);
+    return result;
+}
+
+uint64_t BinaryResultReader::num_entries() const {
+    return m_num_entries;
+}
+
+bool BinaryResultReader::fetch(uint64_t* out_vertex_id, uint64_t* out_value){
+    uint64_t entry[2];
+    do {
+        if(m_position == m_num_entries) return false;
+        if(fread(entry, sizeof(entry), 1, m_handle) != 1) ERROR("Binary result file truncated, entries read: " << m_position << ", expected: " << m_num_entries);
+        m_position++;
+    } while (entry[0] == numeric_limits<uint64_t>::max()); // skip the invalid vertices
+
+    *out_vertex_id = entry[0];
+    *out_value = entry[1];
+    return true;
+}
+
+bool BinaryResultReader::next(uint64_t* out_vertex_id, int64_t* out_value){
+    uint64_t value;
+    if(!fetch(out_vertex_id, &value)) return false;
+    if(m_value_type == details::ResultValueType::DOUBLE){
+        double d; memcpy(&d, &value, sizeof(d));
+        constexpr double upper_bound = static_cast<double>(numeric_limits<int64_t>::max()); // 2^63
+        if(d >= -upper_bound && d < upper_bound){
+            *out_value = static_cast<int64_t>(d);
+        } else { // saturate, as strtoll does for the text format
+            *out_value = (d < 0) ? numeric_limits<int64_t>::min() : numeric_limits<int64_t>::max();
+        }
+    } else {
+        memcpy(out_value, &value, sizeof(value));
+    }
+    return true;
+}
+
+bool BinaryResultReader::next(uint64_t* out_vertex_id, double* out_value){
+    uint64_t value;
+    if(!fetch(out_vertex_id, &value)) return false;
+    if(m_value_type == details::ResultValueType::DOUBLE){
+        memcpy(out_value, &value, sizeof(value));
+    } else {
+        int64_t i; memcpy(&i, &value, sizeof(i));
+        *out_value = static_cast<double>(i);
+    }
+    return true;
+}
+
+} // namespace
@@ -0,0 +1,201 @@
+/**
+ * Copyright (C) 2019 Dean De Leo, email: dleo[at]cwi.nl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <charconv>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gfe::utility {
+
+/**
+ * Format of the files with the results of the Graphalytics kernels, as saved by #save_results.
+ */
+enum class ResultFormat {
+    TEXT, // one line `<vertex> <value>' for each vertex, the format of the reference files from Graphalytics
+    BINARY, // a fixed size header, followed by the pairs <vertex, value> as 64-bit words in the native byte order
+};
+
+/**
+ * Set the format of the files saved by #save_results. The setting is global for the whole process and it is
+ * not thread-safe, it is meant to be set once, at start up. The default is ResultFormat::TEXT.
+ */
+void set_result_format(ResultFormat format);
+
+/**
+ * Retrieve the format of the files saved by #save_results
+ */
+ResultFormat get_result_format();
+
+namespace details {
+
+// The type of the values stored in a binary file
+enum class ResultValueType : uint32_t { INT64 = 0, DOUBLE = 1 };
+
+// Header of the files in the binary format
+struct BinaryResultHeader {
+    char m_magic[8]; // BINARY_RESULT_MAGIC
+    uint32_t m_value_type; // ResultValueType
+    uint32_t m_unused; // padding
+    uint64_t m_num_entries; // number of pairs <vertex, value> that follow the header
+};
+
+constexpr char BINARY_RESULT_MAGIC[8] = { 'G', 'F', 'E', 'R', 'E', 'S', '0', '1' };
+constexpr uint64_t BINARY_ENTRY_SZ = 2 * sizeof(uint64_t); // vertex ID + value
+constexpr uint64_t TEXT_ENTRY_MAX_SZ = 64; // upper bound to the length of a line: vertex (20 digits) + double (24 chars) + separators
+
+// Serialise the entries in the interval [start, end) into the buffer, return the position after the last byte written
+using format_fn_t = std::function<char* (uint64_t start, uint64_t end, char* buffer)>;
+
+/**
+ * Create the file `path' with `num_entries' entries in the format given by #get_result_format. The entries are
+ * serialised in chunks, concurrently by the OpenMP threads into private buffers, and the chunks are written in
+ * order with pwrite, each one at the file offset given by the size of the preceding chunks.
+ */
+void write_results(const char* path, ResultValueType value_type, uint64_t num_entries, const format_fn_t& format);
+
+// Replace the negative scores with the largest value representable, as expected by the validation of the BFS
+template<typename T, bool negative_scores>
+T adjust_score(T value){
+    if constexpr (!negative_scores && std::is_signed_v<T>) {
+        if(value < 0) return std::numeric_limits<T>::max();
+    }
+    return value;
+}
+
+} // namespace details
+
+/**
+ * Save the results of a Graphalytics kernel into the given file, in the format set by #set_result_format. The
+ * accessor get(i), for i in [0, num_entries), returns the pair <vertex ID, score> of the i-th entry. It is invoked
+ * concurrently by multiple threads. Entries with the vertex ID equal to numeric_limits<uint64_t>::max() denote
+ * invalid vertices and are ignored. When negative_scores is false, the negative scores are replaced with the maximum
+ * value of T, as for the unreachable vertices in the BFS.
+ */
+template<typename T, bool negative_scores = true, typename Get>
+void save_results_with(uint64_t num_entries, Get&& get, const char* path){
+    static_assert(std::is_arithmetic_v<T>, "Expected a numeric value for the scores");
+    using details::ResultValueType;
+    constexpr ResultValueType value_type = std::is_floating_point_v<T> ? ResultValueType::DOUBLE : ResultValueType::INT64;
+
+    if(get_result_format() == ResultFormat::BINARY){
+        details::write_results(path, value_type, num_entries, [&get](uint64_t start, uint64_t end, char* buffer){
+            for(uint64_t i = start; i < end; i++){
+                const auto entry = get(i);
+                const uint64_t vertex_id = entry.first;
+                const T score = details::adjust_score<T, negative_scores>(entry.second);
+                memcpy(buffer, &vertex_id, sizeof(vertex_id));
+                if constexpr (value_type == ResultValueType::DOUBLE) {
+                    const double value = score;
+                    memcpy(buffer + sizeof(uint64_t), &value, sizeof(value));
+                } else {
+                    constexpr uint64_t max_value = std::numeric_limits<int64_t>::max();
+                    // unsigned scores beyond the range of an int64_t saturate, as strtoll does for the text format
+                    const int64_t value = (std::is_unsigned_v<T> && static_cast<uint64_t>(score) > max_value) ? static_cast<int64_t>(max_value) : static_cast<int64_t>(score);
+                    memcpy(buffer + sizeof(uint64_t), &value, sizeof(value));
+                }
+                buffer += details::BINARY_ENTRY_SZ;
+            }
+            return buffer;
+        });
+    } else {
+        details::write_results(path, value_type, num_entries, [&get](uint64_t start, uint64_t end, char* buffer){
+            for(uint64_t i = start; i < end; i++){
+                const auto entry = get(i);
+                if(entry.first == std::numeric_limits<uint64_t>::max()) continue; // invalid vertex
+                char* line_end = buffer + details::TEXT_ENTRY_MAX_SZ;
+                buffer = std::to_chars(buffer, line_end, static_cast<uint64_t>(entry.first)).ptr;
+                *(buffer++) = ' ';
+                const T score = details::adjust_score<T, negative_scores>(entry.second);
+                buffer = std::to_chars(buffer, line_end, score).ptr; // shortest repr. for floats, `inf' for infinity
+                *(buffer++) = '\n';
+            }
+            return buffer;
+        });
+    }
+}
+
+/**
+ * Save the results of a Graphalytics kernel, a pair <vertex ID, score> for each vertex, as in #save_results_with
+ */
+template<typename T, bool negative_scores = true>
+void save_results(const std::vector<std::pair<uint64_t, T>>& result, const char* path){
+    save_results_with<T, negative_scores>(result.size(), [&result](uint64_t i){ return result[i]; }, path);
+}
+
+/**
+ * Save the results of a Graphalytics kernel for a dense set of vertices, where the vertex ID is the position in the
+ * array of scores
+ */
+template<typename T, bool negative_scores = true>
+void save_results(const T* __restrict scores, uint64_t num_scores, const char* path){
+    save_results_with<T, negative_scores>(num_scores, [scores](uint64_t i){ return std::make_pair(i, scores[i]); }, path);
+}
+
+/**
+ * Sequential reader of the files saved in the binary format
+ */
+class BinaryResultReader {
+    BinaryResultReader(const BinaryResultReader&) = delete;
+    BinaryResultReader& operator=(const BinaryResultReader&) = delete;
+
+    FILE* m_handle; // file being read
+    details::ResultValueType m_value_type; // whether the values are stored as int64_t or double
+    uint64_t m_num_entries; // total number of entries in the file
+    uint64_t m_position; // number of entries read so far
+
+    // Read the next entry with a valid vertex, return false when the end of the file has been reached
+    bool fetch(uint64_t* out_vertex_id, uint64_t* out_value);
+
+public:
+    /**
+     * Open the given file, the header must be valid
+     */
+    BinaryResultReader(const std::string& path);
+
+    /**
+     * Destructor
+     */
+    ~BinaryResultReader();
+
+    /**
+     * Check whether the given file starts with the header of the binary format
+     */
+    static bool is_binary(const std::string& path);
+
+    /**
+     * Total number of entries in the file, including the invalid vertices
+     */
+    uint64_t num_entries() const;
+
+    /**
+     * Read the next entry, skipping the invalid vertices, and convert its value to the requested type.
+     * Return false when the end of the file has been reached.
+     */
+    bool next(uint64_t* out_vertex_id, int64_t* out_value);
+    bool next(uint64_t* out_vertex_id, double* out_value);
+};
+
+} // namespace